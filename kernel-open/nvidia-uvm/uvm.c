@@ -1046,6 +1046,8 @@ static long uvm_ioctl(struct file *filp, unsigned int cmd, unsigned long arg)
         UVM_ROUTE_CMD_STACK_INIT_CHECK(UVM_TOOLS_GET_PROCESSOR_UUID_TABLE_V2,uvm_api_tools_get_processor_uuid_table_v2);
         UVM_ROUTE_CMD_STACK_INIT_CHECK(UVM_ALLOC_DEVICE_P2P,               uvm_api_alloc_device_p2p);
         UVM_ROUTE_CMD_STACK_INIT_CHECK(UVM_CLEAR_ALL_ACCESS_COUNTERS,      uvm_api_clear_all_access_counters);
+        UVM_ROUTE_CMD_STACK_INIT_CHECK(UVM_MIGRATE_BATCH,                  uvm_api_migrate_batch);
+        UVM_ROUTE_CMD_STACK_INIT_CHECK(UVM_SET_CPU_NUMA_PLACEMENT,         uvm_api_set_cpu_numa_placement);
     }
 
     // Try the test ioctls if none of the above matched
@@ -120,11 +120,13 @@ static NV_STATUS service_ats_requests(uvm_gpu_va_space_t *gpu_va_space,
 static void flush_tlb_va_region(uvm_gpu_va_space_t *gpu_va_space,
                                 NvU64 addr,
                                 size_t size,
-                                uvm_fault_client_type_t client_type)
+                                uvm_ats_fault_context_t *ats_context)
 {
     uvm_ats_fault_invalidate_t *ats_invalidate;
 
-    if (client_type == UVM_FAULT_CLIENT_TYPE_GPC)
+    if (ats_context->ats_invalidate)
+        ats_invalidate = ats_context->ats_invalidate;
+    else if (ats_context->client_type == UVM_FAULT_CLIENT_TYPE_GPC)
         ats_invalidate = &gpu_va_space->gpu->parent->fault_buffer.replayable.ats_invalidate;
     else
         ats_invalidate = &gpu_va_space->gpu->parent->fault_buffer.non_replayable.ats_invalidate;
@@ -562,7 +564,7 @@ static NV_STATUS uvm_ats_service_faults_region(uvm_gpu_va_space_t *gpu_va_space,
     // RW transitions for all page sizes. See the uvm_ats_smmu_invalidate_tlbs()
     // call above.
     if (PAGE_SIZE == UVM_PAGE_SIZE_4K || (UVM_ATS_SMMU_WAR_REQUIRED() && access_type == UVM_FAULT_ACCESS_TYPE_WRITE)) {
-        flush_tlb_va_region(gpu_va_space, start, length, ats_context->client_type);
+        flush_tlb_va_region(gpu_va_space, start, length, ats_context);
     }
     else {
         // ARM requires TLB invalidations on RO -> RW, but not all architectures
@@ -26,6 +26,7 @@
 #include "uvm_hal.h"
 #include "uvm_kvmalloc.h"
 #include "uvm_push.h"
+#include "uvm_pte_batch.h"
 #include "uvm_test.h"
 #include "uvm_tracker.h"
 #include "uvm_va_space.h"
@@ -1234,6 +1235,136 @@ static NV_STATUS test_encryption_decryption(uvm_gpu_t *gpu,
     return NV_OK;
 }
 
+#define PTE_BATCH_TEST_ENTRIES 512
+
+static NvU64 pte_batch_test_value(NvU32 index)
+{
+    return ((NvU64)index << 32) | (index + 1);
+}
+
+static bool pte_batch_test_written(NvU32 index, NvU32 run_length, NvU32 gap_length)
+{
+    return index % (run_length + gap_length) < run_length;
+}
+
+// Write runs of run_length PTEs separated by gaps of gap_length PTEs with a
+// single PTE batch and check that only the PTEs in the runs are written. Also
+// compare the pushbuffer space taken by the batch against a memset per PTE.
+static NV_STATUS test_pte_batch_runs(uvm_gpu_t *gpu, uvm_mem_t *mem, NvU32 run_length, NvU32 gap_length)
+{
+    NvU64 *cpu_ptes = uvm_mem_get_cpu_addr_kernel(mem);
+    uvm_gpu_phys_address_t first_pte = uvm_mem_gpu_physical(mem, gpu, 0, PTE_BATCH_TEST_ENTRIES * sizeof(NvU64));
+    uvm_pte_batch_t batch;
+    uvm_push_t push;
+    NvU32 memset_size, batch_size;
+    NvU32 i;
+
+    memset(cpu_ptes, 0xff, PTE_BATCH_TEST_ENTRIES * sizeof(NvU64));
+
+    // The reference push writes the same value as the initial one, so that it
+    // doesn't hide missing writes from the batch.
+    TEST_NV_CHECK_RET(uvm_push_begin(gpu->channel_manager,
+                                     UVM_CHANNEL_TYPE_GPU_TO_CPU,
+                                     &push,
+                                     "PTE memsets runs %u gaps %u",
+                                     run_length,
+                                     gap_length));
+    memset_size = uvm_push_get_size(&push);
+
+    for (i = 0; i < PTE_BATCH_TEST_ENTRIES; i++) {
+        uvm_gpu_phys_address_t pte = first_pte;
+
+        if (!pte_batch_test_written(i, run_length, gap_length))
+            continue;
+
+        pte.address += i * sizeof(NvU64);
+        uvm_push_set_flag(&push, UVM_PUSH_FLAG_NEXT_MEMBAR_NONE);
+        uvm_push_set_flag(&push, UVM_PUSH_FLAG_CE_NEXT_PIPELINED);
+        gpu->parent->ce_hal->memset_8(&push, uvm_mmu_gpu_address(gpu, pte), ~0ull, sizeof(NvU64));
+    }
+
+    uvm_hal_wfi_membar(&push, UVM_MEMBAR_SYS);
+    memset_size = uvm_push_get_size(&push) - memset_size;
+    TEST_NV_CHECK_RET(uvm_push_end_and_wait(&push));
+
+    TEST_NV_CHECK_RET(uvm_push_begin(gpu->channel_manager,
+                                     UVM_CHANNEL_TYPE_GPU_TO_CPU,
+                                     &push,
+                                     "PTE batch runs %u gaps %u",
+                                     run_length,
+                                     gap_length));
+    batch_size = uvm_push_get_size(&push);
+
+    uvm_pte_batch_begin(&push, &batch);
+
+    for (i = 0; i < PTE_BATCH_TEST_ENTRIES; i++) {
+        uvm_gpu_phys_address_t pte = first_pte;
+
+        if (!pte_batch_test_written(i, run_length, gap_length))
+            continue;
+
+        pte.address += i * sizeof(NvU64);
+        uvm_pte_batch_write_pte(&batch, pte, pte_batch_test_value(i), sizeof(NvU64));
+    }
+
+    uvm_pte_batch_end(&batch);
+    batch_size = uvm_push_get_size(&push) - batch_size;
+    TEST_NV_CHECK_RET(uvm_push_end_and_wait(&push));
+
+    for (i = 0; i < PTE_BATCH_TEST_ENTRIES; i++) {
+        NvU64 expected = pte_batch_test_written(i, run_length, gap_length) ? pte_batch_test_value(i) : ~0ull;
+
+        if (cpu_ptes[i] != expected) {
+            UVM_TEST_PRINT("PTE %u is 0x%llx instead of 0x%llx, runs %u gaps %u, GPU %s\n",
+                           i,
+                           cpu_ptes[i],
+                           expected,
+                           run_length,
+                           gap_length,
+                           uvm_gpu_name(gpu));
+            return NV_ERR_INVALID_STATE;
+        }
+    }
+
+    // Runs longer than the memset queue are written with inline memcopies,
+    // which take less space than a memset per PTE.
+    if (run_length > UVM_PTE_BATCH_MAX_PTES)
+        TEST_CHECK_RET(batch_size < memset_size);
+
+    return NV_OK;
+}
+
+static NV_STATUS test_pte_batch(uvm_gpu_t *gpu)
+{
+    NV_STATUS status = NV_OK;
+    uvm_mem_t *mem = NULL;
+
+    // TODO: Bug 3839176: the test is waived on Confidential Computing because
+    // it assumes that GPU can access system memory without using encryption.
+    if (g_uvm_global.conf_computing_enabled)
+        return NV_OK;
+
+    TEST_NV_CHECK_RET(uvm_mem_alloc_sysmem_dma_and_map_cpu_kernel(PTE_BATCH_TEST_ENTRIES * sizeof(NvU64),
+                                                                  gpu,
+                                                                  NULL,
+                                                                  &mem));
+    TEST_NV_CHECK_GOTO(uvm_mem_map_gpu_phys(mem, gpu), done);
+
+    // Isolated PTEs only ever use the memset queue
+    TEST_NV_CHECK_GOTO(test_pte_batch_runs(gpu, mem, 1, 1), done);
+
+    // Runs just over the memset queue, more than UVM_PTE_BATCH_MAX_RUNS of
+    // them
+    TEST_NV_CHECK_GOTO(test_pte_batch_runs(gpu, mem, UVM_PTE_BATCH_MAX_PTES + 1, 3), done);
+    TEST_NV_CHECK_GOTO(test_pte_batch_runs(gpu, mem, 64, 1), done);
+    TEST_NV_CHECK_GOTO(test_pte_batch_runs(gpu, mem, PTE_BATCH_TEST_ENTRIES, 0), done);
+
+done:
+    uvm_mem_free(mem);
+
+    return status;
+}
+
 static NV_STATUS test_ce(uvm_va_space_t *va_space, bool skipTimestampTest)
 {
     uvm_gpu_t *gpu;
@@ -1242,6 +1373,7 @@ static NV_STATUS test_ce(uvm_va_space_t *va_space, bool skipTimestampTest)
         TEST_NV_CHECK_RET(test_non_pipelined(gpu));
         TEST_NV_CHECK_RET(test_membar(gpu));
         TEST_NV_CHECK_RET(test_memcpy_and_memset(gpu));
+        TEST_NV_CHECK_RET(test_pte_batch(gpu));
         TEST_NV_CHECK_RET(test_semaphore_reduction_inc(gpu));
         TEST_NV_CHECK_RET(test_semaphore_release(gpu));
 
@@ -1255,6 +1387,156 @@ static NV_STATUS test_ce(uvm_va_space_t *va_space, bool skipTimestampTest)
     return NV_OK;
 }
 
+typedef enum
+{
+    // One push per VA block, one CE transfer per page
+    CE_COPY_BANDWIDTH_PER_PAGE,
+
+    // One push per VA block, one CE transfer per VA block
+    CE_COPY_BANDWIDTH_PER_BLOCK,
+
+    // A single push and CE transfer for the whole range
+    CE_COPY_BANDWIDTH_COALESCED,
+
+    CE_COPY_BANDWIDTH_COUNT
+} ce_copy_bandwidth_mode_t;
+
+// Copy size bytes from src to dst, splitting the work in pushes and CE
+// transfers according to mode, and wait for completion.
+static NV_STATUS ce_copy_bandwidth_run(uvm_gpu_t *gpu,
+                                       uvm_gpu_address_t dst,
+                                       uvm_gpu_address_t src,
+                                       NvU64 size,
+                                       ce_copy_bandwidth_mode_t mode)
+{
+    NV_STATUS status = NV_OK;
+    uvm_tracker_t tracker = UVM_TRACKER_INIT();
+    NvU64 push_size = (mode == CE_COPY_BANDWIDTH_COALESCED) ? size : UVM_VA_BLOCK_SIZE;
+    NvU64 copy_size = (mode == CE_COPY_BANDWIDTH_PER_PAGE) ? PAGE_SIZE : push_size;
+    NvU64 push_offset;
+
+    for (push_offset = 0; push_offset < size; push_offset += push_size) {
+        uvm_push_t push;
+        NvU64 offset;
+
+        status = uvm_push_begin(gpu->channel_manager,
+                                UVM_CHANNEL_TYPE_GPU_INTERNAL,
+                                &push,
+                                "CE copy bandwidth, mode %d, offset 0x%llx",
+                                mode,
+                                push_offset);
+        if (status != NV_OK)
+            goto done;
+
+        for (offset = push_offset; offset < push_offset + push_size; offset += copy_size) {
+            uvm_gpu_address_t copy_dst = dst;
+            uvm_gpu_address_t copy_src = src;
+
+            copy_dst.address += offset;
+            copy_src.address += offset;
+
+            // The transfers don't overlap, so only the first one in the push
+            // needs to be non-pipelined, and a single membar at the end of the
+            // push is enough.
+            if (offset != push_offset)
+                uvm_push_set_flag(&push, UVM_PUSH_FLAG_CE_NEXT_PIPELINED);
+
+            uvm_push_set_flag(&push, UVM_PUSH_FLAG_NEXT_MEMBAR_NONE);
+
+            gpu->parent->ce_hal->memcopy(&push, copy_dst, copy_src, copy_size);
+        }
+
+        uvm_push_end(&push);
+
+        status = uvm_tracker_add_push(&tracker, &push);
+        if (status != NV_OK)
+            goto done;
+    }
+
+done:
+    if (status == NV_OK)
+        status = uvm_tracker_wait_deinit(&tracker);
+    else
+        uvm_tracker_deinit(&tracker);
+
+    return status;
+}
+
+// Measure the time it takes to copy a vidmem range of the given size when the
+// copy is split per page, per VA block, or done at once. The latter is what
+// migrations of physically-contiguous ranges can achieve when copies are
+// coalesced.
+static NV_STATUS test_ce_copy_bandwidth(uvm_gpu_t *gpu, NvU64 size, NvU32 iterations, NvU64 *elapsed_ns)
+{
+    NV_STATUS status = NV_OK;
+    uvm_mem_t *src_mem = NULL;
+    uvm_mem_t *dst_mem = NULL;
+    uvm_gpu_address_t src;
+    uvm_gpu_address_t dst;
+    ce_copy_bandwidth_mode_t mode;
+
+    TEST_NV_CHECK_GOTO(uvm_mem_alloc_vidmem(size, gpu, &src_mem), done);
+    TEST_NV_CHECK_GOTO(uvm_mem_map_gpu_kernel(src_mem, gpu), done);
+    TEST_NV_CHECK_GOTO(uvm_mem_alloc_vidmem(size, gpu, &dst_mem), done);
+    TEST_NV_CHECK_GOTO(uvm_mem_map_gpu_kernel(dst_mem, gpu), done);
+
+    src = uvm_mem_gpu_address_virtual_kernel(src_mem, gpu);
+    dst = uvm_mem_gpu_address_virtual_kernel(dst_mem, gpu);
+
+    for (mode = 0; mode < CE_COPY_BANDWIDTH_COUNT; mode++) {
+        NvU64 start;
+        NvU32 i;
+
+        // Warm up the channels and the GPU mappings
+        TEST_NV_CHECK_GOTO(ce_copy_bandwidth_run(gpu, dst, src, size, mode), done);
+
+        start = NV_GETTIME();
+
+        for (i = 0; i < iterations; i++)
+            TEST_NV_CHECK_GOTO(ce_copy_bandwidth_run(gpu, dst, src, size, mode), done);
+
+        elapsed_ns[mode] = NV_GETTIME() - start;
+    }
+
+done:
+    uvm_mem_free(dst_mem);
+    uvm_mem_free(src_mem);
+
+    return status;
+}
+
+NV_STATUS uvm_test_ce_copy_bandwidth(UVM_TEST_CE_COPY_BANDWIDTH_PARAMS *params, struct file *filp)
+{
+    NV_STATUS status;
+    uvm_va_space_t *va_space = uvm_va_space_get(filp);
+    NvU64 elapsed_ns[CE_COPY_BANDWIDTH_COUNT] = {0};
+    uvm_gpu_t *gpu;
+
+    if (params->size == 0 || !IS_ALIGNED(params->size, UVM_VA_BLOCK_SIZE) || params->iterations == 0)
+        return NV_ERR_INVALID_ARGUMENT;
+
+    uvm_va_space_down_read_rm(va_space);
+
+    gpu = uvm_va_space_get_gpu_by_uuid(va_space, &params->gpu_uuid);
+    if (gpu == NULL) {
+        status = NV_ERR_INVALID_DEVICE;
+        goto done;
+    }
+
+    status = test_ce_copy_bandwidth(gpu, params->size, params->iterations, elapsed_ns);
+    if (status != NV_OK)
+        goto done;
+
+    params->per_page_ns = elapsed_ns[CE_COPY_BANDWIDTH_PER_PAGE];
+    params->per_block_ns = elapsed_ns[CE_COPY_BANDWIDTH_PER_BLOCK];
+    params->coalesced_ns = elapsed_ns[CE_COPY_BANDWIDTH_COALESCED];
+
+done:
+    uvm_va_space_up_read_rm(va_space);
+
+    return status;
+}
+
 NV_STATUS uvm_test_ce_sanity(UVM_TEST_CE_SANITY_PARAMS *params, struct file *filp)
 {
     NV_STATUS status;
@@ -80,14 +80,24 @@ static char *uvm_channel_gpput_loc = UVM_CHANNEL_GPPUT_LOC_DEFAULT;
 
 static char *uvm_channel_pushbuffer_loc = UVM_CHANNEL_PUSHBUFFER_LOC_DEFAULT;
 
+// Direct new pushes to the channel with the fewest in-flight bytes, striping
+// work of a channel type across all the Copy Engines that are equivalent for
+// that type. When disabled, the first available channel in the pool of the
+// preferred CE is used.
+#define UVM_CHANNEL_CE_LOAD_BALANCE_DEFAULT 1
+
+static unsigned uvm_channel_ce_load_balance = UVM_CHANNEL_CE_LOAD_BALANCE_DEFAULT;
+
 module_param(uvm_channel_num_gpfifo_entries, uint, S_IRUGO);
 module_param(uvm_channel_gpfifo_loc, charp, S_IRUGO);
 module_param(uvm_channel_gpput_loc, charp, S_IRUGO);
 module_param(uvm_channel_pushbuffer_loc, charp, S_IRUGO);
+module_param(uvm_channel_ce_load_balance, uint, S_IRUGO);
 
 static NV_STATUS manager_create_procfs_dirs(uvm_channel_manager_t *manager);
 static NV_STATUS manager_create_procfs(uvm_channel_manager_t *manager);
 static NV_STATUS channel_create_procfs(uvm_channel_t *channel);
+static uvm_channel_pool_t *channel_manager_ce_pool(uvm_channel_manager_t *manager, NvU32 ce);
 
 typedef enum
 {
@@ -221,6 +231,11 @@ static NvU32 uvm_channel_update_progress_with_max(uvm_channel_t *channel,
         if (entry->type == UVM_GPFIFO_ENTRY_TYPE_NORMAL) {
             uvm_pushbuffer_mark_completed(channel, entry);
             list_add_tail(&entry->push_info->available_list_node, &channel->available_push_infos);
+
+            UVM_ASSERT(channel->in_flight_bytes >= entry->transferred_bytes);
+            channel->in_flight_bytes -= entry->transferred_bytes;
+            channel->pool->stats.completed_bytes += entry->transferred_bytes;
+            channel->pool->stats.completed_pushes++;
         }
 
         gpu_get = (gpu_get + 1) % channel->num_gpfifo_entries;
@@ -580,6 +595,62 @@ done:
     return NV_OK;
 }
 
+// Whether the oldest pending GPFIFO entry of the channel is already known to
+// have completed. Only the completed value cached by the last read of the
+// tracking semaphore is used, the semaphore itself is not read.
+static bool channel_has_retirable_entries(uvm_channel_t *channel)
+{
+    if (channel->gpu_get == channel->cpu_put)
+        return false;
+
+    return channel->gpfifo_entries[channel->gpu_get].tracking_semaphore_value <=
+           (NvU64)atomic64_read(&channel->tracking_sem.completed_value);
+}
+
+// Find the channel in the pool with the fewest in-flight bytes that can accept
+// a new push without waiting. Only channels with strictly fewer in-flight bytes
+// than *least_bytes are considered, in which case *least_bytes is updated.
+// Returns NULL if no such channel exists.
+//
+// The cached in_flight_bytes are compared. Completed pushes are only retired
+// for channels on which some completion has already been observed, e.g. by a
+// tracker wait, so the common case doesn't touch the GPFIFO or the semaphores.
+//
+// The channel is not claimed, so it may no longer be available by the time the
+// caller tries to claim it.
+static uvm_channel_t *channel_pool_find_least_loaded(uvm_channel_pool_t *pool,
+                                                     uvm_channel_reserve_type_t reserve_type,
+                                                     NvU64 *least_bytes)
+{
+    uvm_channel_t *channel;
+    uvm_channel_t *least_loaded = NULL;
+
+    uvm_for_each_channel_in_pool(channel, pool) {
+        channel_pool_lock(pool);
+
+        if (channel_has_retirable_entries(channel)) {
+            channel_pool_unlock(pool);
+            uvm_channel_update_progress(channel);
+            channel_pool_lock(pool);
+        }
+
+        if (channel->in_flight_bytes < *least_bytes &&
+            !(reserve_type == UVM_CHANNEL_RESERVE_WITH_P2P && channel->suspended_p2p) &&
+            channel_get_available_gpfifo_entries(channel) > 0) {
+            *least_bytes = channel->in_flight_bytes;
+            least_loaded = channel;
+        }
+
+        channel_pool_unlock(pool);
+
+        // An idle channel cannot be beaten
+        if (*least_bytes == 0)
+            break;
+    }
+
+    return least_loaded;
+}
+
 // Reserve a channel in the specified pool
 static NV_STATUS channel_reserve_in_pool(uvm_channel_pool_t *pool,
                                          uvm_channel_reserve_type_t reserve_type,
@@ -593,8 +664,17 @@ static NV_STATUS channel_reserve_in_pool(uvm_channel_pool_t *pool,
     if (g_uvm_global.conf_computing_enabled)
         return channel_reserve_and_lock_in_pool(pool, reserve_type, channel_out);
 
+    if (uvm_channel_ce_load_balance && pool->num_channels > 1) {
+        NvU64 least_bytes = U64_MAX;
+
+        channel = channel_pool_find_least_loaded(pool, reserve_type, &least_bytes);
+        if (channel && try_claim_channel(channel, 1, reserve_type)) {
+            *channel_out = channel;
+            return NV_OK;
+        }
+    }
+
     uvm_for_each_channel_in_pool(channel, pool) {
-        // TODO: Bug 1764953: Prefer idle/less busy channels
         if (try_claim_channel(channel, 1, reserve_type)) {
             *channel_out = channel;
             return NV_OK;
@@ -630,6 +710,60 @@ static NV_STATUS channel_reserve_in_pool(uvm_channel_pool_t *pool,
     return NV_ERR_GENERIC;
 }
 
+static bool channel_type_is_balanced(uvm_channel_manager_t *manager, uvm_channel_type_t type)
+{
+    if (!uvm_channel_ce_load_balance)
+        return false;
+
+    if (g_uvm_global.conf_computing_enabled)
+        return false;
+
+    if (type >= UVM_CHANNEL_TYPE_CE_COUNT)
+        return false;
+
+    return bitmap_weight(manager->pool_to_use.balanced_ces[type], UVM_COPY_ENGINE_COUNT_MAX) > 1;
+}
+
+// Reserve the least loaded channel among the pools of all the CEs balanced for
+// the given type. Ties are resolved in favor of the default pool for the type,
+// so a lightly loaded GPU keeps using the preferred CE. If the selected channel
+// cannot be claimed, fall back to waiting on the default pool.
+static NV_STATUS channel_reserve_balanced(uvm_channel_manager_t *manager,
+                                          uvm_channel_type_t type,
+                                          uvm_channel_reserve_type_t reserve_type,
+                                          uvm_channel_t **channel_out)
+{
+    uvm_channel_pool_t *default_pool = manager->pool_to_use.default_for_type[type];
+    uvm_channel_t *least_loaded;
+    NvU64 least_bytes = U64_MAX;
+    unsigned ce;
+
+    least_loaded = channel_pool_find_least_loaded(default_pool, reserve_type, &least_bytes);
+
+    for_each_set_bit(ce, manager->pool_to_use.balanced_ces[type], UVM_COPY_ENGINE_COUNT_MAX) {
+        uvm_channel_pool_t *pool;
+        uvm_channel_t *channel;
+
+        if (least_bytes == 0)
+            break;
+
+        pool = channel_manager_ce_pool(manager, ce);
+        if (pool == default_pool)
+            continue;
+
+        channel = channel_pool_find_least_loaded(pool, reserve_type, &least_bytes);
+        if (channel)
+            least_loaded = channel;
+    }
+
+    if (least_loaded && try_claim_channel(least_loaded, 1, reserve_type)) {
+        *channel_out = least_loaded;
+        return NV_OK;
+    }
+
+    return channel_reserve_in_pool(default_pool, reserve_type, channel_out);
+}
+
 NV_STATUS uvm_channel_reserve_type(uvm_channel_manager_t *manager, uvm_channel_type_t type, uvm_channel_t **channel_out)
 {
     uvm_channel_reserve_type_t reserve_type;
@@ -643,6 +777,9 @@ NV_STATUS uvm_channel_reserve_type(uvm_channel_manager_t *manager, uvm_channel_t
     else
         reserve_type = UVM_CHANNEL_RESERVE_NO_P2P;
 
+    if (channel_type_is_balanced(manager, type))
+        return channel_reserve_balanced(manager, type, reserve_type, channel_out);
+
     return channel_reserve_in_pool(pool, reserve_type, channel_out);
 }
 
@@ -1552,6 +1689,8 @@ void uvm_channel_end_push(uvm_push_t *push)
 
     entry->push_info = &channel->push_infos[push->push_info_index];
     entry->type = UVM_GPFIFO_ENTRY_TYPE_NORMAL;
+    entry->transferred_bytes = push->transferred_bytes;
+    channel->in_flight_bytes += push->transferred_bytes;
 
     UVM_ASSERT(channel->current_gpfifo_count > 0);
     --channel->current_gpfifo_count;
@@ -2969,21 +3108,13 @@ static unsigned ce_usage_count(NvU32 ce, const unsigned *preferred_ce)
     return count;
 }
 
-// Returns negative if the first CE should be considered better than the second
-static int compare_ce_for_channel_type(const UvmGpuCopyEngineCaps *ce_caps,
-                                       uvm_channel_type_t type,
-                                       NvU32 ce_index0,
-                                       NvU32 ce_index1,
-                                       NvU32 *preferred_ce)
+// Compare the capabilities of two CEs that are relevant to the given channel
+// type. Returns negative if the first CE should be considered better than the
+// second, and zero if both CEs are equivalent for the type.
+static int compare_ce_caps_for_channel_type(const UvmGpuCopyEngineCaps *cap0,
+                                            const UvmGpuCopyEngineCaps *cap1,
+                                            uvm_channel_type_t type)
 {
-    unsigned ce0_usage, ce1_usage;
-    const UvmGpuCopyEngineCaps *cap0 = ce_caps + ce_index0;
-    const UvmGpuCopyEngineCaps *cap1 = ce_caps + ce_index1;
-
-    UVM_ASSERT(ce_index0 < UVM_COPY_ENGINE_COUNT_MAX);
-    UVM_ASSERT(ce_index1 < UVM_COPY_ENGINE_COUNT_MAX);
-    UVM_ASSERT(ce_index0 != ce_index1);
-
     switch (type) {
         // For CPU to GPU fast sysmem read is the most important
         case UVM_CHANNEL_TYPE_CPU_TO_GPU:
@@ -3048,9 +3179,32 @@ static int compare_ce_for_channel_type(const UvmGpuCopyEngineCaps *ce_caps,
 
         default:
             UVM_ASSERT_MSG(false, "Unexpected channel type 0x%x\n", type);
-            return 0;
+            break;
     }
 
+    return 0;
+}
+
+// Returns negative if the first CE should be considered better than the second
+static int compare_ce_for_channel_type(const UvmGpuCopyEngineCaps *ce_caps,
+                                       uvm_channel_type_t type,
+                                       NvU32 ce_index0,
+                                       NvU32 ce_index1,
+                                       NvU32 *preferred_ce)
+{
+    unsigned ce0_usage, ce1_usage;
+    const UvmGpuCopyEngineCaps *cap0 = ce_caps + ce_index0;
+    const UvmGpuCopyEngineCaps *cap1 = ce_caps + ce_index1;
+    int caps_diff;
+
+    UVM_ASSERT(ce_index0 < UVM_COPY_ENGINE_COUNT_MAX);
+    UVM_ASSERT(ce_index1 < UVM_COPY_ENGINE_COUNT_MAX);
+    UVM_ASSERT(ce_index0 != ce_index1);
+
+    caps_diff = compare_ce_caps_for_channel_type(cap0, cap1, type);
+    if (caps_diff != 0)
+        return caps_diff;
+
     // By default, prefer less used CEs (within the UVM driver at least)
     ce0_usage = ce_usage_count(ce_index0, preferred_ce);
     ce1_usage = ce_usage_count(ce_index1, preferred_ce);
@@ -3121,9 +3275,31 @@ static void pick_ces(uvm_channel_manager_t *manager, const UvmGpuCopyEngineCaps
                                                 UVM_CHANNEL_TYPE_GPU_TO_GPU,
                                                 UVM_CHANNEL_TYPE_MEMOPS };
 
+    // Channel types that stripe their pushes across all the CEs equivalent to
+    // the preferred one. GPU_TO_GPU already selects an optimal CE per peer,
+    // and MEMOPS is latency sensitive, so they keep using a single CE.
+    static const uvm_channel_type_t balanced_types[] = { UVM_CHANNEL_TYPE_CPU_TO_GPU,
+                                                         UVM_CHANNEL_TYPE_GPU_TO_CPU,
+                                                         UVM_CHANNEL_TYPE_GPU_INTERNAL };
+    unsigned i;
+
     UVM_ASSERT(!g_uvm_global.conf_computing_enabled);
 
     pick_ces_for_channel_types(manager, ce_caps, types, ARRAY_SIZE(types), preferred_ce);
+
+    for (i = 0; i < ARRAY_SIZE(balanced_types); ++i) {
+        const uvm_channel_type_t type = balanced_types[i];
+        const UvmGpuCopyEngineCaps *best_caps = ce_caps + preferred_ce[type];
+        unsigned ce;
+
+        for (ce = 0; ce < UVM_COPY_ENGINE_COUNT_MAX; ++ce) {
+            if (!ce_is_usable(ce_caps + ce))
+                continue;
+
+            if (compare_ce_caps_for_channel_type(ce_caps + ce, best_caps, type) == 0)
+                __set_bit(ce, manager->pool_to_use.balanced_ces[type]);
+        }
+    }
 }
 
 static void pick_ces_conf_computing(uvm_channel_manager_t *manager,
@@ -3986,6 +4162,7 @@ void uvm_channel_manager_destroy(uvm_channel_manager_t *channel_manager)
     if (channel_manager == NULL)
         return;
 
+    proc_remove(channel_manager->procfs.ce_utilization);
     proc_remove(channel_manager->procfs.pending_pushes);
 
     if (uvm_channel_manager_is_wlc_ready(channel_manager))
@@ -4284,6 +4461,57 @@ static int nv_procfs_read_manager_pending_pushes_entry(struct seq_file *s, void
 
 UVM_DEFINE_SINGLE_PROCFS_FILE(manager_pending_pushes_entry);
 
+static void channel_manager_print_ce_utilization(uvm_channel_manager_t *manager, struct seq_file *seq)
+{
+    uvm_channel_pool_t *pool;
+
+    uvm_for_each_pool_of_type(pool, manager, UVM_CHANNEL_POOL_TYPE_CE) {
+        uvm_channel_t *channel;
+        NvU64 in_flight_bytes = 0;
+        NvU64 completed_bytes;
+        NvU64 completed_pushes;
+
+        uvm_for_each_channel_in_pool(channel, pool)
+            uvm_channel_update_progress(channel);
+
+        channel_pool_lock(pool);
+
+        uvm_for_each_channel_in_pool(channel, pool)
+            in_flight_bytes += channel->in_flight_bytes;
+
+        completed_bytes = pool->stats.completed_bytes;
+        completed_pushes = pool->stats.completed_pushes;
+
+        channel_pool_unlock(pool);
+
+        UVM_SEQ_OR_DBG_PRINT(seq, "CE %u:\n", pool->engine_index);
+        UVM_SEQ_OR_DBG_PRINT(seq, "  in_flight_bytes  %llu\n", in_flight_bytes);
+        UVM_SEQ_OR_DBG_PRINT(seq, "  completed_bytes  %llu\n", completed_bytes);
+        UVM_SEQ_OR_DBG_PRINT(seq, "  completed_pushes %llu\n", completed_pushes);
+    }
+}
+
+static int nv_procfs_read_manager_ce_utilization(struct seq_file *s, void *v)
+{
+    uvm_channel_manager_t *manager = (uvm_channel_manager_t *)s->private;
+
+    if (!uvm_down_read_trylock(&g_uvm_global.pm.lock))
+        return -EAGAIN;
+
+    channel_manager_print_ce_utilization(manager, s);
+
+    uvm_up_read(&g_uvm_global.pm.lock);
+
+    return 0;
+}
+
+static int nv_procfs_read_manager_ce_utilization_entry(struct seq_file *s, void *v)
+{
+    UVM_ENTRY_RET(nv_procfs_read_manager_ce_utilization(s, v));
+}
+
+UVM_DEFINE_SINGLE_PROCFS_FILE(manager_ce_utilization_entry);
+
 static NV_STATUS manager_create_procfs(uvm_channel_manager_t *manager)
 {
     uvm_gpu_t *gpu = manager->gpu;
@@ -4299,6 +4527,13 @@ static NV_STATUS manager_create_procfs(uvm_channel_manager_t *manager)
     if (manager->procfs.pending_pushes == NULL)
         return NV_ERR_OPERATING_SYSTEM;
 
+    manager->procfs.ce_utilization = NV_CREATE_PROC_FILE("ce_utilization",
+                                                         gpu->procfs.dir,
+                                                         manager_ce_utilization_entry,
+                                                         manager);
+    if (manager->procfs.ce_utilization == NULL)
+        return NV_ERR_OPERATING_SYSTEM;
+
     return NV_OK;
 }
 
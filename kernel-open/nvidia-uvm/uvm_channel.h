@@ -187,6 +187,10 @@ struct uvm_gpfifo_entry_struct
 
     // Push info for the pending push that used this GPFIFO entry
     uvm_push_info_t *push_info;
+
+    // Number of bytes written by the CE operations in the push, accounted in
+    // uvm_channel_t::in_flight_bytes until the entry completes.
+    NvU64 transferred_bytes;
 };
 
 // A channel pool is a set of channels that use the same engine. For example,
@@ -223,6 +227,17 @@ typedef struct
     // Pool type: Refer to the uvm_channel_pool_type_t enum.
     uvm_channel_pool_type_t pool_type;
 
+    // Utilization of the engine associated with the pool, as observed by the
+    // completion of pushes on its channels. Protected by the pool lock.
+    struct
+    {
+        // Bytes written by CE operations in completed pushes
+        NvU64 completed_bytes;
+
+        // Number of completed pushes
+        NvU64 completed_pushes;
+    } stats;
+
     // Lock protecting the state of channels in the pool.
     //
     // There are two pool lock types available: spinlock and mutex. The mutex
@@ -327,6 +342,12 @@ struct uvm_channel_struct
     // Each entry corresponds to the push_infos entry with the same index.
     uvm_push_acquire_info_t *push_acquire_infos;
 
+    // Number of bytes written by CE operations in pushes that have been
+    // submitted to the channel but have not completed yet. Used as a measure
+    // of the channel queue depth when selecting a channel for a new push.
+    // Protected by the pool lock.
+    NvU64 in_flight_bytes;
+
     // List of uvm_push_info_entry_t that are currently available. A push info
     // entry is not available if it has been assigned to a push
     // (uvm_push_begin), and the GPFIFO entry associated with the push has not
@@ -454,12 +475,20 @@ struct uvm_channel_manager_struct
         // If there is no optimal pool (the entry is NULL), use default pool
         // default_for_type[UVM_CHANNEL_GPU_TO_GPU] instead.
         uvm_channel_pool_t *gpu_to_gpu[UVM_ID_MAX_GPUS];
+
+        // Copy Engines whose capabilities are equivalent to those of the
+        // preferred CE of each channel type. Pushes of a type with more than
+        // one balanced CE are directed to the least loaded channel among the
+        // pools of those CEs. Only populated when the Confidential Computing
+        // feature is disabled.
+        DECLARE_BITMAP(balanced_ces[UVM_CHANNEL_TYPE_CE_COUNT], UVM_COPY_ENGINE_COUNT_MAX);
     } pool_to_use;
 
     struct
     {
         struct proc_dir_entry *channels_dir;
         struct proc_dir_entry *pending_pushes;
+        struct proc_dir_entry *ce_utilization;
     } procfs;
 
     struct
@@ -1386,6 +1386,60 @@ static NV_STATUS test_channel_key_rotation(uvm_va_space_t *va_space)
     return NV_OK;
 }
 
+// Verify that the bytes written by a push are accounted as in-flight on its
+// channel, and retired into the pool statistics once the push completes.
+static NV_STATUS test_in_flight_bytes(uvm_va_space_t *va_space)
+{
+    NV_STATUS status = NV_OK;
+    uvm_gpu_t *gpu;
+
+    for_each_va_space_gpu(gpu, va_space) {
+        uvm_push_t push;
+        uvm_channel_t *channel;
+        uvm_mem_t *mem = NULL;
+        NvU64 completed_bytes;
+        NvU64 completed_pushes;
+        NvU64 transferred_bytes;
+
+        TEST_NV_CHECK_RET(uvm_mem_alloc_vidmem(UVM_PAGE_SIZE_64K, gpu, &mem));
+        TEST_NV_CHECK_GOTO(uvm_mem_map_gpu_kernel(mem, gpu), done);
+
+        TEST_NV_CHECK_GOTO(uvm_push_begin(gpu->channel_manager,
+                                          UVM_CHANNEL_TYPE_GPU_INTERNAL,
+                                          &push,
+                                          "in-flight bytes memset"),
+                           done);
+
+        channel = push.channel;
+        uvm_channel_update_progress_all(channel);
+        completed_bytes = channel->pool->stats.completed_bytes;
+        completed_pushes = channel->pool->stats.completed_pushes;
+
+        gpu->parent->ce_hal->memset_8(&push, uvm_mem_gpu_address_virtual_kernel(mem, gpu), 0, mem->size);
+        transferred_bytes = push.transferred_bytes;
+
+        // End the push before checking anything, so that a failed check
+        // doesn't leave the channel with an open push
+        TEST_NV_CHECK_GOTO(uvm_push_end_and_wait(&push), done);
+        TEST_CHECK_GOTO(transferred_bytes == mem->size, done);
+
+        uvm_channel_update_progress_all(channel);
+
+        TEST_CHECK_GOTO(channel->pool->stats.completed_bytes - completed_bytes >= mem->size, done);
+        TEST_CHECK_GOTO(channel->pool->stats.completed_pushes > completed_pushes, done);
+
+        TEST_NV_CHECK_GOTO(uvm_channel_manager_wait(gpu->channel_manager), done);
+        TEST_CHECK_GOTO(channel->in_flight_bytes == 0, done);
+
+done:
+        uvm_mem_free(mem);
+        if (status != NV_OK)
+            return status;
+    }
+
+    return NV_OK;
+}
+
 static NV_STATUS test_write_ctrl_gpfifo_noop(uvm_va_space_t *va_space)
 {
     uvm_gpu_t *gpu;
@@ -1636,6 +1690,10 @@ NV_STATUS uvm_test_channel_sanity(UVM_TEST_CHANNEL_SANITY_PARAMS *params, struct
     if (status != NV_OK)
         goto done;
 
+    status = test_in_flight_bytes(va_space);
+    if (status != NV_OK)
+        goto done;
+
     status = test_conf_computing_channel_selection(va_space);
     if (status != NV_OK)
         goto done;
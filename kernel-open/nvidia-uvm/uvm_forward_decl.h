@@ -79,6 +79,8 @@ typedef struct uvm_thread_context_wrapper_struct uvm_thread_context_wrapper_t;
 
 typedef struct uvm_perf_module_struct uvm_perf_module_t;
 
+typedef struct uvm_tools_event_batch_struct uvm_tools_event_batch_t;
+
 typedef struct uvm_page_table_range_vec_struct uvm_page_table_range_vec_t;
 typedef struct uvm_page_table_range_struct uvm_page_table_range_t;
 typedef struct uvm_page_tree_struct uvm_page_tree_t;
@@ -558,6 +558,7 @@ static void gpu_info_print_common(uvm_gpu_t *gpu, struct seq_file *s)
     NvU64 num_pages_in;
     NvU64 num_pages_out;
     NvU64 mapped_cpu_pages_size;
+    uvm_fault_stats_t fault_stats;
     NvU32 get;
     NvU32 put;
     NvU32 i;
@@ -617,6 +618,8 @@ static void gpu_info_print_common(uvm_gpu_t *gpu, struct seq_file *s)
 
     UVM_SEQ_OR_DBG_PRINT(s, "interrupts                             %llu\n", gpu->parent->isr.interrupt_count);
 
+    uvm_parent_gpu_fault_stats_read(gpu->parent, &fault_stats);
+
     if (gpu->parent->isr.replayable_faults.handling) {
         UVM_SEQ_OR_DBG_PRINT(s, "replayable_faults_bh                   %llu\n",
                              gpu->parent->isr.replayable_faults.stats.bottom_half_count);
@@ -641,7 +644,7 @@ static void gpu_info_print_common(uvm_gpu_t *gpu, struct seq_file *s)
         UVM_SEQ_OR_DBG_PRINT(s, "replayable_faults_replay_policy        %s\n",
                              uvm_perf_fault_replay_policy_string(gpu->parent->fault_buffer.replayable.replay_policy));
         UVM_SEQ_OR_DBG_PRINT(s, "replayable_faults_num_faults           %llu\n",
-                             gpu->parent->stats.num_replayable_faults);
+                             fault_stats.num_replayable_faults);
     }
     if (gpu->parent->isr.non_replayable_faults.handling) {
         UVM_SEQ_OR_DBG_PRINT(s, "non_replayable_faults_bh               %llu\n",
@@ -655,7 +658,7 @@ static void gpu_info_print_common(uvm_gpu_t *gpu, struct seq_file *s)
         UVM_SEQ_OR_DBG_PRINT(s, "non_replayable_faults_buffer_entries   %u\n",
                              gpu->parent->fault_buffer.non_replayable.max_faults);
         UVM_SEQ_OR_DBG_PRINT(s, "non_replayable_faults_num_faults       %llu\n",
-                             gpu->parent->stats.num_non_replayable_faults);
+                             fault_stats.num_non_replayable_faults);
     }
 
     for (i = 0; i < gpu_info->accessCntrBufferCount; i++) {
@@ -711,21 +714,21 @@ gpu_fault_stats_print_common(uvm_parent_gpu_t *parent_gpu, struct seq_file *s)
 {
     NvU64 num_pages_in;
     NvU64 num_pages_out;
+    uvm_fault_stats_t fault_stats;
+    uvm_perf_fault_replay_policy_t policy;
 
     UVM_ASSERT(uvm_procfs_is_debug_enabled());
 
-    UVM_SEQ_OR_DBG_PRINT(s, "replayable_faults      %llu\n", parent_gpu->stats.num_replayable_faults);
-    UVM_SEQ_OR_DBG_PRINT(s, "duplicates             %llu\n",
-                         parent_gpu->fault_buffer.replayable.stats.num_duplicate_faults);
+    uvm_parent_gpu_fault_stats_read(parent_gpu, &fault_stats);
+
+    UVM_SEQ_OR_DBG_PRINT(s, "replayable_faults      %llu\n", fault_stats.num_replayable_faults);
+    UVM_SEQ_OR_DBG_PRINT(s, "duplicates             %llu\n", fault_stats.num_duplicate_faults);
+    UVM_SEQ_OR_DBG_PRINT(s, "throttled              %llu\n", fault_stats.num_throttled_faults);
     UVM_SEQ_OR_DBG_PRINT(s, "faults_by_access_type:\n");
-    UVM_SEQ_OR_DBG_PRINT(s, "  prefetch             %llu\n",
-                         parent_gpu->fault_buffer.replayable.stats.num_prefetch_faults);
-    UVM_SEQ_OR_DBG_PRINT(s, "  read                 %llu\n",
-                         parent_gpu->fault_buffer.replayable.stats.num_read_faults);
-    UVM_SEQ_OR_DBG_PRINT(s, "  write                %llu\n",
-                         parent_gpu->fault_buffer.replayable.stats.num_write_faults);
-    UVM_SEQ_OR_DBG_PRINT(s, "  atomic               %llu\n",
-                         parent_gpu->fault_buffer.replayable.stats.num_atomic_faults);
+    UVM_SEQ_OR_DBG_PRINT(s, "  prefetch             %llu\n", fault_stats.num_prefetch_faults);
+    UVM_SEQ_OR_DBG_PRINT(s, "  read                 %llu\n", fault_stats.num_read_faults);
+    UVM_SEQ_OR_DBG_PRINT(s, "  write                %llu\n", fault_stats.num_write_faults);
+    UVM_SEQ_OR_DBG_PRINT(s, "  atomic               %llu\n", fault_stats.num_atomic_faults);
     num_pages_out = atomic64_read(&parent_gpu->fault_buffer.replayable.stats.num_pages_out);
     num_pages_in = atomic64_read(&parent_gpu->fault_buffer.replayable.stats.num_pages_in);
     UVM_SEQ_OR_DBG_PRINT(s, "migrations:\n");
@@ -734,24 +737,33 @@ gpu_fault_stats_print_common(uvm_parent_gpu_t *parent_gpu, struct seq_file *s)
     UVM_SEQ_OR_DBG_PRINT(s, "  num_pages_out        %llu (%llu MB)\n", num_pages_out,
                          (num_pages_out * (NvU64)PAGE_SIZE) / (1024u * 1024u));
     UVM_SEQ_OR_DBG_PRINT(s, "replays:\n");
-    UVM_SEQ_OR_DBG_PRINT(s, "  start                %llu\n",
-                         parent_gpu->fault_buffer.replayable.stats.num_replays);
-    UVM_SEQ_OR_DBG_PRINT(s, "  start_ack_all        %llu\n",
-                         parent_gpu->fault_buffer.replayable.stats.num_replays_ack_all);
-    UVM_SEQ_OR_DBG_PRINT(s, "non_replayable_faults  %llu\n", parent_gpu->stats.num_non_replayable_faults);
+    UVM_SEQ_OR_DBG_PRINT(s, "  start                %llu\n", fault_stats.num_replays);
+    UVM_SEQ_OR_DBG_PRINT(s, "  start_ack_all        %llu\n", fault_stats.num_replays_ack_all);
+    UVM_SEQ_OR_DBG_PRINT(s, "parallel_service:\n");
+    UVM_SEQ_OR_DBG_PRINT(s, "  workers              %u/%u\n",
+                         parent_gpu->fault_buffer.replayable.service_workers.num_workers,
+                         parent_gpu->fault_buffer.replayable.service_workers.max_workers);
+    UVM_SEQ_OR_DBG_PRINT(s, "  parallel_batches     %llu\n",
+                         parent_gpu->fault_buffer.replayable.stats.num_parallel_batches);
+    UVM_SEQ_OR_DBG_PRINT(s, "  service_time_ms      %llu\n",
+                         parent_gpu->fault_buffer.replayable.stats.service_time_ns / (1000 * 1000));
+    UVM_SEQ_OR_DBG_PRINT(s, "replay_policies:\n");
+    for (policy = 0; policy < UVM_PERF_FAULT_REPLAY_POLICY_AUTO; policy++) {
+        UVM_SEQ_OR_DBG_PRINT(s, "  %s batches %llu replays %llu time_ms %llu\n",
+                             uvm_perf_fault_replay_policy_string(policy),
+                             parent_gpu->fault_buffer.replayable.stats.replay_policy[policy].num_batches,
+                             parent_gpu->fault_buffer.replayable.stats.replay_policy[policy].num_replays,
+                             parent_gpu->fault_buffer.replayable.stats.replay_policy[policy].time_ns / (1000 * 1000));
+    }
+    UVM_SEQ_OR_DBG_PRINT(s, "non_replayable_faults  %llu\n", fault_stats.num_non_replayable_faults);
     UVM_SEQ_OR_DBG_PRINT(s, "faults_by_access_type:\n");
-    UVM_SEQ_OR_DBG_PRINT(s, "  read                 %llu\n",
-                         parent_gpu->fault_buffer.non_replayable.stats.num_read_faults);
-    UVM_SEQ_OR_DBG_PRINT(s, "  write                %llu\n",
-                         parent_gpu->fault_buffer.non_replayable.stats.num_write_faults);
-    UVM_SEQ_OR_DBG_PRINT(s, "  atomic               %llu\n",
-                         parent_gpu->fault_buffer.non_replayable.stats.num_atomic_faults);
+    UVM_SEQ_OR_DBG_PRINT(s, "  read                 %llu\n", fault_stats.num_non_replayable_read_faults);
+    UVM_SEQ_OR_DBG_PRINT(s, "  write                %llu\n", fault_stats.num_non_replayable_write_faults);
+    UVM_SEQ_OR_DBG_PRINT(s, "  atomic               %llu\n", fault_stats.num_non_replayable_atomic_faults);
     UVM_SEQ_OR_DBG_PRINT(s, "faults_by_addressing:\n");
     UVM_SEQ_OR_DBG_PRINT(s, "  virtual              %llu\n",
-                         parent_gpu->stats.num_non_replayable_faults -
-                         parent_gpu->fault_buffer.non_replayable.stats.num_physical_faults);
-    UVM_SEQ_OR_DBG_PRINT(s, "  physical             %llu\n",
-                         parent_gpu->fault_buffer.non_replayable.stats.num_physical_faults);
+                         fault_stats.num_non_replayable_faults - fault_stats.num_non_replayable_physical_faults);
+    UVM_SEQ_OR_DBG_PRINT(s, "  physical             %llu\n", fault_stats.num_non_replayable_physical_faults);
     num_pages_out = atomic64_read(&parent_gpu->fault_buffer.non_replayable.stats.num_pages_out);
     num_pages_in = atomic64_read(&parent_gpu->fault_buffer.non_replayable.stats.num_pages_in);
     UVM_SEQ_OR_DBG_PRINT(s, "migrations:\n");
@@ -782,6 +794,10 @@ static void gpu_access_counters_print_common(uvm_parent_gpu_t *parent_gpu, struc
                                  (num_pages_in * (NvU64)PAGE_SIZE) / (1024u * 1024u));
             UVM_SEQ_OR_DBG_PRINT(s, "  num_pages_out        %llu (%llu MB)\n", num_pages_out,
                                  (num_pages_out * (NvU64)PAGE_SIZE) / (1024u * 1024u));
+            UVM_SEQ_OR_DBG_PRINT(s, "  ranked_regions       %lld\n",
+                                 atomic64_read(&access_counters->stats.num_ranked_regions));
+            UVM_SEQ_OR_DBG_PRINT(s, "  deferred_regions     %lld\n",
+                                 atomic64_read(&access_counters->stats.num_deferred_regions));
         }
     }
 }
@@ -969,6 +985,130 @@ static int nv_procfs_read_gpu_fault_stats_entry(struct seq_file *s, void *v)
     UVM_ENTRY_RET(nv_procfs_read_gpu_fault_stats(s, v));
 }
 
+// Unlike the other procfs readers this one takes no locks: the fault counters
+// are per-CPU and are summed without synchronizing with the fault servicing
+// path, so the snapshot may be slightly stale but never blocks fault handling.
+static int nv_procfs_read_gpu_fault_counters(struct seq_file *s, void *v)
+{
+    uvm_parent_gpu_t *parent_gpu = (uvm_parent_gpu_t *)s->private;
+    uvm_fault_stats_t fault_stats;
+
+    uvm_parent_gpu_fault_stats_read(parent_gpu, &fault_stats);
+
+    UVM_SEQ_OR_DBG_PRINT(s, "replayable_faults %llu\n", fault_stats.num_replayable_faults);
+    UVM_SEQ_OR_DBG_PRINT(s, "prefetch_faults %llu\n", fault_stats.num_prefetch_faults);
+    UVM_SEQ_OR_DBG_PRINT(s, "read_faults %llu\n", fault_stats.num_read_faults);
+    UVM_SEQ_OR_DBG_PRINT(s, "write_faults %llu\n", fault_stats.num_write_faults);
+    UVM_SEQ_OR_DBG_PRINT(s, "atomic_faults %llu\n", fault_stats.num_atomic_faults);
+    UVM_SEQ_OR_DBG_PRINT(s, "duplicate_faults %llu\n", fault_stats.num_duplicate_faults);
+    UVM_SEQ_OR_DBG_PRINT(s, "throttled_faults %llu\n", fault_stats.num_throttled_faults);
+    UVM_SEQ_OR_DBG_PRINT(s, "replays %llu\n", fault_stats.num_replays);
+    UVM_SEQ_OR_DBG_PRINT(s, "replays_ack_all %llu\n", fault_stats.num_replays_ack_all);
+    UVM_SEQ_OR_DBG_PRINT(s, "non_replayable_faults %llu\n", fault_stats.num_non_replayable_faults);
+    UVM_SEQ_OR_DBG_PRINT(s, "non_replayable_read_faults %llu\n", fault_stats.num_non_replayable_read_faults);
+    UVM_SEQ_OR_DBG_PRINT(s, "non_replayable_write_faults %llu\n", fault_stats.num_non_replayable_write_faults);
+    UVM_SEQ_OR_DBG_PRINT(s, "non_replayable_atomic_faults %llu\n", fault_stats.num_non_replayable_atomic_faults);
+    UVM_SEQ_OR_DBG_PRINT(s, "non_replayable_physical_faults %llu\n", fault_stats.num_non_replayable_physical_faults);
+    UVM_SEQ_OR_DBG_PRINT(s, "instance_ptr_cache_hits %llu\n",
+                         READ_ONCE(parent_gpu->instance_ptr_cache.num_hits));
+    UVM_SEQ_OR_DBG_PRINT(s, "instance_ptr_cache_misses %llu\n",
+                         READ_ONCE(parent_gpu->instance_ptr_cache.num_misses));
+
+    return 0;
+}
+
+static int nv_procfs_read_gpu_fault_counters_entry(struct seq_file *s, void *v)
+{
+    UVM_ENTRY_RET(nv_procfs_read_gpu_fault_counters(s, v));
+}
+
+// Return the exclusive upper bound in ns of the histogram bucket containing the
+// given percentile of the samples.
+static NvU64 fault_latency_percentile(const NvU64 *histogram, NvU64 num_samples, NvU32 percentile)
+{
+    NvU64 target = (num_samples * percentile + 99) / 100;
+    NvU64 count = 0;
+    NvU32 i;
+
+    for (i = 0; i < UVM_FAULT_LATENCY_HISTOGRAM_BUCKETS; i++) {
+        count += histogram[i];
+        if (count >= target)
+            break;
+    }
+
+    return 1ULL << i;
+}
+
+// Like fault_counters, the latency histograms are read without taking any
+// locks.
+static int nv_procfs_read_gpu_fault_latency(struct seq_file *s, void *v)
+{
+    uvm_parent_gpu_t *parent_gpu = (uvm_parent_gpu_t *)s->private;
+    NvU64 histogram[UVM_FAULT_LATENCY_HISTOGRAM_BUCKETS];
+    uvm_fault_latency_stage_t stage;
+    NvU32 i;
+
+    if (!parent_gpu->replayable_faults_supported)
+        return 0;
+
+    for (stage = 0; stage < UVM_FAULT_LATENCY_STAGE_COUNT; stage++) {
+        NvU64 num_samples = 0;
+
+        for (i = 0; i < UVM_FAULT_LATENCY_HISTOGRAM_BUCKETS; i++) {
+            histogram[i] = READ_ONCE(parent_gpu->fault_buffer.replayable.stats.latency_histogram[stage][i]);
+            num_samples += histogram[i];
+        }
+
+        UVM_SEQ_OR_DBG_PRINT(s, "%s\n", uvm_fault_latency_stage_string(stage));
+        UVM_SEQ_OR_DBG_PRINT(s, "  samples              %llu\n", num_samples);
+        if (num_samples == 0)
+            continue;
+
+        UVM_SEQ_OR_DBG_PRINT(s, "  p50_ns               <%llu\n", fault_latency_percentile(histogram, num_samples, 50));
+        UVM_SEQ_OR_DBG_PRINT(s, "  p90_ns               <%llu\n", fault_latency_percentile(histogram, num_samples, 90));
+        UVM_SEQ_OR_DBG_PRINT(s, "  p99_ns               <%llu\n", fault_latency_percentile(histogram, num_samples, 99));
+
+        for (i = 0; i < UVM_FAULT_LATENCY_HISTOGRAM_BUCKETS; i++) {
+            if (histogram[i] == 0)
+                continue;
+
+            UVM_SEQ_OR_DBG_PRINT(s, "  <%-20llu %llu\n", 1ULL << i, histogram[i]);
+        }
+    }
+
+    return 0;
+}
+
+static int nv_procfs_read_gpu_fault_latency_entry(struct seq_file *s, void *v)
+{
+    UVM_ENTRY_RET(nv_procfs_read_gpu_fault_latency(s, v));
+}
+
+// Like fault_counters, the vidmem reclaim counters are read without taking any
+// locks.
+static int nv_procfs_read_gpu_vidmem_reclaim(struct seq_file *s, void *v)
+{
+    uvm_gpu_t *gpu = (uvm_gpu_t *)s->private;
+    uvm_pmm_gpu_t *pmm = &gpu->pmm;
+
+    UVM_SEQ_OR_DBG_PRINT(s, "reclaim %s\n", pmm->root_chunks.reclaim.low_watermark != 0 ? "enabled" : "disabled");
+    UVM_SEQ_OR_DBG_PRINT(s, "low_watermark %u\n", pmm->root_chunks.reclaim.low_watermark);
+    UVM_SEQ_OR_DBG_PRINT(s, "high_watermark %u\n", pmm->root_chunks.reclaim.high_watermark);
+    if (pmm->pma_stats)
+        UVM_SEQ_OR_DBG_PRINT(s, "free_root_chunks %llu\n", READ_ONCE(pmm->pma_stats->numFreePages2m));
+    UVM_SEQ_OR_DBG_PRINT(s, "watermark_hits %lld\n", atomic64_read(&pmm->root_chunks.reclaim.num_hits));
+    UVM_SEQ_OR_DBG_PRINT(s, "watermark_misses %lld\n", atomic64_read(&pmm->root_chunks.reclaim.num_misses));
+    UVM_SEQ_OR_DBG_PRINT(s, "reclaim_runs %lld\n", atomic64_read(&pmm->root_chunks.reclaim.num_runs));
+    UVM_SEQ_OR_DBG_PRINT(s, "reclaimed_root_chunks %lld\n", atomic64_read(&pmm->root_chunks.reclaim.num_reclaimed));
+
+    return 0;
+}
+
+static int nv_procfs_read_gpu_vidmem_reclaim_entry(struct seq_file *s, void *v)
+{
+    UVM_ENTRY_RET(nv_procfs_read_gpu_vidmem_reclaim(s, v));
+}
+
 static int nv_procfs_read_gpu_access_counters(struct seq_file *s, void *v)
 {
     uvm_parent_gpu_t *parent_gpu = (uvm_parent_gpu_t *)s->private;
@@ -990,7 +1130,10 @@ static int nv_procfs_read_gpu_access_counters_entry(struct seq_file *s, void *v)
 
 UVM_DEFINE_SINGLE_PROCFS_FILE(gpu_info_entry);
 UVM_DEFINE_SINGLE_PROCFS_FILE(gpu_fault_stats_entry);
+UVM_DEFINE_SINGLE_PROCFS_FILE(gpu_fault_counters_entry);
+UVM_DEFINE_SINGLE_PROCFS_FILE(gpu_fault_latency_entry);
 UVM_DEFINE_SINGLE_PROCFS_FILE(gpu_access_counters_entry);
+UVM_DEFINE_SINGLE_PROCFS_FILE(gpu_vidmem_reclaim_entry);
 
 static void uvm_parent_gpu_uuid_string(char *buffer, const NvProcessorUuid *uuid)
 {
@@ -1040,7 +1183,24 @@ static void deinit_parent_procfs_dir(uvm_parent_gpu_t *parent_gpu)
 
 static NV_STATUS init_parent_procfs_files(uvm_parent_gpu_t *parent_gpu)
 {
-    // Fault and access counter files are debug only
+    if (!uvm_procfs_is_enabled())
+        return NV_OK;
+
+    parent_gpu->procfs.fault_counters_file = NV_CREATE_PROC_FILE("fault_counters",
+                                                                 parent_gpu->procfs.dir,
+                                                                 gpu_fault_counters_entry,
+                                                                 parent_gpu);
+    if (parent_gpu->procfs.fault_counters_file == NULL)
+        return NV_ERR_OPERATING_SYSTEM;
+
+    parent_gpu->procfs.fault_latency_file = NV_CREATE_PROC_FILE("fault_latency",
+                                                                parent_gpu->procfs.dir,
+                                                                gpu_fault_latency_entry,
+                                                                parent_gpu);
+    if (parent_gpu->procfs.fault_latency_file == NULL)
+        return NV_ERR_OPERATING_SYSTEM;
+
+    // Fault stats and access counter files are debug only
     if (!uvm_procfs_is_debug_enabled())
         return NV_OK;
 
@@ -1065,6 +1225,8 @@ static void deinit_parent_procfs_files(uvm_parent_gpu_t *parent_gpu)
 {
     proc_remove(parent_gpu->procfs.access_counters_file);
     proc_remove(parent_gpu->procfs.fault_stats_file);
+    proc_remove(parent_gpu->procfs.fault_latency_file);
+    proc_remove(parent_gpu->procfs.fault_counters_file);
 }
 
 static NV_STATUS init_procfs_dirs(uvm_gpu_t *gpu)
@@ -1126,11 +1288,19 @@ static NV_STATUS init_procfs_files(uvm_gpu_t *gpu)
     if (gpu->procfs.info_file == NULL)
         return NV_ERR_OPERATING_SYSTEM;
 
+    gpu->procfs.vidmem_reclaim_file = NV_CREATE_PROC_FILE("vidmem_reclaim",
+                                                          gpu->procfs.dir,
+                                                          gpu_vidmem_reclaim_entry,
+                                                          gpu);
+    if (gpu->procfs.vidmem_reclaim_file == NULL)
+        return NV_ERR_OPERATING_SYSTEM;
+
     return NV_OK;
 }
 
 static void deinit_procfs_files(uvm_gpu_t *gpu)
 {
+    proc_remove(gpu->procfs.vidmem_reclaim_file);
     proc_remove(gpu->procfs.info_file);
 }
 
@@ -1239,6 +1409,12 @@ static NV_STATUS alloc_parent_gpu(const NvProcessorUuid *gpu_uuid,
 
     parent_gpu->id = gpu_id;
 
+    parent_gpu->stats.fault_stats = alloc_percpu(uvm_fault_stats_t);
+    if (!parent_gpu->stats.fault_stats) {
+        uvm_kvfree(parent_gpu);
+        return NV_ERR_NO_MEMORY;
+    }
+
     uvm_uuid_copy(&parent_gpu->uuid, gpu_uuid);
     uvm_sema_init(&parent_gpu->isr.replayable_faults.service_lock, 1, UVM_LOCK_ORDER_ISR);
     uvm_sema_init(&parent_gpu->isr.non_replayable_faults.service_lock, 1, UVM_LOCK_ORDER_ISR);
@@ -1266,6 +1442,7 @@ static NV_STATUS alloc_parent_gpu(const NvProcessorUuid *gpu_uuid,
 cleanup:
     uvm_tracker_deinit(&parent_gpu->access_counters.clear_tracker);
     deinit_access_counters_serialize_clear_tracker(parent_gpu);
+    free_percpu(parent_gpu->stats.fault_stats);
     uvm_kvfree(parent_gpu);
 
     return status;
@@ -1879,6 +2056,8 @@ static void uvm_parent_gpu_destroy(nv_kref_t *nv_kref)
     uvm_tracker_deinit(&parent_gpu->access_counters.clear_tracker);
     deinit_access_counters_serialize_clear_tracker(parent_gpu);
 
+    free_percpu(parent_gpu->stats.fault_stats);
+
     uvm_kvfree(parent_gpu);
 }
 
@@ -1895,14 +2074,14 @@ static void update_stats_parent_gpu_fault_instance(uvm_parent_gpu_t *parent_gpu,
         switch (fault_entry->fault_access_type)
         {
             case UVM_FAULT_ACCESS_TYPE_READ:
-                ++parent_gpu->fault_buffer.non_replayable.stats.num_read_faults;
+                uvm_parent_gpu_fault_stats_inc(parent_gpu, num_non_replayable_read_faults);
                 break;
             case UVM_FAULT_ACCESS_TYPE_WRITE:
-                ++parent_gpu->fault_buffer.non_replayable.stats.num_write_faults;
+                uvm_parent_gpu_fault_stats_inc(parent_gpu, num_non_replayable_write_faults);
                 break;
             case UVM_FAULT_ACCESS_TYPE_ATOMIC_WEAK:
             case UVM_FAULT_ACCESS_TYPE_ATOMIC_STRONG:
-                ++parent_gpu->fault_buffer.non_replayable.stats.num_atomic_faults;
+                uvm_parent_gpu_fault_stats_inc(parent_gpu, num_non_replayable_atomic_faults);
                 break;
             default:
                 UVM_ASSERT_MSG(false, "Invalid access type for non-replayable faults\n");
@@ -1910,9 +2089,9 @@ static void update_stats_parent_gpu_fault_instance(uvm_parent_gpu_t *parent_gpu,
         }
 
         if (!fault_entry->is_virtual)
-            ++parent_gpu->fault_buffer.non_replayable.stats.num_physical_faults;
+            uvm_parent_gpu_fault_stats_inc(parent_gpu, num_non_replayable_physical_faults);
 
-        ++parent_gpu->stats.num_non_replayable_faults;
+        uvm_parent_gpu_fault_stats_inc(parent_gpu, num_non_replayable_faults);
 
         return;
     }
@@ -1922,25 +2101,51 @@ static void update_stats_parent_gpu_fault_instance(uvm_parent_gpu_t *parent_gpu,
     switch (fault_entry->fault_access_type)
     {
         case UVM_FAULT_ACCESS_TYPE_PREFETCH:
-            ++parent_gpu->fault_buffer.replayable.stats.num_prefetch_faults;
+            uvm_parent_gpu_fault_stats_inc(parent_gpu, num_prefetch_faults);
             break;
         case UVM_FAULT_ACCESS_TYPE_READ:
-            ++parent_gpu->fault_buffer.replayable.stats.num_read_faults;
+            uvm_parent_gpu_fault_stats_inc(parent_gpu, num_read_faults);
             break;
         case UVM_FAULT_ACCESS_TYPE_WRITE:
-            ++parent_gpu->fault_buffer.replayable.stats.num_write_faults;
+            uvm_parent_gpu_fault_stats_inc(parent_gpu, num_write_faults);
             break;
         case UVM_FAULT_ACCESS_TYPE_ATOMIC_WEAK:
         case UVM_FAULT_ACCESS_TYPE_ATOMIC_STRONG:
-            ++parent_gpu->fault_buffer.replayable.stats.num_atomic_faults;
+            uvm_parent_gpu_fault_stats_inc(parent_gpu, num_atomic_faults);
             break;
         default:
             break;
     }
     if (is_duplicate || fault_entry->filtered)
-        ++parent_gpu->fault_buffer.replayable.stats.num_duplicate_faults;
+        uvm_parent_gpu_fault_stats_inc(parent_gpu, num_duplicate_faults);
+
+    uvm_parent_gpu_fault_stats_inc(parent_gpu, num_replayable_faults);
+}
+
+void uvm_parent_gpu_fault_stats_read(uvm_parent_gpu_t *parent_gpu, uvm_fault_stats_t *stats)
+{
+    int cpu;
+
+    memset(stats, 0, sizeof(*stats));
+
+    for_each_possible_cpu(cpu) {
+        const uvm_fault_stats_t *cpu_stats = per_cpu_ptr(parent_gpu->stats.fault_stats, cpu);
 
-    ++parent_gpu->stats.num_replayable_faults;
+        stats->num_replayable_faults              += READ_ONCE(cpu_stats->num_replayable_faults);
+        stats->num_prefetch_faults                += READ_ONCE(cpu_stats->num_prefetch_faults);
+        stats->num_read_faults                    += READ_ONCE(cpu_stats->num_read_faults);
+        stats->num_write_faults                   += READ_ONCE(cpu_stats->num_write_faults);
+        stats->num_atomic_faults                  += READ_ONCE(cpu_stats->num_atomic_faults);
+        stats->num_duplicate_faults               += READ_ONCE(cpu_stats->num_duplicate_faults);
+        stats->num_throttled_faults               += READ_ONCE(cpu_stats->num_throttled_faults);
+        stats->num_replays                        += READ_ONCE(cpu_stats->num_replays);
+        stats->num_replays_ack_all                += READ_ONCE(cpu_stats->num_replays_ack_all);
+        stats->num_non_replayable_faults          += READ_ONCE(cpu_stats->num_non_replayable_faults);
+        stats->num_non_replayable_read_faults     += READ_ONCE(cpu_stats->num_non_replayable_read_faults);
+        stats->num_non_replayable_write_faults    += READ_ONCE(cpu_stats->num_non_replayable_write_faults);
+        stats->num_non_replayable_atomic_faults   += READ_ONCE(cpu_stats->num_non_replayable_atomic_faults);
+        stats->num_non_replayable_physical_faults += READ_ONCE(cpu_stats->num_non_replayable_physical_faults);
+    }
 }
 
 static void update_stats_fault_cb(uvm_va_space_t *va_space,
@@ -2081,13 +2286,17 @@ NV_STATUS uvm_gpu_init_va_space(uvm_va_space_t *va_space)
 {
     NV_STATUS status;
 
-    if (uvm_procfs_is_debug_enabled()) {
+    // Fault counters are per-CPU and cheap to update, so they are collected
+    // whenever procfs is available to expose them.
+    if (uvm_procfs_is_enabled()) {
         status = uvm_perf_register_event_callback(&va_space->perf_events,
                                                   UVM_PERF_EVENT_FAULT,
                                                   update_stats_fault_cb);
         if (status != NV_OK)
             return status;
+    }
 
+    if (uvm_procfs_is_debug_enabled()) {
         status = uvm_perf_register_event_callback(&va_space->perf_events,
                                                   UVM_PERF_EVENT_MIGRATION,
                                                   update_stats_migration_cb);
@@ -3599,6 +3808,23 @@ static void parent_gpu_add_user_channel_instance_ptr(uvm_parent_gpu_t *parent_gp
                    nvstatusToString(status));
 }
 
+static NvU32 instance_ptr_cache_index(NvU64 key)
+{
+    // Bit 0 of the key is the aperture and the rest is the 4K-aligned address,
+    // so fold the upper bits in to spread vidmem and sysmem instance pointers.
+    return (NvU32)((key ^ (key >> 16)) >> 1) & (UVM_INSTANCE_PTR_CACHE_SIZE - 1);
+}
+
+static void instance_ptr_cache_invalidate_locked(uvm_parent_gpu_t *parent_gpu, uvm_user_channel_t *user_channel)
+{
+    NvU32 index = instance_ptr_cache_index(user_channel->instance_ptr.node.key);
+
+    uvm_assert_spinlock_locked(&parent_gpu->instance_ptr_table_lock);
+
+    if (parent_gpu->instance_ptr_cache.entries[index].user_channel == user_channel)
+        parent_gpu->instance_ptr_cache.entries[index].user_channel = NULL;
+}
+
 static void parent_gpu_remove_user_channel_instance_ptr_locked(uvm_parent_gpu_t *parent_gpu,
                                                                uvm_user_channel_t *user_channel)
 {
@@ -3607,6 +3833,7 @@ static void parent_gpu_remove_user_channel_instance_ptr_locked(uvm_parent_gpu_t
     if (UVM_RB_TREE_EMPTY_NODE(&user_channel->instance_ptr.node))
         return;
 
+    instance_ptr_cache_invalidate_locked(parent_gpu, user_channel);
     uvm_rb_tree_remove(&parent_gpu->instance_ptr_table, &user_channel->instance_ptr.node);
 }
 
@@ -3635,15 +3862,30 @@ static uvm_user_channel_t *instance_ptr_to_user_channel(uvm_parent_gpu_t *parent
                                                         uvm_gpu_phys_address_t instance_ptr)
 {
     NvU64 key = instance_ptr_to_key(instance_ptr);
+    NvU32 index = instance_ptr_cache_index(key);
     uvm_rb_tree_node_t *instance_node;
+    uvm_user_channel_t *user_channel;
 
     uvm_assert_spinlock_locked(&parent_gpu->instance_ptr_table_lock);
 
+    user_channel = parent_gpu->instance_ptr_cache.entries[index].user_channel;
+    if (user_channel && parent_gpu->instance_ptr_cache.entries[index].key == key) {
+        ++parent_gpu->instance_ptr_cache.num_hits;
+        return user_channel;
+    }
+
+    ++parent_gpu->instance_ptr_cache.num_misses;
+
     instance_node = uvm_rb_tree_find(&parent_gpu->instance_ptr_table, key);
     if (!instance_node)
         return NULL;
 
-    return get_user_channel(instance_node);
+    user_channel = get_user_channel(instance_node);
+
+    parent_gpu->instance_ptr_cache.entries[index].key = key;
+    parent_gpu->instance_ptr_cache.entries[index].user_channel = user_channel;
+
+    return user_channel;
 }
 
 static uvm_gpu_va_space_t *user_channel_and_subctx_to_gpu_va_space(uvm_user_channel_t *user_channel, NvU32 subctx_id)
@@ -246,6 +246,11 @@ typedef struct
     // Client type of the service requestor.
     uvm_fault_client_type_t client_type;
 
+    // If not NULL, GPU TLB invalidates required by the service operation are
+    // batched here instead of in the fault buffer of the requestor's client
+    // type. Used by the replayable fault service workers.
+    uvm_ats_fault_invalidate_t *ats_invalidate;
+
     // New residency ID of the faulting region.
     uvm_processor_id_t residency_id;
 
@@ -286,6 +291,14 @@ typedef struct
     } prefetch_state;
 } uvm_ats_fault_context_t;
 
+// Number of key bits sorted in each pass of the fault batch radix sort
+#define UVM_FAULT_SORT_RADIX_BITS 8
+#define UVM_FAULT_SORT_RADIX_SIZE (1 << UVM_FAULT_SORT_RADIX_BITS)
+
+// Maximum number of distinct {VA space, GPU} pairs in a batch for the radix
+// sort to be used. Batches with more pairs fall back to the generic sort.
+#define UVM_FAULT_SORT_MAX_SLOTS 64
+
 struct uvm_fault_service_batch_context_struct
 {
     // Array of elements fetched from the GPU fault buffer. The number of
@@ -325,6 +338,11 @@ struct uvm_fault_service_batch_context_struct
 
     NvU32 num_replays;
 
+    // Replay policy used to service this batch. With
+    // UVM_PERF_FAULT_REPLAY_POLICY_AUTO it is selected for each batch after
+    // preprocessing, otherwise it is the GPU's replay_policy.
+    uvm_perf_fault_replay_policy_t replay_policy;
+
     uvm_ats_fault_context_t ats_context;
 
     // Unique id (per-GPU) generated for tools events recording
@@ -339,6 +357,51 @@ struct uvm_fault_service_batch_context_struct
 
     // Last fetched fault. Used for fault filtering.
     uvm_fault_buffer_entry_t *last_fault;
+
+    // Bitmap of the uTLBs with fatal faults, indexed by uTLB id. Only
+    // allocated for the batch contexts of the fault service workers, whose
+    // shards share utlbs with the batch being serviced. The bits are merged
+    // into utlbs once all the shards are done, so the workers never write to
+    // the shared array. NULL for the other batch contexts.
+    unsigned long *fatal_utlbs;
+
+    // Scratch state used to radix sort ordered_fault_cache during fault batch
+    // preprocessing. The arrays have as many elements as ordered_fault_cache.
+    // Allocated for every batch context that preprocesses fault batches: the
+    // bottom half's, the prefetched next batch's and the ones built by the
+    // fault sort tests. The contexts of the fault service workers only view
+    // an already sorted shard and leave it unallocated.
+    struct
+    {
+        NvU64 *keys;
+
+        NvU64 *tmp_keys;
+
+        uvm_fault_buffer_entry_t **tmp_entries;
+
+        NvU32 counts[UVM_FAULT_SORT_RADIX_SIZE];
+
+        // Distinct {VA space, GPU} pairs in the batch, in sort order. The
+        // index of a pair is packed in the most significant bits of the keys.
+        struct
+        {
+            uvm_va_space_t *va_space;
+
+            NvU32 gpu_id;
+        } slots[UVM_FAULT_SORT_MAX_SLOTS];
+
+        NvU32 num_slots;
+    } sort;
+
+    // Structure used to coalesce fault servicing in a VA block. It points to
+    // the replayable fault buffer's context in the batch context used by the
+    // bottom half, and to the worker's own context in the shards serviced by
+    // the fault service workers.
+    uvm_service_block_context_t *block_service_context;
+
+    // Tools events recorded while servicing the faults of a VA space are
+    // staged here, and written to the event queues once the VA space is done.
+    uvm_tools_event_batch_t *tools_event_batch;
 };
 
 struct uvm_ats_fault_invalidate_struct
@@ -347,6 +410,42 @@ struct uvm_ats_fault_invalidate_struct
     uvm_tlb_batch_t tlb_batch;
 };
 
+// Worker used to service a shard of a replayable fault batch in parallel with
+// the bottom half. See service_fault_batch_parallel() in
+// uvm_gpu_replayable_faults.c.
+typedef struct
+{
+    uvm_parent_gpu_t *parent_gpu;
+
+    // Index of the worker within the pool. Worker 0 is serviced inline by the
+    // bottom half and does not own a queue.
+    NvU32 index;
+
+    // Queue and item used to run the worker. The queue kthread is affine to
+    // the NUMA node closest to the GPU, if any.
+    nv_kthread_q_t q;
+    nv_kthread_q_item_t q_item;
+
+    // Signaled when the worker is done servicing its shard
+    struct completion done;
+
+    // View of the shard of the fault batch serviced by this worker. The fault
+    // arrays are owned by the batch context of the bottom half, but counters,
+    // fatal fault information and the tracker are private to the worker, and
+    // merged back into the bottom half's batch context once all the shards
+    // have been serviced.
+    uvm_fault_service_batch_context_t batch_context;
+
+    // Structure used to coalesce fault servicing in a VA block
+    uvm_service_block_context_t block_service_context;
+
+    // Information required to invalidate stale ATS PTEs from the GPU TLBs
+    uvm_ats_fault_invalidate_t ats_invalidate;
+
+    // Result of servicing the shard
+    NV_STATUS status;
+} uvm_fault_service_worker_t;
+
 typedef struct
 {
     // Fault buffer information and structures provided by RM
@@ -373,6 +472,11 @@ typedef struct
         // fault servicing
         uvm_perf_fault_replay_policy_t replay_policy;
 
+        // Whether the last serviced batch had throttled faults. Used to
+        // select the replay policy of the next batch with
+        // UVM_PERF_FAULT_REPLAY_POLICY_AUTO.
+        bool last_batch_throttled;
+
         // Tracker used to aggregate replay operations, needed for fault cancel
         // and GPU removal
         uvm_tracker_t replay_tracker;
@@ -382,29 +486,40 @@ typedef struct
         // that comes before the replay method.
         NvU32 replay_update_put_ratio;
 
-        // Fault statistics. These fields are per-GPU and most of them are only
-        // updated during fault servicing, and can be safely incremented.
-        // Migrations may be triggered by different GPUs and need to be
-        // incremented using atomics
+        // Fault statistics. These fields are per-GPU. Fault, replay, throttle
+        // and duplicate counters live in parent_gpu->stats.fault_stats.
+        // Migrations may be triggered by different GPUs, so they need to be
+        // incremented using atomics. The rest are only updated by the bottom
+        // half.
         struct
         {
-            NvU64 num_prefetch_faults;
-
-            NvU64 num_read_faults;
+            atomic64_t num_pages_out;
 
-            NvU64 num_write_faults;
+            atomic64_t num_pages_in;
 
-            NvU64 num_atomic_faults;
+            // Number of batches serviced by more than one worker
+            NvU64 num_parallel_batches;
 
-            NvU64 num_duplicate_faults;
+            // Accumulated time spent servicing fault batches, in nanoseconds
+            NvU64 service_time_ns;
 
-            atomic64_t num_pages_out;
+            // Log2 latency histograms of each fault servicing stage. See
+            // uvm_fault_latency_stage_t. Only updated by the bottom half and
+            // read without synchronization.
+            NvU64 latency_histogram[UVM_FAULT_LATENCY_STAGE_COUNT][UVM_FAULT_LATENCY_HISTOGRAM_BUCKETS];
 
-            atomic64_t num_pages_in;
+            // Number of batches serviced, replays issued and time spent
+            // servicing and replaying batches, for each replay policy used in
+            // a batch. The UVM_PERF_FAULT_REPLAY_POLICY_AUTO entries are never
+            // used since a concrete policy is selected for each batch.
+            struct
+            {
+                NvU64 num_batches;
 
-            NvU64 num_replays;
+                NvU64 num_replays;
 
-            NvU64 num_replays_ack_all;
+                NvU64 time_ns;
+            } replay_policy[UVM_PERF_FAULT_REPLAY_POLICY_MAX];
         } stats;
 
         // Number of uTLBs in the chip
@@ -413,11 +528,35 @@ typedef struct
         // Context structure used to service a GPU fault batch
         uvm_fault_service_batch_context_t batch_service_context;
 
+        // Second batch context used to fetch and preprocess the next batch of
+        // faults while the work and the replay of the batch in
+        // batch_service_context are in flight. Both contexts swap roles after
+        // each pipelined batch. NULL if fault pipelining is disabled.
+        uvm_fault_service_batch_context_t *pipeline_batch_context;
+
         // Structure used to coalesce fault servicing in a VA block
         uvm_service_block_context_t block_service_context;
 
         // Information required to invalidate stale ATS PTEs from the GPU TLBs
         uvm_ats_fault_invalidate_t ats_invalidate;
+
+        // Pool of workers used to service large fault batches in parallel.
+        // Shards are formed at VA block boundaries of the sorted batch, so no
+        // VA block is serviced by more than one worker.
+        struct
+        {
+            // Array of max_workers elements. NULL if parallel servicing is
+            // disabled, in which case max_workers is 1.
+            uvm_fault_service_worker_t *workers;
+
+            NvU32 max_workers;
+
+            // Number of workers used to service the next batches. Can be
+            // changed by tests in the [1:max_workers] range.
+            //
+            // Locking: protected by the replayable faults ISR lock.
+            NvU32 num_workers;
+        } service_workers;
     } replayable;
 
     struct uvm_non_replayable_fault_buffer_struct
@@ -440,14 +579,6 @@ typedef struct
         // Fault statistics. See replayable fault stats for more details.
         struct
         {
-            NvU64 num_read_faults;
-
-            NvU64 num_write_faults;
-
-            NvU64 num_atomic_faults;
-
-            NvU64 num_physical_faults;
-
             atomic64_t num_pages_out;
 
             atomic64_t num_pages_in;
@@ -476,6 +607,34 @@ typedef struct
     NvU64 disable_prefetch_faults_timestamp;
 } uvm_fault_buffer_t;
 
+// Access counts of a region, accumulated over a sliding window made of the
+// current and the previous window
+typedef struct
+{
+    uvm_va_space_t *va_space;
+    uvm_gpu_t *gpu;
+    NvU64 address;
+
+    // Start time of the current window
+    NvU64 window_start;
+
+    // Sum of the counter values of the notifications in the current and in the
+    // previous window
+    NvU64 count;
+    NvU64 prev_count;
+} uvm_access_counter_hot_region_t;
+
+// Notifications of a batch that fall in the same region
+typedef struct
+{
+    // Range of the region's notifications in the sorted batch
+    NvU32 first;
+    NvU32 num_notifications;
+
+    // Access count of the region over the sliding window
+    NvU64 score;
+} uvm_access_counter_batch_region_t;
+
 struct uvm_access_counter_service_batch_context_struct
 {
     uvm_access_counter_buffer_entry_t *notification_cache;
@@ -502,6 +661,24 @@ struct uvm_access_counter_service_batch_context_struct
 
     // Unique id (per-GPU) generated for tools events recording
     NvU32 batch_id;
+
+    // Ranking of the regions accessed by the notifications, only allocated if
+    // uvm_perf_access_counter_top_n is not 0. See rank_notifications() in
+    // uvm_gpu_access_counters.c.
+    struct
+    {
+        // Access counts over a sliding window, in a direct-mapped table indexed
+        // by a hash of the region
+        uvm_access_counter_hot_region_t *table;
+
+        // Regions of the current batch
+        uvm_access_counter_batch_region_t *batch_regions;
+
+        // Pointers to batch_regions sorted by score
+        uvm_access_counter_batch_region_t **ranked_regions;
+
+        NvU32 num_batch_regions;
+    } hot_regions;
 };
 
 struct uvm_access_counter_buffer_struct
@@ -554,6 +731,11 @@ struct uvm_access_counter_buffer_struct
         atomic64_t num_pages_out;
 
         atomic64_t num_pages_in;
+
+        // Regions seen by the hot region ranking, and the ones it deferred
+        atomic64_t num_ranked_regions;
+
+        atomic64_t num_deferred_regions;
     } stats;
 
     // Ignoring access counters means that notifications are left in the HW
@@ -643,6 +825,43 @@ typedef enum
     UVM_GPU_PEER_COPY_MODE_COUNT
 } uvm_gpu_peer_copy_mode_t;
 
+// Number of entries in the per-GPU instance pointer translation cache. Must be
+// a power of two.
+#define UVM_INSTANCE_PTR_CACHE_SIZE 32
+
+// Fault counters of a parent GPU. See uvm_parent_gpu_t::stats::fault_stats.
+typedef struct
+{
+    NvU64 num_replayable_faults;
+
+    NvU64 num_prefetch_faults;
+
+    NvU64 num_read_faults;
+
+    NvU64 num_write_faults;
+
+    NvU64 num_atomic_faults;
+
+    NvU64 num_duplicate_faults;
+
+    // Faults on pages throttled by the thrashing mitigation logic
+    NvU64 num_throttled_faults;
+
+    NvU64 num_replays;
+
+    NvU64 num_replays_ack_all;
+
+    NvU64 num_non_replayable_faults;
+
+    NvU64 num_non_replayable_read_faults;
+
+    NvU64 num_non_replayable_write_faults;
+
+    NvU64 num_non_replayable_atomic_faults;
+
+    NvU64 num_non_replayable_physical_faults;
+} uvm_fault_stats_t;
+
 // In order to support SMC/MIG GPU partitions, we split UVM GPUs into two
 // parts: parent GPUs (uvm_parent_gpu_t) which represent unique PCIe devices
 // (including VFs), and sub/child GPUs (uvm_gpu_t) which represent individual
@@ -919,6 +1138,9 @@ struct uvm_gpu_struct
 
         // "gpus/UVM-GPU-${physical-UUID}/${sub_processor_index}/info"
         struct proc_dir_entry *info_file;
+
+        // "gpus/UVM-GPU-${physical-UUID}/${sub_processor_index}/vidmem_reclaim"
+        struct proc_dir_entry *vidmem_reclaim_file;
     } procfs;
 
     // Placeholder for per-GPU performance heuristics information
@@ -1201,6 +1423,12 @@ struct uvm_parent_gpu_struct
         // "gpus/UVM-GPU-${physical-UUID}/fault_stats"
         struct proc_dir_entry *fault_stats_file;
 
+        // "gpus/UVM-GPU-${physical-UUID}/fault_counters"
+        struct proc_dir_entry *fault_counters_file;
+
+        // "gpus/UVM-GPU-${physical-UUID}/fault_latency"
+        struct proc_dir_entry *fault_latency_file;
+
         // "gpus/UVM-GPU-${physical-UUID}/access_counters"
         struct proc_dir_entry *access_counters_file;
 
@@ -1285,6 +1513,26 @@ struct uvm_parent_gpu_struct
     uvm_rb_tree_t instance_ptr_table;
     uvm_spinlock_t instance_ptr_table_lock;
 
+    // Direct-mapped cache of instance_ptr_table lookups. The same few instance
+    // pointers tend to show up in every fault batch, so this avoids walking
+    // the tree for them. Entries map an instance_ptr_table key to its user
+    // channel and are protected by instance_ptr_table_lock. An entry is
+    // invalidated when its channel is removed from instance_ptr_table.
+    struct
+    {
+        struct
+        {
+            NvU64 key;
+
+            // NULL if the entry is not valid
+            uvm_user_channel_t *user_channel;
+        } entries[UVM_INSTANCE_PTR_CACHE_SIZE];
+
+        NvU64 num_hits;
+
+        NvU64 num_misses;
+    } instance_ptr_cache;
+
     struct
     {
         bool supported;
@@ -1292,17 +1540,18 @@ struct uvm_parent_gpu_struct
         bool enabled;
     } smc;
 
-    // Global statistics. These fields are per-GPU and most of them are only
-    // updated during fault servicing, and can be safely incremented.
+    // Global statistics. These fields are per-GPU.
     struct
     {
-        NvU64          num_replayable_faults;
-
-        NvU64      num_non_replayable_faults;
-
         atomic64_t             num_pages_out;
 
         atomic64_t              num_pages_in;
+
+        // Fault counters, kept per CPU so that they can be updated from the
+        // fault servicing paths without locks or contended atomics. Use
+        // uvm_parent_gpu_fault_stats_inc() to update them and
+        // uvm_parent_gpu_fault_stats_read() to read them.
+        uvm_fault_stats_t __percpu *fault_stats;
     } stats;
 
     // Structure to hold nvswitch specific information. In an nvswitch
@@ -1628,6 +1877,14 @@ void uvm_parent_gpu_kref_put(uvm_parent_gpu_t *parent_gpu);
 // waiting for any unfinished trackers contained by the parent GPU.
 void uvm_parent_gpu_sync_trackers(uvm_parent_gpu_t *parent_gpu);
 
+// Increment a field of the fault counters of the parent GPU on the current
+// CPU. This is safe to call from any context without locks.
+#define uvm_parent_gpu_fault_stats_inc(parent_gpu, field) this_cpu_inc((parent_gpu)->stats.fault_stats->field)
+
+// Sum the fault counters of the parent GPU across all CPUs. This does not
+// take any locks, so counters may be slightly behind concurrent updates.
+void uvm_parent_gpu_fault_stats_read(uvm_parent_gpu_t *parent_gpu, uvm_fault_stats_t *stats);
+
 static bool uvm_parent_gpu_supports_full_coherence(uvm_parent_gpu_t *parent_gpu)
 {
     // TODO: Bug 5310178: Replace this with the value returned by RM to check
@@ -21,6 +21,7 @@
 *******************************************************************************/
 
 #include "linux/sort.h"
+#include "linux/hash.h"
 #include "nv_uvm_interface.h"
 #include "uvm_gpu_access_counters.h"
 #include "uvm_global.h"
@@ -43,6 +44,14 @@
 #define UVM_PERF_ACCESS_COUNTER_THRESHOLD_MAX       ((1 << 16) - 1)
 #define UVM_PERF_ACCESS_COUNTER_THRESHOLD_DEFAULT   256
 
+#define UVM_PERF_ACCESS_COUNTER_TOP_N_DEFAULT       0
+#define UVM_PERF_ACCESS_COUNTER_WINDOW_MS_DEFAULT   100
+
+// Size of the regions ranked by hotness, and order of the number of entries of
+// the table tracking them
+#define UVM_ACCESS_COUNTER_HOT_REGION_SIZE          UVM_VA_BLOCK_SIZE
+#define UVM_ACCESS_COUNTER_HOT_REGIONS_ORDER        12
+
 #define UVM_ACCESS_COUNTER_ACTION_BATCH_CLEAR       0x1
 #define UVM_ACCESS_COUNTER_ACTION_TARGETED_CLEAR    0x2
 
@@ -75,6 +84,15 @@ static unsigned uvm_perf_access_counter_batch_count = UVM_PERF_ACCESS_COUNTER_BA
 // See module param documentation below
 static unsigned uvm_perf_access_counter_threshold = UVM_PERF_ACCESS_COUNTER_THRESHOLD_DEFAULT;
 
+// Maximum number of regions serviced per batch. When a batch touches more
+// regions, only the ones with the most accesses over the last
+// uvm_perf_access_counter_window_ms are serviced. The notifications of the
+// others are cleared so that they are sent again, and their counts keep
+// accumulating in the window. 0 services every region.
+static unsigned uvm_perf_access_counter_top_n = UVM_PERF_ACCESS_COUNTER_TOP_N_DEFAULT;
+
+static unsigned uvm_perf_access_counter_window_ms = UVM_PERF_ACCESS_COUNTER_WINDOW_MS_DEFAULT;
+
 // Module parameters for the tunables
 module_param(uvm_perf_access_counter_migration_enable, int, S_IRUGO);
 MODULE_PARM_DESC(uvm_perf_access_counter_migration_enable,
@@ -85,6 +103,13 @@ module_param(uvm_perf_access_counter_threshold, uint, S_IRUGO);
 MODULE_PARM_DESC(uvm_perf_access_counter_threshold,
                  "Number of remote accesses on a region required to trigger a notification."
                  "Valid values: [1, 65535]");
+module_param(uvm_perf_access_counter_top_n, uint, S_IRUGO);
+MODULE_PARM_DESC(uvm_perf_access_counter_top_n,
+                 "Maximum number of 2MB regions migrated per batch of notifications, picking the hottest ones."
+                 "0 migrates all of them");
+module_param(uvm_perf_access_counter_window_ms, uint, S_IRUGO);
+MODULE_PARM_DESC(uvm_perf_access_counter_window_ms,
+                 "Length of the sliding window used to rank regions by access count, in milliseconds.");
 
 static void access_counter_buffer_flush_locked(uvm_access_counter_buffer_t *access_counters,
                                                uvm_gpu_buffer_flush_mode_t flush_mode);
@@ -483,6 +508,28 @@ NV_STATUS uvm_parent_gpu_init_access_counters(uvm_parent_gpu_t *parent_gpu, NvU3
         goto fail;
     }
 
+    if (uvm_perf_access_counter_top_n != 0) {
+        if (uvm_perf_access_counter_window_ms == 0) {
+            UVM_INFO_PRINT("Invalid value %u for uvm_perf_access_counter_window_ms. Using %u instead\n",
+                           uvm_perf_access_counter_window_ms,
+                           UVM_PERF_ACCESS_COUNTER_WINDOW_MS_DEFAULT);
+            uvm_perf_access_counter_window_ms = UVM_PERF_ACCESS_COUNTER_WINDOW_MS_DEFAULT;
+        }
+
+        batch_context->hot_regions.table = uvm_kvmalloc_zero((1 << UVM_ACCESS_COUNTER_HOT_REGIONS_ORDER) *
+                                                             sizeof(*batch_context->hot_regions.table));
+        batch_context->hot_regions.batch_regions = uvm_kvmalloc(access_counters->max_notifications *
+                                                                sizeof(*batch_context->hot_regions.batch_regions));
+        batch_context->hot_regions.ranked_regions = uvm_kvmalloc(access_counters->max_notifications *
+                                                                 sizeof(*batch_context->hot_regions.ranked_regions));
+        if (!batch_context->hot_regions.table ||
+            !batch_context->hot_regions.batch_regions ||
+            !batch_context->hot_regions.ranked_regions) {
+            status = NV_ERR_NO_MEMORY;
+            goto fail;
+        }
+    }
+
     return NV_OK;
 
 fail:
@@ -514,8 +561,14 @@ void uvm_parent_gpu_deinit_access_counters(uvm_parent_gpu_t *parent_gpu, NvU32 n
         access_counters->rm_info.accessCntrBufferHandle = 0;
         uvm_kvfree(batch_context->notification_cache);
         uvm_kvfree(batch_context->notifications);
+        uvm_kvfree(batch_context->hot_regions.table);
+        uvm_kvfree(batch_context->hot_regions.batch_regions);
+        uvm_kvfree(batch_context->hot_regions.ranked_regions);
         batch_context->notification_cache = NULL;
         batch_context->notifications = NULL;
+        batch_context->hot_regions.table = NULL;
+        batch_context->hot_regions.batch_regions = NULL;
+        batch_context->hot_regions.ranked_regions = NULL;
     }
 }
 
@@ -1037,6 +1090,146 @@ static void preprocess_notifications(uvm_parent_gpu_t *parent_gpu,
          NULL);
 }
 
+// Add the given accesses to the sliding window of a region and return its
+// access count over the window. The previous window is weighted by how much of
+// it still overlaps with the sliding window.
+static NvU64 hot_region_update(uvm_access_counter_hot_region_t *hot_region, NvU64 count, NvU64 now)
+{
+    const NvU64 window_ns = uvm_perf_access_counter_window_ms * 1000000ULL;
+    NvU64 elapsed = now - hot_region->window_start;
+
+    if (elapsed >= window_ns) {
+        hot_region->prev_count = elapsed < 2 * window_ns ? hot_region->count : 0;
+        hot_region->count = 0;
+        hot_region->window_start += (elapsed / window_ns) * window_ns;
+        elapsed = now - hot_region->window_start;
+    }
+
+    hot_region->count += count;
+
+    return hot_region->count + hot_region->prev_count * (window_ns - elapsed) / window_ns;
+}
+
+static uvm_access_counter_hot_region_t *hot_region_get(uvm_access_counter_service_batch_context_t *batch_context,
+                                                       const uvm_access_counter_buffer_entry_t *entry,
+                                                       NvU64 address,
+                                                       NvU64 now)
+{
+    uvm_access_counter_hot_region_t *hot_region;
+    NvU64 key = address ^ (NvU64)(uintptr_t)entry->va_space ^ uvm_id_value(entry->gpu->id);
+
+    hot_region = &batch_context->hot_regions.table[hash_64(key, UVM_ACCESS_COUNTER_HOT_REGIONS_ORDER)];
+
+    // On a collision the new region replaces the old one. VA spaces are only
+    // used as keys, so a stale entry can at worst give a new VA space a head
+    // start that fades out with the window.
+    if (hot_region->va_space != entry->va_space || hot_region->gpu != entry->gpu || hot_region->address != address) {
+        hot_region->va_space = entry->va_space;
+        hot_region->gpu = entry->gpu;
+        hot_region->address = address;
+        hot_region->window_start = now;
+        hot_region->count = 0;
+        hot_region->prev_count = 0;
+    }
+
+    return hot_region;
+}
+
+static int cmp_sort_batch_regions_by_score(const void *_a, const void *_b)
+{
+    const uvm_access_counter_batch_region_t *a = *(const uvm_access_counter_batch_region_t **)_a;
+    const uvm_access_counter_batch_region_t *b = *(const uvm_access_counter_batch_region_t **)_b;
+
+    // Hottest first
+    return UVM_CMP_DEFAULT(b->score, a->score);
+}
+
+// Group the sorted notifications of the batch by region, add their counts to
+// the sliding window of each region and, if the batch touches more than
+// uvm_perf_access_counter_top_n regions, mark the notifications of all but the
+// hottest ones as deferred. Regions are never split across VA blocks, so
+// servicing can skip deferred regions without affecting the others.
+static void rank_notifications(uvm_access_counter_buffer_t *access_counters)
+{
+    uvm_access_counter_service_batch_context_t *batch_context = &access_counters->batch_service_context;
+    uvm_access_counter_batch_region_t *batch_regions = batch_context->hot_regions.batch_regions;
+    uvm_access_counter_batch_region_t **ranked_regions = batch_context->hot_regions.ranked_regions;
+    uvm_access_counter_buffer_entry_t *region_entry = NULL;
+    NvU64 region_address = 0;
+    NvU64 now = NV_GETTIME();
+    NvU32 num_regions = 0;
+    NvU32 i;
+
+    for (i = 0; i < batch_context->num_notifications; i++) {
+        uvm_access_counter_buffer_entry_t *current_entry = batch_context->notifications[i];
+        NvU64 address = UVM_ALIGN_DOWN(current_entry->address, UVM_ACCESS_COUNTER_HOT_REGION_SIZE);
+
+        current_entry->deferred = false;
+
+        // Notifications without a VA space are not serviced
+        if (!current_entry->va_space)
+            continue;
+
+        if (!region_entry ||
+            region_entry->va_space != current_entry->va_space ||
+            region_entry->gpu != current_entry->gpu ||
+            region_address != address) {
+            region_entry = current_entry;
+            region_address = address;
+
+            batch_regions[num_regions].first = i;
+            batch_regions[num_regions].num_notifications = 0;
+            batch_regions[num_regions].score = 0;
+            ranked_regions[num_regions] = &batch_regions[num_regions];
+            ++num_regions;
+        }
+
+        ++batch_regions[num_regions - 1].num_notifications;
+        batch_regions[num_regions - 1].score = hot_region_update(hot_region_get(batch_context,
+                                                                                current_entry,
+                                                                                address,
+                                                                                now),
+                                                                 current_entry->counter_value,
+                                                                 now);
+    }
+
+    batch_context->hot_regions.num_batch_regions = num_regions;
+    atomic64_add(num_regions, &access_counters->stats.num_ranked_regions);
+
+    if (num_regions <= uvm_perf_access_counter_top_n)
+        return;
+
+    sort(ranked_regions, num_regions, sizeof(*ranked_regions), cmp_sort_batch_regions_by_score, NULL);
+
+    for (i = uvm_perf_access_counter_top_n; i < num_regions; i++) {
+        NvU32 j;
+
+        for (j = 0; j < ranked_regions[i]->num_notifications; j++)
+            batch_context->notifications[ranked_regions[i]->first + j]->deferred = true;
+    }
+
+    atomic64_add(num_regions - uvm_perf_access_counter_top_n, &access_counters->stats.num_deferred_regions);
+}
+
+// Number of consecutive deferred notifications from the given one in the same
+// VA space and GPU
+static NvU32 deferred_notifications_count(uvm_access_counter_service_batch_context_t *batch_context, NvU32 index)
+{
+    uvm_access_counter_buffer_entry_t *first_entry = batch_context->notifications[index];
+    NvU32 i;
+
+    for (i = index; i < batch_context->num_notifications; i++) {
+        uvm_access_counter_buffer_entry_t *current_entry = batch_context->notifications[i];
+
+        if (!current_entry->deferred ||
+            current_entry->va_space != first_entry->va_space ||
+            current_entry->gpu != first_entry->gpu)
+            break;
+    }
+
+    return i - index;
+}
+
 static NV_STATUS notify_tools_broadcast_and_process_flags(uvm_access_counter_buffer_t *access_counters,
                                                           uvm_access_counter_buffer_entry_t **notification_start,
                                                           NvU32 num_entries,
@@ -1698,6 +1891,9 @@ static NV_STATUS service_notifications(uvm_access_counter_buffer_t *access_count
 
     preprocess_notifications(parent_gpu, batch_context);
 
+    if (uvm_perf_access_counter_top_n != 0)
+        rank_notifications(access_counters);
+
     while (i < batch_context->num_notifications) {
         uvm_access_counter_buffer_entry_t *current_entry = batch_context->notifications[i];
         va_space = current_entry->va_space;
@@ -1727,7 +1923,22 @@ static NV_STATUS service_notifications(uvm_access_counter_buffer_t *access_count
                 gpu_va_space = uvm_gpu_va_space_get(va_space, current_entry->gpu);
             }
 
-            if (gpu_va_space && uvm_va_space_has_access_counter_migrations(va_space)) {
+            if (gpu_va_space && uvm_va_space_has_access_counter_migrations(va_space) && current_entry->deferred) {
+                // Clear the notifications of regions that didn't make the cut
+                // so that they are sent again.
+                NvU32 num_deferred = deferred_notifications_count(batch_context, i);
+
+                status = notify_tools_and_process_flags(va_space,
+                                                        current_entry->gpu,
+                                                        access_counters,
+                                                        0,
+                                                        &batch_context->notifications[i],
+                                                        num_deferred,
+                                                        UVM_ACCESS_COUNTER_ACTION_BATCH_CLEAR,
+                                                        NULL);
+                i += num_deferred;
+            }
+            else if (gpu_va_space && uvm_va_space_has_access_counter_migrations(va_space)) {
                 status = service_notifications_batch(gpu_va_space, mm, access_counters, i, &i);
             }
             else {
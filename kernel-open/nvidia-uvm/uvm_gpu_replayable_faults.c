@@ -23,10 +23,12 @@
 
 #include "linux/sort.h"
 #include "nv_uvm_interface.h"
+#include "uvm_api.h"
 #include "uvm_common.h"
 #include "uvm_linux.h"
 #include "uvm_global.h"
 #include "uvm_gpu_replayable_faults.h"
+#include "uvm_gpu_isr.h"
 #include "uvm_hal.h"
 #include "uvm_kvmalloc.h"
 #include "uvm_tools.h"
@@ -39,6 +41,7 @@
 #include "uvm_gpu_non_replayable_faults.h"
 #include "uvm_ats_faults.h"
 #include "uvm_test.h"
+#include "uvm_test_rng.h"
 
 // The documentation at the beginning of uvm_gpu_non_replayable_faults.c
 // provides some background for understanding replayable faults, non-replayable
@@ -79,7 +82,8 @@ module_param(uvm_perf_fault_batch_count, uint, S_IRUGO);
 
 #define UVM_PERF_FAULT_REPLAY_POLICY_DEFAULT UVM_PERF_FAULT_REPLAY_POLICY_BATCH_FLUSH
 
-// Policy that determines when to issue fault replays
+// Policy that determines when to issue fault replays. See
+// uvm_perf_fault_replay_policy_t.
 static uvm_perf_fault_replay_policy_t uvm_perf_fault_replay_policy = UVM_PERF_FAULT_REPLAY_POLICY_DEFAULT;
 module_param(uvm_perf_fault_replay_policy, uint, S_IRUGO);
 
@@ -115,6 +119,36 @@ module_param(uvm_perf_fault_max_throttle_per_service, uint, S_IRUGO);
 static unsigned uvm_perf_fault_coalesce = 1;
 module_param(uvm_perf_fault_coalesce, uint, S_IRUGO);
 
+// Order fault batches during preprocessing with a radix sort on packed keys
+// instead of the generic comparison sort
+static unsigned uvm_perf_fault_radix_sort = 1;
+module_param(uvm_perf_fault_radix_sort, uint, S_IRUGO);
+
+// Fetch and preprocess the next batch of faults while the copy engine work and
+// the replay of the current batch are in flight. Only used with the
+// UVM_PERF_FAULT_REPLAY_POLICY_BATCH_FLUSH replay policy, since it is the only
+// one that waits for the replay to complete before fetching new faults.
+static unsigned uvm_perf_fault_pipeline = 1;
+module_param(uvm_perf_fault_pipeline, uint, S_IRUGO);
+
+#define UVM_PERF_FAULT_SERVICE_WORKERS_DEFAULT 1
+#define UVM_PERF_FAULT_SERVICE_WORKERS_MAX 16
+
+// Number of threads, including the bottom half, used to service each batch of
+// replayable faults. Sorted batches are split in shards at VA block
+// boundaries, and the shards are serviced concurrently by workers on the NUMA
+// node closest to the GPU. 1 means that batches are only serviced by the
+// bottom half.
+static unsigned uvm_perf_fault_service_workers = UVM_PERF_FAULT_SERVICE_WORKERS_DEFAULT;
+module_param(uvm_perf_fault_service_workers, uint, S_IRUGO);
+
+// Minimum number of coalesced faults in a shard. Batches with fewer faults are
+// serviced by fewer workers, since the cost of waking up the workers is not
+// amortized otherwise.
+#define UVM_PERF_FAULT_SERVICE_MIN_FAULTS_PER_WORKER 32
+
+static void fault_service_worker_entry(void *args);
+
 // This function is used for both the initial fault buffer initialization and
 // the power management resume path.
 static void fault_buffer_reinit_replayable_faults(uvm_parent_gpu_t *parent_gpu)
@@ -135,6 +169,192 @@ static void fault_buffer_reinit_replayable_faults(uvm_parent_gpu_t *parent_gpu)
         parent_gpu->arch_hal->disable_prefetch_faults(parent_gpu);
 }
 
+// There is no error handling in this function. The caller is in charge of
+// calling fault_service_workers_deinit on failure.
+static NV_STATUS fault_service_workers_init(uvm_parent_gpu_t *parent_gpu)
+{
+    NV_STATUS status;
+    uvm_replayable_fault_buffer_t *replayable_faults = &parent_gpu->fault_buffer.replayable;
+    uvm_fault_service_worker_t *workers;
+    char kthread_name[TASK_COMM_LEN + 1];
+    NvU32 max_workers;
+    NvU32 i;
+
+    max_workers = max(uvm_perf_fault_service_workers, 1u);
+    max_workers = min(max_workers, (NvU32)UVM_PERF_FAULT_SERVICE_WORKERS_MAX);
+    if (max_workers != uvm_perf_fault_service_workers) {
+        UVM_INFO_PRINT("Invalid uvm_perf_fault_service_workers value on GPU %s: %u. Valid range [1:%u] Using %u instead\n",
+                       uvm_parent_gpu_name(parent_gpu),
+                       uvm_perf_fault_service_workers,
+                       UVM_PERF_FAULT_SERVICE_WORKERS_MAX,
+                       max_workers);
+    }
+
+    replayable_faults->service_workers.max_workers = max_workers;
+    replayable_faults->service_workers.num_workers = max_workers;
+
+    if (max_workers == 1)
+        return NV_OK;
+
+    workers = uvm_kvmalloc_zero(max_workers * sizeof(*workers));
+    if (!workers)
+        return NV_ERR_NO_MEMORY;
+
+    replayable_faults->service_workers.workers = workers;
+
+    for (i = 0; i < max_workers; ++i) {
+        uvm_fault_service_worker_t *worker = &workers[i];
+
+        worker->parent_gpu = parent_gpu;
+        worker->index = i;
+        init_completion(&worker->done);
+        uvm_tracker_init(&worker->batch_context.tracker);
+
+        worker->batch_context.tools_event_batch = uvm_tools_event_batch_alloc();
+        if (!worker->batch_context.tools_event_batch)
+            return NV_ERR_NO_MEMORY;
+
+        worker->batch_context.fatal_utlbs = uvm_kvmalloc_zero(BITS_TO_LONGS(replayable_faults->utlb_count) *
+                                                              sizeof(*worker->batch_context.fatal_utlbs));
+        if (!worker->batch_context.fatal_utlbs)
+            return NV_ERR_NO_MEMORY;
+
+        // The first shard is serviced by the bottom half, which already owns
+        // a block context and the ATS invalidation state.
+        if (i == 0) {
+            worker->batch_context.block_service_context = &replayable_faults->block_service_context;
+            worker->batch_context.ats_context.ats_invalidate = &replayable_faults->ats_invalidate;
+            continue;
+        }
+
+        worker->block_service_context.block_context = uvm_va_block_context_alloc(NULL);
+        if (!worker->block_service_context.block_context)
+            return NV_ERR_NO_MEMORY;
+
+        worker->batch_context.block_service_context = &worker->block_service_context;
+        worker->batch_context.ats_context.ats_invalidate = &worker->ats_invalidate;
+
+        nv_kthread_q_item_init(&worker->q_item, fault_service_worker_entry, worker);
+
+        snprintf(kthread_name, sizeof(kthread_name), "UVM GPU%u FS%u", uvm_parent_id_value(parent_gpu->id), i);
+        status = uvm_isr_init_queue_on_node(&worker->q, kthread_name, parent_gpu->closest_cpu_numa_node);
+        if (status != NV_OK) {
+            UVM_ERR_PRINT("Failed in nv_kthread_q_init for fault service worker %u: %s, GPU %s\n",
+                          i,
+                          nvstatusToString(status),
+                          uvm_parent_gpu_name(parent_gpu));
+            return status;
+        }
+    }
+
+    return NV_OK;
+}
+
+static NV_STATUS fault_sort_scratch_alloc(uvm_fault_service_batch_context_t *batch_context, NvU32 max_faults)
+{
+    batch_context->sort.keys = uvm_kvmalloc(max_faults * sizeof(*batch_context->sort.keys));
+    if (!batch_context->sort.keys)
+        return NV_ERR_NO_MEMORY;
+
+    batch_context->sort.tmp_keys = uvm_kvmalloc(max_faults * sizeof(*batch_context->sort.tmp_keys));
+    if (!batch_context->sort.tmp_keys)
+        return NV_ERR_NO_MEMORY;
+
+    batch_context->sort.tmp_entries = uvm_kvmalloc(max_faults * sizeof(*batch_context->sort.tmp_entries));
+    if (!batch_context->sort.tmp_entries)
+        return NV_ERR_NO_MEMORY;
+
+    return NV_OK;
+}
+
+static void fault_sort_scratch_free(uvm_fault_service_batch_context_t *batch_context)
+{
+    uvm_kvfree(batch_context->sort.keys);
+    uvm_kvfree(batch_context->sort.tmp_keys);
+    uvm_kvfree(batch_context->sort.tmp_entries);
+    batch_context->sort.keys        = NULL;
+    batch_context->sort.tmp_keys    = NULL;
+    batch_context->sort.tmp_entries = NULL;
+}
+
+static void fault_service_workers_deinit(uvm_parent_gpu_t *parent_gpu)
+{
+    uvm_replayable_fault_buffer_t *replayable_faults = &parent_gpu->fault_buffer.replayable;
+    uvm_fault_service_worker_t *workers = replayable_faults->service_workers.workers;
+    NvU32 i;
+
+    if (!workers)
+        return;
+
+    for (i = 0; i < replayable_faults->service_workers.max_workers; ++i) {
+        uvm_fault_service_worker_t *worker = &workers[i];
+
+        // It's safe to call nv_kthread_q_stop() on queues that were never
+        // initialized.
+        if (i > 0) {
+            nv_kthread_q_stop(&worker->q);
+            uvm_va_block_context_free(worker->block_service_context.block_context);
+        }
+
+        UVM_ASSERT(uvm_tracker_is_empty(&worker->batch_context.tracker));
+        uvm_tracker_deinit(&worker->batch_context.tracker);
+        uvm_tools_event_batch_free(worker->batch_context.tools_event_batch);
+        uvm_kvfree(worker->batch_context.fatal_utlbs);
+    }
+
+    uvm_kvfree(workers);
+    replayable_faults->service_workers.workers = NULL;
+}
+
+// There is no error handling in this function. The caller is in charge of
+// calling fault_batch_context_deinit on failure.
+static NV_STATUS fault_batch_context_init(uvm_parent_gpu_t *parent_gpu,
+                                          uvm_fault_service_batch_context_t *batch_context)
+{
+    uvm_replayable_fault_buffer_t *replayable_faults = &parent_gpu->fault_buffer.replayable;
+
+    batch_context->fault_cache = uvm_kvmalloc_zero(replayable_faults->max_faults * sizeof(*batch_context->fault_cache));
+    if (!batch_context->fault_cache)
+        return NV_ERR_NO_MEMORY;
+
+    batch_context->ordered_fault_cache = uvm_kvmalloc_zero(replayable_faults->max_faults *
+                                                           sizeof(*batch_context->ordered_fault_cache));
+    if (!batch_context->ordered_fault_cache)
+        return NV_ERR_NO_MEMORY;
+
+    // This value must be initialized by HAL
+    UVM_ASSERT(replayable_faults->utlb_count > 0);
+
+    batch_context->utlbs = uvm_kvmalloc_zero(replayable_faults->utlb_count * sizeof(*batch_context->utlbs));
+    if (!batch_context->utlbs)
+        return NV_ERR_NO_MEMORY;
+
+    batch_context->max_utlb_id = 0;
+
+    batch_context->block_service_context = &replayable_faults->block_service_context;
+    batch_context->ats_context.ats_invalidate = &replayable_faults->ats_invalidate;
+
+    batch_context->tools_event_batch = uvm_tools_event_batch_alloc();
+    if (!batch_context->tools_event_batch)
+        return NV_ERR_NO_MEMORY;
+
+    return fault_sort_scratch_alloc(batch_context, replayable_faults->max_faults);
+}
+
+static void fault_batch_context_deinit(uvm_fault_service_batch_context_t *batch_context)
+{
+    fault_sort_scratch_free(batch_context);
+
+    uvm_kvfree(batch_context->fault_cache);
+    uvm_kvfree(batch_context->ordered_fault_cache);
+    uvm_kvfree(batch_context->utlbs);
+    uvm_tools_event_batch_free(batch_context->tools_event_batch);
+    batch_context->fault_cache         = NULL;
+    batch_context->ordered_fault_cache = NULL;
+    batch_context->utlbs               = NULL;
+    batch_context->tools_event_batch   = NULL;
+}
+
 // There is no error handling in this function. The caller is in charge of
 // calling fault_buffer_deinit_replayable_faults on failure.
 static NV_STATUS fault_buffer_init_replayable_faults(uvm_parent_gpu_t *parent_gpu)
@@ -164,26 +384,26 @@ static NV_STATUS fault_buffer_init_replayable_faults(uvm_parent_gpu_t *parent_gp
                        parent_gpu->fault_buffer.max_batch_size);
     }
 
-    batch_context->fault_cache = uvm_kvmalloc_zero(replayable_faults->max_faults * sizeof(*batch_context->fault_cache));
-    if (!batch_context->fault_cache)
-        return NV_ERR_NO_MEMORY;
-
     // fault_cache is used to signal that the tracker was initialized.
     uvm_tracker_init(&replayable_faults->replay_tracker);
 
-    batch_context->ordered_fault_cache = uvm_kvmalloc_zero(replayable_faults->max_faults *
-                                                           sizeof(*batch_context->ordered_fault_cache));
-    if (!batch_context->ordered_fault_cache)
-        return NV_ERR_NO_MEMORY;
+    status = fault_batch_context_init(parent_gpu, batch_context);
+    if (status != NV_OK)
+        return status;
 
-    // This value must be initialized by HAL
-    UVM_ASSERT(replayable_faults->utlb_count > 0);
+    if (uvm_perf_fault_pipeline) {
+        replayable_faults->pipeline_batch_context = uvm_kvmalloc_zero(sizeof(*replayable_faults->pipeline_batch_context));
+        if (!replayable_faults->pipeline_batch_context)
+            return NV_ERR_NO_MEMORY;
 
-    batch_context->utlbs = uvm_kvmalloc_zero(replayable_faults->utlb_count * sizeof(*batch_context->utlbs));
-    if (!batch_context->utlbs)
-        return NV_ERR_NO_MEMORY;
+        status = fault_batch_context_init(parent_gpu, replayable_faults->pipeline_batch_context);
+        if (status != NV_OK)
+            return status;
+    }
 
-    batch_context->max_utlb_id = 0;
+    status = fault_service_workers_init(parent_gpu);
+    if (status != NV_OK)
+        return status;
 
     status = uvm_rm_locked_call(nvUvmInterfaceOwnPageFaultIntr(parent_gpu->rm_device, NV_TRUE));
     if (status != NV_OK) {
@@ -236,12 +456,15 @@ static void fault_buffer_deinit_replayable_faults(uvm_parent_gpu_t *parent_gpu)
             parent_gpu->arch_hal->enable_prefetch_faults(parent_gpu);
     }
 
-    uvm_kvfree(batch_context->fault_cache);
-    uvm_kvfree(batch_context->ordered_fault_cache);
-    uvm_kvfree(batch_context->utlbs);
-    batch_context->fault_cache         = NULL;
-    batch_context->ordered_fault_cache = NULL;
-    batch_context->utlbs               = NULL;
+    fault_service_workers_deinit(parent_gpu);
+
+    if (replayable_faults->pipeline_batch_context) {
+        fault_batch_context_deinit(replayable_faults->pipeline_batch_context);
+        uvm_kvfree(replayable_faults->pipeline_batch_context);
+        replayable_faults->pipeline_batch_context = NULL;
+    }
+
+    fault_batch_context_deinit(batch_context);
 }
 
 NV_STATUS uvm_parent_gpu_fault_buffer_init(uvm_parent_gpu_t *parent_gpu)
@@ -533,12 +756,10 @@ static NV_STATUS push_replay_on_gpu(uvm_gpu_t *gpu,
     // Add this push to the GPU's replay_tracker so cancel can wait on it.
     status = uvm_tracker_add_push_safe(&replayable_faults->replay_tracker, &push);
 
-    if (uvm_procfs_is_debug_enabled()) {
-        if (type == UVM_FAULT_REPLAY_TYPE_START)
-            ++replayable_faults->stats.num_replays;
-        else
-            ++replayable_faults->stats.num_replays_ack_all;
-    }
+    if (type == UVM_FAULT_REPLAY_TYPE_START)
+        uvm_parent_gpu_fault_stats_inc(gpu->parent, num_replays);
+    else
+        uvm_parent_gpu_fault_stats_inc(gpu->parent, num_replays_ack_all);
 
     return status;
 }
@@ -819,6 +1040,68 @@ static bool fetch_fault_buffer_try_merge_entry(uvm_fault_buffer_entry_t *current
     return false;
 }
 
+// Initialize the fault handling fields of a freshly parsed fault entry and
+// coalesce it with previous faults in the batch when possible. Returns true if
+// the entry was merged into a previous entry.
+static bool fetch_fault_buffer_cache_entry(uvm_fault_service_batch_context_t *batch_context,
+                                           uvm_fault_buffer_entry_t *current_entry,
+                                           NvU32 fault_index,
+                                           bool may_filter)
+{
+    bool is_same_instance_ptr = true;
+    uvm_fault_utlb_info_t *current_tlb;
+
+    // The GPU aligns the fault addresses to 4k, but all of our tracking is
+    // done in PAGE_SIZE chunks which might be larger.
+    current_entry->fault_address = UVM_PAGE_ALIGN_DOWN(current_entry->fault_address);
+
+    // Make sure that all fields in the entry are properly initialized
+    current_entry->is_fatal = (current_entry->fault_type >= UVM_FAULT_TYPE_FATAL);
+
+    if (current_entry->is_fatal) {
+        // Record the fatal fault event later as we need the va_space locked
+        current_entry->fatal_reason = UvmEventFatalReasonInvalidFaultType;
+    }
+    else {
+        current_entry->fatal_reason = UvmEventFatalReasonInvalid;
+    }
+
+    current_entry->va_space = NULL;
+    current_entry->gpu = NULL;
+    current_entry->filtered = false;
+    current_entry->replayable.cancel_va_mode = UVM_FAULT_CANCEL_VA_MODE_ALL;
+
+    if (current_entry->fault_source.utlb_id > batch_context->max_utlb_id)
+        batch_context->max_utlb_id = current_entry->fault_source.utlb_id;
+
+    current_tlb = &batch_context->utlbs[current_entry->fault_source.utlb_id];
+
+    if (fault_index > 0) {
+        UVM_ASSERT(batch_context->last_fault);
+        is_same_instance_ptr = cmp_fault_instance_ptr(current_entry, batch_context->last_fault) == 0;
+
+        // Coalesce duplicate faults when possible
+        if (may_filter &&
+            !current_entry->is_fatal &&
+            fetch_fault_buffer_try_merge_entry(current_entry, batch_context, current_tlb, is_same_instance_ptr)) {
+            return true;
+        }
+    }
+
+    if (batch_context->is_single_instance_ptr && !is_same_instance_ptr)
+        batch_context->is_single_instance_ptr = false;
+
+    current_entry->num_instances = 1;
+    current_entry->access_type_mask = uvm_fault_access_type_mask_bit(current_entry->fault_access_type);
+    INIT_LIST_HEAD(&current_entry->merged_instances_list);
+
+    ++current_tlb->num_pending_faults;
+    current_tlb->last_fault = current_entry;
+    batch_context->last_fault = current_entry;
+
+    return false;
+}
+
 // Fetch entries from the fault buffer, decode them and store them in the batch
 // context. We implement the fetch modes described above.
 //
@@ -856,6 +1139,7 @@ static NV_STATUS fetch_fault_buffer_entries(uvm_parent_gpu_t *parent_gpu,
     uvm_replayable_fault_buffer_t *replayable_faults = &parent_gpu->fault_buffer.replayable;
     const bool in_pascal_cancel_path = (!parent_gpu->fault_cancel_va_supported && fetch_mode == FAULT_FETCH_MODE_ALL);
     const bool may_filter = uvm_perf_fault_coalesce && !in_pascal_cancel_path;
+    bool record_entries = false;
 
     UVM_ASSERT(uvm_sem_is_locked(&parent_gpu->isr.replayable_faults.service_lock));
     UVM_ASSERT(parent_gpu->replayable_faults_supported);
@@ -886,12 +1170,13 @@ static NV_STATUS fetch_fault_buffer_entries(uvm_parent_gpu_t *parent_gpu,
     if (get == put)
         goto done;
 
+    // Only query tools once per fetch since it takes a global lock
+    record_entries = uvm_tools_is_fault_buffer_entry_enabled();
+
     // Parse until get != put and have enough space to cache.
     while ((get != put) &&
            (fetch_mode == FAULT_FETCH_MODE_ALL || fault_index < parent_gpu->fault_buffer.max_batch_size)) {
-        bool is_same_instance_ptr = true;
         uvm_fault_buffer_entry_t *current_entry = &fault_cache[fault_index];
-        uvm_fault_utlb_info_t *current_tlb;
 
         // We cannot just wait for the last entry (the one pointed by put) to
         // become valid, we have to do it individually since entries can be
@@ -914,62 +1199,14 @@ static NV_STATUS fetch_fault_buffer_entries(uvm_parent_gpu_t *parent_gpu,
         if (status != NV_OK)
             goto done;
 
-        // The GPU aligns the fault addresses to 4k, but all of our tracking is
-        // done in PAGE_SIZE chunks which might be larger.
-        current_entry->fault_address = UVM_PAGE_ALIGN_DOWN(current_entry->fault_address);
-
-        // Make sure that all fields in the entry are properly initialized
-        current_entry->is_fatal = (current_entry->fault_type >= UVM_FAULT_TYPE_FATAL);
+        UVM_ASSERT(current_entry->fault_source.utlb_id < replayable_faults->utlb_count);
 
-        if (current_entry->is_fatal) {
-            // Record the fatal fault event later as we need the va_space locked
-            current_entry->fatal_reason = UvmEventFatalReasonInvalidFaultType;
-        }
-        else {
-            current_entry->fatal_reason = UvmEventFatalReasonInvalid;
-        }
-
-        current_entry->va_space = NULL;
-        current_entry->gpu = NULL;
-        current_entry->filtered = false;
-        current_entry->replayable.cancel_va_mode = UVM_FAULT_CANCEL_VA_MODE_ALL;
-
-        if (current_entry->fault_source.utlb_id > batch_context->max_utlb_id) {
-            UVM_ASSERT(current_entry->fault_source.utlb_id < replayable_faults->utlb_count);
-            batch_context->max_utlb_id = current_entry->fault_source.utlb_id;
-        }
-
-        current_tlb = &batch_context->utlbs[current_entry->fault_source.utlb_id];
+        if (record_entries)
+            uvm_tools_broadcast_fault_buffer_entry(parent_gpu, current_entry);
 
-        if (fault_index > 0) {
-            UVM_ASSERT(batch_context->last_fault);
-            is_same_instance_ptr = cmp_fault_instance_ptr(current_entry, batch_context->last_fault) == 0;
+        if (!fetch_fault_buffer_cache_entry(batch_context, current_entry, fault_index, may_filter))
+            ++num_coalesced_faults;
 
-            // Coalesce duplicate faults when possible
-            if (may_filter && !current_entry->is_fatal) {
-                bool merged = fetch_fault_buffer_try_merge_entry(current_entry,
-                                                                 batch_context,
-                                                                 current_tlb,
-                                                                 is_same_instance_ptr);
-                if (merged)
-                    goto next_fault;
-            }
-        }
-
-        if (batch_context->is_single_instance_ptr && !is_same_instance_ptr)
-            batch_context->is_single_instance_ptr = false;
-
-        current_entry->num_instances = 1;
-        current_entry->access_type_mask = uvm_fault_access_type_mask_bit(current_entry->fault_access_type);
-        INIT_LIST_HEAD(&current_entry->merged_instances_list);
-
-        ++current_tlb->num_pending_faults;
-        current_tlb->last_fault = current_entry;
-        batch_context->last_fault = current_entry;
-
-        ++num_coalesced_faults;
-
-    next_fault:
         ++fault_index;
         ++get;
         if (get == replayable_faults->max_faults)
@@ -1019,100 +1256,318 @@ static int cmp_sort_fault_entry_by_va_space_gpu_address_access_type(const void *
     return cmp_access_type((*a)->fault_access_type, (*b)->fault_access_type);
 }
 
-// Translate all instance pointers to a VA space and GPU instance. Since the
-// buffer is ordered by instance_ptr, we minimize the number of translations.
-//
-// This function returns NV_WARN_MORE_PROCESSING_REQUIRED if a fault buffer
-// flush occurred and executed successfully, or the error code if it failed.
-// NV_OK otherwise.
-static NV_STATUS translate_instance_ptrs(uvm_parent_gpu_t *parent_gpu,
-                                         uvm_fault_service_batch_context_t *batch_context)
+// Stable LSD radix sort of entries by the keys in batch_context->sort.keys.
+// Digits that are equal in all the keys are skipped, so batches with little
+// entropy in their keys only take a few passes.
+static void fault_radix_sort(uvm_fault_service_batch_context_t *batch_context,
+                             uvm_fault_buffer_entry_t **entries,
+                             NvU32 num_entries)
 {
+    NvU64 *keys = batch_context->sort.keys;
+    NvU64 *tmp_keys = batch_context->sort.tmp_keys;
+    uvm_fault_buffer_entry_t **tmp_entries = batch_context->sort.tmp_entries;
+    uvm_fault_buffer_entry_t **sorted_entries = entries;
+    NvU32 *counts = batch_context->sort.counts;
+    NvU64 diff = 0;
+    NvU32 shift;
     NvU32 i;
-    NV_STATUS status;
 
-    for (i = 0; i < batch_context->num_coalesced_faults; ++i) {
-        uvm_fault_buffer_entry_t *current_entry;
+    for (i = 1; i < num_entries; ++i)
+        diff |= keys[i] ^ keys[0];
 
-        current_entry = batch_context->ordered_fault_cache[i];
+    for (shift = 0; shift < 64 && (diff >> shift) != 0; shift += UVM_FAULT_SORT_RADIX_BITS) {
+        NvU32 offset = 0;
 
-        // If this instance pointer matches the previous instance pointer, just
-        // copy over the already-translated va_space and move on.
-        if (i != 0 && cmp_fault_instance_ptr(current_entry, batch_context->ordered_fault_cache[i - 1]) == 0) {
-            current_entry->va_space = batch_context->ordered_fault_cache[i - 1]->va_space;
-            current_entry->gpu = batch_context->ordered_fault_cache[i - 1]->gpu;
+        if (((diff >> shift) & (UVM_FAULT_SORT_RADIX_SIZE - 1)) == 0)
             continue;
-        }
-
-        status = uvm_parent_gpu_fault_entry_to_va_space(parent_gpu,
-                                                        current_entry,
-                                                        &current_entry->va_space,
-                                                        &current_entry->gpu);
-        if (status != NV_OK) {
-            uvm_gpu_t *gpu = NULL;
-
-            if (status == NV_ERR_PAGE_TABLE_NOT_AVAIL) {
-                // The channel is valid but the subcontext is not. This can only
-                // happen if the subcontext is torn down before its work is
-                // complete while other subcontexts in the same TSG are still
-                // executing which means some GPU is still valid under that
-                // parent GPU. This is a violation of the programming model. We
-                // have limited options since the VA space is gone, meaning we
-                // can't target the PDB for cancel even if we wanted to. So
-                // we'll just throw away precise attribution and cancel this
-                // fault using the SW method, which validates that the intended
-                // context (TSG) is still running so we don't cancel an innocent
-                // context.
-                gpu = uvm_parent_gpu_find_first_valid_gpu(parent_gpu);
 
-                UVM_ASSERT(!current_entry->va_space);
-                UVM_ASSERT(gpu);
-                UVM_ASSERT(gpu->max_subcontexts > 0);
+        memset(counts, 0, sizeof(batch_context->sort.counts));
 
-                if (parent_gpu->smc.enabled) {
-                    status = push_cancel_on_gpu_targeted(gpu,
-                                                         current_entry->instance_ptr,
-                                                         current_entry->fault_source.gpc_id,
-                                                         current_entry->fault_source.client_id,
-                                                         &batch_context->tracker);
-                }
-                else {
-                    status = push_cancel_on_gpu_global(gpu, current_entry->instance_ptr, &batch_context->tracker);
-                }
+        for (i = 0; i < num_entries; ++i)
+            ++counts[(keys[i] >> shift) & (UVM_FAULT_SORT_RADIX_SIZE - 1)];
 
-                if (status != NV_OK)
-                    return status;
+        for (i = 0; i < UVM_FAULT_SORT_RADIX_SIZE; ++i) {
+            NvU32 count = counts[i];
 
-                // Fall through and let the flush restart fault processing
-            }
-            else {
-                UVM_ASSERT(status == NV_ERR_INVALID_CHANNEL);
-            }
+            counts[i] = offset;
+            offset += count;
+        }
 
-            // If the channel is gone then we're looking at a stale fault entry.
-            // The fault must have been resolved already (serviced or
-            // cancelled), so we can just flush the fault buffer.
-            //
-            // No need to use UVM_GPU_BUFFER_FLUSH_MODE_WAIT_UPDATE_PUT since
-            // there was a context preemption for the entries we want to flush,
-            // meaning PUT must reflect them.
-            status = fault_buffer_flush_locked(parent_gpu,
-                                               gpu,
-                                               UVM_GPU_BUFFER_FLUSH_MODE_UPDATE_PUT,
-                                               UVM_FAULT_REPLAY_TYPE_START,
-                                               batch_context);
-            if (status != NV_OK)
-                 return status;
+        for (i = 0; i < num_entries; ++i) {
+            NvU32 pos = counts[(keys[i] >> shift) & (UVM_FAULT_SORT_RADIX_SIZE - 1)]++;
 
-            return NV_WARN_MORE_PROCESSING_REQUIRED;
-        }
-        else {
-            UVM_ASSERT(current_entry->va_space);
-            UVM_ASSERT(current_entry->gpu);
+            tmp_keys[pos] = keys[i];
+            tmp_entries[pos] = entries[i];
         }
+
+        swap(keys, tmp_keys);
+        swap(entries, tmp_entries);
     }
 
-    return NV_OK;
+    if (entries != sorted_entries)
+        memcpy(sorted_entries, entries, num_entries * sizeof(*entries));
+}
+
+// Pack {aperture, instance_ptr address, ve_id} in a key per entry, so that the
+// key order matches cmp_fault_instance_ptr. Returns false if an instance
+// pointer cannot be packed.
+static bool fault_sort_keys_by_instance_ptr(uvm_fault_service_batch_context_t *batch_context)
+{
+    NvU32 i;
+
+    BUILD_BUG_ON(UVM_APERTURE_MAX > 16);
+    BUILD_BUG_ON(sizeof(((uvm_fault_buffer_entry_t *)0)->fault_source.ve_id) != 1);
+
+    for (i = 0; i < batch_context->num_coalesced_faults; ++i) {
+        const uvm_fault_buffer_entry_t *entry = batch_context->ordered_fault_cache[i];
+
+        // Instance blocks are 4K-aligned
+        if (!IS_ALIGNED(entry->instance_ptr.address, UVM_PAGE_SIZE_4K))
+            return false;
+
+        batch_context->sort.keys[i] = ((NvU64)entry->instance_ptr.aperture << 60) |
+                                      ((entry->instance_ptr.address >> 12) << 8) |
+                                      entry->fault_source.ve_id;
+    }
+
+    return true;
+}
+
+static bool fault_sort_slot_less(uvm_va_space_t *va_space_a,
+                                 NvU32 gpu_id_a,
+                                 uvm_va_space_t *va_space_b,
+                                 NvU32 gpu_id_b)
+{
+    int result = cmp_va_space(va_space_a, va_space_b);
+
+    return result < 0 || (result == 0 && gpu_id_a < gpu_id_b);
+}
+
+static NvU32 fault_sort_find_slot(uvm_fault_service_batch_context_t *batch_context,
+                                  uvm_va_space_t *va_space,
+                                  NvU32 gpu_id)
+{
+    NvU32 slot;
+
+    for (slot = 0; slot < batch_context->sort.num_slots; ++slot) {
+        if (batch_context->sort.slots[slot].va_space == va_space && batch_context->sort.slots[slot].gpu_id == gpu_id)
+            break;
+    }
+
+    return slot;
+}
+
+// Pack {VA space slot, GPU ID slot, 4K page, access type rank} in a key per
+// entry, so that the key order matches
+// cmp_sort_fault_entry_by_va_space_gpu_address_access_type. VA space and GPU
+// pairs are replaced by their rank among the distinct pairs in the batch.
+// Returns false if the batch has too many distinct pairs or an address cannot
+// be packed.
+static bool fault_sort_keys_by_va_space_gpu_address_access_type(uvm_fault_service_batch_context_t *batch_context)
+{
+    uvm_fault_buffer_entry_t **ordered_fault_cache = batch_context->ordered_fault_cache;
+    uvm_va_space_t *last_va_space = NULL;
+    NvU32 last_gpu_id = 0;
+    NvU32 last_slot = UVM_FAULT_SORT_MAX_SLOTS;
+    NvU32 i;
+
+    BUILD_BUG_ON(UVM_FAULT_ACCESS_TYPE_COUNT > 8);
+    BUILD_BUG_ON(UVM_FAULT_SORT_MAX_SLOTS > (1 << 9));
+
+    // Gather the distinct {VA space, GPU} pairs. Faults are grouped by
+    // instance_ptr at this point, so pairs change rarely between consecutive
+    // entries.
+    batch_context->sort.num_slots = 0;
+    for (i = 0; i < batch_context->num_coalesced_faults; ++i) {
+        const uvm_fault_buffer_entry_t *entry = ordered_fault_cache[i];
+        NvU32 gpu_id = entry->gpu ? uvm_id_value(entry->gpu->id) : 0;
+        NvU32 slot;
+
+        if (!IS_ALIGNED(entry->fault_address, UVM_PAGE_SIZE_4K))
+            return false;
+
+        if (last_slot != UVM_FAULT_SORT_MAX_SLOTS && entry->va_space == last_va_space && gpu_id == last_gpu_id)
+            continue;
+
+        slot = fault_sort_find_slot(batch_context, entry->va_space, gpu_id);
+        if (slot == batch_context->sort.num_slots) {
+            if (slot == UVM_FAULT_SORT_MAX_SLOTS)
+                return false;
+
+            batch_context->sort.slots[slot].va_space = entry->va_space;
+            batch_context->sort.slots[slot].gpu_id = gpu_id;
+            ++batch_context->sort.num_slots;
+        }
+
+        last_va_space = entry->va_space;
+        last_gpu_id = gpu_id;
+        last_slot = slot;
+    }
+
+    // Order the slots. There are few of them, so use an insertion sort.
+    for (i = 1; i < batch_context->sort.num_slots; ++i) {
+        uvm_va_space_t *va_space = batch_context->sort.slots[i].va_space;
+        NvU32 gpu_id = batch_context->sort.slots[i].gpu_id;
+        NvU32 j = i;
+
+        while (j > 0 && fault_sort_slot_less(va_space,
+                                             gpu_id,
+                                             batch_context->sort.slots[j - 1].va_space,
+                                             batch_context->sort.slots[j - 1].gpu_id)) {
+            batch_context->sort.slots[j] = batch_context->sort.slots[j - 1];
+            --j;
+        }
+
+        batch_context->sort.slots[j].va_space = va_space;
+        batch_context->sort.slots[j].gpu_id = gpu_id;
+    }
+
+    last_slot = UVM_FAULT_SORT_MAX_SLOTS;
+    for (i = 0; i < batch_context->num_coalesced_faults; ++i) {
+        const uvm_fault_buffer_entry_t *entry = ordered_fault_cache[i];
+        NvU32 gpu_id = entry->gpu ? uvm_id_value(entry->gpu->id) : 0;
+
+        if (last_slot == UVM_FAULT_SORT_MAX_SLOTS || entry->va_space != last_va_space || gpu_id != last_gpu_id) {
+            last_slot = fault_sort_find_slot(batch_context, entry->va_space, gpu_id);
+            last_va_space = entry->va_space;
+            last_gpu_id = gpu_id;
+        }
+
+        UVM_ASSERT(last_slot < batch_context->sort.num_slots);
+        UVM_ASSERT(entry->fault_access_type < UVM_FAULT_ACCESS_TYPE_COUNT);
+
+        // More intrusive access types go first, see cmp_access_type
+        batch_context->sort.keys[i] = ((NvU64)last_slot << 55) |
+                                      ((entry->fault_address >> 12) << 3) |
+                                      (UVM_FAULT_ACCESS_TYPE_COUNT - 1 - entry->fault_access_type);
+    }
+
+    return true;
+}
+
+static void sort_fault_entries_by_instance_ptr(uvm_fault_service_batch_context_t *batch_context, bool use_radix_sort)
+{
+    if (use_radix_sort && fault_sort_keys_by_instance_ptr(batch_context)) {
+        fault_radix_sort(batch_context, batch_context->ordered_fault_cache, batch_context->num_coalesced_faults);
+        return;
+    }
+
+    sort(batch_context->ordered_fault_cache,
+         batch_context->num_coalesced_faults,
+         sizeof(*batch_context->ordered_fault_cache),
+         cmp_sort_fault_entry_by_instance_ptr,
+         NULL);
+}
+
+static void sort_fault_entries_by_va_space_gpu_address_access_type(uvm_fault_service_batch_context_t *batch_context,
+                                                                   bool use_radix_sort)
+{
+    if (use_radix_sort && fault_sort_keys_by_va_space_gpu_address_access_type(batch_context)) {
+        fault_radix_sort(batch_context, batch_context->ordered_fault_cache, batch_context->num_coalesced_faults);
+        return;
+    }
+
+    sort(batch_context->ordered_fault_cache,
+         batch_context->num_coalesced_faults,
+         sizeof(*batch_context->ordered_fault_cache),
+         cmp_sort_fault_entry_by_va_space_gpu_address_access_type,
+         NULL);
+}
+
+// Translate all instance pointers to a VA space and GPU instance. Since the
+// buffer is ordered by instance_ptr, we minimize the number of translations.
+//
+// This function returns NV_WARN_MORE_PROCESSING_REQUIRED if a fault buffer
+// flush occurred and executed successfully, or the error code if it failed.
+// NV_OK otherwise.
+static NV_STATUS translate_instance_ptrs(uvm_parent_gpu_t *parent_gpu,
+                                         uvm_fault_service_batch_context_t *batch_context)
+{
+    NvU32 i;
+    NV_STATUS status;
+
+    for (i = 0; i < batch_context->num_coalesced_faults; ++i) {
+        uvm_fault_buffer_entry_t *current_entry;
+
+        current_entry = batch_context->ordered_fault_cache[i];
+
+        // If this instance pointer matches the previous instance pointer, just
+        // copy over the already-translated va_space and move on.
+        if (i != 0 && cmp_fault_instance_ptr(current_entry, batch_context->ordered_fault_cache[i - 1]) == 0) {
+            current_entry->va_space = batch_context->ordered_fault_cache[i - 1]->va_space;
+            current_entry->gpu = batch_context->ordered_fault_cache[i - 1]->gpu;
+            continue;
+        }
+
+        status = uvm_parent_gpu_fault_entry_to_va_space(parent_gpu,
+                                                        current_entry,
+                                                        &current_entry->va_space,
+                                                        &current_entry->gpu);
+        if (status != NV_OK) {
+            uvm_gpu_t *gpu = NULL;
+
+            if (status == NV_ERR_PAGE_TABLE_NOT_AVAIL) {
+                // The channel is valid but the subcontext is not. This can only
+                // happen if the subcontext is torn down before its work is
+                // complete while other subcontexts in the same TSG are still
+                // executing which means some GPU is still valid under that
+                // parent GPU. This is a violation of the programming model. We
+                // have limited options since the VA space is gone, meaning we
+                // can't target the PDB for cancel even if we wanted to. So
+                // we'll just throw away precise attribution and cancel this
+                // fault using the SW method, which validates that the intended
+                // context (TSG) is still running so we don't cancel an innocent
+                // context.
+                gpu = uvm_parent_gpu_find_first_valid_gpu(parent_gpu);
+
+                UVM_ASSERT(!current_entry->va_space);
+                UVM_ASSERT(gpu);
+                UVM_ASSERT(gpu->max_subcontexts > 0);
+
+                if (parent_gpu->smc.enabled) {
+                    status = push_cancel_on_gpu_targeted(gpu,
+                                                         current_entry->instance_ptr,
+                                                         current_entry->fault_source.gpc_id,
+                                                         current_entry->fault_source.client_id,
+                                                         &batch_context->tracker);
+                }
+                else {
+                    status = push_cancel_on_gpu_global(gpu, current_entry->instance_ptr, &batch_context->tracker);
+                }
+
+                if (status != NV_OK)
+                    return status;
+
+                // Fall through and let the flush restart fault processing
+            }
+            else {
+                UVM_ASSERT(status == NV_ERR_INVALID_CHANNEL);
+            }
+
+            // If the channel is gone then we're looking at a stale fault entry.
+            // The fault must have been resolved already (serviced or
+            // cancelled), so we can just flush the fault buffer.
+            //
+            // No need to use UVM_GPU_BUFFER_FLUSH_MODE_WAIT_UPDATE_PUT since
+            // there was a context preemption for the entries we want to flush,
+            // meaning PUT must reflect them.
+            status = fault_buffer_flush_locked(parent_gpu,
+                                               gpu,
+                                               UVM_GPU_BUFFER_FLUSH_MODE_UPDATE_PUT,
+                                               UVM_FAULT_REPLAY_TYPE_START,
+                                               batch_context);
+            if (status != NV_OK)
+                 return status;
+
+            return NV_WARN_MORE_PROCESSING_REQUIRED;
+        }
+        else {
+            UVM_ASSERT(current_entry->va_space);
+            UVM_ASSERT(current_entry->gpu);
+        }
+    }
+
+    return NV_OK;
 }
 
 // Fault cache preprocessing for fault coalescing
@@ -1131,6 +1586,10 @@ static NV_STATUS translate_instance_ptrs(uvm_parent_gpu_t *parent_gpu,
 // 2) translate all instance_ptrs to VA spaces
 // 3) sort by va_space, GPU ID, fault address (fault_address is page-aligned at
 //    this point) and access type.
+//
+// Both sorts use a radix sort on packed keys unless uvm_perf_fault_radix_sort
+// is 0 or the batch cannot be packed, in which case the generic sort() is
+// used.
 static NV_STATUS preprocess_fault_batch(uvm_parent_gpu_t *parent_gpu,
                                         uvm_fault_service_batch_context_t *batch_context)
 {
@@ -1153,13 +1612,8 @@ static NV_STATUS preprocess_fault_batch(uvm_parent_gpu_t *parent_gpu,
     UVM_ASSERT(j == batch_context->num_coalesced_faults);
 
     // 1) if the fault batch contains more than one, sort by instance_ptr
-    if (!batch_context->is_single_instance_ptr) {
-        sort(ordered_fault_cache,
-             batch_context->num_coalesced_faults,
-             sizeof(*ordered_fault_cache),
-             cmp_sort_fault_entry_by_instance_ptr,
-             NULL);
-    }
+    if (!batch_context->is_single_instance_ptr)
+        sort_fault_entries_by_instance_ptr(batch_context, uvm_perf_fault_radix_sort != 0);
 
     // 2) translate all instance_ptrs to VA spaces
     status = translate_instance_ptrs(parent_gpu, batch_context);
@@ -1168,11 +1622,7 @@ static NV_STATUS preprocess_fault_batch(uvm_parent_gpu_t *parent_gpu,
 
     // 3) sort by va_space, GPU ID, fault address (GPU already reports
     // 4K-aligned address), and access type.
-    sort(ordered_fault_cache,
-         batch_context->num_coalesced_faults,
-         sizeof(*ordered_fault_cache),
-         cmp_sort_fault_entry_by_va_space_gpu_address_access_type,
-         NULL);
+    sort_fault_entries_by_va_space_gpu_address_access_type(batch_context, uvm_perf_fault_radix_sort != 0);
 
     return NV_OK;
 }
@@ -1234,18 +1684,28 @@ static void mark_fault_throttled(uvm_fault_service_batch_context_t *batch_contex
     batch_context->has_throttled_faults = true;
 }
 
+// Record that the given uTLB has fatal faults. The shards serviced by the fault
+// service workers share the utlbs array of the batch, so they record it in
+// their own bitmap instead, which is merged into utlbs once all the shards are
+// done. See service_fault_batch_parallel().
+static void mark_utlb_fatal(uvm_fault_service_batch_context_t *batch_context, NvU32 utlb_id)
+{
+    if (batch_context->fatal_utlbs)
+        __set_bit(utlb_id, batch_context->fatal_utlbs);
+    else
+        batch_context->utlbs[utlb_id].has_fatal_faults = true;
+}
+
 static void mark_fault_fatal(uvm_fault_service_batch_context_t *batch_context,
                              uvm_fault_buffer_entry_t *fault_entry,
                              UvmEventFatalReason fatal_reason,
                              uvm_fault_cancel_va_mode_t cancel_va_mode)
 {
-    uvm_fault_utlb_info_t *utlb = &batch_context->utlbs[fault_entry->fault_source.utlb_id];
-
     fault_entry->is_fatal = true;
     fault_entry->fatal_reason = fatal_reason;
     fault_entry->replayable.cancel_va_mode = cancel_va_mode;
 
-    utlb->has_fatal_faults = true;
+    mark_utlb_fatal(batch_context, fault_entry->fault_source.utlb_id);
 
     if (!batch_context->fatal_va_space) {
         UVM_ASSERT(fault_entry->va_space);
@@ -1386,10 +1846,9 @@ static NV_STATUS service_fault_batch_block_locked(uvm_gpu_t *gpu,
     uvm_page_index_t last_page_index;
     NvU32 page_fault_count = 0;
     uvm_range_group_range_iter_t iter;
-    uvm_replayable_fault_buffer_t *replayable_faults = &gpu->parent->fault_buffer.replayable;
     uvm_fault_buffer_entry_t **ordered_fault_cache = batch_context->ordered_fault_cache;
     uvm_fault_buffer_entry_t *first_fault_entry = ordered_fault_cache[first_fault_index];
-    uvm_service_block_context_t *block_context = &replayable_faults->block_service_context;
+    uvm_service_block_context_t *block_context = batch_context->block_service_context;
     uvm_va_space_t *va_space = uvm_va_block_get_va_space(va_block);
     const uvm_va_policy_t *policy;
     NvU64 end;
@@ -1533,8 +1992,10 @@ static NV_STATUS service_fault_batch_block_locked(uvm_gpu_t *gpu,
             // Only update the flag the first time since logical permissions
             // cannot change while we hold the VA space lock.
             // TODO: Bug 1750144: That might not be true with HMM.
-            if (block_context->num_retries == 0)
+            if (block_context->num_retries == 0) {
                 mark_fault_throttled(batch_context, current_entry);
+                uvm_parent_gpu_fault_stats_inc(gpu->parent, num_throttled_faults);
+            }
 
             continue;
         }
@@ -1613,8 +2074,8 @@ static NV_STATUS service_fault_batch_block(uvm_gpu_t *gpu,
     NV_STATUS status;
     uvm_va_block_retry_t va_block_retry;
     NV_STATUS tracker_status;
-    uvm_replayable_fault_buffer_t *replayable_faults = &gpu->parent->fault_buffer.replayable;
-    uvm_service_block_context_t *fault_block_context = &replayable_faults->block_service_context;
+    bool notify_stream;
+    uvm_service_block_context_t *fault_block_context = batch_context->block_service_context;
 
     fault_block_context->operation = UVM_SERVICE_OPERATION_REPLAYABLE_FAULTS;
     fault_block_context->num_retries = 0;
@@ -1635,11 +2096,21 @@ static NV_STATUS service_fault_batch_block(uvm_gpu_t *gpu,
 
     tracker_status = uvm_tracker_add_tracker_safe(&batch_context->tracker, &va_block->tracker);
 
+    notify_stream = status == NV_OK &&
+                    !uvm_va_block_is_hmm(va_block) &&
+                    uvm_processor_mask_test(&va_block->resident, gpu->id);
+
     uvm_mutex_unlock(&va_block->lock);
 
     if (uvm_va_block_is_hmm(va_block))
         uvm_hmm_migrate_finish(va_block);
 
+    // Prefetch the next blocks if the faults follow a stream across VA blocks.
+    // This is done after adding the block's work to the batch tracker so the
+    // replay does not wait for the prefetched blocks.
+    if (notify_stream)
+        uvm_perf_prefetch_stream_notify(va_block, gpu, fault_block_context);
+
     return status == NV_OK? tracker_status: status;
 }
 
@@ -1803,8 +2274,7 @@ static NV_STATUS service_fault_batch_ats_sub(uvm_gpu_va_space_t *gpu_va_space,
     uvm_page_mask_t *write_fault_mask = &ats_context->faults.write_fault_mask;
     uvm_page_mask_t *prefetch_only_fault_mask = &ats_context->faults.prefetch_only_fault_mask;
     uvm_gpu_t *gpu = gpu_va_space->gpu;
-    bool replay_per_va_block =
-                        (gpu->parent->fault_buffer.replayable.replay_policy == UVM_PERF_FAULT_REPLAY_POLICY_BLOCK);
+    bool replay_per_va_block = (batch_context->replay_policy == UVM_PERF_FAULT_REPLAY_POLICY_BLOCK);
 
     UVM_ASSERT(vma);
 
@@ -1956,8 +2426,7 @@ static NV_STATUS service_fault_batch_dispatch(uvm_va_space_t *va_space,
     uvm_va_range_t *va_range_next = NULL;
     uvm_va_block_t *va_block;
     uvm_gpu_t *gpu = gpu_va_space->gpu;
-    uvm_va_block_context_t *va_block_context =
-        gpu->parent->fault_buffer.replayable.block_service_context.block_context;
+    uvm_va_block_context_t *va_block_context = batch_context->block_service_context->block_context;
     uvm_fault_buffer_entry_t *current_entry = batch_context->ordered_fault_cache[fault_index];
     struct mm_struct *mm = va_block_context->mm;
     NvU64 fault_address = current_entry->fault_address;
@@ -1986,7 +2455,7 @@ static NV_STATUS service_fault_batch_dispatch(uvm_va_space_t *va_space,
         NvU64 outer = ~0ULL;
 
          UVM_ASSERT(replay_per_va_block ==
-                    (gpu->parent->fault_buffer.replayable.replay_policy == UVM_PERF_FAULT_REPLAY_POLICY_BLOCK));
+                    (batch_context->replay_policy == UVM_PERF_FAULT_REPLAY_POLICY_BLOCK));
 
         // Limit outer to the minimum of next va_range.start and first
         // fault_address' next UVM_GMMU_ATS_GRANULARITY alignment so that it's
@@ -2109,6 +2578,9 @@ static NV_STATUS service_fault_batch_for_cancel(uvm_fault_service_batch_context_
     batch_context->fatal_gpu                   = NULL;
     batch_context->has_throttled_faults        = false;
 
+    // No replays are issued while servicing for cancel
+    batch_context->replay_policy               = UVM_PERF_FAULT_REPLAY_POLICY_BATCH;
+
     status = fetch_fault_buffer_entries(gpu->parent, batch_context, FAULT_FETCH_MODE_ALL);
     if (status != NV_OK)
         goto done;
@@ -2237,14 +2709,14 @@ static NV_STATUS service_fault_batch(uvm_parent_gpu_t *parent_gpu,
     NvU32 i;
     uvm_va_space_t *va_space = NULL;
     uvm_gpu_va_space_t *prev_gpu_va_space = NULL;
-    uvm_ats_fault_invalidate_t *ats_invalidate = &parent_gpu->fault_buffer.replayable.ats_invalidate;
+    uvm_ats_fault_invalidate_t *ats_invalidate = batch_context->ats_context.ats_invalidate;
     struct mm_struct *mm = NULL;
     const bool replay_per_va_block = service_mode != FAULT_SERVICE_MODE_CANCEL &&
-                                     parent_gpu->fault_buffer.replayable.replay_policy == UVM_PERF_FAULT_REPLAY_POLICY_BLOCK;
-    uvm_service_block_context_t *service_context =
-        &parent_gpu->fault_buffer.replayable.block_service_context;
+                                     batch_context->replay_policy == UVM_PERF_FAULT_REPLAY_POLICY_BLOCK;
+    uvm_service_block_context_t *service_context = batch_context->block_service_context;
     uvm_va_block_context_t *va_block_context = service_context->block_context;
     bool hmm_migratable = true;
+    NvU64 lock_start;
 
     UVM_ASSERT(parent_gpu->replayable_faults_supported);
 
@@ -2270,6 +2742,7 @@ static NV_STATUS service_fault_batch(uvm_parent_gpu_t *parent_gpu,
 
             // Fault on a different va_space, drop the lock of the old one...
             if (va_space) {
+                uvm_tools_event_batch_end(batch_context->tools_event_batch);
                 uvm_va_space_up_read(va_space);
                 uvm_va_space_mm_release_unlock(va_space, mm);
                 mm = NULL;
@@ -2286,7 +2759,13 @@ static NV_STATUS service_fault_batch(uvm_parent_gpu_t *parent_gpu,
             mm = uvm_va_space_mm_retain_lock(va_space);
             uvm_va_block_context_init(va_block_context, mm);
 
+            lock_start = NV_GETTIME();
             uvm_va_space_down_read(va_space);
+            uvm_va_space_lock_stat_add(&va_space->lock_stats.fault_read_wait, NV_GETTIME() - lock_start);
+
+            // Events recorded while servicing the faults of the VA space are
+            // only made visible to the tools once it's done.
+            uvm_tools_event_batch_begin(batch_context->tools_event_batch, va_space);
         }
 
         // Some faults could be already fatal if they cannot be handled by
@@ -2298,7 +2777,7 @@ static NV_STATUS service_fault_batch(uvm_parent_gpu_t *parent_gpu,
                 batch_context->fatal_gpu = current_entry->gpu;
             }
 
-            utlb->has_fatal_faults = true;
+            mark_utlb_fatal(batch_context, current_entry->fault_source.utlb_id);
             UVM_ASSERT(utlb->num_pending_faults > 0);
             continue;
         }
@@ -2333,6 +2812,7 @@ static NV_STATUS service_fault_batch(uvm_parent_gpu_t *parent_gpu,
         if (status == NV_WARN_MORE_PROCESSING_REQUIRED || status == NV_WARN_MISMATCHED_TARGET) {
             if (status == NV_WARN_MISMATCHED_TARGET)
                 hmm_migratable = false;
+            uvm_tools_event_batch_end(batch_context->tools_event_batch);
             uvm_va_space_up_read(va_space);
             uvm_va_space_mm_release_unlock(va_space, mm);
             mm = NULL;
@@ -2369,6 +2849,7 @@ static NV_STATUS service_fault_batch(uvm_parent_gpu_t *parent_gpu,
 
 fail:
     if (va_space) {
+        uvm_tools_event_batch_end(batch_context->tools_event_batch);
         uvm_va_space_up_read(va_space);
         uvm_va_space_mm_release_unlock(va_space, mm);
     }
@@ -2376,6 +2857,164 @@ fail:
     return status;
 }
 
+static void fault_service_worker(void *args)
+{
+    uvm_fault_service_worker_t *worker = (uvm_fault_service_worker_t *)args;
+
+    worker->status = service_fault_batch(worker->parent_gpu, FAULT_SERVICE_MODE_REGULAR, &worker->batch_context);
+
+    complete(&worker->done);
+}
+
+static void fault_service_worker_entry(void *args)
+{
+    UVM_ENTRY_VOID(fault_service_worker(args));
+}
+
+// Return the first index at or after end that does not share the VA space, GPU
+// and VA block region of the fault at end - 1, so that a VA block is never
+// split across shards. This also keeps ATS sub-batches, which are built per
+// UVM_VA_BLOCK_SIZE region, within a single shard.
+static NvU32 fault_service_shard_end(uvm_fault_service_batch_context_t *batch_context, NvU32 end)
+{
+    const uvm_fault_buffer_entry_t *last_entry = batch_context->ordered_fault_cache[end - 1];
+
+    for (; end < batch_context->num_coalesced_faults; ++end) {
+        const uvm_fault_buffer_entry_t *current_entry = batch_context->ordered_fault_cache[end];
+
+        if (current_entry->va_space != last_entry->va_space ||
+            current_entry->gpu != last_entry->gpu ||
+            UVM_VA_BLOCK_ALIGN_DOWN(current_entry->fault_address) !=
+                UVM_VA_BLOCK_ALIGN_DOWN(last_entry->fault_address)) {
+            break;
+        }
+    }
+
+    return end;
+}
+
+static void fault_service_shard_init(uvm_fault_service_batch_context_t *shard_context,
+                                     uvm_fault_service_batch_context_t *batch_context,
+                                     NvU32 start,
+                                     NvU32 end)
+{
+    UVM_ASSERT(start < end);
+    UVM_ASSERT(uvm_tracker_is_empty(&shard_context->tracker));
+
+    shard_context->fault_cache                 = batch_context->fault_cache;
+    shard_context->ordered_fault_cache         = batch_context->ordered_fault_cache + start;
+    shard_context->utlbs                       = batch_context->utlbs;
+    shard_context->max_utlb_id                 = batch_context->max_utlb_id;
+    shard_context->num_cached_faults           = batch_context->num_cached_faults;
+    shard_context->num_coalesced_faults        = end - start;
+    shard_context->fatal_va_space              = NULL;
+    shard_context->fatal_gpu                   = NULL;
+    shard_context->has_throttled_faults        = false;
+    shard_context->num_invalid_prefetch_faults = 0;
+    shard_context->num_duplicate_faults        = 0;
+    shard_context->num_replays                 = 0;
+    shard_context->replay_policy               = batch_context->replay_policy;
+    shard_context->batch_id                    = batch_context->batch_id;
+    shard_context->is_single_instance_ptr      = batch_context->is_single_instance_ptr;
+    shard_context->last_fault                  = NULL;
+
+    bitmap_zero(shard_context->fatal_utlbs, batch_context->max_utlb_id + 1);
+}
+
+// Service a preprocessed fault batch using the fault service workers. The
+// ordered view of the batch is split in contiguous shards, one per worker. The
+// first shard is serviced by the calling thread and the rest by the workers.
+// Once all the shards have been serviced, their results are merged back into
+// batch_context in shard order, so the caller can handle fatal faults and
+// replays as if the batch had been serviced by service_fault_batch().
+//
+// Shards only service their own VA blocks and never issue replays, so this
+// must not be used with UVM_PERF_FAULT_REPLAY_POLICY_BLOCK or in
+// FAULT_SERVICE_MODE_CANCEL.
+static NV_STATUS service_fault_batch_parallel(uvm_parent_gpu_t *parent_gpu,
+                                              uvm_fault_service_batch_context_t *batch_context)
+{
+    NV_STATUS status = NV_OK;
+    uvm_replayable_fault_buffer_t *replayable_faults = &parent_gpu->fault_buffer.replayable;
+    uvm_fault_service_worker_t *workers = replayable_faults->service_workers.workers;
+    NvU32 num_faults = batch_context->num_coalesced_faults;
+    NvU32 num_workers = replayable_faults->service_workers.num_workers;
+    NvU32 num_shards = 0;
+    NvU32 start = 0;
+    NvU32 utlb_id;
+    NvU32 i;
+
+    num_workers = min(num_workers, max(num_faults / UVM_PERF_FAULT_SERVICE_MIN_FAULTS_PER_WORKER, 1u));
+
+    if (num_workers <= 1 || batch_context->replay_policy == UVM_PERF_FAULT_REPLAY_POLICY_BLOCK)
+        return service_fault_batch(parent_gpu, FAULT_SERVICE_MODE_REGULAR, batch_context);
+
+    UVM_ASSERT(workers);
+
+    while (start < num_faults && num_shards < num_workers) {
+        NvU32 end;
+
+        if (num_shards == num_workers - 1) {
+            end = num_faults;
+        }
+        else {
+            end = start + DIV_ROUND_UP(num_faults - start, num_workers - num_shards);
+            end = fault_service_shard_end(batch_context, end);
+        }
+
+        fault_service_shard_init(&workers[num_shards].batch_context, batch_context, start, end);
+
+        start = end;
+        ++num_shards;
+    }
+
+    UVM_ASSERT(start == num_faults);
+
+    // Consecutive VA blocks may have been merged into fewer shards than workers
+    if (num_shards == 1)
+        return service_fault_batch(parent_gpu, FAULT_SERVICE_MODE_REGULAR, batch_context);
+
+    for (i = 1; i < num_shards; ++i) {
+        reinit_completion(&workers[i].done);
+        nv_kthread_q_schedule_q_item(&workers[i].q, &workers[i].q_item);
+    }
+
+    workers[0].status = service_fault_batch(parent_gpu, FAULT_SERVICE_MODE_REGULAR, &workers[0].batch_context);
+
+    for (i = 0; i < num_shards; ++i) {
+        uvm_fault_service_batch_context_t *shard_context = &workers[i].batch_context;
+        NV_STATUS tracker_status;
+
+        if (i > 0)
+            wait_for_completion(&workers[i].done);
+
+        if (status == NV_OK)
+            status = workers[i].status;
+
+        batch_context->num_invalid_prefetch_faults += shard_context->num_invalid_prefetch_faults;
+        batch_context->num_duplicate_faults += shard_context->num_duplicate_faults;
+        batch_context->num_replays += shard_context->num_replays;
+        batch_context->has_throttled_faults |= shard_context->has_throttled_faults;
+
+        for_each_set_bit(utlb_id, shard_context->fatal_utlbs, batch_context->max_utlb_id + 1)
+            batch_context->utlbs[utlb_id].has_fatal_faults = true;
+
+        if (!batch_context->fatal_va_space && shard_context->fatal_va_space) {
+            batch_context->fatal_va_space = shard_context->fatal_va_space;
+            batch_context->fatal_gpu = shard_context->fatal_gpu;
+        }
+
+        tracker_status = uvm_tracker_add_tracker_safe(&batch_context->tracker, &shard_context->tracker);
+        uvm_tracker_clear(&shard_context->tracker);
+        if (status == NV_OK)
+            status = tracker_status;
+    }
+
+    ++replayable_faults->stats.num_parallel_batches;
+
+    return status;
+}
+
 // Tells if the given fault entry is the first one in its uTLB
 static bool is_first_fault_in_utlb(uvm_fault_service_batch_context_t *batch_context, NvU32 fault_index)
 {
@@ -2788,6 +3427,7 @@ static NV_STATUS cancel_faults_precise_tlb(uvm_gpu_t *gpu, uvm_fault_service_bat
         batch_context->fatal_va_space              = NULL;
         batch_context->fatal_gpu                   = NULL;
         batch_context->has_throttled_faults        = false;
+        batch_context->replay_policy               = UVM_PERF_FAULT_REPLAY_POLICY_BATCH;
 
         // 5) Fetch all faults from buffer
         status = fetch_fault_buffer_entries(gpu->parent, batch_context, FAULT_FETCH_MODE_ALL);
@@ -2903,52 +3543,201 @@ static void enable_disable_prefetch_faults(uvm_parent_gpu_t *parent_gpu,
     }
 }
 
-void uvm_parent_gpu_service_replayable_faults(uvm_parent_gpu_t *parent_gpu)
+static void record_latency(uvm_parent_gpu_t *parent_gpu, uvm_fault_latency_stage_t stage, NvU64 latency_ns)
 {
-    NvU32 num_replays = 0;
-    NvU32 num_batches = 0;
-    NvU32 num_throttled = 0;
-    NV_STATUS status = NV_OK;
-    uvm_replayable_fault_buffer_t *replayable_faults = &parent_gpu->fault_buffer.replayable;
-    uvm_fault_service_batch_context_t *batch_context = &replayable_faults->batch_service_context;
+    NvU32 bucket = min((NvU32)fls64(latency_ns), (NvU32)UVM_FAULT_LATENCY_HISTOGRAM_BUCKETS - 1);
 
-    UVM_ASSERT(parent_gpu->replayable_faults_supported);
+    ++parent_gpu->fault_buffer.replayable.stats.latency_histogram[stage][bucket];
+}
 
-    uvm_tracker_init(&batch_context->tracker);
+// Record the time elapsed since start, and return the current time so that it
+// can be used as the start of the next stage.
+static NvU64 record_latency_since(uvm_parent_gpu_t *parent_gpu, uvm_fault_latency_stage_t stage, NvU64 start)
+{
+    NvU64 now = NV_GETTIME();
 
-    // Process all faults in the buffer
-    while (1) {
-        if (num_throttled >= uvm_perf_fault_max_throttle_per_service ||
-            num_batches >= uvm_perf_fault_max_batches_per_service) {
-            break;
-        }
+    record_latency(parent_gpu, stage, now - start);
 
-        batch_context->num_invalid_prefetch_faults = 0;
-        batch_context->num_duplicate_faults        = 0;
-        batch_context->num_replays                 = 0;
-        batch_context->fatal_va_space              = NULL;
-        batch_context->fatal_gpu                   = NULL;
-        batch_context->has_throttled_faults        = false;
+    return now;
+}
 
-        status = fetch_fault_buffer_entries(parent_gpu, batch_context, FAULT_FETCH_MODE_BATCH_READY);
-        if (status != NV_OK)
-            break;
+// Record the latency from the oldest fault in the batch being written to the
+// fault buffer until now, when its replay has just been pushed. The fault
+// timestamps come from the GPU clock, so the GPU clock is used as reference.
+static void record_end_to_end_latency(uvm_parent_gpu_t *parent_gpu,
+                                      uvm_fault_service_batch_context_t *batch_context)
+{
+    const uvm_fault_buffer_entry_t *oldest_entry = &batch_context->fault_cache[0];
+    uvm_gpu_t *gpu = oldest_entry->gpu;
+    NvU64 now;
 
-        if (batch_context->num_cached_faults == 0)
+    // The instance pointer of the fault could not be translated
+    if (!gpu)
+        return;
+
+    now = parent_gpu->host_hal->get_time(gpu);
+    if (now >= oldest_entry->timestamp)
+        record_latency(parent_gpu, UVM_FAULT_LATENCY_STAGE_END_TO_END, now - oldest_entry->timestamp);
+}
+
+// Select the replay policy for a preprocessed batch when
+// UVM_PERF_FAULT_REPLAY_POLICY_AUTO is used:
+// - If the previous batch had throttled faults, the thrashing pages are going
+//   to fault again, so flushing the buffer and waiting for the replay only
+//   delays the rest of the faults. Use BATCH. Throttling is only detected
+//   while servicing, so the signal of the current batch is not available yet.
+// - A high duplicate ratio means that many faults will be reported again
+//   after the replay. Use BATCH_FLUSH so that they are discarded.
+// - If all the faults come from a single uTLB, replaying after each VA block
+//   lets the faulting client resume as early as possible. Use BLOCK.
+// - Otherwise use BATCH_FLUSH.
+static uvm_perf_fault_replay_policy_t select_auto_replay_policy(bool last_batch_throttled,
+                                                                NvU32 replay_update_put_ratio,
+                                                                uvm_fault_service_batch_context_t *batch_context)
+{
+    NvU32 num_utlbs = 0;
+    NvU32 utlb_id;
+
+    if (last_batch_throttled)
+        return UVM_PERF_FAULT_REPLAY_POLICY_BATCH;
+
+    if (batch_context->num_duplicate_faults * 100 > batch_context->num_cached_faults * replay_update_put_ratio)
+        return UVM_PERF_FAULT_REPLAY_POLICY_BATCH_FLUSH;
+
+    for (utlb_id = 0; utlb_id <= batch_context->max_utlb_id; ++utlb_id) {
+        if (batch_context->utlbs[utlb_id].num_pending_faults > 0 && ++num_utlbs > 1)
             break;
+    }
 
-        ++batch_context->batch_id;
+    if (num_utlbs == 1)
+        return UVM_PERF_FAULT_REPLAY_POLICY_BLOCK;
+
+    return UVM_PERF_FAULT_REPLAY_POLICY_BATCH_FLUSH;
+}
+
+static uvm_perf_fault_replay_policy_t select_replay_policy(uvm_parent_gpu_t *parent_gpu,
+                                                           uvm_fault_service_batch_context_t *batch_context)
+{
+    uvm_replayable_fault_buffer_t *replayable_faults = &parent_gpu->fault_buffer.replayable;
 
-        status = preprocess_fault_batch(parent_gpu, batch_context);
+    if (replayable_faults->replay_policy != UVM_PERF_FAULT_REPLAY_POLICY_AUTO)
+        return replayable_faults->replay_policy;
 
-        num_replays += batch_context->num_replays;
+    return select_auto_replay_policy(replayable_faults->last_batch_throttled,
+                                     replayable_faults->replay_update_put_ratio,
+                                     batch_context);
+}
+
+// Account a batch serviced with the given start time in the statistics of its
+// replay policy
+static void account_replay_policy(uvm_parent_gpu_t *parent_gpu,
+                                  uvm_fault_service_batch_context_t *batch_context,
+                                  NvU64 start)
+{
+    uvm_perf_fault_replay_policy_t policy = batch_context->replay_policy;
+
+    UVM_ASSERT(policy < UVM_PERF_FAULT_REPLAY_POLICY_AUTO);
+
+    ++parent_gpu->fault_buffer.replayable.stats.replay_policy[policy].num_batches;
+    parent_gpu->fault_buffer.replayable.stats.replay_policy[policy].num_replays += batch_context->num_replays;
+    parent_gpu->fault_buffer.replayable.stats.replay_policy[policy].time_ns += NV_GETTIME() - start;
+}
+
+// Fetch a new batch of faults into the given batch context and preprocess it.
+//
+// Returns NV_WARN_NOTHING_TO_DO if the fault buffer is empty, and
+// NV_WARN_MORE_PROCESSING_REQUIRED if preprocessing already took care of the
+// whole batch. Replays issued during preprocessing are accounted in
+// batch_context->num_replays.
+static NV_STATUS fetch_and_preprocess_batch(uvm_parent_gpu_t *parent_gpu,
+                                            uvm_fault_service_batch_context_t *batch_context)
+{
+    NV_STATUS status;
+    NvU64 start;
+
+    batch_context->num_invalid_prefetch_faults = 0;
+    batch_context->num_duplicate_faults        = 0;
+    batch_context->num_replays                 = 0;
+    batch_context->fatal_va_space              = NULL;
+    batch_context->fatal_gpu                   = NULL;
+    batch_context->has_throttled_faults        = false;
+
+    start = NV_GETTIME();
+
+    status = fetch_fault_buffer_entries(parent_gpu, batch_context, FAULT_FETCH_MODE_BATCH_READY);
+    if (status != NV_OK)
+        return status;
+
+    if (batch_context->num_cached_faults == 0)
+        return NV_WARN_NOTHING_TO_DO;
+
+    start = record_latency_since(parent_gpu, UVM_FAULT_LATENCY_STAGE_FETCH, start);
+
+    ++batch_context->batch_id;
+
+    status = preprocess_fault_batch(parent_gpu, batch_context);
+
+    batch_context->replay_policy = select_replay_policy(parent_gpu, batch_context);
+
+    record_latency_since(parent_gpu, UVM_FAULT_LATENCY_STAGE_PREPROCESS, start);
+
+    return status;
+}
+
+void uvm_parent_gpu_service_replayable_faults(uvm_parent_gpu_t *parent_gpu)
+{
+    NvU32 num_replays = 0;
+    NvU32 num_batches = 0;
+    NvU32 num_throttled = 0;
+    NvU64 service_start;
+    NvU64 start;
+    bool batch_fetched = false;
+    NV_STATUS status = NV_OK;
+    uvm_replayable_fault_buffer_t *replayable_faults = &parent_gpu->fault_buffer.replayable;
+    uvm_fault_service_batch_context_t *batch_context = &replayable_faults->batch_service_context;
+    uvm_fault_service_batch_context_t *next_batch_context = replayable_faults->pipeline_batch_context;
+
+    UVM_ASSERT(parent_gpu->replayable_faults_supported);
+
+    uvm_tracker_init(&batch_context->tracker);
+    if (next_batch_context)
+        uvm_tracker_init(&next_batch_context->tracker);
+
+    // Process all faults in the buffer
+    while (1) {
+        if (batch_fetched) {
+            // The batch was already fetched and preprocessed while the previous
+            // one was being replayed
+            batch_fetched = false;
+            status = NV_OK;
+        }
+        else {
+            if (num_throttled >= uvm_perf_fault_max_throttle_per_service ||
+                num_batches >= uvm_perf_fault_max_batches_per_service) {
+                break;
+            }
+
+            status = fetch_and_preprocess_batch(parent_gpu, batch_context);
+            if (status == NV_WARN_NOTHING_TO_DO) {
+                status = NV_OK;
+                break;
+            }
+
+            num_replays += batch_context->num_replays;
+        }
 
         if (status == NV_WARN_MORE_PROCESSING_REQUIRED)
             continue;
         else if (status != NV_OK)
             break;
 
-        status = service_fault_batch(parent_gpu, FAULT_SERVICE_MODE_REGULAR, batch_context);
+        service_start = NV_GETTIME();
+
+        status = service_fault_batch_parallel(parent_gpu, batch_context);
+
+        start = record_latency_since(parent_gpu, UVM_FAULT_LATENCY_STAGE_SERVICE, service_start);
+        replayable_faults->stats.service_time_ns += start - service_start;
+        replayable_faults->last_batch_throttled = batch_context->has_throttled_faults;
 
         // We may have issued replays even if status != NV_OK if
         // UVM_PERF_FAULT_REPLAY_POLICY_BLOCK is being used or the fault buffer
@@ -2983,13 +3772,17 @@ void uvm_parent_gpu_service_replayable_faults(uvm_parent_gpu_t *parent_gpu)
             break;
         }
 
-        if (replayable_faults->replay_policy == UVM_PERF_FAULT_REPLAY_POLICY_BATCH) {
+        if (batch_context->replay_policy == UVM_PERF_FAULT_REPLAY_POLICY_BATCH) {
+            start = NV_GETTIME();
             status = push_replay_on_parent_gpu(parent_gpu, UVM_FAULT_REPLAY_TYPE_START, batch_context);
             if (status != NV_OK)
                 break;
             ++num_replays;
+
+            record_latency_since(parent_gpu, UVM_FAULT_LATENCY_STAGE_REPLAY, start);
+            record_end_to_end_latency(parent_gpu, batch_context);
         }
-        else if (replayable_faults->replay_policy == UVM_PERF_FAULT_REPLAY_POLICY_BATCH_FLUSH) {
+        else if (batch_context->replay_policy == UVM_PERF_FAULT_REPLAY_POLICY_BATCH_FLUSH) {
             uvm_gpu_buffer_flush_mode_t flush_mode = UVM_GPU_BUFFER_FLUSH_MODE_CACHED_PUT;
 
             if (batch_context->num_duplicate_faults * 100 >
@@ -2997,15 +3790,79 @@ void uvm_parent_gpu_service_replayable_faults(uvm_parent_gpu_t *parent_gpu)
                 flush_mode = UVM_GPU_BUFFER_FLUSH_MODE_UPDATE_PUT;
             }
 
+            start = NV_GETTIME();
             status = fault_buffer_flush_locked(parent_gpu, NULL, flush_mode, UVM_FAULT_REPLAY_TYPE_START, batch_context);
             if (status != NV_OK)
                 break;
             ++num_replays;
+
+            record_latency_since(parent_gpu, UVM_FAULT_LATENCY_STAGE_REPLAY, start);
+            record_end_to_end_latency(parent_gpu, batch_context);
+
+            if (batch_context->has_throttled_faults)
+                ++num_throttled;
+
+            ++num_batches;
+
+            // Fetch and preprocess the next batch while the replay (and the
+            // work it depends on) is still in flight. The next batch is not
+            // serviced until the replay has completed.
+            if (next_batch_context &&
+                num_throttled < uvm_perf_fault_max_throttle_per_service &&
+                num_batches < uvm_perf_fault_max_batches_per_service) {
+                next_batch_context->batch_id = batch_context->batch_id;
+
+                status = fetch_and_preprocess_batch(parent_gpu, next_batch_context);
+                if (status == NV_OK)
+                    batch_fetched = true;
+                else if (status != NV_WARN_NOTHING_TO_DO && status != NV_WARN_MORE_PROCESSING_REQUIRED)
+                    break;
+
+                num_replays += next_batch_context->num_replays;
+
+                // Keep the batch ids monotonic when the fetched batch was
+                // fully handled during preprocessing
+                if (!batch_fetched)
+                    batch_context->batch_id = next_batch_context->batch_id;
+            }
+
+            start = NV_GETTIME();
             status = uvm_tracker_wait(&replayable_faults->replay_tracker);
-            if (status != NV_OK)
+            if (status != NV_OK) {
+                // The faults of the prefetched batch have already been
+                // consumed from the buffer and would never be replayed.
+                // Cancel them like the faults of a batch that failed to be
+                // serviced.
+                if (batch_fetched)
+                    cancel_fault_batch(parent_gpu, next_batch_context, uvm_tools_status_to_fatal_fault_reason(status));
                 break;
+            }
+
+            record_latency_since(parent_gpu, UVM_FAULT_LATENCY_STAGE_TRACKER_WAIT, start);
+            account_replay_policy(parent_gpu, batch_context, service_start);
+
+            if (batch_fetched) {
+                uvm_fault_service_batch_context_t *tmp = batch_context;
+
+                // Carry over any pending work of the serviced batch, since the
+                // final replay is tracked by the current batch context
+                status = uvm_tracker_add_tracker_safe(&next_batch_context->tracker, &batch_context->tracker);
+                if (status != NV_OK) {
+                    cancel_fault_batch(parent_gpu, next_batch_context, uvm_tools_status_to_fatal_fault_reason(status));
+                    break;
+                }
+
+                uvm_tracker_clear(&batch_context->tracker);
+
+                batch_context = next_batch_context;
+                next_batch_context = tmp;
+            }
+
+            continue;
         }
 
+        account_replay_policy(parent_gpu, batch_context, service_start);
+
         if (batch_context->has_throttled_faults)
             ++num_throttled;
 
@@ -3023,6 +3880,14 @@ void uvm_parent_gpu_service_replayable_faults(uvm_parent_gpu_t *parent_gpu)
 
     uvm_tracker_deinit(&batch_context->tracker);
 
+    if (next_batch_context) {
+        uvm_tracker_deinit(&next_batch_context->tracker);
+
+        // batch_service_context holds the batch id across service calls
+        replayable_faults->batch_service_context.batch_id = max(batch_context->batch_id,
+                                                                next_batch_context->batch_id);
+    }
+
     if (status != NV_OK)
         UVM_DBG_PRINT("Error servicing replayable faults on GPU: %s\n", uvm_parent_gpu_name(parent_gpu));
 }
@@ -3052,13 +3917,29 @@ void uvm_parent_gpu_disable_prefetch_faults(uvm_parent_gpu_t *parent_gpu)
 
 const char *uvm_perf_fault_replay_policy_string(uvm_perf_fault_replay_policy_t replay_policy)
 {
-    BUILD_BUG_ON(UVM_PERF_FAULT_REPLAY_POLICY_MAX != 4);
+    BUILD_BUG_ON(UVM_PERF_FAULT_REPLAY_POLICY_MAX != 5);
 
     switch (replay_policy) {
         UVM_ENUM_STRING_CASE(UVM_PERF_FAULT_REPLAY_POLICY_BLOCK);
         UVM_ENUM_STRING_CASE(UVM_PERF_FAULT_REPLAY_POLICY_BATCH);
         UVM_ENUM_STRING_CASE(UVM_PERF_FAULT_REPLAY_POLICY_BATCH_FLUSH);
         UVM_ENUM_STRING_CASE(UVM_PERF_FAULT_REPLAY_POLICY_ONCE);
+        UVM_ENUM_STRING_CASE(UVM_PERF_FAULT_REPLAY_POLICY_AUTO);
+        UVM_ENUM_STRING_DEFAULT();
+    }
+}
+
+const char *uvm_fault_latency_stage_string(uvm_fault_latency_stage_t stage)
+{
+    BUILD_BUG_ON(UVM_FAULT_LATENCY_STAGE_COUNT != 6);
+
+    switch (stage) {
+        UVM_ENUM_STRING_CASE(UVM_FAULT_LATENCY_STAGE_FETCH);
+        UVM_ENUM_STRING_CASE(UVM_FAULT_LATENCY_STAGE_PREPROCESS);
+        UVM_ENUM_STRING_CASE(UVM_FAULT_LATENCY_STAGE_SERVICE);
+        UVM_ENUM_STRING_CASE(UVM_FAULT_LATENCY_STAGE_TRACKER_WAIT);
+        UVM_ENUM_STRING_CASE(UVM_FAULT_LATENCY_STAGE_REPLAY);
+        UVM_ENUM_STRING_CASE(UVM_FAULT_LATENCY_STAGE_END_TO_END);
         UVM_ENUM_STRING_DEFAULT();
     }
 }
@@ -3116,3 +3997,582 @@ NV_STATUS uvm_test_drain_replayable_faults(UVM_TEST_DRAIN_REPLAYABLE_FAULTS_PARA
 
     return status;
 }
+
+NV_STATUS uvm_test_set_fault_service_workers(UVM_TEST_SET_FAULT_SERVICE_WORKERS_PARAMS *params, struct file *filp)
+{
+    uvm_gpu_t *gpu;
+    uvm_replayable_fault_buffer_t *replayable_faults;
+    NV_STATUS status = NV_OK;
+
+    gpu = uvm_va_space_retain_gpu_by_uuid(uvm_va_space_get(filp), &params->gpu_uuid);
+    if (!gpu)
+        return NV_ERR_INVALID_DEVICE;
+
+    if (!gpu->parent->replayable_faults_supported) {
+        status = NV_ERR_NOT_SUPPORTED;
+        goto done;
+    }
+
+    replayable_faults = &gpu->parent->fault_buffer.replayable;
+
+    if (params->num_workers == 0 || params->num_workers > replayable_faults->service_workers.max_workers) {
+        status = NV_ERR_INVALID_ARGUMENT;
+        goto done;
+    }
+
+    uvm_parent_gpu_replayable_faults_isr_lock(gpu->parent);
+    replayable_faults->service_workers.num_workers = params->num_workers;
+    uvm_parent_gpu_replayable_faults_isr_unlock(gpu->parent);
+
+done:
+    uvm_gpu_release(gpu);
+
+    return status;
+}
+
+NV_STATUS uvm_test_get_fault_service_workers(UVM_TEST_GET_FAULT_SERVICE_WORKERS_PARAMS *params, struct file *filp)
+{
+    uvm_gpu_t *gpu;
+    uvm_replayable_fault_buffer_t *replayable_faults;
+    uvm_fault_stats_t fault_stats;
+
+    gpu = uvm_va_space_retain_gpu_by_uuid(uvm_va_space_get(filp), &params->gpu_uuid);
+    if (!gpu)
+        return NV_ERR_INVALID_DEVICE;
+
+    if (!gpu->parent->replayable_faults_supported) {
+        uvm_gpu_release(gpu);
+        return NV_ERR_NOT_SUPPORTED;
+    }
+
+    replayable_faults = &gpu->parent->fault_buffer.replayable;
+
+    uvm_parent_gpu_replayable_faults_isr_lock(gpu->parent);
+    params->max_workers = replayable_faults->service_workers.max_workers;
+    params->num_workers = replayable_faults->service_workers.num_workers;
+    uvm_parent_gpu_fault_stats_read(gpu->parent, &fault_stats);
+    params->num_replayable_faults = fault_stats.num_replayable_faults;
+    params->num_parallel_batches = replayable_faults->stats.num_parallel_batches;
+    params->service_time_ns = replayable_faults->stats.service_time_ns;
+    uvm_parent_gpu_replayable_faults_isr_unlock(gpu->parent);
+
+    uvm_gpu_release(gpu);
+
+    return NV_OK;
+}
+
+#define FAULT_BATCH_SORT_PERF_MAX_FAULTS (1 << 20)
+
+NV_STATUS uvm_test_fault_batch_sort_perf(UVM_TEST_FAULT_BATCH_SORT_PERF_PARAMS *params, struct file *filp)
+{
+    NV_STATUS status = NV_OK;
+    uvm_fault_service_batch_context_t *batch_context = NULL;
+    uvm_fault_buffer_entry_t *fault_cache = NULL;
+    uvm_fault_buffer_entry_t **initial_order = NULL;
+    NvU8 *va_spaces = NULL;
+    uvm_test_rng_t rng;
+    NvU32 iter;
+    NvU32 i;
+
+    if (params->num_faults == 0 ||
+        params->num_faults > FAULT_BATCH_SORT_PERF_MAX_FAULTS ||
+        params->num_instance_ptrs == 0 ||
+        params->num_va_spaces == 0 ||
+        params->num_va_spaces > params->num_instance_ptrs) {
+        return NV_ERR_INVALID_ARGUMENT;
+    }
+
+    params->radix_sort_ns = 0;
+    params->generic_sort_ns = 0;
+
+    batch_context = uvm_kvmalloc_zero(sizeof(*batch_context));
+    fault_cache = uvm_kvmalloc_zero(params->num_faults * sizeof(*fault_cache));
+    initial_order = uvm_kvmalloc(params->num_faults * sizeof(*initial_order));
+
+    // Opaque VA space handles. The sorts only compare the pointers, so they
+    // are never dereferenced.
+    va_spaces = uvm_kvmalloc(params->num_va_spaces);
+
+    if (!batch_context || !fault_cache || !initial_order || !va_spaces) {
+        status = NV_ERR_NO_MEMORY;
+        goto done;
+    }
+
+    batch_context->ordered_fault_cache = uvm_kvmalloc(params->num_faults * sizeof(*batch_context->ordered_fault_cache));
+    if (!batch_context->ordered_fault_cache) {
+        status = NV_ERR_NO_MEMORY;
+        goto done;
+    }
+
+    status = fault_sort_scratch_alloc(batch_context, params->num_faults);
+    if (status != NV_OK)
+        goto done;
+
+    uvm_test_rng_init(&rng, params->seed);
+
+    // Faults from each channel are clustered in a 256MB window of its VA space,
+    // like the faults of a kernel sweeping over its working set.
+    for (i = 0; i < params->num_faults; ++i) {
+        uvm_fault_buffer_entry_t *entry = &fault_cache[i];
+        NvU32 channel = uvm_test_rng_range_32(&rng, 0, params->num_instance_ptrs - 1);
+
+        entry->instance_ptr.aperture = UVM_APERTURE_VID;
+        entry->instance_ptr.address = (NvU64)(channel + 1) * UVM_PAGE_SIZE_4K;
+        entry->fault_source.ve_id = channel % 64;
+        entry->va_space = (uvm_va_space_t *)&va_spaces[channel % params->num_va_spaces];
+        entry->gpu = NULL;
+        entry->fault_address = (1ULL << 40) +
+                               (NvU64)channel * (1ULL << 30) +
+                               uvm_test_rng_range_64(&rng, 0, (1ULL << 16) - 1) * UVM_PAGE_SIZE_4K;
+        entry->fault_access_type = uvm_test_rng_range_32(&rng, 0, UVM_FAULT_ACCESS_TYPE_COUNT - 1);
+
+        initial_order[i] = entry;
+    }
+
+    batch_context->num_coalesced_faults = params->num_faults;
+
+    for (iter = 0; iter < params->iterations; ++iter) {
+        NvU64 start;
+
+        memcpy(batch_context->ordered_fault_cache,
+               initial_order,
+               params->num_faults * sizeof(*initial_order));
+
+        start = NV_GETTIME();
+        sort_fault_entries_by_instance_ptr(batch_context, true);
+        sort_fault_entries_by_va_space_gpu_address_access_type(batch_context, true);
+        params->radix_sort_ns += NV_GETTIME() - start;
+
+        for (i = 1; i < params->num_faults; ++i) {
+            TEST_CHECK_GOTO(cmp_sort_fault_entry_by_va_space_gpu_address_access_type(
+                                &batch_context->ordered_fault_cache[i - 1],
+                                &batch_context->ordered_fault_cache[i]) <= 0,
+                            done);
+        }
+
+        memcpy(batch_context->ordered_fault_cache,
+               initial_order,
+               params->num_faults * sizeof(*initial_order));
+
+        start = NV_GETTIME();
+        sort_fault_entries_by_instance_ptr(batch_context, false);
+        sort_fault_entries_by_va_space_gpu_address_access_type(batch_context, false);
+        params->generic_sort_ns += NV_GETTIME() - start;
+
+        if (fatal_signal_pending(current)) {
+            status = NV_ERR_SIGNAL_PENDING;
+            goto done;
+        }
+    }
+
+done:
+    if (batch_context) {
+        fault_sort_scratch_free(batch_context);
+        uvm_kvfree(batch_context->ordered_fault_cache);
+    }
+
+    uvm_kvfree(va_spaces);
+    uvm_kvfree(initial_order);
+    uvm_kvfree(fault_cache);
+    uvm_kvfree(batch_context);
+
+    return status;
+}
+
+NV_STATUS uvm_test_set_fault_replay_policy(UVM_TEST_SET_FAULT_REPLAY_POLICY_PARAMS *params, struct file *filp)
+{
+    uvm_gpu_t *gpu;
+    NV_STATUS status = NV_OK;
+
+    if (params->policy >= UVM_PERF_FAULT_REPLAY_POLICY_MAX)
+        return NV_ERR_INVALID_ARGUMENT;
+
+    gpu = uvm_va_space_retain_gpu_by_uuid(uvm_va_space_get(filp), &params->gpu_uuid);
+    if (!gpu)
+        return NV_ERR_INVALID_DEVICE;
+
+    if (!gpu->parent->replayable_faults_supported) {
+        status = NV_ERR_NOT_SUPPORTED;
+        goto done;
+    }
+
+    uvm_parent_gpu_replayable_faults_isr_lock(gpu->parent);
+    gpu->parent->fault_buffer.replayable.replay_policy = params->policy;
+    gpu->parent->fault_buffer.replayable.last_batch_throttled = false;
+    uvm_parent_gpu_replayable_faults_isr_unlock(gpu->parent);
+
+done:
+    uvm_gpu_release(gpu);
+
+    return status;
+}
+
+NV_STATUS uvm_test_get_fault_replay_policy_stats(UVM_TEST_GET_FAULT_REPLAY_POLICY_STATS_PARAMS *params,
+                                                 struct file *filp)
+{
+    uvm_gpu_t *gpu;
+    uvm_replayable_fault_buffer_t *replayable_faults;
+    NvU32 i;
+
+    BUILD_BUG_ON(UVM_TEST_FAULT_REPLAY_POLICY_COUNT != UVM_PERF_FAULT_REPLAY_POLICY_AUTO);
+
+    gpu = uvm_va_space_retain_gpu_by_uuid(uvm_va_space_get(filp), &params->gpu_uuid);
+    if (!gpu)
+        return NV_ERR_INVALID_DEVICE;
+
+    if (!gpu->parent->replayable_faults_supported) {
+        uvm_gpu_release(gpu);
+        return NV_ERR_NOT_SUPPORTED;
+    }
+
+    replayable_faults = &gpu->parent->fault_buffer.replayable;
+
+    uvm_parent_gpu_replayable_faults_isr_lock(gpu->parent);
+
+    params->policy = replayable_faults->replay_policy;
+    for (i = 0; i < UVM_TEST_FAULT_REPLAY_POLICY_COUNT; i++) {
+        params->num_batches[i] = replayable_faults->stats.replay_policy[i].num_batches;
+        params->num_replays[i] = replayable_faults->stats.replay_policy[i].num_replays;
+        params->time_ns[i] = replayable_faults->stats.replay_policy[i].time_ns;
+    }
+
+    if (params->reset)
+        memset(replayable_faults->stats.replay_policy, 0, sizeof(replayable_faults->stats.replay_policy));
+
+    uvm_parent_gpu_replayable_faults_isr_unlock(gpu->parent);
+
+    uvm_gpu_release(gpu);
+
+    return NV_OK;
+}
+
+#define FAULT_TRACE_REPLAY_MAX_BATCH_SIZE 4096
+#define FAULT_TRACE_REPLAY_MAX_UTLBS 256
+
+static NV_STATUS fault_trace_entry_init(uvm_fault_buffer_entry_t *entry, const UvmEventTestFaultBufferEntryInfo *info)
+{
+    if ((info->instancePtrAperture != UVM_APERTURE_VID && info->instancePtrAperture != UVM_APERTURE_SYS) ||
+        info->accessType >= UVM_FAULT_ACCESS_TYPE_COUNT ||
+        info->faultType >= UVM_FAULT_TYPE_COUNT ||
+        info->clientType >= UVM_FAULT_CLIENT_TYPE_COUNT ||
+        info->utlbId >= FAULT_TRACE_REPLAY_MAX_UTLBS) {
+        return NV_ERR_INVALID_ARGUMENT;
+    }
+
+    memset(entry, 0, sizeof(*entry));
+
+    entry->fault_address                = info->address;
+    entry->timestamp                    = info->timeStampGpu;
+    entry->instance_ptr.address         = info->instancePtr;
+    entry->instance_ptr.aperture        = info->instancePtrAperture;
+    entry->fault_type                   = info->faultType;
+    entry->fault_access_type            = info->accessType;
+    entry->fault_source.client_type     = info->clientType;
+    entry->fault_source.client_id       = info->clientId;
+    entry->fault_source.mmu_engine_id   = info->mmuEngineId;
+    entry->fault_source.utlb_id         = info->utlbId;
+    entry->fault_source.gpc_id          = info->gpcId;
+    entry->fault_source.ve_id           = info->veId;
+    entry->is_replayable                = true;
+    entry->is_virtual                   = true;
+
+    return NV_OK;
+}
+
+// Coalesce and preprocess a batch of trace entries already stored in
+// batch_context->fault_cache, like fetch_fault_buffer_entries() and
+// preprocess_fault_batch() do for the entries in the fault buffer.
+static void fault_trace_replay_batch(uvm_fault_service_batch_context_t *batch_context,
+                                     NvU8 *va_spaces,
+                                     UVM_TEST_FAULT_TRACE_REPLAY_PARAMS *params)
+{
+    uvm_fault_buffer_entry_t *previous_entry = NULL;
+    NvU32 num_va_spaces = 0;
+    NvU32 i, j;
+
+    for (i = 0; i <= batch_context->max_utlb_id; ++i) {
+        batch_context->utlbs[i].num_pending_faults = 0;
+        batch_context->utlbs[i].has_fatal_faults = false;
+    }
+
+    batch_context->max_utlb_id = 0;
+    batch_context->is_single_instance_ptr = true;
+    batch_context->last_fault = NULL;
+    batch_context->num_coalesced_faults = 0;
+
+    for (i = 0; i < batch_context->num_cached_faults; ++i) {
+        if (!fetch_fault_buffer_cache_entry(batch_context, &batch_context->fault_cache[i], i, params->coalesce))
+            ++batch_context->num_coalesced_faults;
+    }
+
+    for (i = 0, j = 0; i < batch_context->num_cached_faults; ++i) {
+        if (!batch_context->fault_cache[i].filtered)
+            batch_context->ordered_fault_cache[j++] = &batch_context->fault_cache[i];
+    }
+
+    if (!batch_context->is_single_instance_ptr)
+        sort_fault_entries_by_instance_ptr(batch_context, params->radix_sort);
+
+    // There are no channels to translate the instance pointers, so each
+    // distinct instance pointer gets its own opaque VA space handle.
+    for (i = 0; i < batch_context->num_coalesced_faults; ++i) {
+        uvm_fault_buffer_entry_t *current_entry = batch_context->ordered_fault_cache[i];
+
+        if (i == 0 || cmp_fault_instance_ptr(current_entry, batch_context->ordered_fault_cache[i - 1]) != 0)
+            ++num_va_spaces;
+
+        current_entry->va_space = (uvm_va_space_t *)&va_spaces[num_va_spaces - 1];
+    }
+
+    sort_fault_entries_by_va_space_gpu_address_access_type(batch_context, params->radix_sort);
+
+    // Account duplicates like update_batch_and_notify_fault()
+    for (i = 0; i < batch_context->num_coalesced_faults; ++i) {
+        uvm_fault_buffer_entry_t *current_entry = batch_context->ordered_fault_cache[i];
+
+        if (check_fault_entry_duplicate(current_entry, previous_entry))
+            params->num_duplicate_faults += current_entry->num_instances;
+        else
+            params->num_duplicate_faults += current_entry->num_instances - 1;
+
+        previous_entry = current_entry;
+    }
+
+    params->num_coalesced_faults += batch_context->num_coalesced_faults;
+}
+
+NV_STATUS uvm_test_fault_trace_replay(UVM_TEST_FAULT_TRACE_REPLAY_PARAMS *params, struct file *filp)
+{
+    NV_STATUS status = NV_OK;
+    uvm_fault_service_batch_context_t *batch_context = NULL;
+    UvmEventTestFaultBufferEntryInfo *infos = NULL;
+    NvU8 *va_spaces = NULL;
+    NvU32 num_replayed = 0;
+    NvU32 i;
+
+    if (params->batch_size == 0 || params->batch_size > FAULT_TRACE_REPLAY_MAX_BATCH_SIZE || params->num_entries == 0)
+        return NV_ERR_INVALID_ARGUMENT;
+
+    params->num_batches = 0;
+    params->num_coalesced_faults = 0;
+    params->num_duplicate_faults = 0;
+    params->preprocess_ns = 0;
+
+    batch_context = uvm_kvmalloc_zero(sizeof(*batch_context));
+    infos = uvm_kvmalloc(params->batch_size * sizeof(*infos));
+
+    // Opaque VA space handles. They are only compared, never dereferenced.
+    va_spaces = uvm_kvmalloc(params->batch_size);
+
+    if (!batch_context || !infos || !va_spaces) {
+        status = NV_ERR_NO_MEMORY;
+        goto done;
+    }
+
+    batch_context->fault_cache = uvm_kvmalloc_zero(params->batch_size * sizeof(*batch_context->fault_cache));
+    batch_context->ordered_fault_cache = uvm_kvmalloc(params->batch_size *
+                                                      sizeof(*batch_context->ordered_fault_cache));
+    batch_context->utlbs = uvm_kvmalloc_zero(FAULT_TRACE_REPLAY_MAX_UTLBS * sizeof(*batch_context->utlbs));
+    if (!batch_context->fault_cache || !batch_context->ordered_fault_cache || !batch_context->utlbs) {
+        status = NV_ERR_NO_MEMORY;
+        goto done;
+    }
+
+    status = fault_sort_scratch_alloc(batch_context, params->batch_size);
+    if (status != NV_OK)
+        goto done;
+
+    while (num_replayed < params->num_entries) {
+        NvU32 batch_size = min(params->batch_size, params->num_entries - num_replayed);
+        void __user *user_entries = (void __user *)(uintptr_t)(params->trace + (NvU64)num_replayed * sizeof(*infos));
+        NvU64 start;
+
+        if (copy_from_user(infos, user_entries, batch_size * sizeof(*infos))) {
+            status = NV_ERR_INVALID_ADDRESS;
+            goto done;
+        }
+
+        for (i = 0; i < batch_size; ++i) {
+            status = fault_trace_entry_init(&batch_context->fault_cache[i], &infos[i]);
+            if (status != NV_OK)
+                goto done;
+        }
+
+        batch_context->num_cached_faults = batch_size;
+
+        start = NV_GETTIME();
+        fault_trace_replay_batch(batch_context, va_spaces, params);
+        params->preprocess_ns += NV_GETTIME() - start;
+
+        ++params->num_batches;
+        num_replayed += batch_size;
+
+        if (fatal_signal_pending(current)) {
+            status = NV_ERR_SIGNAL_PENDING;
+            goto done;
+        }
+    }
+
+done:
+    if (batch_context) {
+        fault_sort_scratch_free(batch_context);
+        uvm_kvfree(batch_context->utlbs);
+        uvm_kvfree(batch_context->ordered_fault_cache);
+        uvm_kvfree(batch_context->fault_cache);
+    }
+
+    uvm_kvfree(va_spaces);
+    uvm_kvfree(infos);
+    uvm_kvfree(batch_context);
+
+    return status;
+}
+
+typedef enum
+{
+    REPLAY_BENCHMARK_BATCH_SINGLE_UTLB = 0,
+    REPLAY_BENCHMARK_BATCH_MULTI_UTLB,
+    REPLAY_BENCHMARK_BATCH_DUPLICATES,
+    REPLAY_BENCHMARK_BATCH_THROTTLED,
+    REPLAY_BENCHMARK_BATCH_COUNT
+} replay_benchmark_batch_kind_t;
+
+// Run the synthetic trace described in UVM_TEST_FAULT_REPLAY_POLICY_BENCHMARK
+// with the given policy. batch_context only provides the fields read by
+// select_auto_replay_policy().
+static void replay_benchmark_run(UVM_TEST_FAULT_REPLAY_POLICY_BENCHMARK_PARAMS *params,
+                                 uvm_fault_service_batch_context_t *batch_context,
+                                 uvm_perf_fault_replay_policy_t policy)
+{
+    NvU32 num_blocks = (params->batch_size + params->faults_per_block - 1) / params->faults_per_block;
+    NvU32 batches_per_service = max(uvm_perf_fault_max_batches_per_service, 1u);
+    NvU64 now = 0;
+    NvU64 num_replays = 0;
+    NvU64 fault_latency = 0;
+    NvU64 num_pending_faults = 0;
+    NvU64 pending_fetch_time = 0;
+    NvU32 num_carried = 0;
+    bool last_batch_throttled = false;
+    NvU32 i, j;
+
+    for (i = 0; i < params->num_batches; ++i) {
+        replay_benchmark_batch_kind_t kind = (i / params->run_length) % REPLAY_BENCHMARK_BATCH_COUNT;
+        NvU32 num_utlbs = kind == REPLAY_BENCHMARK_BATCH_SINGLE_UTLB ? 1 : params->num_utlbs;
+        NvU32 num_duplicates = 0;
+        NvU64 replay_cost = (NvU64)params->replay_ns * num_utlbs;
+        uvm_perf_fault_replay_policy_t batch_policy = policy;
+        NvU64 fetch_time;
+
+        if (kind == REPLAY_BENCHMARK_BATCH_DUPLICATES || kind == REPLAY_BENCHMARK_BATCH_THROTTLED)
+            num_duplicates = params->batch_size * params->duplicate_percent / 100;
+
+        if (policy == UVM_PERF_FAULT_REPLAY_POLICY_AUTO) {
+            for (j = 0; j < FAULT_TRACE_REPLAY_MAX_UTLBS; ++j)
+                batch_context->utlbs[j].num_pending_faults = j < num_utlbs ? 1 : 0;
+
+            batch_context->max_utlb_id = num_utlbs - 1;
+            batch_context->num_cached_faults = params->batch_size + num_carried;
+            batch_context->num_duplicate_faults = num_duplicates + num_carried;
+
+            batch_policy = select_auto_replay_policy(last_batch_throttled,
+                                                     uvm_perf_fault_replay_update_put_ratio,
+                                                     batch_context);
+            ++params->auto_num_batches[batch_policy];
+        }
+
+        now += (NvU64)(params->batch_size + num_carried) * params->fault_ns;
+        fetch_time = now;
+
+        if (batch_policy == UVM_PERF_FAULT_REPLAY_POLICY_BLOCK) {
+            for (j = 0; j < num_blocks; ++j) {
+                NvU32 num_faults = min(params->faults_per_block, params->batch_size - j * params->faults_per_block);
+
+                now += params->block_service_ns + replay_cost;
+                fault_latency += (now - fetch_time) * num_faults;
+                ++num_replays;
+            }
+        }
+        else {
+            now += (NvU64)num_blocks * params->block_service_ns;
+            if (batch_policy == UVM_PERF_FAULT_REPLAY_POLICY_BATCH_FLUSH)
+                now += params->flush_ns;
+
+            num_pending_faults += params->batch_size;
+            pending_fetch_time += fetch_time * params->batch_size;
+
+            if (batch_policy != UVM_PERF_FAULT_REPLAY_POLICY_ONCE ||
+                (i + 1) % batches_per_service == 0 ||
+                i + 1 == params->num_batches) {
+                now += replay_cost;
+                fault_latency += now * num_pending_faults - pending_fetch_time;
+                ++num_replays;
+
+                num_pending_faults = 0;
+                pending_fetch_time = 0;
+            }
+        }
+
+        // Duplicates show up again in the next batch unless they were flushed.
+        // Flushing right after a throttled batch doesn't help since the
+        // thrashing pages fault again anyway.
+        if (batch_policy == UVM_PERF_FAULT_REPLAY_POLICY_BATCH_FLUSH && !last_batch_throttled)
+            num_carried = 0;
+        else
+            num_carried = num_duplicates;
+
+        last_batch_throttled = kind == REPLAY_BENCHMARK_BATCH_THROTTLED;
+    }
+
+    params->num_replays[policy] = num_replays;
+    params->time_ns[policy] = now;
+    params->fault_latency_ns[policy] = fault_latency;
+}
+
+NV_STATUS uvm_test_fault_replay_policy_benchmark(UVM_TEST_FAULT_REPLAY_POLICY_BENCHMARK_PARAMS *params,
+                                                 struct file *filp)
+{
+    NV_STATUS status = NV_OK;
+    uvm_fault_service_batch_context_t *batch_context;
+    uvm_perf_fault_replay_policy_t policy;
+
+    BUILD_BUG_ON(UVM_TEST_FAULT_REPLAY_POLICY_COUNT + 1 != UVM_PERF_FAULT_REPLAY_POLICY_MAX);
+
+    if (params->num_batches == 0 ||
+        params->batch_size == 0 ||
+        params->batch_size > FAULT_TRACE_REPLAY_MAX_BATCH_SIZE ||
+        params->faults_per_block == 0 ||
+        params->num_utlbs == 0 ||
+        params->num_utlbs > FAULT_TRACE_REPLAY_MAX_UTLBS ||
+        params->duplicate_percent > 100 ||
+        params->run_length == 0) {
+        return NV_ERR_INVALID_ARGUMENT;
+    }
+
+    batch_context = uvm_kvmalloc_zero(sizeof(*batch_context));
+    if (!batch_context)
+        return NV_ERR_NO_MEMORY;
+
+    batch_context->utlbs = uvm_kvmalloc_zero(FAULT_TRACE_REPLAY_MAX_UTLBS * sizeof(*batch_context->utlbs));
+    if (!batch_context->utlbs) {
+        status = NV_ERR_NO_MEMORY;
+        goto done;
+    }
+
+    memset(params->auto_num_batches, 0, sizeof(params->auto_num_batches));
+    params->num_faults = (NvU64)params->num_batches * params->batch_size;
+
+    for (policy = 0; policy < UVM_PERF_FAULT_REPLAY_POLICY_MAX; ++policy)
+        replay_benchmark_run(params, batch_context, policy);
+
+    if (params->num_batches > params->run_length * REPLAY_BENCHMARK_BATCH_COUNT && params->num_utlbs > 1) {
+        TEST_CHECK_GOTO(params->auto_num_batches[UVM_PERF_FAULT_REPLAY_POLICY_BLOCK] > 0, done);
+        TEST_CHECK_GOTO(params->auto_num_batches[UVM_PERF_FAULT_REPLAY_POLICY_BATCH] > 0, done);
+        TEST_CHECK_GOTO(params->auto_num_batches[UVM_PERF_FAULT_REPLAY_POLICY_BATCH_FLUSH] > 0, done);
+    }
+
+done:
+    uvm_kvfree(batch_context->utlbs);
+    uvm_kvfree(batch_context);
+
+    return status;
+}
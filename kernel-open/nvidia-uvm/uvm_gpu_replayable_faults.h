@@ -45,6 +45,11 @@ typedef enum
     // Issue a fault replay after all faults in the buffer have been serviced
     UVM_PERF_FAULT_REPLAY_POLICY_ONCE,
 
+    // Select one of BLOCK, BATCH or BATCH_FLUSH for each batch, based on the
+    // duplicate ratio, the presence of throttled faults and the number of
+    // uTLBs with pending faults in the batch.
+    UVM_PERF_FAULT_REPLAY_POLICY_AUTO,
+
     // TODO: Bug 1768226: Implement uTLB-aware fault replay policy
 
     UVM_PERF_FAULT_REPLAY_POLICY_MAX,
@@ -52,6 +57,40 @@ typedef enum
 
 const char *uvm_perf_fault_replay_policy_string(uvm_perf_fault_replay_policy_t fault_replay);
 
+// Stages of replayable fault servicing tracked by the per-GPU latency
+// histograms. All stages except END_TO_END are measured per fault batch with
+// the CPU clock.
+typedef enum
+{
+    // Reading and parsing the fault buffer entries of a batch
+    UVM_FAULT_LATENCY_STAGE_FETCH = 0,
+
+    // Sorting, coalescing and instance pointer translation of a batch
+    UVM_FAULT_LATENCY_STAGE_PREPROCESS,
+
+    // Servicing all the faults in a batch
+    UVM_FAULT_LATENCY_STAGE_SERVICE,
+
+    // Waiting for the replay of the previous batch to complete
+    UVM_FAULT_LATENCY_STAGE_TRACKER_WAIT,
+
+    // Pushing the replay, including the fault buffer flush if any
+    UVM_FAULT_LATENCY_STAGE_REPLAY,
+
+    // From the GPU timestamp of the oldest fault in a batch to the replay of
+    // the batch, measured with the GPU clock
+    UVM_FAULT_LATENCY_STAGE_END_TO_END,
+
+    UVM_FAULT_LATENCY_STAGE_COUNT,
+} uvm_fault_latency_stage_t;
+
+// Number of log2 buckets in each latency histogram. Bucket 0 counts latencies
+// of 0ns, bucket i counts latencies in [2^(i-1), 2^i) ns and the last bucket
+// also counts everything above it.
+#define UVM_FAULT_LATENCY_HISTOGRAM_BUCKETS 40
+
+const char *uvm_fault_latency_stage_string(uvm_fault_latency_stage_t stage);
+
 NV_STATUS uvm_parent_gpu_fault_buffer_init(uvm_parent_gpu_t *parent_gpu);
 void uvm_parent_gpu_fault_buffer_deinit(uvm_parent_gpu_t *parent_gpu);
 
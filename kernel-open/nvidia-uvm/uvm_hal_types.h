@@ -553,6 +553,11 @@ struct uvm_access_counter_buffer_entry_struct
     // This is the GPU that triggered the notification.
     uvm_gpu_t *gpu;
 
+    // Set when ranking the batch, if the region of the notification is not
+    // among the hottest ones to be serviced. See rank_notifications() in
+    // uvm_gpu_access_counters.c.
+    bool deferred;
+
     // Number of times the tracked region was accessed since the last time it
     // was cleared. Counter values saturate at the maximum value supported by
     // the GPU (2^16 - 1 on Turing)
@@ -48,6 +48,14 @@ MODULE_PARM_DESC(uvm_disable_hmm,
 
 module_param(uvm_disable_hmm, bool, 0444);
 
+static bool uvm_hmm_invalidate_batch = true;
+module_param(uvm_hmm_invalidate_batch, bool, S_IRUGO|S_IWUSR);
+MODULE_PARM_DESC(uvm_hmm_invalidate_batch,
+                 "Handle all HMM va_blocks covered by a single mmu_notifier "
+                 "invalidation together so the GPU unmaps of the blocks "
+                 "overlap and only one tracker wait is paid per block. "
+                 "Default: true.");
+
 #if UVM_IS_CONFIG_HMM()
 
 #include <linux/hmm.h>
@@ -73,6 +81,7 @@ module_param(uvm_disable_hmm, bool, 0444);
 #include "uvm_api.h"
 #include "uvm_va_policy.h"
 #include "uvm_tools.h"
+#include "uvm_test.h"
 
 // The function nv_PageSwapCache() wraps the check for page swap cache flag in
 // order to support a wide variety of kernel versions.
@@ -412,51 +421,18 @@ void uvm_hmm_remove_gpu_va_space(uvm_va_space_t *va_space,
     }
 }
 
-static bool hmm_invalidate(uvm_va_block_t *va_block,
-                           const struct mmu_notifier_range *range,
-                           unsigned long cur_seq)
+// Maximum number of va_blocks handled by a single batched invalidation. The
+// blocks are handled sequentially by the notifier callback of the first
+// block, this only bounds the on-stack array of retained blocks.
+#define UVM_HMM_INVALIDATE_BATCH_MAX_BLOCKS 16
+
+// Clamp the invalidation range to the va_block. Returns false if they don't
+// overlap.
+static bool hmm_invalidate_region(uvm_va_block_t *va_block,
+                                  const struct mmu_notifier_range *range,
+                                  uvm_va_block_region_t *region)
 {
-    uvm_thread_context_t *uvm_context = uvm_thread_context();
-    struct mmu_interval_notifier *mni = &va_block->hmm.notifier;
-    struct mm_struct *mm = mni->mm;
-    uvm_va_block_context_t *va_block_context;
-    uvm_va_block_region_t region;
     NvU64 start, end;
-    uvm_processor_id_t id;
-    NV_STATUS status = NV_OK;
-
-    // The MMU_NOTIFY_RELEASE event isn't really needed since mn_itree_release()
-    // doesn't remove the interval notifiers from the struct_mm so there will
-    // be a full range MMU_NOTIFY_UNMAP event after the release from
-    // unmap_vmas() during exit_mmap().
-    if (range->event == MMU_NOTIFY_SOFT_DIRTY || range->event == MMU_NOTIFY_RELEASE)
-        return true;
-
-    // Blockable is only set false by
-    // mmu_notifier_invalidate_range_start_nonblock() which is only called in
-    // __oom_reap_task_mm().
-    if (!mmu_notifier_range_blockable(range))
-        return false;
-
-    // We only ignore invalidations in this context whilst holding the
-    // va_block lock. This prevents deadlock when try_to_migrate()
-    // calls the notifier, but holding the lock prevents other threads
-    // invalidating PTEs so we can safely assume the results of
-    // migrate_vma_setup() are correct.
-    if (uvm_context->ignore_hmm_invalidate_va_block == va_block ||
-        ((range->event == MMU_NOTIFY_MIGRATE || range->event == MMU_NOTIFY_EXCLUSIVE) &&
-         range->owner == &g_uvm_global))
-        return true;
-
-    va_block_context = uvm_va_block_context_alloc(mm);
-    if (!va_block_context)
-        return true;
-
-    uvm_mutex_lock(&va_block->lock);
-
-    // mmu_interval_notifier_remove() is always called before marking a
-    // va_block as dead so this va_block has to be alive.
-    UVM_ASSERT(!uvm_va_block_is_dead(va_block));
 
     // Note: unmap_vmas() does MMU_NOTIFY_UNMAP [0, 0xffffffffffffffff]
     // Also note that hmm_invalidate() can be called when a new va_block is not
@@ -471,16 +447,34 @@ static bool hmm_invalidate(uvm_va_block_t *va_block,
     if (end > va_block->end)
         end = va_block->end;
     if (start > end)
-        goto unlock;
+        return false;
+
+    *region = uvm_va_block_region_from_start_end(va_block, start, end);
+
+    return true;
+}
+
+// Start invalidating the given region of the va_block: bump the sequence
+// numbers and push the GPU unmaps. The caller must wait for the va_block
+// tracker and then call hmm_invalidate_end_locked().
+static NV_STATUS hmm_invalidate_begin_locked(uvm_va_block_t *va_block,
+                                             uvm_va_block_context_t *va_block_context,
+                                             const struct mmu_notifier_range *range,
+                                             unsigned long cur_seq,
+                                             uvm_va_block_region_t region)
+{
+    uvm_thread_context_t *uvm_context = uvm_thread_context();
+    uvm_processor_id_t id;
+    NV_STATUS status = NV_OK;
+
+    uvm_assert_mutex_locked(&va_block->lock);
 
     // These will be equal if no other thread causes an invalidation
     // whilst the va_block lock was dropped.
     uvm_context->hmm_invalidate_seqnum++;
     va_block->hmm.changed++;
 
-    mmu_interval_set_seq(mni, cur_seq);
-
-    region = uvm_va_block_region_from_start_end(va_block, start, end);
+    mmu_interval_set_seq(&va_block->hmm.notifier, cur_seq);
 
     va_block_context->hmm.vma = NULL;
 
@@ -501,13 +495,233 @@ static bool hmm_invalidate(uvm_va_block_t *va_block,
     if (range->event == MMU_NOTIFY_UNMAP || range->event == MMU_NOTIFY_CLEAR)
         uvm_va_block_munmap_region(va_block, region);
 
+    return status;
+}
+
+static NV_STATUS hmm_invalidate_end_locked(uvm_va_block_t *va_block,
+                                           uvm_va_block_region_t region,
+                                           NV_STATUS status)
+{
+    uvm_assert_mutex_locked(&va_block->lock);
+
     if (status == NV_OK)
         status = uvm_tracker_wait(&va_block->tracker);
 
     // Remove stale HMM struct page pointers to system memory.
     uvm_va_block_remove_cpu_chunks(va_block, region);
 
-unlock:
+    return status;
+}
+
+// Linux calls the interval notifiers of all va_blocks overlapping an
+// invalidation one after the other, in address order, with the same cur_seq.
+// Handling each va_block in isolation serializes a GPU unmap and a tracker
+// wait per 2MB block, which dominates munmap() and mprotect() of large HMM
+// ranges. Instead, the first notifier callback of an invalidation collects
+// the following va_blocks covered by the range, pushes the GPU unmaps for all
+// of them and only then waits for each block's tracker. The va_blocks handled
+// this way are marked so their own notifier callbacks, which follow in the
+// same invalidation, return immediately. Each notifier callback runs in its
+// own thread context so the mark is kept in the va_block itself, keyed by the
+// invalidation range and sequence number.
+//
+// Unmapping the following va_blocks before their own notifier callbacks run
+// is safe because:
+// - mmu_notifier_invalidate_range_start() marks the whole interval tree as
+//   being invalidated before calling any notifier, so mmu_interval_read_begin()
+//   on any of the collected va_blocks already waits for the end of this
+//   invalidation and no new GPU mapping can be established from a HMM range
+//   snapshot taken after the first callback.
+// - hmm_invalidate_begin_locked() calls mmu_interval_set_seq() on each
+//   va_block under its lock before unmapping it, so a fault which sampled the
+//   sequence number earlier fails mmu_interval_read_retry() and retries rather
+//   than mapping stale pages after the unmap.
+// - The collected va_blocks are retained and each one is locked individually,
+//   so they can't be freed or split under the batch. A va_block which dies in
+//   the meantime is skipped.
+// - The skipped notifier callback of each va_block still sets its own
+//   sequence number and bumps hmm.changed, so the va_block observes every
+//   invalidation exactly as if it had handled it itself.
+//
+// Returns true if the va_block invalidation was handled, false if the caller
+// has to invalidate the va_block itself.
+static bool hmm_invalidate_batch(uvm_va_block_t *va_block,
+                                 const struct mmu_notifier_range *range,
+                                 unsigned long cur_seq)
+{
+    uvm_thread_context_t *uvm_context = uvm_thread_context();
+    uvm_va_block_t *blocks[UVM_HMM_INVALIDATE_BATCH_MAX_BLOCKS];
+    NV_STATUS block_status[UVM_HMM_INVALIDATE_BATCH_MAX_BLOCKS];
+    uvm_va_block_context_t *va_block_context;
+    uvm_range_tree_node_t *node;
+    uvm_va_space_t *va_space;
+    NvU64 range_end;
+    size_t num_blocks = 0;
+    NV_STATUS status = NV_OK;
+    size_t i;
+
+    if (!uvm_hmm_invalidate_batch)
+        return false;
+
+    va_space = va_block->hmm.va_space;
+    UVM_ASSERT(va_space);
+
+    if (READ_ONCE(va_space->test.hmm_invalidate_batch_disabled))
+        return false;
+
+    // Taking other va_block locks while this thread holds one isn't allowed.
+    if (uvm_context->ignore_hmm_invalidate_va_block)
+        return false;
+
+    uvm_mutex_lock(&va_block->lock);
+
+    // mmu_interval_notifier_remove() is always called before marking a
+    // va_block as dead so this va_block has to be alive.
+    UVM_ASSERT(!uvm_va_block_is_dead(va_block));
+
+    if (va_block->hmm.invalidate_batch_range == range && va_block->hmm.invalidate_batch_seq == cur_seq) {
+        // The GPU unmap was already done by the first callback of this
+        // invalidation but the notifier sequence number has to be updated by
+        // its own callback, same as in hmm_invalidate().
+        mmu_interval_set_seq(&va_block->hmm.notifier, cur_seq);
+        va_block->hmm.changed++;
+        va_block->hmm.invalidate_batch_range = NULL;
+        uvm_mutex_unlock(&va_block->lock);
+        return true;
+    }
+
+    uvm_mutex_unlock(&va_block->lock);
+
+    range_end = (range->end == ULONG_MAX) ? range->end : range->end - 1;
+    if (range_end <= va_block->end)
+        return false;
+
+    // The blocks_lock may be held by a thread which is waiting on something
+    // this invalidation blocks, fall back to the per va_block path in that
+    // case.
+    if (!uvm_mutex_trylock(&va_space->hmm.blocks_lock))
+        return false;
+
+    blocks[num_blocks++] = va_block;
+    uvm_va_block_retain(va_block);
+
+    uvm_range_tree_for_each_in(node, &va_space->hmm.blocks, va_block->end + 1, range_end) {
+        if (num_blocks == ARRAY_SIZE(blocks))
+            break;
+
+        blocks[num_blocks] = hmm_va_block_from_node(node);
+        uvm_va_block_retain(blocks[num_blocks++]);
+    }
+
+    uvm_mutex_unlock(&va_space->hmm.blocks_lock);
+
+    va_block_context = uvm_va_block_context_alloc(va_block->hmm.notifier.mm);
+    if (!va_block_context) {
+        for (i = 0; i < num_blocks; i++)
+            uvm_va_block_release(blocks[i]);
+
+        // The per va_block path can't do better.
+        return true;
+    }
+
+    // Push the GPU unmaps of all the va_blocks before waiting for any of them.
+    for (i = 0; i < num_blocks; i++) {
+        uvm_va_block_t *block = blocks[i];
+        uvm_va_block_region_t region;
+
+        block_status[i] = NV_OK;
+
+        uvm_mutex_lock(&block->lock);
+
+        if (!uvm_va_block_is_dead(block) && hmm_invalidate_region(block, range, &region)) {
+            block_status[i] = hmm_invalidate_begin_locked(block, va_block_context, range, cur_seq, region);
+
+            if (i > 0) {
+                block->hmm.invalidate_batch_range = range;
+                block->hmm.invalidate_batch_seq = cur_seq;
+            }
+        }
+
+        uvm_mutex_unlock(&block->lock);
+    }
+
+    for (i = 0; i < num_blocks; i++) {
+        uvm_va_block_t *block = blocks[i];
+        uvm_va_block_region_t region;
+
+        uvm_mutex_lock(&block->lock);
+
+        // Each va_block only skips its tracker wait if its own unmap failed,
+        // the unmaps of the other va_blocks may still be in flight.
+        if (!uvm_va_block_is_dead(block) && hmm_invalidate_region(block, range, &region)) {
+            block_status[i] = hmm_invalidate_end_locked(block, region, block_status[i]);
+            if (block_status[i] != NV_OK && status == NV_OK)
+                status = block_status[i];
+        }
+
+        uvm_mutex_unlock(&block->lock);
+
+        uvm_va_block_release(block);
+    }
+
+    uvm_va_block_context_free(va_block_context);
+
+    UVM_ASSERT(status == NV_OK);
+    return true;
+}
+
+static bool hmm_invalidate(uvm_va_block_t *va_block,
+                           const struct mmu_notifier_range *range,
+                           unsigned long cur_seq,
+                           bool batch)
+{
+    uvm_thread_context_t *uvm_context = uvm_thread_context();
+    struct mm_struct *mm = va_block->hmm.notifier.mm;
+    uvm_va_block_context_t *va_block_context;
+    uvm_va_block_region_t region;
+    NV_STATUS status = NV_OK;
+
+    // The MMU_NOTIFY_RELEASE event isn't really needed since mn_itree_release()
+    // doesn't remove the interval notifiers from the struct_mm so there will
+    // be a full range MMU_NOTIFY_UNMAP event after the release from
+    // unmap_vmas() during exit_mmap().
+    if (range->event == MMU_NOTIFY_SOFT_DIRTY || range->event == MMU_NOTIFY_RELEASE)
+        return true;
+
+    // Blockable is only set false by
+    // mmu_notifier_invalidate_range_start_nonblock() which is only called in
+    // __oom_reap_task_mm().
+    if (!mmu_notifier_range_blockable(range))
+        return false;
+
+    // We only ignore invalidations in this context whilst holding the
+    // va_block lock. This prevents deadlock when try_to_migrate()
+    // calls the notifier, but holding the lock prevents other threads
+    // invalidating PTEs so we can safely assume the results of
+    // migrate_vma_setup() are correct.
+    if (uvm_context->ignore_hmm_invalidate_va_block == va_block ||
+        ((range->event == MMU_NOTIFY_MIGRATE || range->event == MMU_NOTIFY_EXCLUSIVE) &&
+         range->owner == &g_uvm_global))
+        return true;
+
+    if (batch && hmm_invalidate_batch(va_block, range, cur_seq))
+        return true;
+
+    va_block_context = uvm_va_block_context_alloc(mm);
+    if (!va_block_context)
+        return true;
+
+    uvm_mutex_lock(&va_block->lock);
+
+    // mmu_interval_notifier_remove() is always called before marking a
+    // va_block as dead so this va_block has to be alive.
+    UVM_ASSERT(!uvm_va_block_is_dead(va_block));
+
+    if (hmm_invalidate_region(va_block, range, &region)) {
+        status = hmm_invalidate_begin_locked(va_block, va_block_context, range, cur_seq, region);
+        status = hmm_invalidate_end_locked(va_block, region, status);
+    }
+
     uvm_mutex_unlock(&va_block->lock);
 
     uvm_va_block_context_free(va_block_context);
@@ -522,7 +736,7 @@ static bool uvm_hmm_invalidate_entry(struct mmu_interval_notifier *mni,
 {
     uvm_va_block_t *va_block = container_of(mni, uvm_va_block_t, hmm.notifier);
 
-    UVM_ENTRY_RET(hmm_invalidate(va_block, range, cur_seq));
+    UVM_ENTRY_RET(hmm_invalidate(va_block, range, cur_seq, true));
 }
 
 static const struct mmu_interval_notifier_ops uvm_hmm_notifier_ops =
@@ -774,6 +988,7 @@ static NV_STATUS hmm_migrate_range(uvm_va_block_t *va_block,
                                                                        region,
                                                                        dest_id,
                                                                        mode,
+                                                                       UVM_MAKE_RESIDENT_CAUSE_API_MIGRATE,
                                                                        out_tracker));
         if (status != NV_OK)
             break;
@@ -817,7 +1032,9 @@ static bool hmm_split_invalidate(struct mmu_interval_notifier *mni,
     hmm_split_invalidate_data_t *split_data = container_of(mni, hmm_split_invalidate_data_t, notifier);
 
     uvm_tools_test_hmm_split_invalidate(split_data->existing_block->hmm.va_space);
-    hmm_invalidate(split_data->existing_block, range, cur_seq);
+    // The split notifier covers a va_block which is being modified, so don't
+    // batch it with its neighbours.
+    hmm_invalidate(split_data->existing_block, range, cur_seq, false);
 
     return true;
 }
@@ -3826,6 +4043,125 @@ NV_STATUS uvm_test_split_invalidate_delay(UVM_TEST_SPLIT_INVALIDATE_DELAY_PARAMS
     return NV_OK;
 }
 
+NV_STATUS uvm_test_hmm_munmap_check(UVM_TEST_HMM_MUNMAP_CHECK_PARAMS *params, struct file *filp)
+{
+    uvm_va_space_t *va_space = uvm_va_space_get(filp);
+    uvm_range_tree_node_t *node;
+    NvU64 addr = params->base;
+    NvU64 end;
+    NV_STATUS status = NV_OK;
+
+    if (!current->mm || !uvm_hmm_is_enabled(va_space))
+        return NV_ERR_INVALID_STATE;
+
+    if (!PAGE_ALIGNED(params->base) || !PAGE_ALIGNED(params->length) || params->length == 0)
+        return NV_ERR_INVALID_ADDRESS;
+
+    // Only invalidations spanning several va_blocks are batched
+    end = params->base + params->length - 1;
+    if (UVM_VA_BLOCK_ALIGN_DOWN(params->base) == UVM_VA_BLOCK_ALIGN_DOWN(end))
+        return NV_ERR_INVALID_ARGUMENT;
+
+    if (vm_munmap(params->base, params->length) != 0)
+        return NV_ERR_INVALID_ADDRESS;
+
+    params->va_block_count = 0;
+
+    uvm_va_space_down_read(va_space);
+
+    while (addr <= end) {
+        uvm_va_block_t *va_block;
+        uvm_va_block_region_t region;
+        uvm_processor_id_t id;
+
+        uvm_mutex_lock(&va_space->hmm.blocks_lock);
+        node = uvm_range_tree_iter_first(&va_space->hmm.blocks, addr, end);
+        uvm_mutex_unlock(&va_space->hmm.blocks_lock);
+
+        if (!node)
+            break;
+
+        // The va_space lock keeps the va_block in the tree
+        va_block = hmm_va_block_from_node(node);
+        region = uvm_va_block_region_from_start_end(va_block,
+                                                    max(va_block->start, params->base),
+                                                    min(va_block->end, end));
+
+        uvm_mutex_lock(&va_block->lock);
+
+        for_each_gpu_id_in_mask(id, &va_block->mapped) {
+            if (!uvm_page_mask_region_empty(uvm_va_block_map_mask_get(va_block, id), region)) {
+                UVM_TEST_PRINT("va_block [0x%llx, 0x%llx] still mapped on GPU %u after munmap\n",
+                               va_block->start,
+                               va_block->end,
+                               uvm_id_value(id));
+                status = NV_ERR_INVALID_STATE;
+            }
+        }
+
+        uvm_mutex_unlock(&va_block->lock);
+
+        params->va_block_count++;
+
+        if (status != NV_OK || va_block->end == ULONG_MAX)
+            break;
+
+        addr = va_block->end + 1;
+    }
+
+    uvm_va_space_up_read(va_space);
+
+    return status;
+}
+
+NV_STATUS uvm_test_hmm_set_invalidate_batch(UVM_TEST_HMM_SET_INVALIDATE_BATCH_PARAMS *params,
+                                            struct file *filp)
+{
+    uvm_va_space_t *va_space = uvm_va_space_get(filp);
+
+    if (!uvm_hmm_is_enabled(va_space))
+        return NV_ERR_INVALID_STATE;
+
+    WRITE_ONCE(va_space->test.hmm_invalidate_batch_disabled, !params->enable);
+
+    return NV_OK;
+}
+
+NV_STATUS uvm_test_hmm_munmap_benchmark(UVM_TEST_HMM_MUNMAP_BENCHMARK_PARAMS *params, struct file *filp)
+{
+    uvm_va_space_t *va_space = uvm_va_space_get(filp);
+    uvm_range_tree_node_t *node;
+    NvU64 end;
+    NvU64 start_time;
+
+    if (!current->mm || !uvm_hmm_is_enabled(va_space))
+        return NV_ERR_INVALID_STATE;
+
+    if (!PAGE_ALIGNED(params->base) || !PAGE_ALIGNED(params->length) || params->length == 0)
+        return NV_ERR_INVALID_ADDRESS;
+
+    end = params->base + params->length - 1;
+    params->va_block_count = 0;
+
+    uvm_va_space_down_read(va_space);
+    uvm_mutex_lock(&va_space->hmm.blocks_lock);
+
+    uvm_range_tree_for_each_in(node, &va_space->hmm.blocks, params->base, end)
+        params->va_block_count++;
+
+    uvm_mutex_unlock(&va_space->hmm.blocks_lock);
+    uvm_va_space_up_read(va_space);
+
+    start_time = NV_GETTIME();
+
+    if (vm_munmap(params->base, params->length) != 0)
+        return NV_ERR_INVALID_ADDRESS;
+
+    params->munmap_ns = NV_GETTIME() - start_time;
+
+    return NV_OK;
+}
+
 NV_STATUS uvm_hmm_va_range_info(uvm_va_space_t *va_space,
                                 struct mm_struct *mm,
                                 UVM_TEST_VA_RANGE_INFO_PARAMS *params)
@@ -386,6 +386,13 @@ typedef struct
     NV_STATUS uvm_test_split_invalidate_delay(UVM_TEST_SPLIT_INVALIDATE_DELAY_PARAMS *params,
                                               struct file *filp);
 
+    NV_STATUS uvm_test_hmm_munmap_check(UVM_TEST_HMM_MUNMAP_CHECK_PARAMS *params, struct file *filp);
+
+    NV_STATUS uvm_test_hmm_set_invalidate_batch(UVM_TEST_HMM_SET_INVALIDATE_BATCH_PARAMS *params,
+                                                struct file *filp);
+
+    NV_STATUS uvm_test_hmm_munmap_benchmark(UVM_TEST_HMM_MUNMAP_BENCHMARK_PARAMS *params, struct file *filp);
+
     NV_STATUS uvm_hmm_va_range_info(uvm_va_space_t *va_space,
                                     struct mm_struct *mm,
                                     UVM_TEST_VA_RANGE_INFO_PARAMS *params);
@@ -654,6 +661,23 @@ typedef struct
         return NV_ERR_INVALID_STATE;
     }
 
+    static NV_STATUS uvm_test_hmm_munmap_check(UVM_TEST_HMM_MUNMAP_CHECK_PARAMS *params, struct file *filp)
+    {
+        return NV_ERR_INVALID_STATE;
+    }
+
+    static NV_STATUS uvm_test_hmm_set_invalidate_batch(UVM_TEST_HMM_SET_INVALIDATE_BATCH_PARAMS *params,
+                                                       struct file *filp)
+    {
+        return NV_ERR_INVALID_STATE;
+    }
+
+    static NV_STATUS uvm_test_hmm_munmap_benchmark(UVM_TEST_HMM_MUNMAP_BENCHMARK_PARAMS *params,
+                                                   struct file *filp)
+    {
+        return NV_ERR_INVALID_STATE;
+    }
+
     static NV_STATUS uvm_hmm_va_range_info(uvm_va_space_t *va_space,
                                            struct mm_struct *mm,
                                            UVM_TEST_VA_RANGE_INFO_PARAMS *params)
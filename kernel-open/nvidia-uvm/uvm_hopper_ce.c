@@ -282,6 +282,8 @@ static void hopper_memset_common(uvm_push_t *push,
                    push->channel->name,
                    uvm_gpu_name(gpu));
 
+    uvm_push_add_transferred_bytes(push, num_elements * memset_element_size);
+
     launch_dma_dst_type = hopper_memset_push_phys_mode(push, dst);
     launch_dma_plc_mode = gpu->parent->ce_hal->plc_mode();
 
@@ -503,6 +505,8 @@ static void encrypt_or_decrypt(uvm_push_t *push, uvm_gpu_address_t dst, uvm_gpu_
                    ((src.address + size - 1) >> UVM_CONF_COMPUTING_BUF_ALIGNMENT));
     }
 
+    uvm_push_add_transferred_bytes(push, size);
+
     launch_dma_src_dst_type = gpu->parent->ce_hal->phys_mode(push, dst, src);
     launch_dma_plc_mode = gpu->parent->ce_hal->plc_mode();
 
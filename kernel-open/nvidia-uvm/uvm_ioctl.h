@@ -1035,6 +1035,91 @@ typedef struct
     NV_STATUS       rmStatus;                                                  // OUT
 } UVM_DISCARD_PARAMS;
 
+//
+// Initialize an event queue made of one ring per CPU. queueBuffer holds
+// numRings rings of queueBufferSize UvmEventEntry_V2 entries each, and
+// controlBuffer holds numRings UvmToolsEventControlData, one per ring.
+//
+// Ring i only receives events recorded on CPU i, without any synchronization
+// with the other CPUs, so events are only ordered within a ring: consumers must
+// merge the rings by event timestamp. Events recorded while servicing a fault
+// batch are made visible once per batch rather than once per event. Queues
+// created with the other init ioctls are not affected by this batching.
+//
+// numRings must be at least the number of possible CPU ids in the system, and
+// is set to the number of rings actually used on return.
+//
+#define UVM_TOOLS_INIT_EVENT_TRACKER_PER_CPU                          UVM_IOCTL_BASE(81)
+typedef struct
+{
+    NvU64           queueBuffer        NV_ALIGN_BYTES(8); // IN
+    NvU64           queueBufferSize    NV_ALIGN_BYTES(8); // IN
+    NvU64           controlBuffer      NV_ALIGN_BYTES(8); // IN
+    NvU32           numRings;                             // IN/OUT
+    NvU32           uvmFd;                                // IN
+    NV_STATUS       rmStatus;                             // OUT
+} UVM_TOOLS_INIT_EVENT_TRACKER_PER_CPU_PARAMS;
+
+//
+// Migrate a batch of ranges with a single call. entries points to an array of
+// numEntries UVM_MIGRATE_BATCH_ENTRY, each one migrated like UVM_MIGRATE with
+// the given flags and a cpuNumaNode of -1. The copies of all the entries are
+// pushed without waiting for the previous ones to complete.
+//
+// If UVM_MIGRATE_FLAG_ASYNC is 0, the ioctl returns once all the migrations
+// are done. semaphoreAddress must be 0 and eventFd must be -1.
+//
+// If UVM_MIGRATE_FLAG_ASYNC is 1 and the returned error code is NV_OK,
+// semaphorePayload is written to semaphoreAddress if it is non-zero, and the
+// eventfd referred to by eventFd is signaled if it is not -1, once all the
+// migrations are complete.
+//
+// Only managed and HMM ranges are supported. If an entry covers memory only
+// accessible through ATS, NV_ERR_NOT_SUPPORTED is returned and user space is
+// responsible for migrating it with UVM_MIGRATE. On error, numMigrated is the
+// index of the entry that failed; the entries before it have been migrated.
+//
+// numEntries must not exceed UVM_MIGRATE_BATCH_MAX_ENTRIES.
+//
+#define UVM_MIGRATE_BATCH_MAX_ENTRIES 16384
+
+typedef struct
+{
+    NvU64           base               NV_ALIGN_BYTES(8);
+    NvU64           length             NV_ALIGN_BYTES(8);
+    NvProcessorUuid destinationUuid;
+} UVM_MIGRATE_BATCH_ENTRY;
+
+#define UVM_MIGRATE_BATCH                                             UVM_IOCTL_BASE(82)
+typedef struct
+{
+    NvU64           entries            NV_ALIGN_BYTES(8); // IN
+    NvU32           numEntries;                           // IN
+    NvU32           flags;                                // IN
+    NvU64           semaphoreAddress   NV_ALIGN_BYTES(8); // IN
+    NvU32           semaphorePayload;                     // IN
+    NvS32           eventFd;                              // IN
+    NvU32           numMigrated;                          // OUT
+    NV_STATUS       rmStatus;                             // OUT
+} UVM_MIGRATE_BATCH_PARAMS;
+
+//
+// Set the CPU NUMA placement policy of a managed VA range. placement is one of
+// UvmCpuNumaPlacement. The policy is ignored for pages of VA ranges with a
+// preferred CPU NUMA node.
+//
+// Only managed ranges are supported. NV_ERR_NOT_SUPPORTED is returned for HMM
+// ranges, and ranges only accessible through ATS are ignored.
+//
+#define UVM_SET_CPU_NUMA_PLACEMENT                                    UVM_IOCTL_BASE(83)
+typedef struct
+{
+    NvU64           requestedBase      NV_ALIGN_BYTES(8); // IN
+    NvU64           length             NV_ALIGN_BYTES(8); // IN
+    NvU32           placement;                            // IN
+    NV_STATUS       rmStatus;                             // OUT
+} UVM_SET_CPU_NUMA_PLACEMENT_PARAMS;
+
 //
 // Temporary ioctls which should be removed before UVM 8 release
 // Number backwards from 2047 - highest custom ioctl function number
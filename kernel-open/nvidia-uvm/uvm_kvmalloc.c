@@ -77,8 +77,25 @@ static struct
     uvm_rb_tree_t allocation_info;
 
     struct kmem_cache *info_cache;
+
+    // Per uvm_kvmalloc_object_t statistics
+    struct
+    {
+        // Objects currently constructed
+        atomic_long_t live;
+
+        // Objects handed out to callers, and how many of those were reused
+        // from a cache
+        atomic_long_t allocations;
+        atomic_long_t cache_hits;
+    } objects[UVM_KVMALLOC_OBJECT_COUNT];
 } g_uvm_leak_checker;
 
+static const char *g_uvm_kvmalloc_object_names[UVM_KVMALLOC_OBJECT_COUNT] =
+{
+    [UVM_KVMALLOC_OBJECT_VA_BLOCK_CONTEXT] = "uvm_va_block_context_t",
+};
+
 // Default to byte-count-only leak checking for non-release builds. This can
 // always be overridden by the module parameter.
 static int uvm_leak_checker = (UVM_IS_DEBUG() || UVM_IS_DEVELOP()) ?
@@ -107,9 +124,22 @@ NV_STATUS uvm_kvmalloc_init(void)
 
 void uvm_kvmalloc_exit(void)
 {
+    int object;
+
     if (!g_malloc_initialized)
         return;
 
+    for (object = 0; object < UVM_KVMALLOC_OBJECT_COUNT; object++) {
+        long live = atomic_long_read(&g_uvm_leak_checker.objects[object].live);
+
+        if (live > 0) {
+            UVM_INFO_PRINT("Memory leak of %ld %s objects detected.\n", live, g_uvm_kvmalloc_object_names[object]);
+
+            if (g_uvm_global.unload_state.ptr)
+                *g_uvm_global.unload_state.ptr |= UVM_TEST_UNLOAD_STATE_MEMORY_LEAK;
+        }
+    }
+
     if (atomic_long_read(&g_uvm_leak_checker.bytes_allocated) > 0) {
         UVM_INFO_PRINT("!!!!!!!!!!!!!!!!!!!!!!!!!!!!\n");
         UVM_INFO_PRINT("Memory leak of %lu bytes detected.%s\n",
@@ -410,3 +440,40 @@ size_t uvm_kvsize(void *p)
         return get_hdr(p)->alloc_size;
     return ksize(p);
 }
+
+void uvm_kvmalloc_object_created(uvm_kvmalloc_object_t object)
+{
+    if (uvm_leak_checker)
+        atomic_long_inc(&g_uvm_leak_checker.objects[object].live);
+}
+
+void uvm_kvmalloc_object_destroyed(uvm_kvmalloc_object_t object)
+{
+    if (uvm_leak_checker)
+        atomic_long_dec(&g_uvm_leak_checker.objects[object].live);
+}
+
+void uvm_kvmalloc_object_allocated(uvm_kvmalloc_object_t object, bool from_cache)
+{
+    if (!uvm_leak_checker)
+        return;
+
+    atomic_long_inc(&g_uvm_leak_checker.objects[object].allocations);
+    if (from_cache)
+        atomic_long_inc(&g_uvm_leak_checker.objects[object].cache_hits);
+}
+
+NV_STATUS uvm_test_kvmalloc_object_stats(UVM_TEST_KVMALLOC_OBJECT_STATS_PARAMS *params, struct file *filp)
+{
+    if (params->object >= UVM_KVMALLOC_OBJECT_COUNT)
+        return NV_ERR_INVALID_ARGUMENT;
+
+    if (!uvm_leak_checker)
+        return NV_ERR_INVALID_STATE;
+
+    params->live = atomic_long_read(&g_uvm_leak_checker.objects[params->object].live);
+    params->allocations = atomic_long_read(&g_uvm_leak_checker.objects[params->object].allocations);
+    params->cache_hits = atomic_long_read(&g_uvm_leak_checker.objects[params->object].cache_hits);
+
+    return NV_OK;
+}
@@ -70,6 +70,24 @@ void *__uvm_kvrealloc(void *p, size_t new_size, const char *file, int line, cons
 // p must not be NULL.
 size_t uvm_kvsize(void *p);
 
+// Objects which are allocated from dedicated caches rather than with
+// uvm_kvmalloc, but whose allocations are still accounted by the leak checker.
+// Objects still alive at uvm_kvmalloc_exit() are reported as leaks.
+typedef enum
+{
+    UVM_KVMALLOC_OBJECT_VA_BLOCK_CONTEXT = UVM_TEST_KVMALLOC_OBJECT_VA_BLOCK_CONTEXT,
+    UVM_KVMALLOC_OBJECT_COUNT = UVM_TEST_KVMALLOC_OBJECT_COUNT
+} uvm_kvmalloc_object_t;
+
+// A new object was constructed or an object was destroyed
+void uvm_kvmalloc_object_created(uvm_kvmalloc_object_t object);
+void uvm_kvmalloc_object_destroyed(uvm_kvmalloc_object_t object);
+
+// An object was handed out to a caller, either newly constructed or reused
+// from a cache of freed objects if from_cache is true.
+void uvm_kvmalloc_object_allocated(uvm_kvmalloc_object_t object, bool from_cache);
+
 NV_STATUS uvm_test_kvmalloc(UVM_TEST_KVMALLOC_PARAMS *params, struct file *filp);
+NV_STATUS uvm_test_kvmalloc_object_stats(UVM_TEST_KVMALLOC_OBJECT_STATS_PARAMS *params, struct file *filp);
 
 #endif // __UVM_KVMALLOC_H__
@@ -54,6 +54,7 @@
 
 #include <linux/file.h>             /* fget()                           */
 
+#include <linux/completion.h>
 #include <linux/percpu.h>
 #include <linux/printk.h>
 #include <linux/ratelimit.h>
@@ -271,6 +271,8 @@ void uvm_hal_maxwell_ce_memcopy(uvm_push_t *push, uvm_gpu_address_t dst, uvm_gpu
     if (uvm_gpu_get_injected_nvlink_error(gpu) != NV_OK && uvm_gpu_address_is_peer(gpu, dst))
         size = 0;
 
+    uvm_push_add_transferred_bytes(push, size);
+
     gpu->parent->ce_hal->memcopy_patch_src(push, &src);
 
     launch_dma_src_dst_type = gpu->parent->ce_hal->phys_mode(push, dst, src);
@@ -343,6 +345,8 @@ static void memset_common(uvm_push_t *push, uvm_gpu_address_t dst, size_t size,
                    push->channel->name,
                    uvm_gpu_name(gpu));
 
+    uvm_push_add_transferred_bytes(push, size * memset_element_size);
+
     launch_dma_dst_type = maxwell_memset_push_phys_mode(push, dst);
     launch_dma_plc_mode = gpu->parent->ce_hal->plc_mode();
 
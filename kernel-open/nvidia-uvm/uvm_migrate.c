@@ -41,7 +41,9 @@
 #include "uvm_migrate.h"
 #include "uvm_migrate_pageable.h"
 #include "uvm_va_space_mm.h"
+#include "uvm_test.h"
 #include "nv_speculation_barrier.h"
+#include <linux/eventfd.h>
 
 typedef enum
 {
@@ -61,6 +63,10 @@ module_param(uvm_perf_migrate_cpu_preunmap_block_order, uint, S_IRUGO);
 static bool g_uvm_perf_migrate_cpu_preunmap_enable __read_mostly;
 static NvU64 g_uvm_perf_migrate_cpu_preunmap_size __read_mostly;
 
+// Queue waiting for the completion of asynchronous UVM_MIGRATE_BATCH calls
+// signaled through an eventfd
+static nv_kthread_q_t g_uvm_migrate_batch_q;
+
 static bool is_migration_single_block(uvm_va_range_managed_t *first_managed_range, NvU64 base, NvU64 length)
 {
     NvU64 end = base + length - 1;
@@ -199,6 +205,7 @@ NV_STATUS uvm_va_block_migrate_locked(uvm_va_block_t *va_block,
                                       uvm_va_block_region_t region,
                                       uvm_processor_id_t dest_id,
                                       uvm_migrate_mode_t mode,
+                                      uvm_make_resident_cause_t cause,
                                       uvm_tracker_t *out_tracker)
 {
     uvm_va_space_t *va_space = uvm_va_block_get_va_space(va_block);
@@ -217,7 +224,7 @@ NV_STATUS uvm_va_block_migrate_locked(uvm_va_block_t *va_block,
                                                  service_context,
                                                  dest_id,
                                                  region,
-                                                 UVM_MAKE_RESIDENT_CAUSE_API_MIGRATE);
+                                                 cause);
     }
     else {
         uvm_va_policy_t *policy = &va_block->managed_range->policy;
@@ -235,7 +242,7 @@ NV_STATUS uvm_va_block_migrate_locked(uvm_va_block_t *va_block,
                                                                    region,
                                                                    make_resident_mask,
                                                                    NULL,
-                                                                   UVM_MAKE_RESIDENT_CAUSE_API_MIGRATE);
+                                                                   cause);
             }
 
             // We've read-duplicated all non-discarded pages.
@@ -248,7 +255,7 @@ NV_STATUS uvm_va_block_migrate_locked(uvm_va_block_t *va_block,
                                                     region,
                                                     make_resident_mask,
                                                     NULL,
-                                                    UVM_MAKE_RESIDENT_CAUSE_API_MIGRATE);
+                                                    cause);
             }
         }
         else {
@@ -259,7 +266,7 @@ NV_STATUS uvm_va_block_migrate_locked(uvm_va_block_t *va_block,
                                                 region,
                                                 NULL,
                                                 NULL,
-                                                UVM_MAKE_RESIDENT_CAUSE_API_MIGRATE);
+                                                cause);
         }
     }
 
@@ -484,6 +491,7 @@ static NV_STATUS uvm_va_range_migrate_multi_block(uvm_va_range_managed_t *manage
                                                                      region,
                                                                      dest_id,
                                                                      mode,
+                                                                     UVM_MAKE_RESIDENT_CAUSE_API_MIGRATE,
                                                                      out_tracker));
         if (status != NV_OK)
             return status;
@@ -867,11 +875,20 @@ NV_STATUS uvm_migrate_init(void)
         }
     }
 
+    status = errno_to_nv_status(nv_kthread_q_init(&g_uvm_migrate_batch_q, "UVM migrate batch"));
+    if (status != NV_OK) {
+        uvm_migrate_pageable_exit();
+        return status;
+    }
+
     return NV_OK;
 }
 
 void uvm_migrate_exit(void)
 {
+    // Pending completions hold GPU references, so they must be done before
+    // the GPUs are torn down.
+    nv_kthread_q_stop(&g_uvm_migrate_batch_q);
     uvm_migrate_pageable_exit();
 }
 
@@ -1100,6 +1117,300 @@ done:
     return status;
 }
 
+// Completion of an asynchronous UVM_MIGRATE_BATCH signaled through an eventfd.
+// The tracker is waited on from g_uvm_migrate_batch_q, with references on the
+// GPUs it depends on so that they cannot go away in the meantime.
+typedef struct
+{
+    nv_kthread_q_item_t q_item;
+
+    uvm_tracker_t tracker;
+
+    uvm_processor_mask_t gpus;
+
+    struct eventfd_ctx *eventfd;
+} uvm_migrate_batch_completion_t;
+
+static void migrate_batch_complete(void *args)
+{
+    uvm_migrate_batch_completion_t *completion = (uvm_migrate_batch_completion_t *)args;
+    NV_STATUS status;
+
+    status = uvm_tracker_wait_deinit(&completion->tracker);
+
+    // Only signal successful migrations. A failed wait means that a global
+    // error was hit, which user space finds out about on its next call.
+    if (status == NV_OK) {
+#if defined(NV_EVENTFD_SIGNAL_HAS_COUNTER_ARG)
+        eventfd_signal(completion->eventfd, 1);
+#else
+        eventfd_signal(completion->eventfd);
+#endif
+    }
+
+    eventfd_ctx_put(completion->eventfd);
+    uvm_global_gpu_release(&completion->gpus);
+    uvm_kvfree(completion);
+
+    uvm_tools_flush_events();
+}
+
+static void migrate_batch_complete_entry(void *args)
+{
+    UVM_ENTRY_VOID(migrate_batch_complete(args));
+}
+
+static NV_STATUS migrate_batch_entry(uvm_va_space_t *va_space,
+                                     struct mm_struct *mm,
+                                     const UVM_MIGRATE_BATCH_ENTRY *entry,
+                                     NvU32 flags,
+                                     uvm_gpu_t **dest_gpu,
+                                     uvm_tracker_t *tracker,
+                                     uvm_processor_mask_t *gpus_to_check_for_nvlink_errors)
+{
+    uvm_processor_id_t dest_id = UVM_ID_CPU;
+    int dest_nid = NUMA_NO_NODE;
+    uvm_api_range_type_t type;
+
+    if (uvm_api_range_invalid(entry->base, entry->length))
+        return NV_ERR_INVALID_ADDRESS;
+
+    // Consecutive entries usually share their destination
+    if (!uvm_uuid_is_cpu(&entry->destinationUuid)) {
+        if (!*dest_gpu || !uvm_uuid_eq(&(*dest_gpu)->uuid, &entry->destinationUuid)) {
+            if (flags & UVM_MIGRATE_FLAG_NO_GPU_VA_SPACE)
+                *dest_gpu = uvm_va_space_get_gpu_by_uuid(va_space, &entry->destinationUuid);
+            else
+                *dest_gpu = uvm_va_space_get_gpu_by_uuid_with_gpu_va_space(va_space, &entry->destinationUuid);
+
+            if (!*dest_gpu)
+                return NV_ERR_INVALID_DEVICE;
+        }
+
+        if (!uvm_gpu_can_address(*dest_gpu, entry->base, entry->length))
+            return NV_ERR_OUT_OF_RANGE;
+
+        // Migration to an integrated GPU is equivalent to migration to that
+        // GPUs nearest NUMA node.
+        if ((*dest_gpu)->parent->is_integrated_gpu)
+            dest_nid = (*dest_gpu)->parent->closest_cpu_numa_node;
+        else
+            dest_id = (*dest_gpu)->id;
+    }
+
+    type = uvm_api_range_type_check(va_space, mm, entry->base, entry->length);
+    if (type == UVM_API_RANGE_TYPE_INVALID)
+        return NV_ERR_INVALID_ADDRESS;
+
+    // Pageable migrations may need to go back to user space, see UVM_MIGRATE
+    if (type == UVM_API_RANGE_TYPE_ATS)
+        return NV_ERR_NOT_SUPPORTED;
+
+    return uvm_migrate(va_space,
+                       mm,
+                       entry->base,
+                       entry->length,
+                       dest_id,
+                       dest_nid,
+                       flags,
+                       uvm_va_space_iter_managed_first(va_space, entry->base, entry->base),
+                       tracker,
+                       gpus_to_check_for_nvlink_errors);
+}
+
+static NV_STATUS migrate_batch_check_params(const UVM_MIGRATE_BATCH_PARAMS *params)
+{
+    const bool synchronous = !(params->flags & UVM_MIGRATE_FLAG_ASYNC);
+
+    if (params->flags & ~UVM_MIGRATE_FLAGS_ALL)
+        return NV_ERR_INVALID_ARGUMENT;
+
+    if ((params->flags & UVM_MIGRATE_FLAGS_TEST_ALL) && !uvm_enable_builtin_tests) {
+        UVM_INFO_PRINT("Test flag set for UVM_MIGRATE_BATCH. Did you mean to insmod with uvm_enable_builtin_tests=1?\n");
+        return NV_ERR_INVALID_ARGUMENT;
+    }
+
+    if (params->numEntries == 0 || params->numEntries > UVM_MIGRATE_BATCH_MAX_ENTRIES)
+        return NV_ERR_INVALID_ARGUMENT;
+
+    if (synchronous && (params->semaphoreAddress != 0 || params->eventFd != -1))
+        return NV_ERR_INVALID_ARGUMENT;
+
+    if (params->semaphoreAddress == 0 && params->semaphorePayload != 0)
+        return NV_ERR_INVALID_ARGUMENT;
+
+    return NV_OK;
+}
+
+// Migrate the params->numEntries entries, which the caller has already copied
+// from params->entries. params must have been checked with
+// migrate_batch_check_params().
+static NV_STATUS migrate_batch(uvm_va_space_t *va_space,
+                               const UVM_MIGRATE_BATCH_ENTRY *entries,
+                               UVM_MIGRATE_BATCH_PARAMS *params)
+{
+    uvm_migrate_batch_completion_t *completion = NULL;
+    uvm_tracker_t local_tracker = UVM_TRACKER_INIT();
+    uvm_tracker_t *tracker_ptr;
+    uvm_tracker_entry_t *tracker_entry;
+    uvm_gpu_t *dest_gpu = NULL;
+    uvm_gpu_t *sema_gpu = NULL;
+    uvm_va_range_semaphore_pool_t *sema_va_range = NULL;
+    struct mm_struct *mm;
+    NV_STATUS status = NV_OK;
+    const bool synchronous = !(params->flags & UVM_MIGRATE_FLAG_ASYNC);
+    uvm_processor_mask_t *gpus_to_check_for_nvlink_errors = NULL;
+    NvU32 i = 0;
+
+    params->numMigrated = 0;
+
+    if (params->eventFd != -1) {
+        struct eventfd_ctx *eventfd = eventfd_ctx_fdget(params->eventFd);
+
+        if (IS_ERR(eventfd))
+            return errno_to_nv_status(PTR_ERR(eventfd));
+
+        completion = uvm_kvmalloc_zero(sizeof(*completion));
+        if (!completion) {
+            eventfd_ctx_put(eventfd);
+            return NV_ERR_NO_MEMORY;
+        }
+
+        completion->eventfd = eventfd;
+        uvm_tracker_init(&completion->tracker);
+        nv_kthread_q_item_init(&completion->q_item, migrate_batch_complete_entry, completion);
+    }
+
+    gpus_to_check_for_nvlink_errors = uvm_processor_mask_cache_alloc();
+    if (!gpus_to_check_for_nvlink_errors) {
+        status = NV_ERR_NO_MEMORY;
+        goto out;
+    }
+
+    uvm_processor_mask_zero(gpus_to_check_for_nvlink_errors);
+
+    // All the entries share a tracker, so the copies of an entry don't wait
+    // for the ones of the previous entries.
+    tracker_ptr = completion ? &completion->tracker : &local_tracker;
+
+    // mmap_lock will be needed if we have to create CPU mappings
+    mm = uvm_va_space_mm_or_current_retain_lock(va_space);
+    uvm_va_space_down_read(va_space);
+
+    if (params->semaphoreAddress != 0) {
+        sema_va_range = uvm_va_range_semaphore_pool_find(va_space, params->semaphoreAddress);
+        if (!IS_ALIGNED(params->semaphoreAddress, sizeof(params->semaphorePayload)) || !sema_va_range) {
+            status = NV_ERR_INVALID_ADDRESS;
+            goto done;
+        }
+    }
+
+    for (i = 0; i < params->numEntries; i++) {
+        status = migrate_batch_entry(va_space,
+                                     mm,
+                                     &entries[i],
+                                     params->flags,
+                                     &dest_gpu,
+                                     tracker_ptr,
+                                     gpus_to_check_for_nvlink_errors);
+        if (status != NV_OK)
+            break;
+
+        if (!uvm_uuid_is_cpu(&entries[i].destinationUuid))
+            sema_gpu = dest_gpu;
+    }
+
+    params->numMigrated = i;
+
+done:
+    uvm_global_gpu_retain(gpus_to_check_for_nvlink_errors);
+
+    // We only need to hold mmap_lock to create new CPU mappings, so drop it if
+    // we need to wait for the tracker to finish.
+    if (mm)
+        uvm_up_read_mmap_lock_out_of_order(mm);
+
+    if (status == NV_OK && sema_va_range)
+        status = semaphore_release(params->semaphoreAddress, params->semaphorePayload, sema_va_range, sema_gpu, tracker_ptr);
+
+    if (status == NV_OK && completion) {
+        // Hand the tracker over to the completion, which holds references on
+        // the GPUs it depends on.
+        uvm_processor_mask_zero(&completion->gpus);
+        for_each_tracker_entry(tracker_entry, &completion->tracker)
+            uvm_processor_mask_set(&completion->gpus, uvm_tracker_entry_gpu(tracker_entry)->id);
+
+        uvm_global_gpu_retain(&completion->gpus);
+        nv_kthread_q_schedule_q_item(&g_uvm_migrate_batch_q, &completion->q_item);
+        completion = NULL;
+    }
+    else if (synchronous || status != NV_OK) {
+        // Wait on the tracker if we are synchronous or there was an error. The
+        // VA space lock must be held to prevent GPUs from being unregistered.
+        NV_STATUS tracker_status = uvm_tracker_wait(tracker_ptr);
+
+        // Only clobber status if we didn't hit an earlier error
+        if (status == NV_OK)
+            status = tracker_status;
+    }
+
+    uvm_tracker_deinit(&local_tracker);
+
+    uvm_va_space_up_read(va_space);
+    uvm_va_space_mm_or_current_release(va_space, mm);
+
+    // Check for STO errors in case there was no other error until now.
+    if (status == NV_OK && !uvm_processor_mask_empty(gpus_to_check_for_nvlink_errors))
+        status = uvm_global_gpu_check_nvlink_error(gpus_to_check_for_nvlink_errors);
+
+    uvm_global_gpu_release(gpus_to_check_for_nvlink_errors);
+
+    if (synchronous)
+        uvm_tools_flush_events();
+
+out:
+    uvm_processor_mask_cache_free(gpus_to_check_for_nvlink_errors);
+
+    if (completion) {
+        uvm_tracker_deinit(&completion->tracker);
+        eventfd_ctx_put(completion->eventfd);
+        uvm_kvfree(completion);
+    }
+
+    return status;
+}
+
+NV_STATUS uvm_api_migrate_batch(UVM_MIGRATE_BATCH_PARAMS *params, struct file *filp)
+{
+    UVM_MIGRATE_BATCH_ENTRY *entries;
+    NV_STATUS status;
+
+    params->numMigrated = 0;
+
+    status = migrate_batch_check_params(params);
+    if (status != NV_OK)
+        return status;
+
+    // The entries are copied before taking any lock, since reading them could
+    // fault on UVM memory.
+    entries = uvm_kvmalloc(params->numEntries * sizeof(*entries));
+    if (!entries)
+        return NV_ERR_NO_MEMORY;
+
+    if (copy_from_user(entries,
+                       (const void __user *)(uintptr_t)params->entries,
+                       params->numEntries * sizeof(*entries))) {
+        uvm_kvfree(entries);
+        return NV_ERR_INVALID_ADDRESS;
+    }
+
+    status = migrate_batch(uvm_va_space_get(filp), entries, params);
+
+    uvm_kvfree(entries);
+
+    return status;
+}
+
 NV_STATUS uvm_api_migrate_range_group(UVM_MIGRATE_RANGE_GROUP_PARAMS *params, struct file *filp)
 {
     NV_STATUS status = NV_OK;
@@ -1208,3 +1519,285 @@ done:
 
     return status == NV_OK? tracker_status : status;
 }
+
+// Number of entries the range of uvm_test_migrate_batch() is split into
+#define TEST_MIGRATE_BATCH_NUM_ENTRIES 4
+
+// Split [base, base + length) into TEST_MIGRATE_BATCH_NUM_ENTRIES entries
+// migrated to the given destination
+static void test_migrate_batch_fill(UVM_MIGRATE_BATCH_ENTRY *entries,
+                                    NvU64 base,
+                                    NvU64 length,
+                                    const NvProcessorUuid *dest_uuid)
+{
+    NvU64 entry_length = length / TEST_MIGRATE_BATCH_NUM_ENTRIES;
+    NvU32 i;
+
+    for (i = 0; i < TEST_MIGRATE_BATCH_NUM_ENTRIES; i++) {
+        entries[i].base = base + i * entry_length;
+        entries[i].length = entry_length;
+        uvm_uuid_copy(&entries[i].destinationUuid, dest_uuid);
+    }
+}
+
+// Run the batch like UVM_MIGRATE_BATCH would, minus the copy of the entries
+// from user space
+static NV_STATUS test_migrate_batch_run(uvm_va_space_t *va_space,
+                                        const UVM_MIGRATE_BATCH_ENTRY *entries,
+                                        NvU32 num_entries,
+                                        NvU32 flags,
+                                        NvS32 event_fd,
+                                        NvU32 *num_migrated)
+{
+    UVM_MIGRATE_BATCH_PARAMS params = {0};
+    NV_STATUS status;
+
+    params.numEntries = num_entries;
+    params.flags = flags;
+    params.eventFd = event_fd;
+
+    status = migrate_batch_check_params(&params);
+    if (status == NV_OK)
+        status = migrate_batch(va_space, entries, &params);
+
+    *num_migrated = params.numMigrated;
+
+    return status;
+}
+
+// Check that all the pages of [base, base + length) have a copy resident on
+// the given processor
+static NV_STATUS test_migrate_batch_check_resident(uvm_va_space_t *va_space,
+                                                   NvU64 base,
+                                                   NvU64 length,
+                                                   uvm_processor_id_t id)
+{
+    uvm_processor_mask_t *resident_processors;
+    NV_STATUS status = NV_OK;
+    NvU64 addr;
+
+    resident_processors = uvm_processor_mask_cache_alloc();
+    if (!resident_processors)
+        return NV_ERR_NO_MEMORY;
+
+    uvm_va_space_down_read(va_space);
+
+    for (addr = base; addr < base + length; addr += PAGE_SIZE) {
+        uvm_va_block_t *va_block;
+
+        TEST_NV_CHECK_GOTO(uvm_va_block_find(va_space, addr, &va_block), done);
+
+        uvm_mutex_lock(&va_block->lock);
+        uvm_va_block_page_resident_processors(va_block,
+                                              uvm_va_block_cpu_page_index(va_block, addr),
+                                              resident_processors);
+        uvm_mutex_unlock(&va_block->lock);
+
+        TEST_CHECK_GOTO(uvm_processor_mask_test(resident_processors, id), done);
+    }
+
+done:
+    uvm_va_space_up_read(va_space);
+    uvm_processor_mask_cache_free(resident_processors);
+
+    return status;
+}
+
+// Read and reset the counter of the eventfd, which is non-blocking
+static NV_STATUS test_migrate_batch_read_eventfd(struct file *event_file, NvU64 *count)
+{
+    loff_t pos = 0;
+    ssize_t ret;
+
+    ret = kernel_read(event_file, count, sizeof(*count), &pos);
+    if (ret == -EAGAIN) {
+        *count = 0;
+        return NV_OK;
+    }
+
+    if (ret < 0)
+        return errno_to_nv_status(ret);
+
+    return ret == sizeof(*count) ? NV_OK : NV_ERR_INVALID_STATE;
+}
+
+// Arguments rejected before any entry is read
+static NV_STATUS test_migrate_batch_invalid_params(struct file *filp)
+{
+    UVM_MIGRATE_BATCH_PARAMS params = {0};
+
+    params.eventFd = -1;
+    TEST_CHECK_RET(uvm_api_migrate_batch(&params, filp) == NV_ERR_INVALID_ARGUMENT);
+
+    params.numEntries = UVM_MIGRATE_BATCH_MAX_ENTRIES + 1;
+    TEST_CHECK_RET(uvm_api_migrate_batch(&params, filp) == NV_ERR_INVALID_ARGUMENT);
+
+    params.numEntries = 1;
+    params.flags = ~UVM_MIGRATE_FLAGS_ALL;
+    TEST_CHECK_RET(uvm_api_migrate_batch(&params, filp) == NV_ERR_INVALID_ARGUMENT);
+
+    // Completion can only be signaled in asynchronous mode
+    params.flags = 0;
+    params.eventFd = 0;
+    TEST_CHECK_RET(uvm_api_migrate_batch(&params, filp) == NV_ERR_INVALID_ARGUMENT);
+
+    params.eventFd = -1;
+    params.semaphoreAddress = PAGE_SIZE;
+    TEST_CHECK_RET(uvm_api_migrate_batch(&params, filp) == NV_ERR_INVALID_ARGUMENT);
+
+    params.flags = UVM_MIGRATE_FLAG_ASYNC;
+    params.semaphoreAddress = 0;
+    params.semaphorePayload = 1;
+    TEST_CHECK_RET(uvm_api_migrate_batch(&params, filp) == NV_ERR_INVALID_ARGUMENT);
+
+    TEST_CHECK_RET(params.numMigrated == 0);
+
+    return NV_OK;
+}
+
+NV_STATUS uvm_test_migrate_batch(UVM_TEST_MIGRATE_BATCH_PARAMS *params, struct file *filp)
+{
+    uvm_va_space_t *va_space = uvm_va_space_get(filp);
+    UVM_MIGRATE_BATCH_ENTRY entries[TEST_MIGRATE_BATCH_NUM_ENTRIES];
+    const NvU64 entry_length = params->length / TEST_MIGRATE_BATCH_NUM_ENTRIES;
+    NvProcessorUuid invalid_uuid;
+    uvm_processor_id_t gpu_dest_id = UVM_ID_INVALID;
+    struct file *event_file = NULL;
+    NvU32 num_migrated;
+    NvU64 count;
+    uvm_gpu_t *gpu;
+    NV_STATUS status;
+
+    params->ats_rejected = NV_FALSE;
+
+    if (!PAGE_ALIGNED(params->base) ||
+        params->length == 0 ||
+        params->length % (TEST_MIGRATE_BATCH_NUM_ENTRIES * PAGE_SIZE) != 0)
+        return NV_ERR_INVALID_ARGUMENT;
+
+    // The eventfd is read back to check that it was signaled, which must not
+    // block
+    if (params->event_fd != -1) {
+        event_file = fget(params->event_fd);
+        if (!event_file)
+            return NV_ERR_INVALID_ARGUMENT;
+
+        if (!(event_file->f_flags & O_NONBLOCK)) {
+            status = NV_ERR_INVALID_ARGUMENT;
+            goto done;
+        }
+    }
+
+    uvm_va_space_down_read(va_space);
+    gpu = uvm_va_space_get_gpu_by_uuid_with_gpu_va_space(va_space, &params->gpu_uuid);
+    if (gpu)
+        gpu_dest_id = gpu->parent->is_integrated_gpu ? UVM_ID_CPU : gpu->id;
+    uvm_va_space_up_read(va_space);
+
+    if (!gpu) {
+        status = NV_ERR_INVALID_DEVICE;
+        goto done;
+    }
+
+    status = test_migrate_batch_invalid_params(filp);
+    if (status != NV_OK)
+        goto done;
+
+    // Synchronous batch
+    test_migrate_batch_fill(entries, params->base, params->length, &params->gpu_uuid);
+    TEST_NV_CHECK_GOTO(test_migrate_batch_run(va_space, entries, TEST_MIGRATE_BATCH_NUM_ENTRIES, 0, -1, &num_migrated),
+                       done);
+    TEST_CHECK_GOTO(num_migrated == TEST_MIGRATE_BATCH_NUM_ENTRIES, done);
+    TEST_NV_CHECK_GOTO(test_migrate_batch_check_resident(va_space, params->base, params->length, gpu_dest_id), done);
+
+    // Asynchronous batch without completion signaling. Residency is updated
+    // when the copies are pushed.
+    test_migrate_batch_fill(entries, params->base, params->length, &NV_PROCESSOR_UUID_CPU_DEFAULT);
+    TEST_NV_CHECK_GOTO(test_migrate_batch_run(va_space,
+                                              entries,
+                                              TEST_MIGRATE_BATCH_NUM_ENTRIES,
+                                              UVM_MIGRATE_FLAG_ASYNC,
+                                              -1,
+                                              &num_migrated),
+                       done);
+    TEST_CHECK_GOTO(num_migrated == TEST_MIGRATE_BATCH_NUM_ENTRIES, done);
+    TEST_NV_CHECK_GOTO(test_migrate_batch_check_resident(va_space, params->base, params->length, UVM_ID_CPU), done);
+
+    // Asynchronous batch signaled through the eventfd. Flushing the queue
+    // waits for the completion to run.
+    if (event_file) {
+        TEST_NV_CHECK_GOTO(test_migrate_batch_read_eventfd(event_file, &count), done);
+
+        test_migrate_batch_fill(entries, params->base, params->length, &params->gpu_uuid);
+        TEST_NV_CHECK_GOTO(test_migrate_batch_run(va_space,
+                                                  entries,
+                                                  TEST_MIGRATE_BATCH_NUM_ENTRIES,
+                                                  UVM_MIGRATE_FLAG_ASYNC,
+                                                  params->event_fd,
+                                                  &num_migrated),
+                           done);
+        TEST_CHECK_GOTO(num_migrated == TEST_MIGRATE_BATCH_NUM_ENTRIES, done);
+
+        nv_kthread_q_flush(&g_uvm_migrate_batch_q);
+
+        TEST_NV_CHECK_GOTO(test_migrate_batch_read_eventfd(event_file, &count), done);
+        TEST_CHECK_GOTO(count == 1, done);
+        TEST_NV_CHECK_GOTO(test_migrate_batch_check_resident(va_space, params->base, params->length, gpu_dest_id),
+                           done);
+
+        test_migrate_batch_fill(entries, params->base, params->length, &NV_PROCESSOR_UUID_CPU_DEFAULT);
+        TEST_NV_CHECK_GOTO(test_migrate_batch_run(va_space,
+                                                  entries,
+                                                  TEST_MIGRATE_BATCH_NUM_ENTRIES,
+                                                  0,
+                                                  -1,
+                                                  &num_migrated),
+                           done);
+    }
+
+    // A failing entry stops the batch, and numMigrated reports how far it got
+    test_migrate_batch_fill(entries, params->base, params->length, &params->gpu_uuid);
+    entries[1].base += 1;
+    status = test_migrate_batch_run(va_space, entries, TEST_MIGRATE_BATCH_NUM_ENTRIES, 0, -1, &num_migrated);
+    TEST_CHECK_GOTO(status == NV_ERR_INVALID_ADDRESS, done);
+    TEST_CHECK_GOTO(num_migrated == 1, done);
+    TEST_NV_CHECK_GOTO(test_migrate_batch_check_resident(va_space, params->base, entry_length, gpu_dest_id), done);
+
+    memset(&invalid_uuid, 0xff, sizeof(invalid_uuid));
+    test_migrate_batch_fill(entries, params->base, params->length, &invalid_uuid);
+    status = test_migrate_batch_run(va_space, entries, TEST_MIGRATE_BATCH_NUM_ENTRIES, 0, -1, &num_migrated);
+    TEST_CHECK_GOTO(status == NV_ERR_INVALID_DEVICE, done);
+    TEST_CHECK_GOTO(num_migrated == 0, done);
+
+    // Pageable memory only reachable through ATS is rejected
+    if (params->pageable_base != 0) {
+        uvm_api_range_type_t type;
+        struct mm_struct *mm;
+
+        mm = uvm_va_space_mm_or_current_retain_lock(va_space);
+        uvm_va_space_down_read(va_space);
+        type = uvm_api_range_type_check(va_space, mm, params->pageable_base, PAGE_SIZE);
+        uvm_va_space_up_read(va_space);
+        uvm_va_space_mm_or_current_release_unlock(va_space, mm);
+
+        if (type == UVM_API_RANGE_TYPE_ATS) {
+            test_migrate_batch_fill(entries, params->base, params->length, &params->gpu_uuid);
+            entries[1].base = params->pageable_base;
+            entries[1].length = PAGE_SIZE;
+
+            status = test_migrate_batch_run(va_space, entries, 2, 0, -1, &num_migrated);
+            TEST_CHECK_GOTO(status == NV_ERR_NOT_SUPPORTED, done);
+            TEST_CHECK_GOTO(num_migrated == 1, done);
+
+            params->ats_rejected = NV_TRUE;
+        }
+    }
+
+    status = NV_OK;
+
+done:
+    if (event_file)
+        fput(event_file);
+
+    return status;
+}
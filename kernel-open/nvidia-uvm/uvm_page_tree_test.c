@@ -296,14 +296,48 @@ static bool assert_invalidate_range_specific(fake_tlb_invalidate_t *inval,
     return true;
 }
 
+// Find an invalidate of a range fully covering [base, base + size), excluding
+// invalidate all.
+static fake_tlb_invalidate_t *find_covering_invalidate(NvU64 base, NvU64 size)
+{
+    NvU32 i;
+
+    for (i = 0; i < g_fake_invals_count; ++i) {
+        fake_tlb_invalidate_t *inval = &g_fake_invals[i];
+
+        if (inval->base == 0 && inval->size == -1)
+            continue;
+
+        if (inval->base <= base && inval->base + inval->size >= base + size)
+            return inval;
+    }
+
+    return NULL;
+}
+
+static NvU32 count_invalidate_all(void)
+{
+    NvU32 count = 0;
+    NvU32 i;
+
+    for (i = 0; i < g_fake_invals_count; ++i) {
+        if (g_fake_invals[i].base == 0 && g_fake_invals[i].size == -1)
+            ++count;
+    }
+
+    return count;
+}
+
 static bool assert_invalidate_range(NvU64 base,
                                     NvU64 size,
                                     NvU64 page_size,
                                     bool allow_inval_all,
+                                    bool allow_merged,
                                     NvU32 range_depth,
                                     NvU32 all_depth,
                                     bool expected_membar)
 {
+    fake_tlb_invalidate_t *merged;
     NvU32 i;
 
     UVM_ASSERT(g_fake_tlb_invals_tracking_enabled);
@@ -323,6 +357,12 @@ static bool assert_invalidate_range(NvU64 base,
     if (g_fake_invals_count == 1 && allow_inval_all)
         return assert_last_invalidate_all(all_depth, expected_membar);
 
+    // A range merged with its neighbours is invalidated with the smallest page
+    // size and the broadest depth across all of them.
+    merged = allow_merged ? find_covering_invalidate(base, size) : NULL;
+    if (merged && merged->depth <= range_depth && merged->page_size <= page_size)
+        return true;
+
     UVM_TEST_PRINT("Couldn't find an invalidate for range [0x%llx, 0x%llx) in:\n", base, base + size);
     for (i = 0; i < g_fake_invals_count; ++i) {
         fake_tlb_invalidate_t *inval = &g_fake_invals[i];
@@ -1381,10 +1421,16 @@ static NV_STATUS test_tlb_batch_invalidates_case(uvm_page_tree_t *tree,
             bool allow_inval_all = (total_pages > gpu->parent->tlb_batch.max_pages) ||
                                    !gpu->parent->tlb_batch.va_invalidate_supported ||
                                    (i > UVM_TLB_BATCH_MAX_ENTRIES);
+
+            // Past the number of ranges a per VA invalidate can issue, ranges
+            // separated by small gaps get merged.
+            bool allow_merged = gpu->parent->tlb_batch.va_range_invalidate_supported &&
+                                (i > gpu->parent->tlb_batch.max_ranges || i > UVM_TLB_BATCH_MAX_ENTRIES);
             TEST_CHECK_RET(assert_invalidate_range(base + (NvU64)j * 2 * size,
                                                    size,
                                                    min_page_size,
                                                    allow_inval_all,
+                                                   allow_merged,
                                                    expected_range_depth,
                                                    expected_inval_all_depth,
                                                    false));
@@ -1433,6 +1479,98 @@ done:
     return status;
 }
 
+// Queue up num_pages 4K invalidates, stride bytes apart, in reverse order so
+// that the batch has to keep its ranges sorted.
+static void tlb_batch_invalidate_strided(uvm_tlb_batch_t *batch, NvU64 base, NvU64 stride, NvU32 num_pages)
+{
+    NvU32 i;
+
+    for (i = num_pages; i > 0; --i)
+        uvm_tlb_batch_invalidate(batch, base + (i - 1) * stride, UVM_PAGE_SIZE_4K, UVM_PAGE_SIZE_4K, UVM_MEMBAR_NONE);
+}
+
+static bool assert_strided_pages_invalidated(NvU64 base, NvU64 stride, NvU32 num_pages)
+{
+    NvU32 i;
+
+    for (i = 0; i < num_pages; ++i) {
+        NvU64 addr = base + i * stride;
+
+        if (!find_covering_invalidate(addr, UVM_PAGE_SIZE_4K)) {
+            UVM_TEST_PRINT("Page 0x%llx not invalidated\n", addr);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Fragmented unmaps used to exceed the four tracked ranges and fall back to an
+// invalidate all. Check that the batch merges ranges instead, and only falls
+// back to invalidate all when the ranges are too far apart.
+static NV_STATUS test_tlb_batch_fragmented(uvm_gpu_t *gpu)
+{
+    NV_STATUS status = NV_OK;
+    uvm_page_tree_t tree;
+    uvm_tlb_batch_t batch;
+    uvm_push_t push;
+    const NvU32 num_pages = 3 * UVM_TLB_BATCH_MAX_ENTRIES;
+    const NvU64 base = 64 * UVM_PAGE_SIZE_2M;
+
+    // Merging ranges only pays off on GPUs which invalidate a range with a
+    // single method.
+    TEST_CHECK_RET(gpu->parent->tlb_batch.va_range_invalidate_supported);
+
+    MEM_NV_CHECK_RET(test_page_tree_init(gpu, BIG_PAGE_SIZE_PASCAL, &tree), NV_OK);
+    TEST_NV_CHECK_GOTO(uvm_push_begin_fake(gpu, &push), done);
+
+    fake_tlb_invals_enable();
+
+    // Contiguous pages queued up one by one end up as a single range
+    uvm_tlb_batch_begin(&tree, &batch);
+    tlb_batch_invalidate_strided(&batch, base, UVM_PAGE_SIZE_4K, num_pages);
+    uvm_tlb_batch_end(&batch, &push, UVM_MEMBAR_NONE);
+    TEST_CHECK_GOTO(g_fake_invals_count == 1, disable);
+    TEST_CHECK_GOTO(g_last_fake_inval->base == base, disable);
+    TEST_CHECK_GOTO(g_last_fake_inval->size == num_pages * UVM_PAGE_SIZE_4K, disable);
+    fake_tlb_invals_reset();
+
+    // Every other 64K page of a few VA blocks
+    uvm_tlb_batch_begin(&tree, &batch);
+    tlb_batch_invalidate_strided(&batch, base, UVM_PAGE_SIZE_64K, num_pages);
+    uvm_tlb_batch_end(&batch, &push, UVM_MEMBAR_NONE);
+    TEST_CHECK_GOTO(count_invalidate_all() == 0, disable);
+    TEST_CHECK_GOTO(g_fake_invals_count <= gpu->parent->tlb_batch.max_ranges, disable);
+    TEST_CHECK_GOTO(assert_strided_pages_invalidated(base, UVM_PAGE_SIZE_64K, num_pages), disable);
+    fake_tlb_invals_reset();
+
+    // The same pattern repeated twice, the second time with overlapping
+    // ranges, doesn't need any more ranges.
+    uvm_tlb_batch_begin(&tree, &batch);
+    tlb_batch_invalidate_strided(&batch, base, UVM_PAGE_SIZE_64K, num_pages);
+    tlb_batch_invalidate_strided(&batch, base, UVM_PAGE_SIZE_64K, num_pages);
+    uvm_tlb_batch_end(&batch, &push, UVM_MEMBAR_NONE);
+    TEST_CHECK_GOTO(count_invalidate_all() == 0, disable);
+    TEST_CHECK_GOTO(assert_strided_pages_invalidated(base, UVM_PAGE_SIZE_64K, num_pages), disable);
+    fake_tlb_invals_reset();
+
+    // Pages far apart can't be merged so a single invalidate all is used
+    uvm_tlb_batch_begin(&tree, &batch);
+    tlb_batch_invalidate_strided(&batch, base, 4 * UVM_PAGE_SIZE_2M, num_pages);
+    uvm_tlb_batch_end(&batch, &push, UVM_MEMBAR_NONE);
+    TEST_CHECK_GOTO(g_fake_invals_count == 1, disable);
+    TEST_CHECK_GOTO(count_invalidate_all() == 1, disable);
+
+disable:
+    fake_tlb_invals_disable();
+    uvm_push_end_fake(&push);
+
+done:
+    uvm_page_tree_deinit(&tree);
+
+    return status;
+}
+
 typedef struct
 {
     NvU64 count;
@@ -2768,6 +2906,8 @@ static NV_STATUS ampere_test_page_tree(uvm_gpu_t *ampere)
     MEM_NV_CHECK_RET(test_tlb_batch_invalidates(ampere, page_sizes, num_page_sizes), NV_OK);
     ampere->parent->tlb_batch.va_invalidate_supported = true;
 
+    MEM_NV_CHECK_RET(test_tlb_batch_fragmented(ampere), NV_OK);
+
     for (i = 0; i < num_page_sizes; i++) {
         MEM_NV_CHECK_RET(shrink_test(ampere, BIG_PAGE_SIZE_PASCAL, page_sizes[i]), NV_OK);
         MEM_NV_CHECK_RET(get_upper_test(ampere, BIG_PAGE_SIZE_PASCAL, page_sizes[i]), NV_OK);
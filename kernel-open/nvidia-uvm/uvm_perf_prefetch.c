@@ -29,6 +29,7 @@
 #include "uvm_kvmalloc.h"
 #include "uvm_va_block.h"
 #include "uvm_va_range.h"
+#include "uvm_va_space.h"
 #include "uvm_test.h"
 
 //
@@ -55,14 +56,79 @@ static unsigned uvm_perf_prefetch_threshold  = UVM_PREFETCH_THRESHOLD_DEFAULT;
 // logic
 static unsigned uvm_perf_prefetch_min_faults = UVM_PREFETCH_MIN_FAULTS_DEFAULT;
 
+// Enable/disable the per-VA range adaptation of the prefetch threshold
+static unsigned uvm_perf_prefetch_adaptive = 1;
+
+#define UVM_PREFETCH_THRESHOLD_MIN_DEFAULT 25
+#define UVM_PREFETCH_THRESHOLD_MAX_DEFAULT 90
+
+// Bounds of the adaptive prefetch threshold
+//
+// Valid values 1-100
+static unsigned uvm_perf_prefetch_threshold_min = UVM_PREFETCH_THRESHOLD_MIN_DEFAULT;
+static unsigned uvm_perf_prefetch_threshold_max = UVM_PREFETCH_THRESHOLD_MAX_DEFAULT;
+
+// Number of prefetched pages that need to be accounted as used or wasted
+// before the threshold of a VA range is reevaluated
+#define UVM_PREFETCH_ADAPTIVE_WINDOW_PAGES 512
+
+// Percentage of wasted prefetched pages above which the threshold is raised,
+// and below which it is lowered
+#define UVM_PREFETCH_ADAPTIVE_WASTE_HIGH 20
+#define UVM_PREFETCH_ADAPTIVE_WASTE_LOW  5
+
+// Amount by which the threshold is raised or lowered on each update
+#define UVM_PREFETCH_ADAPTIVE_STEP 5
+
+// Enable/disable the cross-VA-block stream prefetcher
+static unsigned uvm_perf_prefetch_stream_enable = 1;
+
+#define UVM_PREFETCH_STREAM_DEPTH_MIN     1
+#define UVM_PREFETCH_STREAM_DEPTH_DEFAULT 4
+#define UVM_PREFETCH_STREAM_DEPTH_MAX     32
+
+// Number of VA blocks ahead of the last faulting block that are migrated once
+// a stream has been detected
+static unsigned uvm_perf_prefetch_stream_depth = UVM_PREFETCH_STREAM_DEPTH_DEFAULT;
+
+#define UVM_PREFETCH_STREAM_CONFIDENCE_MIN     1
+#define UVM_PREFETCH_STREAM_CONFIDENCE_DEFAULT 2
+#define UVM_PREFETCH_STREAM_CONFIDENCE_MAX     16
+
+// Number of consecutive faulting blocks that need to follow the same stride
+// before the stream prefetcher starts migrating blocks ahead of the stream
+static unsigned uvm_perf_prefetch_stream_confidence = UVM_PREFETCH_STREAM_CONFIDENCE_DEFAULT;
+
+#define UVM_PREFETCH_STREAM_BLOCKS_PER_FAULT_DEFAULT 2
+
+// Maximum number of VA blocks migrated ahead of the stream while servicing a
+// single faulting block. This bounds the work added to the fault servicing
+// path, the prefetch window grows up to uvm_perf_prefetch_stream_depth over
+// several faults.
+static unsigned uvm_perf_prefetch_stream_blocks_per_fault = UVM_PREFETCH_STREAM_BLOCKS_PER_FAULT_DEFAULT;
+
 // Module parameters for the tunables
 module_param(uvm_perf_prefetch_enable, uint, S_IRUGO);
 module_param(uvm_perf_prefetch_threshold, uint, S_IRUGO);
 module_param(uvm_perf_prefetch_min_faults, uint, S_IRUGO);
+module_param(uvm_perf_prefetch_adaptive, uint, S_IRUGO);
+module_param(uvm_perf_prefetch_threshold_min, uint, S_IRUGO);
+module_param(uvm_perf_prefetch_threshold_max, uint, S_IRUGO);
+module_param(uvm_perf_prefetch_stream_enable, uint, S_IRUGO);
+module_param(uvm_perf_prefetch_stream_depth, uint, S_IRUGO);
+module_param(uvm_perf_prefetch_stream_confidence, uint, S_IRUGO);
+module_param(uvm_perf_prefetch_stream_blocks_per_fault, uint, S_IRUGO);
 
 static bool g_uvm_perf_prefetch_enable;
 static unsigned g_uvm_perf_prefetch_threshold;
 static unsigned g_uvm_perf_prefetch_min_faults;
+static bool g_uvm_perf_prefetch_adaptive;
+static unsigned g_uvm_perf_prefetch_threshold_min;
+static unsigned g_uvm_perf_prefetch_threshold_max;
+static bool g_uvm_perf_prefetch_stream_enable;
+static unsigned g_uvm_perf_prefetch_stream_depth;
+static unsigned g_uvm_perf_prefetch_stream_confidence;
+static unsigned g_uvm_perf_prefetch_stream_blocks_per_fault;
 
 void uvm_perf_prefetch_bitmap_tree_iter_init(const uvm_perf_prefetch_bitmap_tree_t *bitmap_tree,
                                              uvm_page_index_t page_index,
@@ -101,7 +167,8 @@ NvU16 uvm_perf_prefetch_bitmap_tree_iter_get_count(const uvm_perf_prefetch_bitma
 
 static uvm_va_block_region_t compute_prefetch_region(uvm_page_index_t page_index,
                                                      uvm_perf_prefetch_bitmap_tree_t *bitmap_tree,
-                                                     uvm_va_block_region_t max_prefetch_region)
+                                                     uvm_va_block_region_t max_prefetch_region,
+                                                     unsigned threshold)
 {
     NvU16 counter;
     uvm_perf_prefetch_bitmap_tree_iter_t iter;
@@ -115,7 +182,7 @@ static uvm_va_block_region_t compute_prefetch_region(uvm_page_index_t page_index
         NvU16 subregion_pages = uvm_va_block_region_num_pages(subregion);
 
         UVM_ASSERT(counter <= subregion_pages);
-        if (counter * 100 > subregion_pages * g_uvm_perf_prefetch_threshold)
+        if (counter * 100 > subregion_pages * threshold)
             prefetch_region = subregion;
     }
 
@@ -300,6 +367,7 @@ static void compute_prefetch_mask(uvm_va_block_region_t faulted_region,
                                   uvm_va_block_region_t max_prefetch_region,
                                   uvm_perf_prefetch_bitmap_tree_t *bitmap_tree,
                                   const uvm_page_mask_t *faulted_pages,
+                                  unsigned threshold,
                                   uvm_page_mask_t *out_prefetch_mask)
 {
     uvm_page_index_t page_index;
@@ -308,7 +376,10 @@ static void compute_prefetch_mask(uvm_va_block_region_t faulted_region,
 
     // Update the tree using the faulted mask to compute the pages to prefetch.
     for_each_va_block_page_in_region_mask(page_index, faulted_pages, faulted_region) {
-        uvm_va_block_region_t region = compute_prefetch_region(page_index, bitmap_tree, max_prefetch_region);
+        uvm_va_block_region_t region = compute_prefetch_region(page_index,
+                                                               bitmap_tree,
+                                                               max_prefetch_region,
+                                                               threshold);
 
         uvm_page_mask_region_fill(out_prefetch_mask, region);
 
@@ -318,6 +389,115 @@ static void compute_prefetch_mask(uvm_va_block_region_t faulted_region,
     }
 }
 
+void uvm_perf_prefetch_adaptive_init(uvm_perf_prefetch_adaptive_t *adaptive)
+{
+    memset(adaptive, 0, sizeof(*adaptive));
+    uvm_spin_lock_init(&adaptive->lock, UVM_LOCK_ORDER_LEAF);
+
+    adaptive->threshold = g_uvm_perf_prefetch_threshold;
+}
+
+static unsigned prefetch_threshold(uvm_va_block_t *va_block)
+{
+    if (!g_uvm_perf_prefetch_adaptive || !va_block->managed_range)
+        return g_uvm_perf_prefetch_threshold;
+
+    return READ_ONCE(va_block->managed_range->prefetch_adaptive.threshold);
+}
+
+// Account prefetched pages and reevaluate the threshold of the VA range once
+// enough pages have been accounted.
+static void prefetch_adaptive_update(uvm_perf_prefetch_adaptive_t *adaptive, NvU32 used_pages, NvU32 wasted_pages)
+{
+    NvU32 total_pages;
+
+    uvm_spin_lock(&adaptive->lock);
+
+    adaptive->used_pages += used_pages;
+    adaptive->wasted_pages += wasted_pages;
+
+    total_pages = adaptive->used_pages + adaptive->wasted_pages;
+    if (total_pages >= UVM_PREFETCH_ADAPTIVE_WINDOW_PAGES) {
+        NvU32 waste = adaptive->wasted_pages * 100 / total_pages;
+        unsigned threshold = adaptive->threshold;
+
+        // A higher threshold requires a denser fault pattern before the
+        // remaining pages of a region are prefetched
+        if (waste > UVM_PREFETCH_ADAPTIVE_WASTE_HIGH && threshold < g_uvm_perf_prefetch_threshold_max) {
+            threshold = min(threshold + UVM_PREFETCH_ADAPTIVE_STEP, g_uvm_perf_prefetch_threshold_max);
+            ++adaptive->num_raises;
+        }
+        else if (waste < UVM_PREFETCH_ADAPTIVE_WASTE_LOW && threshold > g_uvm_perf_prefetch_threshold_min) {
+            threshold = max(threshold, g_uvm_perf_prefetch_threshold_min + UVM_PREFETCH_ADAPTIVE_STEP) -
+                        UVM_PREFETCH_ADAPTIVE_STEP;
+            ++adaptive->num_lowers;
+        }
+
+        WRITE_ONCE(adaptive->threshold, threshold);
+
+        adaptive->used_pages = 0;
+        adaptive->wasted_pages = 0;
+    }
+
+    uvm_spin_unlock(&adaptive->lock);
+}
+
+// Called on a new fault migration to the processor the block last prefetched
+// to. Prefetched pages that are still resident there, or that are being
+// faulted on again (for example, to upgrade the access permissions), have
+// survived until the next fault on the block and are accounted as used.
+static void prefetch_adaptive_account_used(uvm_va_block_t *va_block,
+                                           uvm_va_block_context_t *va_block_context,
+                                           const uvm_page_mask_t *resident_mask,
+                                           const uvm_page_mask_t *faulted_pages)
+{
+    uvm_page_mask_t *prefetched_pages = &va_block->prefetch_info.prefetched_pages;
+    uvm_page_mask_t *used_pages = &va_block_context->scratch_page_mask;
+    NvU32 num_used;
+
+    if (!g_uvm_perf_prefetch_adaptive || !va_block->managed_range || uvm_page_mask_empty(prefetched_pages))
+        return;
+
+    if (resident_mask)
+        uvm_page_mask_or(used_pages, resident_mask, faulted_pages);
+    else
+        uvm_page_mask_copy(used_pages, faulted_pages);
+
+    num_used = uvm_page_mask_and_weight(used_pages, used_pages, prefetched_pages);
+
+    uvm_page_mask_zero(prefetched_pages);
+
+    if (num_used > 0)
+        prefetch_adaptive_update(&va_block->managed_range->prefetch_adaptive, num_used, 0);
+}
+
+void uvm_perf_prefetch_notify_eviction(uvm_va_block_t *va_block,
+                                       uvm_processor_id_t id,
+                                       const uvm_page_mask_t *evicted_pages)
+{
+    uvm_page_mask_t *prefetched_pages = &va_block->prefetch_info.prefetched_pages;
+    NvU32 num_wasted;
+
+    uvm_assert_mutex_locked(&va_block->lock);
+
+    if (!g_uvm_perf_prefetch_adaptive || !va_block->managed_range)
+        return;
+
+    if (!uvm_id_equal(va_block->prefetch_info.last_migration_proc_id, id))
+        return;
+
+    num_wasted = uvm_page_mask_weight(prefetched_pages);
+    if (num_wasted == 0)
+        return;
+
+    // Prefetched pages evicted before the next fault on the block are
+    // considered untouched
+    num_wasted -= uvm_page_mask_andnot_weight(prefetched_pages, prefetched_pages, evicted_pages);
+
+    if (num_wasted > 0)
+        prefetch_adaptive_update(&va_block->managed_range->prefetch_adaptive, 0, num_wasted);
+}
+
 // Determine whether prefetching should be applied for the given migration.
 //
 // This function evaluates multiple conditions to decide if prefetching is
@@ -394,6 +574,10 @@ static NvU32 uvm_perf_prefetch_prenotify_fault_migrations(uvm_va_block_t *va_blo
     if (!uvm_id_equal(va_block->prefetch_info.last_migration_proc_id, new_residency)) {
         va_block->prefetch_info.last_migration_proc_id = new_residency;
         va_block->prefetch_info.fault_migrations_to_last_proc = 0;
+
+        // The block moved on to a different processor, so there is no
+        // feedback about the pages prefetched to the previous one
+        uvm_page_mask_zero(&va_block->prefetch_info.prefetched_pages);
     }
 
     // Compute the expanded region that prefetching is allowed from.
@@ -412,6 +596,8 @@ static NvU32 uvm_perf_prefetch_prenotify_fault_migrations(uvm_va_block_t *va_blo
     if (UVM_ID_IS_CPU(new_residency) || va_block->gpus[uvm_id_gpu_index(new_residency)] != NULL)
         resident_mask = uvm_va_block_resident_mask_get(va_block, new_residency, NUMA_NO_NODE);
 
+    prefetch_adaptive_account_used(va_block, va_block_context, resident_mask, faulted_pages);
+
     // - If this is a first-touch fault and the destination processor is the
     //   preferred location, populate the whole max_prefetch_region.
     // - Do not prefetch pages out of the preferred location (policy location
@@ -441,6 +627,7 @@ static NvU32 uvm_perf_prefetch_prenotify_fault_migrations(uvm_va_block_t *va_blo
                               max_prefetch_region,
                               bitmap_tree,
                               &va_block_context->scratch_page_mask,
+                              prefetch_threshold(va_block),
                               prefetch_pages);
     }
 
@@ -460,11 +647,11 @@ static NvU32 uvm_perf_prefetch_prenotify_fault_migrations(uvm_va_block_t *va_blo
         uvm_page_mask_andnot(prefetch_pages, prefetch_pages, &va_block_context->scratch_page_mask);
     }
 
+    va_block->prefetch_info.fault_migrations_to_last_proc += uvm_page_mask_region_weight(faulted_pages, faulted_region);
+
     // Avoid prefetching pages that are thrashing
     if (thrashing_pages)
-        uvm_page_mask_andnot(prefetch_pages, prefetch_pages, thrashing_pages);
-
-    va_block->prefetch_info.fault_migrations_to_last_proc += uvm_page_mask_region_weight(faulted_pages, faulted_region);
+        return uvm_page_mask_andnot_weight(prefetch_pages, prefetch_pages, thrashing_pages);
 
     return uvm_page_mask_weight(prefetch_pages);
 }
@@ -498,7 +685,12 @@ void uvm_perf_prefetch_compute_ats(uvm_va_space_t *va_space,
 
     init_bitmap_tree_from_region(bitmap_tree, max_prefetch_region, residency_mask, faulted_pages);
 
-    compute_prefetch_mask(faulted_region, max_prefetch_region, bitmap_tree, faulted_pages, out_prefetch_mask);
+    compute_prefetch_mask(faulted_region,
+                          max_prefetch_region,
+                          bitmap_tree,
+                          faulted_pages,
+                          g_uvm_perf_prefetch_threshold,
+                          out_prefetch_mask);
 }
 
 void uvm_perf_prefetch_get_hint_va_block(uvm_va_block_t *va_block,
@@ -553,8 +745,211 @@ void uvm_perf_prefetch_get_hint_va_block(uvm_va_block_t *va_block,
         if (changed)
             pending_prefetch_pages = uvm_page_mask_weight(prefetch_pages);
 
-        if (pending_prefetch_pages > 0)
+        if (pending_prefetch_pages > 0) {
             out_hint->residency = va_block->prefetch_info.last_migration_proc_id;
+
+            if (g_uvm_perf_prefetch_adaptive && va_block->managed_range) {
+                uvm_page_mask_or(&va_block->prefetch_info.prefetched_pages,
+                                 &va_block->prefetch_info.prefetched_pages,
+                                 prefetch_pages);
+            }
+        }
+    }
+}
+
+void uvm_perf_prefetch_stream_init(uvm_perf_prefetch_stream_t *stream)
+{
+    memset(stream, 0, sizeof(*stream));
+    uvm_spin_lock_init(&stream->lock, UVM_LOCK_ORDER_LEAF);
+}
+
+// Whether whole blocks of the managed range can be speculatively migrated to
+// the given GPU
+static bool stream_prefetch_allowed(uvm_va_range_managed_t *managed_range, uvm_gpu_t *gpu)
+{
+    uvm_va_space_t *va_space = managed_range->va_range.va_space;
+    const uvm_va_policy_t *policy = &managed_range->policy;
+
+    if (!uvm_perf_prefetch_enabled(va_space))
+        return false;
+
+    // Do not prefetch out of the preferred location, and leave read
+    // duplication to the regular fault path
+    if (UVM_ID_IS_VALID(policy->preferred_location) && !uvm_id_equal(policy->preferred_location, gpu->id))
+        return false;
+
+    if (uvm_va_policy_is_read_duplicate(policy, va_space))
+        return false;
+
+    return !uvm_processor_mask_test(&managed_range->uvm_lite_gpus, gpu->id);
+}
+
+// Migrate the block at the given index of the managed range to the GPU.
+// Returns whether the block was prefetched.
+static bool stream_prefetch_block(uvm_va_range_managed_t *managed_range,
+                                  size_t index,
+                                  uvm_gpu_t *gpu,
+                                  uvm_service_block_context_t *service_context)
+{
+    uvm_va_space_t *va_space = managed_range->va_range.va_space;
+    uvm_va_block_retry_t va_block_retry;
+    uvm_va_block_t *va_block;
+    NV_STATUS status;
+
+    status = uvm_va_range_block_create(managed_range, index, &va_block);
+    if (status != NV_OK)
+        return false;
+
+    if (!uvm_range_group_all_migratable(va_space, va_block->start, va_block->end))
+        return false;
+
+    // Blocks that are thrashing are handled by the thrashing mitigation logic
+    if (uvm_perf_thrashing_get_thrashing_pages(va_block))
+        return false;
+
+    // A speculative migration isn't worth evicting other blocks, which may be
+    // in use, so give up if the GPU is out of free memory.
+    uvm_va_block_retry_init(&va_block_retry);
+    va_block_retry.no_eviction = true;
+
+    uvm_mutex_lock(&va_block->lock);
+
+    // Migrations are only tracked by the block's tracker so that fault
+    // servicing does not wait for them. Any later operation on the block will.
+    do {
+        status = uvm_va_block_migrate_locked(va_block,
+                                             &va_block_retry,
+                                             service_context,
+                                             uvm_va_block_region_from_block(va_block),
+                                             gpu->id,
+                                             UVM_MIGRATE_MODE_MAKE_RESIDENT_AND_MAP,
+                                             UVM_MAKE_RESIDENT_CAUSE_PREFETCH,
+                                             NULL);
+    } while (status == NV_ERR_MORE_PROCESSING_REQUIRED);
+
+    uvm_mutex_unlock(&va_block->lock);
+
+    uvm_va_block_retry_deinit(&va_block_retry, va_block);
+
+    return status == NV_OK;
+}
+
+// Update the stream detector after the block at index took a fault. Returns in
+// update the accounting of the previous prefetches, and the steps along
+// update->stride to prefetch, if any (stride is 0 otherwise). At most
+// max_new_blocks blocks are claimed for prefetching by a single update.
+//
+// Locking: the stream lock must be held.
+static void stream_update(uvm_perf_prefetch_stream_t *stream,
+                          size_t index,
+                          NvU32 depth,
+                          NvU32 confidence,
+                          NvU32 max_new_blocks,
+                          uvm_perf_prefetch_stream_update_t *update)
+{
+    long delta;
+
+    memset(update, 0, sizeof(*update));
+
+    if (!stream->valid) {
+        stream->valid = true;
+        stream->last_index = index;
+        return;
+    }
+
+    // Faults on the same block are usually split across several batches
+    delta = (long)index - (long)stream->last_index;
+    if (delta == 0)
+        return;
+
+    if (stream->stride != 0 &&
+        delta % stream->stride == 0 &&
+        delta / stream->stride > 0 &&
+        delta / stream->stride <= (long)stream->num_prefetched + 1) {
+        NvU32 steps = delta / stream->stride;
+
+        // The stream went past the prefetched blocks in between without
+        // faulting on them. If the faulting block itself was prefetched, it
+        // still faulted.
+        if (stream->confidence >= confidence) {
+            update->num_hits = min(steps - 1, stream->num_prefetched);
+            update->num_misses = 1;
+        }
+
+        stream->num_prefetched -= min(steps, stream->num_prefetched);
+        if (stream->confidence < UVM_PREFETCH_STREAM_CONFIDENCE_MAX)
+            ++stream->confidence;
+    }
+    else {
+        // Start learning a new stride. Blocks prefetched for the previous
+        // stream are simply left where they are.
+        stream->stride = delta;
+        stream->confidence = 0;
+        stream->num_prefetched = 0;
+    }
+
+    stream->last_index = index;
+
+    if (stream->confidence >= confidence && stream->num_prefetched < depth) {
+        update->stride = stream->stride;
+        update->first_step = stream->num_prefetched + 1;
+        update->last_step = min(depth, stream->num_prefetched + max_new_blocks);
+
+        // Claim the blocks before dropping the lock so that concurrent
+        // notifications do not prefetch them again
+        stream->num_prefetched = update->last_step;
+    }
+}
+
+void uvm_perf_prefetch_stream_notify(uvm_va_block_t *va_block,
+                                     uvm_gpu_t *gpu,
+                                     uvm_service_block_context_t *service_context)
+{
+    uvm_va_range_managed_t *managed_range = va_block->managed_range;
+    uvm_perf_prefetch_stream_update_t update;
+    uvm_perf_prefetch_stream_t *stream;
+    size_t num_blocks;
+    size_t index;
+    NvU32 num_prefetched = 0;
+    NvU32 step;
+
+    if (!g_uvm_perf_prefetch_stream_enable || !managed_range)
+        return;
+
+    uvm_assert_rwsem_locked(&managed_range->va_range.va_space->lock);
+
+    if (!stream_prefetch_allowed(managed_range, gpu))
+        return;
+
+    stream = &managed_range->prefetch_stream;
+    num_blocks = uvm_va_range_num_blocks(managed_range);
+    index = uvm_va_range_block_index(managed_range, va_block->start);
+
+    uvm_spin_lock(&stream->lock);
+    stream_update(stream,
+                  index,
+                  g_uvm_perf_prefetch_stream_depth,
+                  g_uvm_perf_prefetch_stream_confidence,
+                  g_uvm_perf_prefetch_stream_blocks_per_fault,
+                  &update);
+    stream->num_hits += update.num_hits;
+    stream->num_misses += update.num_misses;
+    uvm_spin_unlock(&stream->lock);
+
+    for (step = update.first_step; update.stride != 0 && step <= update.last_step; step++) {
+        long target = (long)index + (long)step * update.stride;
+
+        if (target < 0 || target >= (long)num_blocks)
+            break;
+
+        if (stream_prefetch_block(managed_range, target, gpu, service_context))
+            ++num_prefetched;
+    }
+
+    if (num_prefetched > 0) {
+        uvm_spin_lock(&stream->lock);
+        stream->num_prefetched_blocks += num_prefetched;
+        uvm_spin_unlock(&stream->lock);
     }
 }
 
@@ -588,6 +983,204 @@ NV_STATUS uvm_perf_prefetch_init(void)
         g_uvm_perf_prefetch_min_faults = UVM_PREFETCH_MIN_FAULTS_DEFAULT;
     }
 
+    g_uvm_perf_prefetch_adaptive = uvm_perf_prefetch_adaptive != 0;
+
+    if (uvm_perf_prefetch_threshold_min >= 1 &&
+        uvm_perf_prefetch_threshold_min <= uvm_perf_prefetch_threshold_max &&
+        uvm_perf_prefetch_threshold_max <= 100) {
+        g_uvm_perf_prefetch_threshold_min = uvm_perf_prefetch_threshold_min;
+        g_uvm_perf_prefetch_threshold_max = uvm_perf_prefetch_threshold_max;
+    }
+    else {
+        UVM_INFO_PRINT("Invalid values %u-%u for uvm_perf_prefetch_threshold_min-max. Using %u-%u instead\n",
+                       uvm_perf_prefetch_threshold_min,
+                       uvm_perf_prefetch_threshold_max,
+                       UVM_PREFETCH_THRESHOLD_MIN_DEFAULT,
+                       UVM_PREFETCH_THRESHOLD_MAX_DEFAULT);
+
+        g_uvm_perf_prefetch_threshold_min = UVM_PREFETCH_THRESHOLD_MIN_DEFAULT;
+        g_uvm_perf_prefetch_threshold_max = UVM_PREFETCH_THRESHOLD_MAX_DEFAULT;
+    }
+
+    g_uvm_perf_prefetch_stream_enable = uvm_perf_prefetch_stream_enable != 0;
+
+    if (uvm_perf_prefetch_stream_depth >= UVM_PREFETCH_STREAM_DEPTH_MIN &&
+        uvm_perf_prefetch_stream_depth <= UVM_PREFETCH_STREAM_DEPTH_MAX) {
+        g_uvm_perf_prefetch_stream_depth = uvm_perf_prefetch_stream_depth;
+    }
+    else {
+        UVM_INFO_PRINT("Invalid value %u for uvm_perf_prefetch_stream_depth. Using %u instead\n",
+                       uvm_perf_prefetch_stream_depth,
+                       UVM_PREFETCH_STREAM_DEPTH_DEFAULT);
+
+        g_uvm_perf_prefetch_stream_depth = UVM_PREFETCH_STREAM_DEPTH_DEFAULT;
+    }
+
+    if (uvm_perf_prefetch_stream_confidence >= UVM_PREFETCH_STREAM_CONFIDENCE_MIN &&
+        uvm_perf_prefetch_stream_confidence <= UVM_PREFETCH_STREAM_CONFIDENCE_MAX) {
+        g_uvm_perf_prefetch_stream_confidence = uvm_perf_prefetch_stream_confidence;
+    }
+    else {
+        UVM_INFO_PRINT("Invalid value %u for uvm_perf_prefetch_stream_confidence. Using %u instead\n",
+                       uvm_perf_prefetch_stream_confidence,
+                       UVM_PREFETCH_STREAM_CONFIDENCE_DEFAULT);
+
+        g_uvm_perf_prefetch_stream_confidence = UVM_PREFETCH_STREAM_CONFIDENCE_DEFAULT;
+    }
+
+    if (uvm_perf_prefetch_stream_blocks_per_fault >= 1 &&
+        uvm_perf_prefetch_stream_blocks_per_fault <= g_uvm_perf_prefetch_stream_depth) {
+        g_uvm_perf_prefetch_stream_blocks_per_fault = uvm_perf_prefetch_stream_blocks_per_fault;
+    }
+    else {
+        UVM_INFO_PRINT("Invalid value %u for uvm_perf_prefetch_stream_blocks_per_fault. Using %u instead\n",
+                       uvm_perf_prefetch_stream_blocks_per_fault,
+                       min(UVM_PREFETCH_STREAM_BLOCKS_PER_FAULT_DEFAULT, g_uvm_perf_prefetch_stream_depth));
+
+        g_uvm_perf_prefetch_stream_blocks_per_fault = min(UVM_PREFETCH_STREAM_BLOCKS_PER_FAULT_DEFAULT,
+                                                          g_uvm_perf_prefetch_stream_depth);
+    }
+
+    return NV_OK;
+}
+
+NV_STATUS uvm_test_get_prefetch_adaptive_state(UVM_TEST_GET_PREFETCH_ADAPTIVE_STATE_PARAMS *params, struct file *filp)
+{
+    uvm_va_space_t *va_space = uvm_va_space_get(filp);
+    uvm_va_range_managed_t *managed_range;
+    uvm_perf_prefetch_adaptive_t *adaptive;
+    NV_STATUS status = NV_OK;
+
+    uvm_va_space_down_read(va_space);
+
+    managed_range = uvm_va_range_managed_find(va_space, params->lookup_address);
+    if (!managed_range) {
+        status = NV_ERR_INVALID_ADDRESS;
+        goto out;
+    }
+
+    adaptive = &managed_range->prefetch_adaptive;
+
+    uvm_spin_lock(&adaptive->lock);
+    params->enabled       = g_uvm_perf_prefetch_adaptive;
+    params->threshold     = adaptive->threshold;
+    params->threshold_min = g_uvm_perf_prefetch_threshold_min;
+    params->threshold_max = g_uvm_perf_prefetch_threshold_max;
+    params->used_pages    = adaptive->used_pages;
+    params->wasted_pages  = adaptive->wasted_pages;
+    params->num_raises    = adaptive->num_raises;
+    params->num_lowers    = adaptive->num_lowers;
+    uvm_spin_unlock(&adaptive->lock);
+
+out:
+    uvm_va_space_up_read(va_space);
+
+    return status;
+}
+
+NV_STATUS uvm_test_get_prefetch_stream_state(UVM_TEST_GET_PREFETCH_STREAM_STATE_PARAMS *params, struct file *filp)
+{
+    uvm_va_space_t *va_space = uvm_va_space_get(filp);
+    uvm_va_range_managed_t *managed_range;
+    uvm_perf_prefetch_stream_t *stream;
+    NV_STATUS status = NV_OK;
+
+    uvm_va_space_down_read(va_space);
+
+    managed_range = uvm_va_range_managed_find(va_space, params->lookup_address);
+    if (!managed_range) {
+        status = NV_ERR_INVALID_ADDRESS;
+        goto out;
+    }
+
+    stream = &managed_range->prefetch_stream;
+
+    uvm_spin_lock(&stream->lock);
+    params->enabled           = g_uvm_perf_prefetch_stream_enable;
+    params->stride            = stream->stride;
+    params->confidence        = stream->confidence;
+    params->window            = stream->num_prefetched;
+    params->prefetched_blocks = stream->num_prefetched_blocks;
+    params->hits              = stream->num_hits;
+    params->misses            = stream->num_misses;
+    uvm_spin_unlock(&stream->lock);
+
+out:
+    uvm_va_space_up_read(va_space);
+
+    return status;
+}
+
+// Feed the block indices to a fresh stream detector and check the outcome of
+// the last update.
+static NV_STATUS test_stream_sequence(const size_t *indices,
+                                      size_t num_indices,
+                                      long expected_stride,
+                                      NvU32 expected_first_step,
+                                      NvU32 expected_last_step,
+                                      NvU64 expected_hits,
+                                      NvU64 expected_misses)
+{
+    uvm_perf_prefetch_stream_t stream;
+    uvm_perf_prefetch_stream_update_t update;
+    size_t i;
+
+    uvm_perf_prefetch_stream_init(&stream);
+
+    // Fixed tunables so that the test doesn't depend on the module parameters
+    for (i = 0; i < num_indices; i++) {
+        uvm_spin_lock(&stream.lock);
+        stream_update(&stream, indices[i], 4, 2, 2, &update);
+        stream.num_hits += update.num_hits;
+        stream.num_misses += update.num_misses;
+        uvm_spin_unlock(&stream.lock);
+    }
+
+    TEST_CHECK_RET(update.stride == expected_stride);
+    if (expected_stride != 0) {
+        TEST_CHECK_RET(update.first_step == expected_first_step);
+        TEST_CHECK_RET(update.last_step == expected_last_step);
+    }
+
+    TEST_CHECK_RET(stream.num_hits == expected_hits);
+    TEST_CHECK_RET(stream.num_misses == expected_misses);
+
+    return NV_OK;
+}
+
+NV_STATUS uvm_test_prefetch_stream_sanity(UVM_TEST_PREFETCH_STREAM_SANITY_PARAMS *params, struct file *filp)
+{
+    // Not enough matching strides yet
+    static const size_t learning[] = {0, 1, 2};
+
+    // The third matching stride starts prefetching, two blocks at a time
+    static const size_t detected[] = {0, 1, 2, 3};
+
+    // Repeated faults on the same block don't advance the stream
+    static const size_t repeated[] = {0, 1, 1, 2, 2, 3};
+
+    // The stream skips the two prefetched blocks 4 and 5: two hits, and the
+    // faulting block 6 is a miss
+    static const size_t skipped[] = {0, 1, 2, 3, 6};
+
+    // Faults on prefetched blocks are misses, and the window grows by two
+    // blocks at a time up to the depth
+    static const size_t grown[] = {0, 1, 2, 3, 4, 5};
+
+    // Backwards strided stream
+    static const size_t backwards[] = {40, 38, 36, 34};
+
+    // Breaking the stride resets the detector, without accounting
+    static const size_t broken[] = {0, 1, 2, 3, 20};
+
+    TEST_NV_CHECK_RET(test_stream_sequence(learning, ARRAY_SIZE(learning), 0, 0, 0, 0, 0));
+    TEST_NV_CHECK_RET(test_stream_sequence(detected, ARRAY_SIZE(detected), 1, 1, 2, 0, 0));
+    TEST_NV_CHECK_RET(test_stream_sequence(repeated, ARRAY_SIZE(repeated), 1, 1, 2, 0, 0));
+    TEST_NV_CHECK_RET(test_stream_sequence(skipped, ARRAY_SIZE(skipped), 1, 1, 2, 2, 1));
+    TEST_NV_CHECK_RET(test_stream_sequence(grown, ARRAY_SIZE(grown), 1, 3, 4, 0, 2));
+    TEST_NV_CHECK_RET(test_stream_sequence(backwards, ARRAY_SIZE(backwards), -2, 1, 2, 0, 0));
+    TEST_NV_CHECK_RET(test_stream_sequence(broken, ARRAY_SIZE(broken), 0, 0, 0, 0, 0));
+
     return NV_OK;
 }
 
@@ -25,6 +25,7 @@
 #define __UVM_PERF_PREFETCH_H__
 
 #include "uvm_linux.h"
+#include "uvm_lock.h"
 #include "uvm_processors.h"
 #include "uvm_va_block_types.h"
 
@@ -58,6 +59,81 @@ typedef struct
     uvm_page_index_t node_idx;
 } uvm_perf_prefetch_bitmap_tree_iter_t;
 
+// Per-VA-range stream detector used to prefetch whole VA blocks ahead of
+// sequential or strided GPU sweeps. It tracks the index of the last VA block
+// in the range that took a GPU fault and learns the stride between
+// consecutive faulting blocks. Once the same stride has been observed enough
+// times, the next blocks along the stream are migrated to the faulting GPU
+// before they are accessed.
+typedef struct
+{
+    uvm_spinlock_t lock;
+
+    // Index within the VA range of the last VA block that faulted
+    size_t last_index;
+
+    // Distance in VA blocks between consecutive faulting blocks. 0 if no
+    // stride has been learnt yet.
+    long stride;
+
+    // Number of consecutive faulting blocks that followed stride
+    NvU32 confidence;
+
+    // Number of blocks after last_index along the stream that have already
+    // been prefetched
+    NvU32 num_prefetched;
+
+    // Whether last_index is valid
+    bool valid;
+
+    // Number of VA blocks migrated ahead of the stream
+    NvU64 num_prefetched_blocks;
+
+    // Number of prefetched VA blocks the stream went past without faulting on
+    // them (hits), and of VA blocks of a detected stream that faulted anyway
+    // (misses). Accuracy is num_hits / num_prefetched_blocks, and coverage
+    // num_hits / (num_hits + num_misses).
+    NvU64 num_hits;
+    NvU64 num_misses;
+} uvm_perf_prefetch_stream_t;
+
+// Outcome of a stream detector update
+typedef struct
+{
+    // Distance in VA blocks between the blocks to prefetch, 0 if there is
+    // nothing to prefetch
+    long stride;
+
+    // Steps along stride, from the faulting block, of the blocks to prefetch
+    NvU32 first_step;
+    NvU32 last_step;
+
+    // Accounting of the previous prefetches
+    NvU32 num_hits;
+    NvU32 num_misses;
+} uvm_perf_prefetch_stream_update_t;
+
+// Per-VA-range state of the adaptive prefetch threshold. Prefetched pages are
+// accounted as used or as evicted untouched, and the threshold of the range
+// is raised when too many of them are wasted and lowered when almost all of
+// them are used.
+typedef struct
+{
+    uvm_spinlock_t lock;
+
+    // Threshold used for the blocks of the range. See
+    // uvm_perf_prefetch_threshold.
+    unsigned threshold;
+
+    // Prefetched pages accounted since the last threshold update
+    NvU32 used_pages;
+    NvU32 wasted_pages;
+
+    // Number of times the threshold has been raised or lowered
+    NvU64 num_raises;
+    NvU64 num_lowers;
+} uvm_perf_prefetch_adaptive_t;
+
 // Global initialization function (no clean up needed).
 NV_STATUS uvm_perf_prefetch_init(void);
 
@@ -97,6 +173,37 @@ void uvm_perf_prefetch_get_hint_va_block(uvm_va_block_t *va_block,
                                          uvm_perf_prefetch_bitmap_tree_t *bitmap_tree,
                                          uvm_perf_prefetch_hint_t *out_hint);
 
+// Initialize the stream detector of a managed VA range.
+void uvm_perf_prefetch_stream_init(uvm_perf_prefetch_stream_t *stream);
+
+// Initialize the adaptive prefetch threshold state of a managed VA range.
+void uvm_perf_prefetch_adaptive_init(uvm_perf_prefetch_adaptive_t *adaptive);
+
+// Account the prefetched pages of va_block that are being evicted from the
+// given processor as wasted.
+//
+// Locking: The caller must hold the va_block lock.
+void uvm_perf_prefetch_notify_eviction(uvm_va_block_t *va_block,
+                                       uvm_processor_id_t id,
+                                       const uvm_page_mask_t *evicted_pages);
+
+// Notify the stream detector of the VA range containing va_block that the
+// block has been made resident on gpu as a result of a GPU fault. If the
+// faulting blocks of the range follow a stream, up to
+// uvm_perf_prefetch_stream_blocks_per_fault of the next blocks along the
+// stream are migrated to gpu, with UVM_MAKE_RESIDENT_CAUSE_PREFETCH and
+// without evicting any memory. The migrations are only tracked by the trackers
+// of the prefetched blocks, so the caller does not wait for them.
+//
+// va_block must be a managed block. service_context->block_context is used
+// as scratch for the migrations, so it must not be in use by the caller.
+//
+// Locking: The caller must hold the va_space lock, and must not hold the
+//          va_block lock.
+void uvm_perf_prefetch_stream_notify(uvm_va_block_t *va_block,
+                                     uvm_gpu_t *gpu,
+                                     uvm_service_block_context_t *service_context);
+
 void uvm_perf_prefetch_bitmap_tree_iter_init(const uvm_perf_prefetch_bitmap_tree_t *bitmap_tree,
                                              uvm_page_index_t page_index,
                                              uvm_perf_prefetch_bitmap_tree_iter_t *iter);
@@ -102,6 +102,13 @@ typedef struct
 
     NvU64                  last_thrashing_time_stamp;
 
+    // Oscillation period of the thrashing pages in the block, learned as a
+    // moving average of the time between consecutive thrashing events on the
+    // same page. See uvm_perf_thrashing_adaptive.
+    NvU64                                  period_ns;
+
+    NvU8                          num_period_samples;
+
     // Stats
     NvU32                           throttling_count;
 
@@ -315,6 +322,15 @@ static unsigned uvm_perf_thrashing_pin = UVM_PERF_THRASHING_PIN_DEFAULT;
 
 static unsigned uvm_perf_thrashing_max_resets = UVM_PERF_THRASHING_MAX_RESETS_DEFAULT;
 
+#define UVM_PERF_THRASHING_ADAPTIVE_DEFAULT 1
+
+// Size the throttling and pinning durations of each VA block to the
+// oscillation period learned for its thrashing pages, instead of using the
+// VA space-wide lapse. uvm_perf_thrashing_nap and uvm_perf_thrashing_pin then
+// become multipliers of the learned period, and the VA space-wide durations
+// are used as upper bounds.
+static unsigned uvm_perf_thrashing_adaptive = UVM_PERF_THRASHING_ADAPTIVE_DEFAULT;
+
 // Module parameters for the tunables
 module_param(uvm_perf_thrashing_enable,        uint, S_IRUGO);
 module_param(uvm_perf_thrashing_threshold,     uint, S_IRUGO);
@@ -325,6 +341,7 @@ module_param(uvm_perf_thrashing_nap,           uint, S_IRUGO);
 module_param(uvm_perf_thrashing_epoch,         uint, S_IRUGO);
 module_param(uvm_perf_thrashing_pin,           uint, S_IRUGO);
 module_param(uvm_perf_thrashing_max_resets,    uint, S_IRUGO);
+module_param(uvm_perf_thrashing_adaptive,      uint, S_IRUGO);
 
 // See map_remote_on_atomic_fault uvm_va_block.c
 unsigned uvm_perf_map_remote_on_native_atomics_fault = 0;
@@ -341,6 +358,7 @@ static NvU64 g_uvm_perf_thrashing_nap;
 static NvU64 g_uvm_perf_thrashing_epoch;
 static NvU64 g_uvm_perf_thrashing_pin;
 static unsigned g_uvm_perf_thrashing_max_resets;
+static bool g_uvm_perf_thrashing_adaptive;
 
 // Helper macros to initialize thrashing parameters from module parameters
 //
@@ -784,10 +802,63 @@ static bool thrashing_state_checks(uvm_va_block_t *va_block,
     return true;
 }
 
+// Account a new interval between two consecutive thrashing events on a page
+// of the block in its oscillation period. The period is an exponential moving
+// average in which new samples have a weight of 1/8.
+static void thrashing_period_update(block_thrashing_info_t *block_thrashing, NvU64 interval_ns)
+{
+    if (block_thrashing->num_period_samples == 0)
+        block_thrashing->period_ns = interval_ns;
+    else
+        block_thrashing->period_ns = block_thrashing->period_ns - block_thrashing->period_ns / 8 + interval_ns / 8;
+
+    UVM_PERF_SATURATING_INC(block_thrashing->num_period_samples);
+}
+
+// The learned period is only used once as many samples as required to detect
+// thrashing on a page have been accounted. Test overrides always use the
+// VA space-wide durations so that tests get deterministic timeouts.
+static bool thrashing_period_is_valid(va_space_thrashing_info_t *va_space_thrashing,
+                                      block_thrashing_info_t *block_thrashing)
+{
+    return g_uvm_perf_thrashing_adaptive &&
+           !va_space_thrashing->params.test_overrides &&
+           block_thrashing->num_period_samples >= va_space_thrashing->params.threshold;
+}
+
+static NvU64 thrashing_period_scale(block_thrashing_info_t *block_thrashing, NvU64 multiplier, NvU64 max_ns)
+{
+    NvU64 duration_ns = block_thrashing->period_ns * multiplier;
+
+    return clamp(duration_ns, min((NvU64)UVM_PERF_THRASHING_LAPSE_USEC_MIN * 1000, max_ns), max_ns);
+}
+
+// Time that a throttled processor is forbidden to work on a thrashing page of
+// the block
+static NvU64 thrashing_nap_ns(va_space_thrashing_info_t *va_space_thrashing, block_thrashing_info_t *block_thrashing)
+{
+    if (!thrashing_period_is_valid(va_space_thrashing, block_thrashing))
+        return va_space_thrashing->params.nap_ns;
+
+    return thrashing_period_scale(block_thrashing, g_uvm_perf_thrashing_nap, va_space_thrashing->params.nap_ns);
+}
+
+// Time that a thrashing page of the block remains pinned. It is never larger
+// than the VA space-wide pin_ns, and it is only 0 (pinned forever) if pin_ns
+// is 0.
+static NvU64 thrashing_pin_ns(va_space_thrashing_info_t *va_space_thrashing, block_thrashing_info_t *block_thrashing)
+{
+    if (va_space_thrashing->params.pin_ns == 0 || !thrashing_period_is_valid(va_space_thrashing, block_thrashing))
+        return va_space_thrashing->params.pin_ns;
+
+    return thrashing_period_scale(block_thrashing, g_uvm_perf_thrashing_pin, va_space_thrashing->params.pin_ns);
+}
+
 // Update throttling heuristics. Mainly check if a new throttling period has
 // started and choose the next processor not to be throttled. This function
 // is executed before the thrashing mitigation logic kicks in.
 static void thrashing_throttle_update(va_space_thrashing_info_t *va_space_thrashing,
+                                      block_thrashing_info_t *block_thrashing,
                                       uvm_va_block_t *va_block,
                                       page_thrashing_info_t *page_thrashing,
                                       uvm_processor_id_t processor,
@@ -798,7 +869,7 @@ static void thrashing_throttle_update(va_space_thrashing_info_t *va_space_thrash
     uvm_assert_mutex_locked(&va_block->lock);
 
     if (time_stamp > current_end_time_stamp) {
-        NvU64 throttling_end_time_stamp = time_stamp + va_space_thrashing->params.nap_ns;
+        NvU64 throttling_end_time_stamp = time_stamp + thrashing_nap_ns(va_space_thrashing, block_thrashing);
         page_thrashing_set_throttling_end_time_stamp(page_thrashing, throttling_end_time_stamp);
 
         // Avoid choosing the same processor in consecutive thrashing periods
@@ -942,13 +1013,18 @@ static NV_STATUS thrashing_pin_page(va_space_thrashing_info_t *va_space_thrashin
 
     if (!page_thrashing->pinned) {
         if (va_space_thrashing->params.pin_ns > 0) {
+            NvU64 pin_ns = thrashing_pin_ns(va_space_thrashing, block_thrashing);
             pinned_page_t *pinned_page = nv_kmem_cache_zalloc(g_pinned_page_cache, NV_UVM_GFP_FLAGS);
             if (!pinned_page)
                 return NV_ERR_NO_MEMORY;
 
             pinned_page->va_block = va_block;
             pinned_page->page_index = page_index;
-            pinned_page->deadline = time_stamp + va_space_thrashing->params.pin_ns;
+
+            // Per-block pinning durations break the ordering of the per-VA
+            // space list. Since they are bounded by pin_ns, a page is unpinned
+            // at most pin_ns after its deadline.
+            pinned_page->deadline = time_stamp + pin_ns;
 
             uvm_spin_lock(&va_space_thrashing->pinned_pages.lock);
 
@@ -964,7 +1040,7 @@ static NV_STATUS thrashing_pin_page(va_space_thrashing_info_t *va_space_thrashin
                 !va_space_thrashing->pinned_pages.in_va_space_teardown) {
                 int scheduled;
                 scheduled = schedule_delayed_work(&va_space_thrashing->pinned_pages.dwork,
-                                                  usecs_to_jiffies(va_space_thrashing->params.pin_ns / 1000));
+                                                  usecs_to_jiffies(pin_ns / 1000));
                 UVM_ASSERT(scheduled != 0);
             }
 
@@ -1376,6 +1452,8 @@ void thrashing_event_cb(uvm_va_space_t *va_space, uvm_perf_event_t event_id, uvm
             continue;
 
         if (time_stamp - last_time_stamp <= va_space_thrashing->params.lapse_ns) {
+            thrashing_period_update(block_thrashing, time_stamp - last_time_stamp);
+
             UVM_PERF_SATURATING_INC(page_thrashing->num_thrashing_events);
             if (page_thrashing->num_thrashing_events == va_space_thrashing->params.threshold)
                 thrashing_detected(va_block, block_thrashing, page_thrashing, page_index, processor_id);
@@ -1719,6 +1797,8 @@ uvm_perf_thrashing_hint_t uvm_perf_thrashing_get_hint(uvm_va_block_t *va_block,
         block_thrashing->last_processor            = UVM_ID_INVALID;
         block_thrashing->last_time_stamp           = 0;
         block_thrashing->last_thrashing_time_stamp = 0;
+        block_thrashing->period_ns                 = 0;
+        block_thrashing->num_period_samples        = 0;
         uvm_page_mask_zero(&block_thrashing->thrashing_pages);
         goto done;
     }
@@ -1761,7 +1841,7 @@ uvm_perf_thrashing_hint_t uvm_perf_thrashing_get_hint(uvm_va_block_t *va_block,
     UVM_ASSERT(page_thrashing->has_migration_events || page_thrashing->has_revocation_events);
 
     // Update throttling heuristics
-    thrashing_throttle_update(va_space_thrashing, va_block, page_thrashing, requester, time_stamp);
+    thrashing_throttle_update(va_space_thrashing, block_thrashing, va_block, page_thrashing, requester, time_stamp);
 
     if (page_thrashing->pinned &&
         page_thrashing->has_revocation_events &&
@@ -2062,6 +2142,8 @@ NV_STATUS uvm_perf_thrashing_init(void)
 
     INIT_THRASHING_PARAMETER(uvm_perf_thrashing_max_resets, UVM_PERF_THRASHING_MAX_RESETS_DEFAULT);
 
+    INIT_THRASHING_PARAMETER_TOGGLE(uvm_perf_thrashing_adaptive, UVM_PERF_THRASHING_ADAPTIVE_DEFAULT);
+
     g_va_block_thrashing_info_cache = NV_KMEM_CACHE_CREATE("uvm_block_thrashing_info_t", block_thrashing_info_t);
     if (!g_va_block_thrashing_info_cache) {
         status = NV_ERR_NO_MEMORY;
@@ -2211,3 +2293,50 @@ done_unlock_va_space:
 
     return status;
 }
+
+NV_STATUS uvm_test_get_block_thrashing_state(UVM_TEST_GET_BLOCK_THRASHING_STATE_PARAMS *params, struct file *filp)
+{
+    NV_STATUS status;
+    uvm_va_space_t *va_space = uvm_va_space_get(filp);
+    va_space_thrashing_info_t *va_space_thrashing;
+    block_thrashing_info_t *block_thrashing;
+    uvm_va_block_t *va_block;
+
+    uvm_va_space_down_read(va_space);
+
+    va_space_thrashing = va_space_thrashing_info_get(va_space);
+    if (!va_space_thrashing->params.enable) {
+        status = NV_ERR_INVALID_STATE;
+        goto done_unlock_va_space;
+    }
+
+    status = uvm_va_block_find(va_space, params->lookup_address, &va_block);
+    if (status != NV_OK)
+        goto done_unlock_va_space;
+
+    uvm_mutex_lock(&va_block->lock);
+
+    block_thrashing = thrashing_info_get(va_block);
+    if (block_thrashing) {
+        params->has_thrashing_info    = NV_TRUE;
+        params->has_page_tracking     = block_thrashing->pages != NULL;
+        params->num_thrashing_pages   = block_thrashing->num_thrashing_pages;
+        params->num_pinned_pages      = block_thrashing->pinned_pages.count;
+        params->throttling_count      = block_thrashing->throttling_count;
+        params->thrashing_reset_count = block_thrashing->thrashing_reset_count;
+        params->num_period_samples    = block_thrashing->num_period_samples;
+        params->period_ns             = block_thrashing->period_ns;
+        params->nap_ns                = thrashing_nap_ns(va_space_thrashing, block_thrashing);
+        params->pin_ns                = thrashing_pin_ns(va_space_thrashing, block_thrashing);
+    }
+    else {
+        params->has_thrashing_info = NV_FALSE;
+    }
+
+    uvm_mutex_unlock(&va_block->lock);
+
+done_unlock_va_space:
+    uvm_va_space_up_read(va_space);
+
+    return status;
+}
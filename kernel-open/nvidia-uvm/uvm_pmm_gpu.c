@@ -193,6 +193,42 @@ MODULE_PARM_DESC(uvm_global_oversubscription, "Enable (1) or disable (0) global
 static unsigned uvm_perf_pma_batch_nonpinned_order = UVM_PERF_PMA_BATCH_NONPINNED_ORDER_DEFAULT;
 module_param(uvm_perf_pma_batch_nonpinned_order, uint, S_IRUGO);
 
+#define UVM_PERF_PMM_EVICTION_POLICY_DEFAULT UVM_PMM_EVICTION_POLICY_LRU
+
+// Policy used to pick which root chunks to evict (see
+// uvm_pmm_eviction_policy_t):
+// 0 - LRU
+// 1 - CLOCK-Pro
+static unsigned uvm_perf_pmm_eviction_policy = UVM_PERF_PMM_EVICTION_POLICY_DEFAULT;
+module_param(uvm_perf_pmm_eviction_policy, uint, S_IRUGO);
+
+#define UVM_PERF_PMM_EVICTION_REUSE_USEC_DEFAULT 1000
+
+// With the CLOCK-Pro policy, references to a root chunk closer than this to
+// the previous one are considered part of the same use. This keeps the burst
+// of faults that populates a chunk from marking it as reused.
+static unsigned uvm_perf_pmm_eviction_reuse_usec = UVM_PERF_PMM_EVICTION_REUSE_USEC_DEFAULT;
+module_param(uvm_perf_pmm_eviction_reuse_usec, uint, S_IRUGO);
+
+#define UVM_PERF_PMM_RECLAIM_LOW_WATERMARK_DEFAULT 0
+#define UVM_PERF_PMM_RECLAIM_HIGH_WATERMARK_DEFAULT 16
+
+// Background reclaim. When the number of free root chunks in PMA drops below
+// uvm_perf_pmm_reclaim_low_watermark, a per-GPU thread evicts root chunks until
+// uvm_perf_pmm_reclaim_high_watermark of them are free, so that allocations on
+// the fault path rarely have to evict inline. A low watermark of 0 disables
+// background reclaim.
+static unsigned uvm_perf_pmm_reclaim_low_watermark = UVM_PERF_PMM_RECLAIM_LOW_WATERMARK_DEFAULT;
+module_param(uvm_perf_pmm_reclaim_low_watermark, uint, S_IRUGO);
+
+static unsigned uvm_perf_pmm_reclaim_high_watermark = UVM_PERF_PMM_RECLAIM_HIGH_WATERMARK_DEFAULT;
+module_param(uvm_perf_pmm_reclaim_high_watermark, uint, S_IRUGO);
+
+// Maximum number of cold root chunks the CLOCK-Pro policy promotes while
+// looking for a chunk to evict, in order to bound the time spent with the list
+// lock held.
+#define UVM_PMM_EVICTION_COLD_SCAN_MAX 64
+
 // Helper type for refcounting cache
 typedef struct
 {
@@ -632,6 +668,60 @@ NV_STATUS uvm_pmm_gpu_alloc_user(uvm_pmm_gpu_t *pmm,
     return pmm_gpu_alloc(pmm, num_chunks, chunk_size, UVM_PMM_GPU_MEMORY_TYPE_USER, flags, chunks, out_tracker);
 }
 
+static NvU64 eviction_policy_now(uvm_pmm_gpu_t *pmm)
+{
+    if (pmm->root_chunks.eviction_policy == UVM_PMM_EVICTION_POLICY_LRU)
+        return 0;
+
+    return NV_GETTIME();
+}
+
+static void root_chunk_eviction_reset(uvm_gpu_root_chunk_t *root_chunk)
+{
+    root_chunk->eviction.last_reference_time = 0;
+    root_chunk->eviction.referenced = false;
+    root_chunk->eviction.frequent = false;
+}
+
+// Move a used root chunk to the tail of the used list it belongs to
+static void root_chunk_eviction_used_locked(uvm_pmm_gpu_t *pmm, uvm_gpu_root_chunk_t *root_chunk, NvU64 now)
+{
+    uvm_pmm_alloc_list_t alloc_list = UVM_PMM_ALLOC_LIST_USED;
+
+    uvm_assert_spinlock_locked(&pmm->list_lock);
+
+    // Start the reuse window when the chunk starts being used
+    if (root_chunk->eviction.last_reference_time == 0)
+        root_chunk->eviction.last_reference_time = now;
+
+    if (root_chunk->eviction.frequent)
+        alloc_list = UVM_PMM_ALLOC_LIST_USED_FREQUENT;
+
+    list_move_tail(&root_chunk->chunk.list, &pmm->root_chunks.alloc_list[alloc_list]);
+}
+
+static void root_chunk_eviction_reference_locked(uvm_pmm_gpu_t *pmm, uvm_gpu_root_chunk_t *root_chunk, NvU64 now)
+{
+    uvm_assert_spinlock_locked(&pmm->list_lock);
+
+    if (now - root_chunk->eviction.last_reference_time < uvm_perf_pmm_eviction_reuse_usec * 1000ULL)
+        return;
+
+    root_chunk->eviction.last_reference_time = now;
+
+    if (root_chunk->eviction.frequent || !root_chunk->eviction.referenced) {
+        root_chunk->eviction.referenced = true;
+        return;
+    }
+
+    // A cold chunk reused twice before the cold hand got to it is promoted
+    // right away.
+    root_chunk->eviction.referenced = false;
+    root_chunk->eviction.frequent = true;
+    list_move_tail(&root_chunk->chunk.list, &pmm->root_chunks.alloc_list[UVM_PMM_ALLOC_LIST_USED_FREQUENT]);
+    ++pmm->root_chunks.eviction_stats.num_promoted;
+}
+
 static void chunk_update_lists_locked(uvm_pmm_gpu_t *pmm, uvm_gpu_chunk_t *chunk)
 {
     uvm_gpu_root_chunk_t *root_chunk = root_chunk_from_chunk(pmm, chunk);
@@ -647,7 +737,10 @@ static void chunk_update_lists_locked(uvm_pmm_gpu_t *pmm, uvm_gpu_chunk_t *chunk
         else if (root_chunk->chunk.state != UVM_PMM_GPU_CHUNK_STATE_FREE) {
             UVM_ASSERT(root_chunk->chunk.state == UVM_PMM_GPU_CHUNK_STATE_IS_SPLIT ||
                        root_chunk->chunk.state == UVM_PMM_GPU_CHUNK_STATE_ALLOCATED);
-            list_move_tail(&root_chunk->chunk.list, &pmm->root_chunks.alloc_list[UVM_PMM_ALLOC_LIST_USED]);
+            root_chunk_eviction_used_locked(pmm, root_chunk, eviction_policy_now(pmm));
+        }
+        else {
+            root_chunk_eviction_reset(root_chunk);
         }
     }
 
@@ -1405,10 +1498,15 @@ static void chunk_start_eviction(uvm_pmm_gpu_t *pmm, uvm_gpu_chunk_t *chunk)
 
     list_del_init(&chunk->list);
     uvm_gpu_chunk_set_in_eviction(chunk, true);
+    root_chunk_eviction_reset(root_chunk);
 }
 
 static void root_chunk_update_eviction_list(uvm_pmm_gpu_t *pmm, uvm_gpu_chunk_t *chunk, uvm_pmm_alloc_list_t alloc_list)
 {
+    NvU64 now = eviction_policy_now(pmm);
+
+    UVM_ASSERT(alloc_list != UVM_PMM_ALLOC_LIST_USED_FREQUENT);
+
     uvm_spin_lock(&pmm->list_lock);
 
     UVM_ASSERT(uvm_gpu_chunk_get_size(chunk) == UVM_CHUNK_SIZE_MAX);
@@ -1417,11 +1515,20 @@ static void root_chunk_update_eviction_list(uvm_pmm_gpu_t *pmm, uvm_gpu_chunk_t
                chunk->state == UVM_PMM_GPU_CHUNK_STATE_TEMP_PINNED);
 
     if (!chunk_is_root_chunk_pinned(pmm, chunk) && !chunk_is_in_eviction(pmm, chunk)) {
+        uvm_gpu_root_chunk_t *root_chunk = root_chunk_from_chunk(pmm, chunk);
+
         // An unpinned chunk not selected for eviction should be on one of the
         // eviction lists.
         UVM_ASSERT(!list_empty(&chunk->list));
 
-        list_move_tail(&chunk->list, &pmm->root_chunks.alloc_list[alloc_list]);
+        if (alloc_list == UVM_PMM_ALLOC_LIST_USED) {
+            root_chunk_eviction_used_locked(pmm, root_chunk, now);
+        }
+        else {
+            // Chunks without data in use start over as cold chunks
+            root_chunk_eviction_reset(root_chunk);
+            list_move_tail(&chunk->list, &pmm->root_chunks.alloc_list[alloc_list]);
+        }
     }
 
     uvm_spin_unlock(&pmm->list_lock);
@@ -1442,6 +1549,29 @@ void uvm_pmm_gpu_mark_root_chunk_discarded(uvm_pmm_gpu_t *pmm, uvm_gpu_chunk_t *
     root_chunk_update_eviction_list(pmm, chunk, UVM_PMM_ALLOC_LIST_DISCARDED);
 }
 
+void uvm_pmm_gpu_mark_root_chunk_referenced(uvm_pmm_gpu_t *pmm, uvm_gpu_chunk_t *chunk)
+{
+    NvU64 now;
+
+    // LRU doesn't track references, skip the lock
+    if (pmm->root_chunks.eviction_policy == UVM_PMM_EVICTION_POLICY_LRU)
+        return;
+
+    now = NV_GETTIME();
+
+    uvm_spin_lock(&pmm->list_lock);
+
+    UVM_ASSERT(uvm_gpu_chunk_get_size(chunk) == UVM_CHUNK_SIZE_MAX);
+    UVM_ASSERT(uvm_gpu_chunk_is_user(chunk));
+
+    if (!chunk_is_root_chunk_pinned(pmm, chunk) && !chunk_is_in_eviction(pmm, chunk)) {
+        UVM_ASSERT(!list_empty(&chunk->list));
+        root_chunk_eviction_reference_locked(pmm, root_chunk_from_chunk(pmm, chunk), now);
+    }
+
+    uvm_spin_unlock(&pmm->list_lock);
+}
+
 static uvm_pmm_alloc_list_t get_alloc_list(uvm_pmm_gpu_t *pmm, uvm_gpu_chunk_t *chunk)
 {
     uvm_pmm_alloc_list_t alloc_list;
@@ -1459,7 +1589,7 @@ static uvm_pmm_alloc_list_t get_alloc_list(uvm_pmm_gpu_t *pmm, uvm_gpu_chunk_t *
     return UVM_PMM_ALLOC_LIST_COUNT;
 }
 
-static uvm_gpu_chunk_t *get_first_allocated_chunk(uvm_pmm_gpu_t *pmm)
+static uvm_gpu_chunk_t *get_first_allocated_chunk(uvm_pmm_gpu_t *pmm, uvm_pmm_alloc_list_t *out_alloc_list)
 {
     uvm_pmm_alloc_list_t alloc_list;
 
@@ -1467,14 +1597,148 @@ static uvm_gpu_chunk_t *get_first_allocated_chunk(uvm_pmm_gpu_t *pmm)
 
     for (alloc_list = 0; alloc_list < UVM_PMM_ALLOC_LIST_COUNT; alloc_list++) {
         uvm_gpu_chunk_t *chunk = list_first_chunk(&pmm->root_chunks.alloc_list[alloc_list]);
-        if (chunk)
+        if (chunk) {
+            *out_alloc_list = alloc_list;
             return chunk;
+        }
     }
 
     return NULL;
 }
 
-static uvm_gpu_root_chunk_t *pick_root_chunk_to_evict(uvm_pmm_gpu_t *pmm)
+// Find an unused, discarded or unreferenced cold root chunk with
+// UVM_PMM_EVICTION_POLICY_CLOCK_PRO, without moving chunks between the lists.
+// Only the first UVM_PMM_EVICTION_COLD_SCAN_MAX chunks of the cold list are
+// considered. Returns NULL if there is no such chunk.
+static uvm_gpu_chunk_t *clock_pro_find_cold_chunk(uvm_pmm_gpu_t *pmm, uvm_pmm_alloc_list_t *out_alloc_list)
+{
+    uvm_gpu_chunk_t *chunk;
+    uvm_pmm_alloc_list_t alloc_list;
+    NvU32 i = 0;
+
+    uvm_assert_spinlock_locked(&pmm->list_lock);
+
+    for (alloc_list = 0; alloc_list < UVM_PMM_ALLOC_LIST_USED; alloc_list++) {
+        chunk = list_first_chunk(&pmm->root_chunks.alloc_list[alloc_list]);
+        if (chunk) {
+            *out_alloc_list = alloc_list;
+            return chunk;
+        }
+    }
+
+    list_for_each_entry(chunk, &pmm->root_chunks.alloc_list[UVM_PMM_ALLOC_LIST_USED], list) {
+        uvm_gpu_root_chunk_t *root_chunk = container_of(chunk, uvm_gpu_root_chunk_t, chunk);
+
+        if (i++ == UVM_PMM_EVICTION_COLD_SCAN_MAX)
+            break;
+
+        if (!root_chunk->eviction.referenced) {
+            *out_alloc_list = UVM_PMM_ALLOC_LIST_USED;
+            return chunk;
+        }
+    }
+
+    return NULL;
+}
+
+// Pick an allocated root chunk with UVM_PMM_EVICTION_POLICY_CLOCK_PRO. Unused
+// and discarded chunks go first, as with LRU. Then the hot hand advances by one
+// chunk over the frequent list, demoting it if it wasn't referenced since the
+// last pass, and the cold hand walks the used list promoting referenced chunks
+// until it finds one to evict.
+//
+// If cold_only is set, the lists are left untouched and only a chunk found by
+// clock_pro_find_cold_chunk() is returned. This is used by the background
+// reclaimer, which must not promote chunks nor evict frequently used ones.
+static uvm_gpu_chunk_t *clock_pro_pick_allocated_chunk(uvm_pmm_gpu_t *pmm,
+                                                       bool cold_only,
+                                                       uvm_pmm_alloc_list_t *out_alloc_list)
+{
+    struct list_head *cold_list = &pmm->root_chunks.alloc_list[UVM_PMM_ALLOC_LIST_USED];
+    struct list_head *hot_list = &pmm->root_chunks.alloc_list[UVM_PMM_ALLOC_LIST_USED_FREQUENT];
+    uvm_gpu_root_chunk_t *root_chunk;
+    uvm_gpu_chunk_t *chunk;
+    uvm_pmm_alloc_list_t alloc_list;
+    NvU32 i;
+
+    uvm_assert_spinlock_locked(&pmm->list_lock);
+
+    if (cold_only)
+        return clock_pro_find_cold_chunk(pmm, out_alloc_list);
+
+    for (alloc_list = 0; alloc_list < UVM_PMM_ALLOC_LIST_USED; alloc_list++) {
+        chunk = list_first_chunk(&pmm->root_chunks.alloc_list[alloc_list]);
+        if (chunk) {
+            *out_alloc_list = alloc_list;
+            return chunk;
+        }
+    }
+
+    chunk = list_first_chunk(hot_list);
+    if (chunk) {
+        root_chunk = container_of(chunk, uvm_gpu_root_chunk_t, chunk);
+        if (root_chunk->eviction.referenced) {
+            root_chunk->eviction.referenced = false;
+            list_move_tail(&chunk->list, hot_list);
+        }
+        else {
+            root_chunk->eviction.frequent = false;
+            list_move_tail(&chunk->list, cold_list);
+            ++pmm->root_chunks.eviction_stats.num_demoted;
+        }
+    }
+
+    for (i = 0; i < UVM_PMM_EVICTION_COLD_SCAN_MAX; i++) {
+        chunk = list_first_chunk(cold_list);
+        if (!chunk)
+            break;
+
+        root_chunk = container_of(chunk, uvm_gpu_root_chunk_t, chunk);
+        if (!root_chunk->eviction.referenced)
+            break;
+
+        root_chunk->eviction.referenced = false;
+        root_chunk->eviction.frequent = true;
+        list_move_tail(&chunk->list, hot_list);
+        ++pmm->root_chunks.eviction_stats.num_promoted;
+    }
+
+    // If the scan budget ran out, evict the head of the cold list anyway. Hot
+    // chunks are only evicted when there are no cold chunks left.
+    chunk = list_first_chunk(cold_list);
+    if (chunk) {
+        *out_alloc_list = UVM_PMM_ALLOC_LIST_USED;
+        return chunk;
+    }
+
+    chunk = list_first_chunk(hot_list);
+    if (chunk)
+        *out_alloc_list = UVM_PMM_ALLOC_LIST_USED_FREQUENT;
+
+    return chunk;
+}
+
+static uvm_gpu_chunk_t *pick_allocated_chunk(uvm_pmm_gpu_t *pmm, bool cold_only)
+{
+    uvm_pmm_alloc_list_t alloc_list = UVM_PMM_ALLOC_LIST_COUNT;
+    uvm_gpu_chunk_t *chunk;
+
+    // LRU never uses the frequent list, so all of its chunks are cold
+    if (pmm->root_chunks.eviction_policy == UVM_PMM_EVICTION_POLICY_CLOCK_PRO)
+        chunk = clock_pro_pick_allocated_chunk(pmm, cold_only, &alloc_list);
+    else
+        chunk = get_first_allocated_chunk(pmm, &alloc_list);
+
+    if (chunk)
+        ++pmm->root_chunks.eviction_stats.num_evicted[alloc_list];
+
+    return chunk;
+}
+
+// Pick a root chunk to evict and start its eviction. If cold_only is set,
+// frequently used chunks are never picked, see
+// clock_pro_pick_allocated_chunk().
+static uvm_gpu_root_chunk_t *pick_root_chunk_to_evict(uvm_pmm_gpu_t *pmm, bool cold_only)
 {
     uvm_gpu_chunk_t *chunk;
 
@@ -1501,7 +1765,7 @@ static uvm_gpu_root_chunk_t *pick_root_chunk_to_evict(uvm_pmm_gpu_t *pmm)
     // TODO: Bug 1765193: Move the chunks to the tail of the used list whenever
     // they get mapped.
     if (!chunk)
-        chunk = get_first_allocated_chunk(pmm);
+        chunk = pick_allocated_chunk(pmm, cold_only);
 
     if (chunk)
         chunk_start_eviction(pmm, chunk);
@@ -1528,7 +1792,7 @@ static NV_STATUS pick_and_evict_root_chunk(uvm_pmm_gpu_t *pmm,
 
     uvm_assert_mutex_locked(&pmm->lock);
 
-    root_chunk = pick_root_chunk_to_evict(pmm);
+    root_chunk = pick_root_chunk_to_evict(pmm, false);
     if (!root_chunk)
         return NV_ERR_NO_MEMORY;
 
@@ -1589,6 +1853,106 @@ static NV_STATUS pick_and_evict_root_chunk_retry(uvm_pmm_gpu_t *pmm,
     return status;
 }
 
+// Whether the reclaimer has anything left to evict: free root chunks in PMM or
+// cold allocated ones. Frequently used chunks are left to inline eviction.
+static bool reclaim_has_candidates(uvm_pmm_gpu_t *pmm)
+{
+    uvm_pmm_alloc_list_t alloc_list;
+    bool result;
+
+    uvm_spin_lock(&pmm->list_lock);
+
+    result = list_first_chunk(find_free_list(pmm,
+                                             UVM_PMM_GPU_MEMORY_TYPE_USER,
+                                             UVM_CHUNK_SIZE_MAX,
+                                             UVM_PMM_LIST_NO_ZERO)) ||
+             list_first_chunk(find_free_list(pmm,
+                                             UVM_PMM_GPU_MEMORY_TYPE_USER,
+                                             UVM_CHUNK_SIZE_MAX,
+                                             UVM_PMM_LIST_ZERO));
+
+    if (!result) {
+        if (pmm->root_chunks.eviction_policy == UVM_PMM_EVICTION_POLICY_CLOCK_PRO)
+            result = clock_pro_find_cold_chunk(pmm, &alloc_list) != NULL;
+        else
+            result = get_first_allocated_chunk(pmm, &alloc_list) != NULL;
+    }
+
+    uvm_spin_unlock(&pmm->list_lock);
+
+    return result;
+}
+
+static NvU64 reclaim_num_free_root_chunks(uvm_pmm_gpu_t *pmm)
+{
+    return READ_ONCE(pmm->pma_stats->numFreePages2m);
+}
+
+static void process_reclaim(void *args)
+{
+    uvm_pmm_gpu_t *pmm = (uvm_pmm_gpu_t *)args;
+
+    atomic64_inc(&pmm->root_chunks.reclaim.num_runs);
+
+    while (reclaim_num_free_root_chunks(pmm) < pmm->root_chunks.reclaim.high_watermark) {
+        uvm_gpu_root_chunk_t *root_chunk;
+        NV_STATUS status;
+
+        if (uvm_global_get_status() != NV_OK)
+            break;
+
+        uvm_mutex_lock(&pmm->lock);
+
+        // Stop once there are no cold chunks left
+        root_chunk = pick_root_chunk_to_evict(pmm, true);
+        if (!root_chunk) {
+            uvm_mutex_unlock(&pmm->lock);
+            break;
+        }
+
+        status = evict_root_chunk(pmm, root_chunk, PMM_CONTEXT_DEFAULT);
+
+        uvm_mutex_unlock(&pmm->lock);
+
+        // The chunk has already been freed back to PMA if it had pages with an
+        // elevated refcount. Move on to the next one.
+        if (status == NV_ERR_IN_USE)
+            continue;
+
+        if (status != NV_OK)
+            break;
+
+        free_root_chunk(pmm, root_chunk, FREE_ROOT_CHUNK_MODE_DEFAULT);
+        atomic64_inc(&pmm->root_chunks.reclaim.num_reclaimed);
+    }
+}
+
+static void process_reclaim_entry(void *args)
+{
+    UVM_ENTRY_VOID(process_reclaim(args));
+}
+
+static void reclaim_wake_up_if_needed(uvm_pmm_gpu_t *pmm)
+{
+    if (pmm->root_chunks.reclaim.low_watermark == 0)
+        return;
+
+    if (reclaim_num_free_root_chunks(pmm) < pmm->root_chunks.reclaim.low_watermark)
+        nv_kthread_q_schedule_q_item(&pmm->root_chunks.reclaim.q, &pmm->root_chunks.reclaim.q_item);
+}
+
+// Account a root chunk allocation that is allowed to evict, and wake up the
+// reclaimer if free memory dropped below the low watermark.
+static void reclaim_update(uvm_pmm_gpu_t *pmm, bool evicted)
+{
+    if (evicted)
+        atomic64_inc(&pmm->root_chunks.reclaim.num_misses);
+    else
+        atomic64_inc(&pmm->root_chunks.reclaim.num_hits);
+
+    reclaim_wake_up_if_needed(pmm);
+}
+
 static uvm_gpu_chunk_t *find_free_chunk_locked(uvm_pmm_gpu_t *pmm,
                                                uvm_pmm_gpu_memory_type_t type,
                                                uvm_chunk_size_t chunk_size,
@@ -1679,17 +2043,23 @@ static NV_STATUS alloc_or_evict_root_chunk(uvm_pmm_gpu_t *pmm,
                                            uvm_gpu_chunk_t **chunk_out)
 {
     uvm_gpu_t *gpu = uvm_pmm_to_gpu(pmm);
+    const bool may_evict = (flags & UVM_PMM_ALLOC_FLAGS_EVICT) && uvm_parent_gpu_supports_eviction(gpu->parent);
     NV_STATUS status;
     uvm_gpu_chunk_t *chunk;
 
     status = alloc_root_chunk(pmm, type, flags, &chunk);
     if (status != NV_OK) {
-        if ((flags & UVM_PMM_ALLOC_FLAGS_EVICT) && uvm_parent_gpu_supports_eviction(gpu->parent))
+        if (may_evict) {
+            reclaim_update(pmm, true);
             status = pick_and_evict_root_chunk_retry(pmm, type, PMM_CONTEXT_DEFAULT, chunk_out);
+        }
 
         return status;
     }
 
+    if (may_evict)
+        reclaim_update(pmm, false);
+
     *chunk_out = chunk;
     return status;
 }
@@ -1701,12 +2071,14 @@ static NV_STATUS alloc_or_evict_root_chunk_unlocked(uvm_pmm_gpu_t *pmm,
                                                     uvm_gpu_chunk_t **chunk_out)
 {
     uvm_gpu_t *gpu = uvm_pmm_to_gpu(pmm);
+    const bool may_evict = (flags & UVM_PMM_ALLOC_FLAGS_EVICT) && uvm_parent_gpu_supports_eviction(gpu->parent);
     NV_STATUS status;
     uvm_gpu_chunk_t *chunk;
 
     status = alloc_root_chunk(pmm, type, flags, &chunk);
     if (status != NV_OK) {
-        if ((flags & UVM_PMM_ALLOC_FLAGS_EVICT) && uvm_parent_gpu_supports_eviction(gpu->parent)) {
+        if (may_evict) {
+            reclaim_update(pmm, true);
             uvm_mutex_lock(&pmm->lock);
             status = pick_and_evict_root_chunk_retry(pmm, type, PMM_CONTEXT_DEFAULT, chunk_out);
             uvm_mutex_unlock(&pmm->lock);
@@ -1715,6 +2087,9 @@ static NV_STATUS alloc_or_evict_root_chunk_unlocked(uvm_pmm_gpu_t *pmm,
         return status;
     }
 
+    if (may_evict)
+        reclaim_update(pmm, false);
+
     *chunk_out = chunk;
     return status;
 }
@@ -2050,6 +2425,7 @@ void free_root_chunk(uvm_pmm_gpu_t *pmm, uvm_gpu_root_chunk_t *root_chunk, free_
     UVM_ASSERT(list_empty(&chunk->list));
 
     chunk_unpin(pmm, chunk, UVM_PMM_GPU_CHUNK_STATE_PMA_OWNED);
+    root_chunk_eviction_reset(root_chunk);
 
     uvm_spin_unlock(&pmm->list_lock);
 
@@ -3448,6 +3824,15 @@ NV_STATUS uvm_pmm_gpu_init(uvm_pmm_gpu_t *pmm)
     for (alloc_list = 0; alloc_list < UVM_PMM_ALLOC_LIST_COUNT; alloc_list++)
         INIT_LIST_HEAD(&pmm->root_chunks.alloc_list[alloc_list]);
 
+    if (uvm_perf_pmm_eviction_policy >= UVM_PMM_EVICTION_POLICY_COUNT) {
+        UVM_INFO_PRINT("Invalid value %u for uvm_perf_pmm_eviction_policy. Using %u instead\n",
+                       uvm_perf_pmm_eviction_policy,
+                       UVM_PERF_PMM_EVICTION_POLICY_DEFAULT);
+        uvm_perf_pmm_eviction_policy = UVM_PERF_PMM_EVICTION_POLICY_DEFAULT;
+    }
+
+    pmm->root_chunks.eviction_policy = uvm_perf_pmm_eviction_policy;
+
     INIT_LIST_HEAD(&pmm->root_chunks.va_block_lazy_free);
     nv_kthread_q_item_init(&pmm->root_chunks.va_block_lazy_free_q_item, process_lazy_free_entry, pmm);
 
@@ -3525,6 +3910,23 @@ NV_STATUS uvm_pmm_gpu_init(uvm_pmm_gpu_t *pmm)
             if (status != NV_OK)
                 goto cleanup;
         }
+
+        if (uvm_perf_pmm_reclaim_low_watermark != 0 && uvm_parent_gpu_supports_eviction(gpu->parent)) {
+            if (uvm_perf_pmm_reclaim_high_watermark < uvm_perf_pmm_reclaim_low_watermark) {
+                UVM_INFO_PRINT("Invalid value %u for uvm_perf_pmm_reclaim_high_watermark. Using %u instead\n",
+                               uvm_perf_pmm_reclaim_high_watermark,
+                               uvm_perf_pmm_reclaim_low_watermark);
+                uvm_perf_pmm_reclaim_high_watermark = uvm_perf_pmm_reclaim_low_watermark;
+            }
+
+            status = errno_to_nv_status(nv_kthread_q_init(&pmm->root_chunks.reclaim.q, "vidmem reclaim"));
+            if (status != NV_OK)
+                goto cleanup;
+
+            nv_kthread_q_item_init(&pmm->root_chunks.reclaim.q_item, process_reclaim_entry, pmm);
+            pmm->root_chunks.reclaim.low_watermark = uvm_perf_pmm_reclaim_low_watermark;
+            pmm->root_chunks.reclaim.high_watermark = uvm_perf_pmm_reclaim_high_watermark;
+        }
     }
 
     return NV_OK;
@@ -3562,6 +3964,9 @@ void uvm_pmm_gpu_deinit(uvm_pmm_gpu_t *pmm)
 
     gpu = uvm_pmm_to_gpu(pmm);
 
+    if (pmm->root_chunks.reclaim.low_watermark != 0)
+        nv_kthread_q_stop(&pmm->root_chunks.reclaim.q);
+
     nv_kthread_q_flush(&gpu->parent->lazy_free_q);
     UVM_ASSERT(list_empty(&pmm->root_chunks.va_block_lazy_free));
     UVM_ASSERT(uvm_pmm_gpu_check_orphan_pages(pmm));
@@ -3711,7 +4116,7 @@ NV_STATUS uvm_test_evict_chunk(UVM_TEST_EVICT_CHUNK_PARAMS *params, struct file
             root_chunk = NULL;
     }
     else if (params->eviction_mode == UvmTestEvictModeDefault) {
-        root_chunk = pick_root_chunk_to_evict(pmm);
+        root_chunk = pick_root_chunk_to_evict(pmm, false);
     }
     else {
         UVM_DBG_PRINT("Invalid eviction mode: 0x%x\n", params->eviction_mode);
@@ -3967,10 +4372,11 @@ NV_STATUS uvm_test_pmm_get_alloc_list(UVM_TEST_PMM_GET_ALLOC_LIST_PARAMS *params
     NV_STATUS status = NV_OK;
 
     // -Wall implies -Wenum-compare, so cast through int to avoid warnings
-    BUILD_BUG_ON((int)UVM_TEST_PMM_ALLOC_LIST_UNUSED    != (int)UVM_PMM_ALLOC_LIST_UNUSED);
-    BUILD_BUG_ON((int)UVM_TEST_PMM_ALLOC_LIST_DISCARDED != (int)UVM_PMM_ALLOC_LIST_DISCARDED);
-    BUILD_BUG_ON((int)UVM_TEST_PMM_ALLOC_LIST_USED      != (int)UVM_PMM_ALLOC_LIST_USED);
-    BUILD_BUG_ON((int)UVM_TEST_PMM_ALLOC_LIST_COUNT     != (int)UVM_PMM_ALLOC_LIST_COUNT);
+    BUILD_BUG_ON((int)UVM_TEST_PMM_ALLOC_LIST_UNUSED        != (int)UVM_PMM_ALLOC_LIST_UNUSED);
+    BUILD_BUG_ON((int)UVM_TEST_PMM_ALLOC_LIST_DISCARDED     != (int)UVM_PMM_ALLOC_LIST_DISCARDED);
+    BUILD_BUG_ON((int)UVM_TEST_PMM_ALLOC_LIST_USED          != (int)UVM_PMM_ALLOC_LIST_USED);
+    BUILD_BUG_ON((int)UVM_TEST_PMM_ALLOC_LIST_USED_FREQUENT != (int)UVM_PMM_ALLOC_LIST_USED_FREQUENT);
+    BUILD_BUG_ON((int)UVM_TEST_PMM_ALLOC_LIST_COUNT         != (int)UVM_PMM_ALLOC_LIST_COUNT);
 
     uvm_va_space_down_read(va_space);
 
@@ -4009,3 +4415,269 @@ out:
     uvm_va_space_up_read(va_space);
     return status;
 }
+
+NV_STATUS uvm_test_pmm_eviction_stats(UVM_TEST_PMM_EVICTION_STATS_PARAMS *params, struct file *filp)
+{
+    uvm_va_space_t *va_space = uvm_va_space_get(filp);
+    uvm_gpu_t *gpu;
+    uvm_pmm_gpu_t *pmm;
+    uvm_pmm_alloc_list_t alloc_list;
+
+    BUILD_BUG_ON((int)UVM_TEST_PMM_EVICTION_POLICY_LRU       != (int)UVM_PMM_EVICTION_POLICY_LRU);
+    BUILD_BUG_ON((int)UVM_TEST_PMM_EVICTION_POLICY_CLOCK_PRO != (int)UVM_PMM_EVICTION_POLICY_CLOCK_PRO);
+    BUILD_BUG_ON((int)UVM_TEST_PMM_EVICTION_POLICY_COUNT     != (int)UVM_PMM_EVICTION_POLICY_COUNT);
+
+    uvm_va_space_down_read(va_space);
+
+    gpu = uvm_va_space_get_gpu_by_uuid(va_space, &params->gpu_uuid);
+    if (!gpu) {
+        uvm_va_space_up_read(va_space);
+        return NV_ERR_INVALID_DEVICE;
+    }
+
+    pmm = &gpu->pmm;
+
+    uvm_spin_lock(&pmm->list_lock);
+
+    params->policy = pmm->root_chunks.eviction_policy;
+    for (alloc_list = 0; alloc_list < UVM_PMM_ALLOC_LIST_COUNT; alloc_list++)
+        params->num_evicted[alloc_list] = pmm->root_chunks.eviction_stats.num_evicted[alloc_list];
+
+    params->num_promoted = pmm->root_chunks.eviction_stats.num_promoted;
+    params->num_demoted = pmm->root_chunks.eviction_stats.num_demoted;
+
+    uvm_spin_unlock(&pmm->list_lock);
+
+    uvm_va_space_up_read(va_space);
+
+    return NV_OK;
+}
+
+#define EVICTION_BENCHMARK_MAX_CHUNKS (1 << 20)
+#define EVICTION_BENCHMARK_MAX_PAGES  (1 << 24)
+#define EVICTION_BENCHMARK_NOT_RESIDENT ((NvU32)-1)
+
+typedef struct
+{
+    uvm_pmm_gpu_t *pmm;
+    uvm_gpu_root_chunk_t *root_chunks;
+    NvU32 num_chunks;
+    NvU32 num_used_chunks;
+
+    // Simulated root chunk backing each page of the workload, and the reverse
+    NvU32 *page_to_chunk;
+    NvU32 *chunk_to_page;
+
+    NvU64 num_bytes_migrated;
+    NvU64 num_hot_misses;
+} eviction_benchmark_t;
+
+static void eviction_benchmark_access(eviction_benchmark_t *bench, NvU32 page, bool is_hot, NvU64 now)
+{
+    uvm_pmm_gpu_t *pmm = bench->pmm;
+    uvm_gpu_root_chunk_t *root_chunk;
+    NvU32 chunk_index = bench->page_to_chunk[page];
+
+    uvm_spin_lock(&pmm->list_lock);
+
+    if (chunk_index != EVICTION_BENCHMARK_NOT_RESIDENT) {
+        root_chunk_eviction_reference_locked(pmm, &bench->root_chunks[chunk_index], now);
+        uvm_spin_unlock(&pmm->list_lock);
+        return;
+    }
+
+    bench->num_bytes_migrated += UVM_CHUNK_SIZE_MAX;
+    if (is_hot)
+        ++bench->num_hot_misses;
+
+    if (bench->num_used_chunks < bench->num_chunks) {
+        chunk_index = bench->num_used_chunks++;
+    }
+    else {
+        uvm_gpu_chunk_t *chunk = pick_allocated_chunk(pmm, false);
+
+        UVM_ASSERT(chunk);
+
+        list_del_init(&chunk->list);
+        root_chunk = container_of(chunk, uvm_gpu_root_chunk_t, chunk);
+        root_chunk_eviction_reset(root_chunk);
+
+        chunk_index = root_chunk - bench->root_chunks;
+        bench->page_to_chunk[bench->chunk_to_page[chunk_index]] = EVICTION_BENCHMARK_NOT_RESIDENT;
+        bench->num_bytes_migrated += UVM_CHUNK_SIZE_MAX;
+    }
+
+    bench->page_to_chunk[page] = chunk_index;
+    bench->chunk_to_page[chunk_index] = page;
+    root_chunk_eviction_used_locked(pmm, &bench->root_chunks[chunk_index], now);
+
+    uvm_spin_unlock(&pmm->list_lock);
+}
+
+static NV_STATUS eviction_benchmark_run(eviction_benchmark_t *bench,
+                                        uvm_pmm_eviction_policy_t policy,
+                                        UVM_TEST_PMM_EVICTION_POLICY_BENCHMARK_PARAMS *params,
+                                        NvU32 num_pages)
+{
+    uvm_pmm_gpu_t *pmm = bench->pmm;
+    uvm_pmm_alloc_list_t alloc_list;
+    NvU64 now = 0;
+    NvU32 iter;
+    NvU32 i;
+
+    memset(pmm, 0, sizeof(*pmm));
+    for (alloc_list = 0; alloc_list < UVM_PMM_ALLOC_LIST_COUNT; alloc_list++)
+        INIT_LIST_HEAD(&pmm->root_chunks.alloc_list[alloc_list]);
+
+    uvm_spin_lock_init(&pmm->list_lock, UVM_LOCK_ORDER_LEAF);
+    pmm->root_chunks.eviction_policy = policy;
+
+    for (i = 0; i < bench->num_chunks; i++) {
+        memset(&bench->root_chunks[i], 0, sizeof(bench->root_chunks[i]));
+        INIT_LIST_HEAD(&bench->root_chunks[i].chunk.list);
+    }
+
+    for (i = 0; i < num_pages; i++)
+        bench->page_to_chunk[i] = EVICTION_BENCHMARK_NOT_RESIDENT;
+
+    bench->num_used_chunks = 0;
+    bench->num_bytes_migrated = 0;
+    bench->num_hot_misses = 0;
+
+    for (iter = 0; iter < params->iterations; iter++) {
+        // Simulated time. It never is 0, which means no reference.
+        now += params->iteration_usec * 1000ULL;
+
+        for (i = 0; i < params->hot_chunks; i++)
+            eviction_benchmark_access(bench, i, true, now);
+
+        for (i = 0; i < params->scan_chunks; i++)
+            eviction_benchmark_access(bench, params->hot_chunks + iter * params->scan_chunks + i, false, now);
+
+        if (fatal_signal_pending(current))
+            return NV_ERR_SIGNAL_PENDING;
+    }
+
+    params->num_bytes_migrated[policy] = bench->num_bytes_migrated;
+    params->num_hot_misses[policy] = bench->num_hot_misses;
+
+    return NV_OK;
+}
+
+NV_STATUS uvm_test_pmm_eviction_policy_benchmark(UVM_TEST_PMM_EVICTION_POLICY_BENCHMARK_PARAMS *params,
+                                                 struct file *filp)
+{
+    eviction_benchmark_t bench = {0};
+    uvm_pmm_eviction_policy_t policy;
+    NvU64 num_pages;
+    NV_STATUS status = NV_OK;
+
+    num_pages = params->hot_chunks + (NvU64)params->scan_chunks * params->iterations;
+
+    if (params->num_chunks == 0 ||
+        params->num_chunks > EVICTION_BENCHMARK_MAX_CHUNKS ||
+        params->hot_chunks >= params->num_chunks ||
+        params->iteration_usec == 0 ||
+        num_pages == 0 ||
+        num_pages > EVICTION_BENCHMARK_MAX_PAGES)
+        return NV_ERR_INVALID_ARGUMENT;
+
+    bench.num_chunks = params->num_chunks;
+    bench.pmm = uvm_kvmalloc(sizeof(*bench.pmm));
+    bench.root_chunks = uvm_kvmalloc(params->num_chunks * sizeof(*bench.root_chunks));
+    bench.chunk_to_page = uvm_kvmalloc(params->num_chunks * sizeof(*bench.chunk_to_page));
+    bench.page_to_chunk = uvm_kvmalloc(num_pages * sizeof(*bench.page_to_chunk));
+    if (!bench.pmm || !bench.root_chunks || !bench.chunk_to_page || !bench.page_to_chunk) {
+        status = NV_ERR_NO_MEMORY;
+        goto done;
+    }
+
+    for (policy = 0; policy < UVM_PMM_EVICTION_POLICY_COUNT; policy++) {
+        status = eviction_benchmark_run(&bench, policy, params, (NvU32)num_pages);
+        if (status != NV_OK)
+            goto done;
+    }
+
+done:
+    uvm_kvfree(bench.page_to_chunk);
+    uvm_kvfree(bench.chunk_to_page);
+    uvm_kvfree(bench.root_chunks);
+    uvm_kvfree(bench.pmm);
+
+    return status;
+}
+
+NV_STATUS uvm_test_pmm_reclaim_watermark(UVM_TEST_PMM_RECLAIM_WATERMARK_PARAMS *params, struct file *filp)
+{
+    NV_STATUS status = NV_OK;
+    uvm_va_space_t *va_space = uvm_va_space_get(filp);
+    uvm_gpu_t *gpu;
+    uvm_pmm_gpu_t *pmm;
+    NvU32 saved_low_watermark;
+    NvU32 saved_high_watermark;
+    NvU64 num_runs;
+    NvU64 num_reclaimed;
+    NvU64 num_frequent_evicted;
+
+    if (params->low_watermark == 0 || params->high_watermark < params->low_watermark)
+        return NV_ERR_INVALID_ARGUMENT;
+
+    gpu = uvm_va_space_retain_gpu_by_uuid(va_space, &params->gpu_uuid);
+    if (!gpu)
+        return NV_ERR_INVALID_DEVICE;
+
+    pmm = &gpu->pmm;
+
+    params->reclaim_enabled = pmm->root_chunks.reclaim.low_watermark != 0;
+    if (!params->reclaim_enabled)
+        goto out;
+
+    // Let any pending run complete with the old watermarks first
+    nv_kthread_q_flush(&pmm->root_chunks.reclaim.q);
+
+    saved_low_watermark = pmm->root_chunks.reclaim.low_watermark;
+    saved_high_watermark = pmm->root_chunks.reclaim.high_watermark;
+    pmm->root_chunks.reclaim.low_watermark = params->low_watermark;
+    pmm->root_chunks.reclaim.high_watermark = params->high_watermark;
+
+    num_runs = atomic64_read(&pmm->root_chunks.reclaim.num_runs);
+    num_reclaimed = atomic64_read(&pmm->root_chunks.reclaim.num_reclaimed);
+
+    uvm_spin_lock(&pmm->list_lock);
+    num_frequent_evicted = pmm->root_chunks.eviction_stats.num_evicted[UVM_PMM_ALLOC_LIST_USED_FREQUENT];
+    uvm_spin_unlock(&pmm->list_lock);
+
+    params->num_free_before = reclaim_num_free_root_chunks(pmm);
+
+    reclaim_wake_up_if_needed(pmm);
+    nv_kthread_q_flush(&pmm->root_chunks.reclaim.q);
+
+    params->num_free_after = reclaim_num_free_root_chunks(pmm);
+    params->woken_up = atomic64_read(&pmm->root_chunks.reclaim.num_runs) != num_runs;
+    params->num_reclaimed = atomic64_read(&pmm->root_chunks.reclaim.num_reclaimed) - num_reclaimed;
+
+    // The reclaimer only runs below the low watermark
+    TEST_CHECK_GOTO(params->woken_up == (params->num_free_before < params->low_watermark), restore);
+
+    if (params->woken_up) {
+        // It stops at the high watermark, or earlier if it ran out of cold
+        // chunks.
+        TEST_CHECK_GOTO(params->num_free_after >= params->high_watermark || !reclaim_has_candidates(pmm), restore);
+    }
+    else {
+        TEST_CHECK_GOTO(params->num_reclaimed == 0, restore);
+    }
+
+    uvm_spin_lock(&pmm->list_lock);
+    if (pmm->root_chunks.eviction_stats.num_evicted[UVM_PMM_ALLOC_LIST_USED_FREQUENT] != num_frequent_evicted)
+        status = NV_ERR_INVALID_STATE;
+    uvm_spin_unlock(&pmm->list_lock);
+
+restore:
+    pmm->root_chunks.reclaim.low_watermark = saved_low_watermark;
+    pmm->root_chunks.reclaim.high_watermark = saved_high_watermark;
+
+out:
+    uvm_gpu_release(gpu);
+    return status;
+}
@@ -197,11 +197,37 @@ typedef enum
     UVM_PMM_ALLOC_LIST_DISCARDED,
 
     // Root chunks used by VA blocks, likely with resident pages.
+    //
+    // With UVM_PMM_EVICTION_POLICY_CLOCK_PRO this only holds the "cold" chunks,
+    // the ones that have not been reused since they were populated.
     UVM_PMM_ALLOC_LIST_USED,
 
+    // Root chunks used by VA blocks that were reused after being populated.
+    // Only used with UVM_PMM_EVICTION_POLICY_CLOCK_PRO. These are evicted last.
+    UVM_PMM_ALLOC_LIST_USED_FREQUENT,
+
     UVM_PMM_ALLOC_LIST_COUNT
 } uvm_pmm_alloc_list_t;
 
+// Policy used to pick which allocated root chunks to evict. Selected with the
+// uvm_perf_pmm_eviction_policy module parameter.
+typedef enum
+{
+    // Evict in LRU order of the unused, discarded and used lists.
+    UVM_PMM_EVICTION_POLICY_LRU,
+
+    // Scan resistant policy in the spirit of CLOCK-Pro. Used root chunks start
+    // cold and are only promoted to UVM_PMM_ALLOC_LIST_USED_FREQUENT when they
+    // are reused, as reported by uvm_pmm_gpu_mark_root_chunk_referenced(),
+    // after uvm_perf_pmm_eviction_reuse_usec has passed since their last
+    // reference. A one-pass scan over a large buffer therefore only recycles
+    // cold chunks. Each eviction also advances a "hot hand" over the frequent
+    // chunks which demotes the ones not referenced since its last pass.
+    UVM_PMM_EVICTION_POLICY_CLOCK_PRO,
+
+    UVM_PMM_EVICTION_POLICY_COUNT
+} uvm_pmm_eviction_policy_t;
+
 // Maximum chunk sizes per type of allocation in single GPU.
 // The worst case today is Maxwell with 4 allocations sizes for page tables and
 // 2 page sizes used by uvm_mem_t. Notably one of the allocations for page
@@ -349,6 +375,22 @@ typedef struct uvm_gpu_root_chunk_struct
     //
     // Protected by the corresponding root chunk bit lock.
     uvm_tracker_t tracker;
+
+    // State of UVM_PMM_EVICTION_POLICY_CLOCK_PRO. Reset whenever the chunk
+    // stops holding VA block data.
+    //
+    // Protected by the PMM list lock.
+    struct
+    {
+        // Time in nanoseconds of the last reference that was counted
+        NvU64 last_reference_time;
+
+        // Referenced since the chunk was last passed by one of the hands
+        bool referenced;
+
+        // Whether the chunk is on UVM_PMM_ALLOC_LIST_USED_FREQUENT when used
+        bool frequent;
+    } eviction;
 } uvm_gpu_root_chunk_t;
 
 typedef struct uvm_pmm_gpu_struct
@@ -379,6 +421,42 @@ typedef struct uvm_pmm_gpu_struct
         // LRU lists for picking which root chunks to evict
         struct list_head alloc_list[UVM_PMM_ALLOC_LIST_COUNT];
 
+        // Policy used to pick root chunks from alloc_list
+        uvm_pmm_eviction_policy_t eviction_policy;
+
+        // Eviction statistics, protected by the PMM list lock
+        struct
+        {
+            // Root chunks picked for eviction from each of the alloc lists
+            NvU64 num_evicted[UVM_PMM_ALLOC_LIST_COUNT];
+
+            // Root chunks moved between the used lists
+            NvU64 num_promoted;
+            NvU64 num_demoted;
+        } eviction_stats;
+
+        // Background reclaim of root chunks, see
+        // uvm_perf_pmm_reclaim_low_watermark. Only enabled if low_watermark is
+        // not 0.
+        struct
+        {
+            nv_kthread_q_t q;
+            nv_kthread_q_item_t q_item;
+
+            // Watermarks, in number of free root chunks in PMA
+            NvU32 low_watermark;
+            NvU32 high_watermark;
+
+            // Root chunk allocations allowed to evict that found free memory
+            // (hits) or had to evict inline (misses)
+            atomic64_t num_hits;
+            atomic64_t num_misses;
+
+            // Times the reclaimer was woken up, and root chunks it evicted
+            atomic64_t num_runs;
+            atomic64_t num_reclaimed;
+        } reclaim;
+
         // List of chunks needing to be lazily freed and a queue for processing
         // the list. TODO: Bug 3881835: revisit whether to use nv_kthread_q_t or
         // workqueue.
@@ -581,6 +659,13 @@ void uvm_pmm_gpu_mark_root_chunk_unused(uvm_pmm_gpu_t *pmm, uvm_gpu_chunk_t *chu
 // Mark an allocated chunk as discarded
 void uvm_pmm_gpu_mark_root_chunk_discarded(uvm_pmm_gpu_t *pmm, uvm_gpu_chunk_t *chunk);
 
+// Report a reuse of a used user chunk, for example a GPU fault or an access
+// counter notification serviced on memory already resident in it. This is the
+// signal UVM_PMM_EVICTION_POLICY_CLOCK_PRO uses to tell hot chunks from cold
+// ones. Like uvm_pmm_gpu_mark_root_chunk_used(), this doesn't do anything if
+// the chunk is pinned or selected for eviction.
+void uvm_pmm_gpu_mark_root_chunk_referenced(uvm_pmm_gpu_t *pmm, uvm_gpu_chunk_t *chunk);
+
 static bool uvm_gpu_chunk_same_root(uvm_gpu_chunk_t *chunk1, uvm_gpu_chunk_t *chunk2)
 {
     return UVM_ALIGN_DOWN(chunk1->address, UVM_CHUNK_SIZE_MAX) == UVM_ALIGN_DOWN(chunk2->address, UVM_CHUNK_SIZE_MAX);
@@ -649,5 +734,9 @@ static uvm_chunk_size_t uvm_chunk_find_prev_size(uvm_chunk_sizes_mask_t chunk_si
          (__size) = uvm_chunk_find_prev_size((__chunk_sizes), (__size)))
 
 NV_STATUS uvm_test_pmm_get_alloc_list(UVM_TEST_PMM_GET_ALLOC_LIST_PARAMS *params, struct file *filp);
+NV_STATUS uvm_test_pmm_eviction_stats(UVM_TEST_PMM_EVICTION_STATS_PARAMS *params, struct file *filp);
+NV_STATUS uvm_test_pmm_eviction_policy_benchmark(UVM_TEST_PMM_EVICTION_POLICY_BENCHMARK_PARAMS *params,
+                                                 struct file *filp);
+NV_STATUS uvm_test_pmm_reclaim_watermark(UVM_TEST_PMM_RECLAIM_WATERMARK_PARAMS *params, struct file *filp);
 
 #endif
@@ -31,6 +31,9 @@ static int uvm_cpu_chunk_allocation_sizes = UVM_CPU_CHUNK_SIZES;
 module_param(uvm_cpu_chunk_allocation_sizes, uint, S_IRUGO | S_IWUSR);
 MODULE_PARM_DESC(uvm_cpu_chunk_allocation_sizes, "OR'ed value of all CPU chunk allocation sizes.");
 
+// Per-node allocation counters, see uvm_cpu_chunk_get_node_allocated_pages()
+static atomic64_t g_cpu_chunk_node_allocated_pages[MAX_NUMNODES];
+
 NV_STATUS uvm_pmm_sysmem_init(void)
 {
     // Ensure that only supported CPU chunk sizes are enabled.
@@ -529,10 +532,37 @@ NV_STATUS uvm_cpu_chunk_alloc(uvm_chunk_size_t alloc_size,
     chunk->common.type = UVM_CPU_CHUNK_TYPE_PHYSICAL;
     chunk->common.page = page;
 
+    atomic64_add(alloc_size / PAGE_SIZE, &g_cpu_chunk_node_allocated_pages[page_to_nid(page)]);
+
     *new_chunk = &chunk->common;
     return NV_OK;
 }
 
+int uvm_cpu_chunk_interleave_node(NvU64 index)
+{
+    unsigned int num_nodes = num_node_state(N_MEMORY);
+    unsigned int position;
+    int nid;
+
+    if (num_nodes == 0)
+        return NUMA_NO_NODE;
+
+    position = index % num_nodes;
+    for_each_node_state(nid, N_MEMORY) {
+        if (position-- == 0)
+            return nid;
+    }
+
+    return NUMA_NO_NODE;
+}
+
+NvU64 uvm_cpu_chunk_get_node_allocated_pages(int nid)
+{
+    UVM_ASSERT(nid >= 0 && nid < MAX_NUMNODES);
+
+    return atomic64_read(&g_cpu_chunk_node_allocated_pages[nid]);
+}
+
 NV_STATUS uvm_cpu_chunk_alloc_hmm(struct page *page,
                                   uvm_cpu_chunk_t **new_chunk)
 {
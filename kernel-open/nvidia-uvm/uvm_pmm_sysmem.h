@@ -204,6 +204,15 @@ NV_STATUS uvm_cpu_chunk_alloc(uvm_chunk_size_t alloc_size,
                               int nid,
                               uvm_cpu_chunk_t **new_chunk);
 
+// Return the NUMA node with memory at position index modulo the number of
+// such nodes. NUMA_NO_NODE is returned if memory nodes are concurrently
+// removed.
+int uvm_cpu_chunk_interleave_node(NvU64 index);
+
+// Return the number of base pages allocated by uvm_cpu_chunk_alloc() on the
+// given NUMA node since the module was loaded.
+NvU64 uvm_cpu_chunk_get_node_allocated_pages(int nid);
+
 // Allocate a HMM CPU chunk.
 //
 // HMM chunks differ from normal CPU chunks in that the kernel has already
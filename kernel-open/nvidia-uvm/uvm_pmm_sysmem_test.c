@@ -794,21 +794,49 @@ static NV_STATUS test_cpu_chunk_numa_alloc(uvm_va_space_t *va_space)
     uvm_cpu_chunk_t *chunk;
     uvm_chunk_sizes_mask_t alloc_sizes = uvm_cpu_chunk_get_allocation_sizes();
     size_t size;
+    NvU64 index;
+    NV_STATUS status = NV_OK;
 
     for_each_chunk_size(size, alloc_sizes) {
         int nid;
 
         for_each_possible_uvm_node(nid) {
+            NvU64 allocated_pages;
+            size_t i;
+
             // Do not test CPU allocation on nodes that have no memory or CPU
             if (!node_state(nid, N_MEMORY) || !node_state(nid, N_CPU))
                 continue;
 
-            TEST_NV_CHECK_RET(test_cpu_chunk_alloc(size, UVM_CPU_CHUNK_ALLOC_FLAGS_NONE, nid, &chunk));
+            allocated_pages = uvm_cpu_chunk_get_node_allocated_pages(nid);
+
+            // Strict allocations can't fall back to other nodes, so all the
+            // pages of the chunk have to be on nid.
+            TEST_NV_CHECK_RET(test_cpu_chunk_alloc(size, UVM_CPU_CHUNK_ALLOC_FLAGS_STRICT, nid, &chunk));
+
+            for (i = 0; i < uvm_cpu_chunk_num_pages(chunk); i++)
+                TEST_CHECK_GOTO(page_to_nid(chunk->page + i) == nid, done);
+
+            // Other threads may allocate concurrently, so the per-node counter
+            // can only be checked for a lower bound.
+            TEST_CHECK_GOTO(uvm_cpu_chunk_get_node_allocated_pages(nid) >= allocated_pages + size / PAGE_SIZE, done);
+
             uvm_cpu_chunk_free(chunk);
         }
     }
 
+    // Interleaving only selects nodes with memory
+    for (index = 0; index < 2 * MAX_NUMNODES; index++) {
+        int nid = uvm_cpu_chunk_interleave_node(index);
+
+        TEST_CHECK_RET(nid == NUMA_NO_NODE || node_state(nid, N_MEMORY));
+    }
+
     return NV_OK;
+
+done:
+    uvm_cpu_chunk_free(chunk);
+    return status;
 }
 
 static uvm_gpu_t *find_first_parent_gpu(const uvm_processor_mask_t *test_gpus,
@@ -909,3 +937,13 @@ done:
     uvm_processor_mask_cache_free(test_gpus);
     return status;
 }
+
+NV_STATUS uvm_test_get_cpu_chunk_node_stats(UVM_TEST_GET_CPU_CHUNK_NODE_STATS_PARAMS *params, struct file *filp)
+{
+    if (params->nid < 0 || params->nid >= MAX_NUMNODES || !node_possible(params->nid))
+        return NV_ERR_INVALID_ARGUMENT;
+
+    params->allocated_pages = uvm_cpu_chunk_get_node_allocated_pages(params->nid);
+
+    return NV_OK;
+}
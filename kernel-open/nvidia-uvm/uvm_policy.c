@@ -960,6 +960,81 @@ NV_STATUS uvm_api_disable_read_duplication(const UVM_DISABLE_READ_DUPLICATION_PA
     return read_duplication_set(va_space, params->requestedBase, params->length, false);
 }
 
+static bool cpu_numa_placement_is_split_needed(const uvm_va_policy_t *policy, void *data)
+{
+    UvmCpuNumaPlacement new_placement;
+
+    UVM_ASSERT(data);
+
+    new_placement = *(UvmCpuNumaPlacement *)data;
+    return policy->cpu_numa_placement != new_placement;
+}
+
+NV_STATUS uvm_api_set_cpu_numa_placement(const UVM_SET_CPU_NUMA_PLACEMENT_PARAMS *params, struct file *filp)
+{
+    uvm_va_space_t *va_space = uvm_va_space_get(filp);
+    const NvU64 last_address = params->requestedBase + params->length - 1;
+    UvmCpuNumaPlacement new_placement;
+    uvm_va_range_managed_t *managed_range;
+    uvm_va_range_managed_t *managed_range_last = NULL;
+    uvm_api_range_type_t type;
+    struct mm_struct *mm;
+    NV_STATUS status;
+
+    if (params->placement >= UvmCpuNumaPlacementCount)
+        return NV_ERR_INVALID_ARGUMENT;
+
+    new_placement = (UvmCpuNumaPlacement)params->placement;
+
+    // The placement only applies to future allocations, so no mappings are
+    // created. mmap_lock is only needed to validate the range.
+    mm = uvm_va_space_mm_or_current_retain_lock(va_space);
+    uvm_va_space_down_write(va_space);
+
+    type = uvm_api_range_type_check(va_space, mm, params->requestedBase, params->length);
+    if (type == UVM_API_RANGE_TYPE_INVALID) {
+        status = NV_ERR_INVALID_ADDRESS;
+        goto done;
+    }
+    else if (type == UVM_API_RANGE_TYPE_ATS) {
+        status = NV_OK;
+        goto done;
+    }
+    else if (type == UVM_API_RANGE_TYPE_HMM) {
+        // HMM pages may be allocated by the kernel, which doesn't follow UVM
+        // NUMA placement. See block_select_node_residency.
+        status = NV_ERR_NOT_SUPPORTED;
+        goto done;
+    }
+
+    status = split_span_as_needed(va_space,
+                                  params->requestedBase,
+                                  last_address + 1,
+                                  cpu_numa_placement_is_split_needed,
+                                  &new_placement);
+    if (status != NV_OK)
+        goto done;
+
+    uvm_for_each_va_range_managed_in_contig(managed_range, va_space, params->requestedBase, last_address) {
+        managed_range_last = managed_range;
+
+        // If we didn't split the ends, check that they match
+        if (managed_range->va_range.node.start < params->requestedBase ||
+            managed_range->va_range.node.end > last_address)
+            UVM_ASSERT(managed_range->policy.cpu_numa_placement == new_placement);
+
+        managed_range->policy.cpu_numa_placement = new_placement;
+    }
+
+    UVM_ASSERT(managed_range_last);
+    UVM_ASSERT(managed_range_last->va_range.node.end >= last_address);
+
+done:
+    uvm_va_space_up_write(va_space);
+    uvm_va_space_mm_or_current_release_unlock(va_space, mm);
+    return status;
+}
+
 static NV_STATUS system_wide_atomics_set(uvm_va_space_t *va_space, const NvProcessorUuid *gpu_uuid, bool enable)
 {
     NV_STATUS status = NV_OK;
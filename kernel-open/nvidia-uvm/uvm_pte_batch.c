@@ -24,6 +24,12 @@
 #include "uvm_pte_batch.h"
 #include "uvm_hal.h"
 
+// Whether non-consecutive PTE writes can share an inline data fragment, see
+// UVM_PTE_BATCH_MAX_RUNS.
+static int uvm_pte_batch_inline_runs __read_mostly = 1;
+module_param(uvm_pte_batch_inline_runs, int, S_IRUGO|S_IWUSR);
+MODULE_PARM_DESC(uvm_pte_batch_inline_runs, "Share a single inline data fragment between non-consecutive PTE writes");
+
 static bool uvm_gpu_phys_address_eq(uvm_gpu_phys_address_t pa1, uvm_gpu_phys_address_t pa2)
 {
     return pa1.address == pa2.address && pa1.aperture == pa2.aperture;
@@ -37,11 +43,30 @@ void uvm_pte_batch_begin(uvm_push_t *push, uvm_pte_batch_t *batch)
     batch->push = push;
 }
 
+static void pte_batch_copy_run(uvm_pte_batch_t *batch,
+                               uvm_gpu_address_t inline_data_addr,
+                               uvm_gpu_phys_address_t pte_first_address,
+                               NvU32 offset,
+                               NvU32 size)
+{
+    uvm_gpu_t *gpu = uvm_push_get_gpu(batch->push);
+
+    inline_data_addr.address += offset;
+
+    uvm_push_set_flag(batch->push, UVM_PUSH_FLAG_NEXT_MEMBAR_NONE);
+    uvm_push_set_flag(batch->push, UVM_PUSH_FLAG_CE_NEXT_PIPELINED);
+    gpu->parent->ce_hal->memcopy(batch->push,
+                                 uvm_mmu_gpu_address(gpu, pte_first_address),
+                                 inline_data_addr,
+                                 size);
+}
+
 static void uvm_pte_batch_flush_ptes_inline(uvm_pte_batch_t *batch)
 {
     uvm_gpu_address_t inline_data_addr;
-    uvm_gpu_t *gpu = uvm_push_get_gpu(batch->push);
-    size_t ptes_size = batch->pte_count * batch->pte_entry_size;
+    size_t ptes_size = batch->pte_run_offset + batch->pte_count * batch->pte_entry_size;
+    NvU32 run_offset = 0;
+    NvU32 i;
 
     UVM_ASSERT(batch->pte_count != 0);
     UVM_ASSERT(batch->inlining);
@@ -51,12 +76,24 @@ static void uvm_pte_batch_flush_ptes_inline(uvm_pte_batch_t *batch)
     batch->inlining = false;
     inline_data_addr = uvm_push_inline_data_end(&batch->inline_data);
 
-    uvm_push_set_flag(batch->push, UVM_PUSH_FLAG_NEXT_MEMBAR_NONE);
-    uvm_push_set_flag(batch->push, UVM_PUSH_FLAG_CE_NEXT_PIPELINED);
-    gpu->parent->ce_hal->memcopy(batch->push,
-                                 uvm_mmu_gpu_address(gpu, batch->pte_first_address),
-                                 inline_data_addr,
-                                 ptes_size);
+    for (i = 0; i < batch->run_count; ++i) {
+        uvm_gpu_phys_address_t run_address = uvm_gpu_phys_address(batch->pte_first_address.aperture,
+                                                                   batch->run_addresses[i]);
+
+        pte_batch_copy_run(batch, inline_data_addr, run_address, run_offset, batch->run_sizes[i]);
+        run_offset += batch->run_sizes[i];
+    }
+
+    UVM_ASSERT(run_offset == batch->pte_run_offset);
+
+    pte_batch_copy_run(batch,
+                       inline_data_addr,
+                       batch->pte_first_address,
+                       batch->pte_run_offset,
+                       batch->pte_count * batch->pte_entry_size);
+
+    batch->run_count = 0;
+    batch->pte_run_offset = 0;
 }
 
 static void uvm_pte_batch_flush_ptes_memset(uvm_pte_batch_t *batch)
@@ -89,6 +126,49 @@ static void uvm_pte_batch_flush_ptes(uvm_pte_batch_t *batch)
     batch->pte_count = 0;
 }
 
+// Start a new run of entry_count PTEs of entry_size at first_pte within the
+// on-going inline data fragment.
+//
+// Returns false if there is no on-going fragment or it can't fit the run, in
+// which case the caller has to flush the batch.
+static bool pte_batch_start_inline_run(uvm_pte_batch_t *batch,
+                                       uvm_gpu_phys_address_t first_pte,
+                                       NvU32 entry_size,
+                                       NvU32 entry_count)
+{
+    size_t data_size;
+
+    // The run sizes are stored as 16-bit values
+    BUILD_BUG_ON(UVM_PUSH_INLINE_DATA_MAX_SIZE > 0xffff);
+
+    if (!batch->inlining || !uvm_pte_batch_inline_runs)
+        return false;
+
+    if (batch->run_count == UVM_PTE_BATCH_MAX_RUNS)
+        return false;
+
+    // Only the aperture of the on-going run is tracked
+    if (first_pte.aperture != batch->pte_first_address.aperture)
+        return false;
+
+    data_size = uvm_push_inline_data_size(&batch->inline_data);
+    if (data_size + entry_size * entry_count > UVM_PUSH_INLINE_DATA_MAX_SIZE)
+        return false;
+
+    UVM_ASSERT(batch->pte_count != 0);
+
+    batch->run_addresses[batch->run_count] = batch->pte_first_address.address;
+    batch->run_sizes[batch->run_count] = batch->pte_count * batch->pte_entry_size;
+    ++batch->run_count;
+
+    batch->pte_first_address = first_pte;
+    batch->pte_entry_size = entry_size;
+    batch->pte_run_offset = data_size;
+    batch->pte_count = 0;
+
+    return true;
+}
+
 static void uvm_pte_batch_write_consecutive_inline(uvm_pte_batch_t *batch, NvU64 pte_bits)
 {
     size_t extra_size = batch->pte_entry_size - sizeof(pte_bits);
@@ -141,16 +221,17 @@ void uvm_pte_batch_write_ptes(uvm_pte_batch_t *batch, uvm_gpu_phys_address_t fir
         batch->membar = UVM_MEMBAR_SYS;
 
     while (entry_count > 0) {
-        NvU32 entries_this_time;
+        NvU32 entries_this_time = min(max_entries, entry_count);
 
-        uvm_pte_batch_flush_ptes(batch);
-        pte_batch_begin_inline(batch);
+        if (!pte_batch_start_inline_run(batch, first_pte, entry_size, entries_this_time)) {
+            uvm_pte_batch_flush_ptes(batch);
+            pte_batch_begin_inline(batch);
 
-        entries_this_time = min(max_entries, entry_count);
-        uvm_push_inline_data_add(&batch->inline_data, pte_bits, entries_this_time * entry_size);
+            batch->pte_entry_size = entry_size;
+            batch->pte_first_address = first_pte;
+        }
 
-        batch->pte_entry_size = entry_size;
-        batch->pte_first_address = first_pte;
+        uvm_push_inline_data_add(&batch->inline_data, pte_bits, entries_this_time * entry_size);
         batch->pte_count = entries_this_time;
 
         pte_bits += entries_this_time * (entry_size / sizeof(*pte_bits));
@@ -174,14 +255,13 @@ void uvm_pte_batch_write_pte(uvm_pte_batch_t *batch, uvm_gpu_phys_address_t pte,
 
     // Note that pte_count and pte_entry_size can be zero for the first PTE.
     // That's ok as the first PTE will never need a flush.
-    if ((batch->pte_count + 1) * batch->pte_entry_size > UVM_PUSH_INLINE_DATA_MAX_SIZE)
-        needs_flush = true;
-
-    if (!uvm_gpu_phys_address_eq(pte, consecutive_pte_address))
-        needs_flush = true;
-
-    if (batch->pte_entry_size != pte_size)
+    if (batch->pte_entry_size == pte_size && uvm_gpu_phys_address_eq(pte, consecutive_pte_address)) {
+        if (batch->pte_run_offset + (batch->pte_count + 1) * batch->pte_entry_size > UVM_PUSH_INLINE_DATA_MAX_SIZE)
+            needs_flush = true;
+    }
+    else if (!pte_batch_start_inline_run(batch, pte, pte_size, 1)) {
         needs_flush = true;
+    }
 
     if (needs_flush) {
         uvm_pte_batch_flush_ptes(batch);
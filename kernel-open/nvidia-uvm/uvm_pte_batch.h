@@ -42,6 +42,15 @@
 //       change as inline memcopy would have lower latency.
 #define UVM_PTE_BATCH_MAX_PTES 4
 
+// Max runs of consecutive PTEs that can share a single inline data fragment, in
+// addition to the on-going run. Once the batch switched to inline memcopy, a PTE
+// write that isn't consecutive with the previous one, but is in the same
+// aperture, starts a new run within the same fragment instead of flushing it.
+// Mapping a fragmented VA block then costs one NOOP method per
+// UVM_PTE_BATCH_MAX_RUNS + 1 runs and one memcopy per run. PTE batches take
+// space on the stack, next to a TLB batch, so this is kept small.
+#define UVM_PTE_BATCH_MAX_RUNS 8
+
 struct uvm_pte_batch_struct
 {
     uvm_push_t *push;
@@ -54,6 +63,16 @@ struct uvm_pte_batch_struct
     NvU64 pte_bits_queue[UVM_PTE_BATCH_MAX_PTES];
     NvU32 pte_count;
 
+    // Offset of the on-going run within the inline data fragment
+    NvU32 pte_run_offset;
+
+    // Completed runs of the inline data fragment, only used while inlining.
+    // The runs are laid out back to back in the fragment, starting at offset
+    // 0, and are all in the aperture of pte_first_address.
+    NvU64 run_addresses[UVM_PTE_BATCH_MAX_RUNS];
+    NvU16 run_sizes[UVM_PTE_BATCH_MAX_RUNS];
+    NvU32 run_count;
+
     // A membar to be applied after all the PTE writes.
     // Starts out as UVM_MEMBAR_GPU and is promoted to UVM_MEMBAR_SYS if any of
     // the written PTEs are in sysmem.
@@ -109,6 +109,11 @@ struct uvm_push_struct
 
     // Channel to use for indirect submission
     uvm_channel_t *launch_channel;
+
+    // Number of bytes written by the CE operations in the push. Used by the
+    // channel manager to balance pushes across channels, see
+    // uvm_channel_t::in_flight_bytes.
+    NvU64 transferred_bytes;
 };
 
 #define UVM_PUSH_ACQUIRE_INFO_MAX_ENTRIES 16
@@ -485,6 +490,12 @@ static uvm_gpu_t *uvm_push_get_gpu(uvm_push_t *push)
     return push->gpu;
 }
 
+// Account for size bytes written by a CE operation in the push
+static void uvm_push_add_transferred_bytes(uvm_push_t *push, NvU64 size)
+{
+    push->transferred_bytes += size;
+}
+
 // Validate that the given method can be pushed to the underlying channel. The
 // method contents can be used to further validate individual fields.
 bool uvm_push_method_is_valid(uvm_push_t *push, NvU8 subch, NvU32 method_address, NvU32 method_data);
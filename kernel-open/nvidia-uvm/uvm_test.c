@@ -360,6 +360,32 @@ long uvm_test_ioctl(struct file *filp, unsigned int cmd, unsigned long arg)
         UVM_ROUTE_CMD_STACK_INIT_CHECK(UVM_TEST_VA_BLOCK_DISCARD_STATUS,      uvm_test_va_block_discard_status);
         UVM_ROUTE_CMD_STACK_INIT_CHECK(UVM_TEST_PMM_GET_ALLOC_LIST,           uvm_test_pmm_get_alloc_list);
         UVM_ROUTE_CMD_STACK_INIT_CHECK(UVM_TEST_DUMP_ACCESS_BITS,             uvm_test_dump_access_bits);
+        UVM_ROUTE_CMD_STACK_INIT_CHECK(UVM_TEST_SET_FAULT_SERVICE_WORKERS,    uvm_test_set_fault_service_workers);
+        UVM_ROUTE_CMD_STACK_INIT_CHECK(UVM_TEST_GET_FAULT_SERVICE_WORKERS,    uvm_test_get_fault_service_workers);
+        UVM_ROUTE_CMD_STACK_INIT_CHECK(UVM_TEST_FAULT_BATCH_SORT_PERF,        uvm_test_fault_batch_sort_perf);
+        UVM_ROUTE_CMD_STACK_INIT_CHECK(UVM_TEST_GET_PREFETCH_ADAPTIVE_STATE,  uvm_test_get_prefetch_adaptive_state);
+        UVM_ROUTE_CMD_STACK_INIT_CHECK(UVM_TEST_SET_FAULT_REPLAY_POLICY,      uvm_test_set_fault_replay_policy);
+        UVM_ROUTE_CMD_STACK_INIT_CHECK(UVM_TEST_GET_FAULT_REPLAY_POLICY_STATS, uvm_test_get_fault_replay_policy_stats);
+        UVM_ROUTE_CMD_STACK_INIT_CHECK(UVM_TEST_FAULT_TRACE_REPLAY,           uvm_test_fault_trace_replay);
+        UVM_ROUTE_CMD_STACK_INIT_CHECK(UVM_TEST_PMM_EVICTION_STATS,           uvm_test_pmm_eviction_stats);
+        UVM_ROUTE_CMD_STACK_INIT_CHECK(UVM_TEST_PMM_EVICTION_POLICY_BENCHMARK, uvm_test_pmm_eviction_policy_benchmark);
+        UVM_ROUTE_CMD_STACK_INIT_CHECK(UVM_TEST_GET_BLOCK_THRASHING_STATE, uvm_test_get_block_thrashing_state);
+        UVM_ROUTE_CMD_STACK_NO_INIT_CHECK(UVM_TEST_GET_CPU_CHUNK_NODE_STATS, uvm_test_get_cpu_chunk_node_stats);
+        UVM_ROUTE_CMD_STACK_INIT_CHECK(UVM_TEST_CE_COPY_BANDWIDTH, uvm_test_ce_copy_bandwidth);
+        UVM_ROUTE_CMD_STACK_INIT_CHECK(UVM_TEST_VA_SPACE_LOCK_STATS, uvm_test_va_space_lock_stats);
+        UVM_ROUTE_CMD_STACK_NO_INIT_CHECK(UVM_TEST_KVMALLOC_OBJECT_STATS, uvm_test_kvmalloc_object_stats);
+        UVM_ROUTE_CMD_STACK_NO_INIT_CHECK(UVM_TEST_PAGE_MASK_BENCHMARK,   uvm_test_page_mask_benchmark);
+        UVM_ROUTE_CMD_STACK_INIT_CHECK(UVM_TEST_HMM_MUNMAP_CHECK,         uvm_test_hmm_munmap_check);
+        UVM_ROUTE_CMD_STACK_INIT_CHECK(UVM_TEST_GET_PREFETCH_STREAM_STATE, uvm_test_get_prefetch_stream_state);
+        UVM_ROUTE_CMD_STACK_NO_INIT_CHECK(UVM_TEST_PREFETCH_STREAM_SANITY, uvm_test_prefetch_stream_sanity);
+        UVM_ROUTE_CMD_STACK_INIT_CHECK(UVM_TEST_PMM_RECLAIM_WATERMARK,    uvm_test_pmm_reclaim_watermark);
+        UVM_ROUTE_CMD_STACK_INIT_CHECK(UVM_TEST_FAULT_REPLAY_POLICY_BENCHMARK, uvm_test_fault_replay_policy_benchmark);
+        UVM_ROUTE_CMD_STACK_INIT_CHECK(UVM_TEST_VA_BLOCK_COPY_COALESCE,   uvm_test_va_block_copy_coalesce);
+        UVM_ROUTE_CMD_STACK_INIT_CHECK(UVM_TEST_TOOLS_PER_CPU_RINGS,      uvm_test_tools_per_cpu_rings);
+        UVM_ROUTE_CMD_STACK_INIT_CHECK(UVM_TEST_MIGRATE_BATCH,            uvm_test_migrate_batch);
+        UVM_ROUTE_CMD_STACK_INIT_CHECK(UVM_TEST_HMM_SET_INVALIDATE_BATCH, uvm_test_hmm_set_invalidate_batch);
+        UVM_ROUTE_CMD_STACK_INIT_CHECK(UVM_TEST_HMM_MUNMAP_BENCHMARK,     uvm_test_hmm_munmap_benchmark);
+        UVM_ROUTE_CMD_STACK_INIT_CHECK(UVM_TEST_CPU_NUMA_PLACEMENT,       uvm_test_cpu_numa_placement);
     }
 
     return -EINVAL;
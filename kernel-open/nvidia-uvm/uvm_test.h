@@ -147,6 +147,8 @@ NV_STATUS uvm_test_set_prefetch_filtering(UVM_TEST_SET_PREFETCH_FILTERING_PARAMS
 
 NV_STATUS uvm_test_va_block(UVM_TEST_VA_BLOCK_PARAMS *params, struct file *filp);
 
+NV_STATUS uvm_test_page_mask_benchmark(UVM_TEST_PAGE_MASK_BENCHMARK_PARAMS *params, struct file *filp);
+
 NV_STATUS uvm_test_evict_chunk(UVM_TEST_EVICT_CHUNK_PARAMS *params, struct file *filp);
 
 NV_STATUS uvm_test_flush_deferred_work(UVM_TEST_FLUSH_DEFERRED_WORK_PARAMS *params, struct file *filp);
@@ -154,6 +156,7 @@ NV_STATUS uvm_test_flush_deferred_work(UVM_TEST_FLUSH_DEFERRED_WORK_PARAMS *para
 NV_STATUS uvm_test_set_page_prefetch_policy(UVM_TEST_SET_PAGE_PREFETCH_POLICY_PARAMS *params, struct file *filp);
 NV_STATUS uvm_test_get_page_thrashing_policy(UVM_TEST_GET_PAGE_THRASHING_POLICY_PARAMS *params, struct file *filp);
 NV_STATUS uvm_test_set_page_thrashing_policy(UVM_TEST_SET_PAGE_THRASHING_POLICY_PARAMS *params, struct file *filp);
+NV_STATUS uvm_test_get_block_thrashing_state(UVM_TEST_GET_BLOCK_THRASHING_STATE_PARAMS *params, struct file *filp);
 
 NV_STATUS uvm_test_range_group_tree(UVM_TEST_RANGE_GROUP_TREE_PARAMS *params, struct file *filp);
 NV_STATUS uvm_test_range_group_range_info(UVM_TEST_RANGE_GROUP_RANGE_INFO_PARAMS *params, struct file *filp);
@@ -176,6 +179,19 @@ NV_STATUS uvm_test_pmm_release_free_root_chunks(UVM_TEST_PMM_RELEASE_FREE_ROOT_C
                                                 struct file *filp);
 
 NV_STATUS uvm_test_drain_replayable_faults(UVM_TEST_DRAIN_REPLAYABLE_FAULTS_PARAMS *params, struct file *filp);
+NV_STATUS uvm_test_set_fault_service_workers(UVM_TEST_SET_FAULT_SERVICE_WORKERS_PARAMS *params, struct file *filp);
+NV_STATUS uvm_test_get_fault_service_workers(UVM_TEST_GET_FAULT_SERVICE_WORKERS_PARAMS *params, struct file *filp);
+NV_STATUS uvm_test_fault_batch_sort_perf(UVM_TEST_FAULT_BATCH_SORT_PERF_PARAMS *params, struct file *filp);
+NV_STATUS uvm_test_get_prefetch_adaptive_state(UVM_TEST_GET_PREFETCH_ADAPTIVE_STATE_PARAMS *params, struct file *filp);
+NV_STATUS uvm_test_get_prefetch_stream_state(UVM_TEST_GET_PREFETCH_STREAM_STATE_PARAMS *params, struct file *filp);
+NV_STATUS uvm_test_prefetch_stream_sanity(UVM_TEST_PREFETCH_STREAM_SANITY_PARAMS *params, struct file *filp);
+NV_STATUS uvm_test_set_fault_replay_policy(UVM_TEST_SET_FAULT_REPLAY_POLICY_PARAMS *params, struct file *filp);
+NV_STATUS uvm_test_get_fault_replay_policy_stats(UVM_TEST_GET_FAULT_REPLAY_POLICY_STATS_PARAMS *params,
+                                                 struct file *filp);
+NV_STATUS uvm_test_fault_trace_replay(UVM_TEST_FAULT_TRACE_REPLAY_PARAMS *params, struct file *filp);
+NV_STATUS uvm_test_fault_replay_policy_benchmark(UVM_TEST_FAULT_REPLAY_POLICY_BENCHMARK_PARAMS *params,
+                                                 struct file *filp);
+NV_STATUS uvm_test_migrate_batch(UVM_TEST_MIGRATE_BATCH_PARAMS *params, struct file *filp);
 
 NV_STATUS uvm_test_va_space_add_dummy_thread_contexts(UVM_TEST_VA_SPACE_ADD_DUMMY_THREAD_CONTEXTS_PARAMS *params,
                                                       struct file *filp);
@@ -192,4 +208,6 @@ NV_STATUS uvm_test_dump_access_bits(UVM_TEST_DUMP_ACCESS_BITS_PARAMS *params, st
 NV_STATUS uvm_test_sec2_sanity(UVM_TEST_SEC2_SANITY_PARAMS *params, struct file *filp);
 NV_STATUS uvm_test_sec2_cpu_gpu_roundtrip(UVM_TEST_SEC2_CPU_GPU_ROUNDTRIP_PARAMS *params, struct file *filp);
 NV_STATUS uvm_test_cpu_chunk_api(UVM_TEST_CPU_CHUNK_API_PARAMS *params, struct file *filp);
+NV_STATUS uvm_test_get_cpu_chunk_node_stats(UVM_TEST_GET_CPU_CHUNK_NODE_STATS_PARAMS *params, struct file *filp);
+NV_STATUS uvm_test_ce_copy_bandwidth(UVM_TEST_CE_COPY_BANDWIDTH_PARAMS *params, struct file *filp);
 #endif
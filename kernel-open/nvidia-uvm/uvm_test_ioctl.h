@@ -1555,6 +1555,7 @@ typedef enum
     UVM_TEST_PMM_ALLOC_LIST_UNUSED = 0,
     UVM_TEST_PMM_ALLOC_LIST_DISCARDED,
     UVM_TEST_PMM_ALLOC_LIST_USED,
+    UVM_TEST_PMM_ALLOC_LIST_USED_FREQUENT,
     UVM_TEST_PMM_ALLOC_LIST_COUNT
 } UVM_TEST_PMM_ALLOC_LIST_TYPE;
 
@@ -1581,6 +1582,603 @@ typedef struct
     NV_STATUS rmStatus;                                  // Out
 } UVM_TEST_DUMP_ACCESS_BITS_PARAMS;
 
+// Set the number of threads, including the bottom half, used to service each
+// batch of replayable faults on the given GPU. num_workers must be in the
+// [1:max_workers] range reported by UVM_TEST_GET_FAULT_SERVICE_WORKERS.
+#define UVM_TEST_SET_FAULT_SERVICE_WORKERS               UVM_TEST_IOCTL_BASE(113)
+typedef struct
+{
+    NvProcessorUuid                 gpu_uuid;                                           // In
+    NvU32                           num_workers;                                        // In
+
+    NV_STATUS                       rmStatus;                                           // Out
+} UVM_TEST_SET_FAULT_SERVICE_WORKERS_PARAMS;
+
+// Query the replayable fault service worker configuration and the statistics
+// needed to compute the servicing throughput for a given worker count.
+#define UVM_TEST_GET_FAULT_SERVICE_WORKERS               UVM_TEST_IOCTL_BASE(114)
+typedef struct
+{
+    NvProcessorUuid                 gpu_uuid;                                           // In
+    NvU32                           max_workers;                                        // Out
+    NvU32                           num_workers;                                        // Out
+    NvU64                           num_replayable_faults;  NV_ALIGN_BYTES(8)           // Out
+    NvU64                           num_parallel_batches;   NV_ALIGN_BYTES(8)           // Out
+    NvU64                           service_time_ns;        NV_ALIGN_BYTES(8)           // Out
+
+    NV_STATUS                       rmStatus;                                           // Out
+} UVM_TEST_GET_FAULT_SERVICE_WORKERS_PARAMS;
+
+// Microbenchmark of the fault batch preprocessing sorts on a synthetic fault
+// stream. Each iteration sorts the same stream by instance_ptr and then by
+// VA space, GPU, address and access type, once with the radix sort and once
+// with the generic sort(). The radix sort output order is checked against the
+// comparator used by the generic sort.
+#define UVM_TEST_FAULT_BATCH_SORT_PERF                   UVM_TEST_IOCTL_BASE(115)
+typedef struct
+{
+    NvU32                           num_faults;                                         // In
+    NvU32                           num_instance_ptrs;                                  // In
+    NvU32                           num_va_spaces;                                      // In
+    NvU32                           iterations;                                         // In
+    NvU32                           seed;                                               // In
+
+    // Total time, in nanoseconds, spent in each sort implementation
+    NvU64                           radix_sort_ns NV_ALIGN_BYTES(8);                    // Out
+    NvU64                           generic_sort_ns NV_ALIGN_BYTES(8);                  // Out
+
+    NV_STATUS                       rmStatus;                                           // Out
+} UVM_TEST_FAULT_BATCH_SORT_PERF_PARAMS;
+
+// Read the adaptive prefetch threshold state of the managed VA range covering
+// lookup_address.
+//
+// Error returns:
+// NV_ERR_INVALID_ADDRESS
+//  - lookup_address doesn't match a managed VA range
+#define UVM_TEST_GET_PREFETCH_ADAPTIVE_STATE             UVM_TEST_IOCTL_BASE(116)
+typedef struct
+{
+    NvU64                           lookup_address NV_ALIGN_BYTES(8);                   // In
+
+    NvBool                          enabled;                                            // Out
+    NvU32                           threshold;                                          // Out
+    NvU32                           threshold_min;                                      // Out
+    NvU32                           threshold_max;                                      // Out
+
+    // Prefetched pages accounted since the last threshold update
+    NvU32                           used_pages;                                         // Out
+    NvU32                           wasted_pages;                                       // Out
+
+    NvU64                           num_raises NV_ALIGN_BYTES(8);                       // Out
+    NvU64                           num_lowers NV_ALIGN_BYTES(8);                       // Out
+
+    NV_STATUS                       rmStatus;                                           // Out
+} UVM_TEST_GET_PREFETCH_ADAPTIVE_STATE_PARAMS;
+
+// Pin the replay policy used to service replayable faults on the given GPU.
+// policy takes a uvm_perf_fault_replay_policy_t value. Setting
+// UVM_PERF_FAULT_REPLAY_POLICY_AUTO (4) selects the policy for each batch.
+//
+// Error returns:
+// NV_ERR_INVALID_ARGUMENT
+//  - policy is not a valid replay policy
+#define UVM_TEST_SET_FAULT_REPLAY_POLICY                 UVM_TEST_IOCTL_BASE(117)
+typedef struct
+{
+    NvProcessorUuid                 gpu_uuid;                                           // In
+    NvU32                           policy;                                             // In
+
+    NV_STATUS                       rmStatus;                                           // Out
+} UVM_TEST_SET_FAULT_REPLAY_POLICY_PARAMS;
+
+// Number of replay policies that can be used to service a batch. Keep this in
+// sync with uvm_perf_fault_replay_policy_t in uvm_gpu_replayable_faults.h.
+#define UVM_TEST_FAULT_REPLAY_POLICY_COUNT 4
+
+// Query the replay policy statistics of the given GPU. The arrays are indexed
+// by uvm_perf_fault_replay_policy_t and report, for each policy, the number of
+// batches serviced with it, the replays issued for them and the wall time
+// spent servicing and replaying them. Benchmarks pin each policy with
+// UVM_TEST_SET_FAULT_REPLAY_POLICY, run the same fault trace and compare the
+// replay count against the wall time. If reset is set the statistics are
+// cleared after being read.
+#define UVM_TEST_GET_FAULT_REPLAY_POLICY_STATS           UVM_TEST_IOCTL_BASE(118)
+typedef struct
+{
+    NvProcessorUuid                 gpu_uuid;                                           // In
+    NvBool                          reset;                                              // In
+    NvU32                           policy;                                             // Out
+
+    NvU64                           num_batches[UVM_TEST_FAULT_REPLAY_POLICY_COUNT] NV_ALIGN_BYTES(8);  // Out
+    NvU64                           num_replays[UVM_TEST_FAULT_REPLAY_POLICY_COUNT] NV_ALIGN_BYTES(8);  // Out
+    NvU64                           time_ns[UVM_TEST_FAULT_REPLAY_POLICY_COUNT] NV_ALIGN_BYTES(8);      // Out
+
+    NV_STATUS                       rmStatus;                                           // Out
+} UVM_TEST_GET_FAULT_REPLAY_POLICY_STATS_PARAMS;
+
+// Replay a recorded stream of replayable fault buffer entries through the
+// fault batch coalescing and preprocessing logic, without any GPU. trace points
+// to an array of num_entries UvmEventTestFaultBufferEntryInfo, as recorded
+// with the UvmEventTypeTestFaultBufferEntry tools event. The stream is split in
+// batches of batch_size entries. Instance pointers stand for VA spaces since
+// there is no channel to translate them.
+//
+// Error returns:
+// NV_ERR_INVALID_ARGUMENT
+//  - batch_size or num_entries are out of range, or an entry has an invalid
+//    aperture, access type or uTLB id
+// NV_ERR_INVALID_ADDRESS
+//  - trace could not be read
+#define UVM_TEST_FAULT_TRACE_REPLAY                      UVM_TEST_IOCTL_BASE(119)
+typedef struct
+{
+    NvU64                           trace NV_ALIGN_BYTES(8);                            // In
+    NvU32                           num_entries;                                        // In
+    NvU32                           batch_size;                                         // In
+    NvBool                          coalesce;                                           // In
+    NvBool                          radix_sort;                                         // In
+
+    NvU32                           num_batches;                                        // Out
+
+    // Faults left after coalescing at fetch time
+    NvU64                           num_coalesced_faults NV_ALIGN_BYTES(8);             // Out
+
+    // Fault instances that would be accounted as duplicates while servicing
+    NvU64                           num_duplicate_faults NV_ALIGN_BYTES(8);             // Out
+
+    // Total time, in nanoseconds, spent coalescing and preprocessing
+    NvU64                           preprocess_ns NV_ALIGN_BYTES(8);                    // Out
+
+    NV_STATUS                       rmStatus;                                           // Out
+} UVM_TEST_FAULT_TRACE_REPLAY_PARAMS;
+
+// Keep this in sync with uvm_pmm_eviction_policy_t in uvm_pmm_gpu.h
+typedef enum
+{
+    UVM_TEST_PMM_EVICTION_POLICY_LRU = 0,
+    UVM_TEST_PMM_EVICTION_POLICY_CLOCK_PRO,
+    UVM_TEST_PMM_EVICTION_POLICY_COUNT
+} UVM_TEST_PMM_EVICTION_POLICY;
+
+// Query the root chunk eviction policy of the GPU and its statistics since the
+// GPU was registered.
+#define UVM_TEST_PMM_EVICTION_STATS                      UVM_TEST_IOCTL_BASE(120)
+typedef struct
+{
+    NvProcessorUuid gpu_uuid;                                                           // In
+    NvU32           policy;                                                             // Out (UVM_TEST_PMM_EVICTION_POLICY)
+
+    // Root chunks picked for eviction from each list
+    NvU64           num_evicted[UVM_TEST_PMM_ALLOC_LIST_COUNT] NV_ALIGN_BYTES(8);       // Out
+    NvU64           num_promoted NV_ALIGN_BYTES(8);                                     // Out
+    NvU64           num_demoted NV_ALIGN_BYTES(8);                                      // Out
+    NV_STATUS       rmStatus;                                                           // Out
+} UVM_TEST_PMM_EVICTION_STATS_PARAMS;
+
+// Oversubscription benchmark of the root chunk eviction policies. The real
+// policy code runs on a private set of num_chunks simulated root chunks, with
+// no GPU memory involved. Each iteration accesses every chunk of a hot set of
+// hot_chunks chunks, then a window of scan_chunks chunks of a much larger
+// buffer that is scanned in a single pass. Accesses are iteration_usec apart
+// in simulated time. Every miss migrates a root chunk in, and evicts one when
+// all simulated chunks are in use.
+//
+// For each policy, num_bytes_migrated is the amount of data migrated in and
+// out, and num_hot_misses the number of accesses to the hot set that missed.
+// Useful work is the hot set accesses, so bytes migrated per second of useful
+// work is num_bytes_migrated / (iterations * iteration_usec).
+#define UVM_TEST_PMM_EVICTION_POLICY_BENCHMARK           UVM_TEST_IOCTL_BASE(121)
+typedef struct
+{
+    NvU32                           num_chunks;                                         // In
+    NvU32                           hot_chunks;                                         // In
+    NvU32                           scan_chunks;                                        // In
+    NvU32                           iterations;                                         // In
+    NvU32                           iteration_usec;                                     // In
+
+    NvU64                           num_bytes_migrated[UVM_TEST_PMM_EVICTION_POLICY_COUNT] NV_ALIGN_BYTES(8); // Out
+    NvU64                           num_hot_misses[UVM_TEST_PMM_EVICTION_POLICY_COUNT] NV_ALIGN_BYTES(8);     // Out
+    NV_STATUS                       rmStatus;                                           // Out
+} UVM_TEST_PMM_EVICTION_POLICY_BENCHMARK_PARAMS;
+
+// Dump the thrashing detection state of the VA block containing
+// lookup_address. has_thrashing_info is set to false if no thrashing has been
+// tracked for the block yet. nap_ns and pin_ns are the throttling and pinning
+// durations currently applied to the thrashing pages of the block, which are
+// sized to the learned oscillation period period_ns when the
+// uvm_perf_thrashing_adaptive module parameter is set.
+//
+// Returns NV_ERR_INVALID_STATE if thrashing detection is disabled for the
+// VA space.
+#define UVM_TEST_GET_BLOCK_THRASHING_STATE               UVM_TEST_IOCTL_BASE(122)
+typedef struct
+{
+    NvU64                           lookup_address NV_ALIGN_BYTES(8);                   // In
+
+    NvBool                          has_thrashing_info;                                 // Out
+    NvBool                          has_page_tracking;                                  // Out
+    NvU32                           num_thrashing_pages;                                // Out
+    NvU32                           num_pinned_pages;                                   // Out
+    NvU32                           throttling_count;                                   // Out
+    NvU32                           thrashing_reset_count;                              // Out
+    NvU32                           num_period_samples;                                 // Out
+    NvU64                           period_ns NV_ALIGN_BYTES(8);                        // Out
+    NvU64                           nap_ns NV_ALIGN_BYTES(8);                           // Out
+    NvU64                           pin_ns NV_ALIGN_BYTES(8);                           // Out
+    NV_STATUS                       rmStatus;                                           // Out
+} UVM_TEST_GET_BLOCK_THRASHING_STATE_PARAMS;
+
+// Return the number of base pages allocated for CPU chunks on NUMA node nid
+// since the module was loaded. Together with UVM_SET_CPU_NUMA_PLACEMENT, this
+// is used to check where CPU pages are placed.
+//
+// Returns NV_ERR_INVALID_ARGUMENT if nid is not a possible NUMA node.
+#define UVM_TEST_GET_CPU_CHUNK_NODE_STATS                UVM_TEST_IOCTL_BASE(123)
+typedef struct
+{
+    NvS32                           nid;                                                // In
+    NvU64                           allocated_pages NV_ALIGN_BYTES(8);                  // Out
+    NV_STATUS                       rmStatus;                                           // Out
+} UVM_TEST_GET_CPU_CHUNK_NODE_STATS_PARAMS;
+
+// Measure the time to copy size bytes between two vidmem buffers of the given
+// GPU, iterations times, using three strategies: one push per 2MB VA block with
+// one CE transfer per page, one push per VA block with one CE transfer per VA
+// block, and a single push with a single CE transfer for the whole range. The
+// bandwidth of each strategy is size * iterations / *_ns.
+//
+// size must be a non-zero multiple of UVM_TEST_VA_BLOCK_SIZE. Sizes up to 1GB
+// are expected, but the maximum depends on the available vidmem.
+#define UVM_TEST_CE_COPY_BANDWIDTH                       UVM_TEST_IOCTL_BASE(124)
+typedef struct
+{
+    NvProcessorUuid                 gpu_uuid;                                           // In
+    NvU64                           size NV_ALIGN_BYTES(8);                             // In
+    NvU32                           iterations;                                         // In
+    NvU64                           per_page_ns NV_ALIGN_BYTES(8);                      // Out
+    NvU64                           per_block_ns NV_ALIGN_BYTES(8);                     // Out
+    NvU64                           coalesced_ns NV_ALIGN_BYTES(8);                     // Out
+    NV_STATUS                       rmStatus;                                           // Out
+} UVM_TEST_CE_COPY_BANDWIDTH_PARAMS;
+
+// Report the VA space lock latency statistics of the VA space, used to compare
+// writer and reader latencies under a mixed ioctl and fault load with and
+// without the uvm_free_range_locked module parameter:
+//  - free_write_*: critical sections of successful UvmFree calls holding the
+//    lock for write
+//  - free_range_locked_*: teardown of external ranges by UvmFree with the lock
+//    only held for read
+//  - fault_read_wait_*: waits of the replayable fault servicing path to
+//    acquire the lock for read
+//
+// If reset is set, the statistics are cleared after being read.
+#define UVM_TEST_VA_SPACE_LOCK_STATS                     UVM_TEST_IOCTL_BASE(125)
+typedef struct
+{
+    NvBool                          reset;                                              // In
+    NvU64                           free_write_count NV_ALIGN_BYTES(8);                 // Out
+    NvU64                           free_write_total_ns NV_ALIGN_BYTES(8);              // Out
+    NvU64                           free_write_max_ns NV_ALIGN_BYTES(8);                // Out
+    NvU64                           free_range_locked_count NV_ALIGN_BYTES(8);          // Out
+    NvU64                           free_range_locked_total_ns NV_ALIGN_BYTES(8);       // Out
+    NvU64                           free_range_locked_max_ns NV_ALIGN_BYTES(8);         // Out
+    NvU64                           fault_read_wait_count NV_ALIGN_BYTES(8);            // Out
+    NvU64                           fault_read_wait_total_ns NV_ALIGN_BYTES(8);         // Out
+    NvU64                           fault_read_wait_max_ns NV_ALIGN_BYTES(8);           // Out
+    NV_STATUS                       rmStatus;                                           // Out
+} UVM_TEST_VA_SPACE_LOCK_STATS_PARAMS;
+
+typedef enum
+{
+    UVM_TEST_KVMALLOC_OBJECT_VA_BLOCK_CONTEXT = 0,
+    UVM_TEST_KVMALLOC_OBJECT_COUNT
+} UVM_TEST_KVMALLOC_OBJECT;
+
+// Report the leak checker statistics of objects allocated from dedicated
+// caches. live is the number of objects currently constructed, allocations the
+// number of objects handed out to callers and cache_hits how many of those were
+// reused from a cache of freed objects instead of being constructed.
+//
+// Returns NV_ERR_INVALID_STATE if the leak checker is disabled.
+#define UVM_TEST_KVMALLOC_OBJECT_STATS                   UVM_TEST_IOCTL_BASE(126)
+typedef struct
+{
+    NvU32                           object;                                             // In (UVM_TEST_KVMALLOC_OBJECT)
+    NvU64                           live NV_ALIGN_BYTES(8);                             // Out
+    NvU64                           allocations NV_ALIGN_BYTES(8);                      // Out
+    NvU64                           cache_hits NV_ALIGN_BYTES(8);                       // Out
+    NV_STATUS                       rmStatus;                                           // Out
+} UVM_TEST_KVMALLOC_OBJECT_STATS_PARAMS;
+
+typedef enum
+{
+    UVM_TEST_PAGE_MASK_OP_AND = 0,
+    UVM_TEST_PAGE_MASK_OP_ANDNOT,
+    UVM_TEST_PAGE_MASK_OP_OR,
+    UVM_TEST_PAGE_MASK_OP_WEIGHT,
+    UVM_TEST_PAGE_MASK_OP_ANDNOT_WEIGHT,
+    UVM_TEST_PAGE_MASK_OP_AND_FIND_FIRST,
+    UVM_TEST_PAGE_MASK_OP_COUNT
+} UVM_TEST_PAGE_MASK_OP;
+
+// Run the given uvm_page_mask_t operation iterations times on random masks,
+// both with the uvm_page_mask_*() helpers and with the equivalent sequence of
+// generic bitmap_*() calls, and report the total time taken by each. The
+// results of both implementations are also compared.
+//
+// Returns NV_ERR_INVALID_STATE if the results don't match.
+#define UVM_TEST_PAGE_MASK_BENCHMARK                     UVM_TEST_IOCTL_BASE(127)
+typedef struct
+{
+    NvU32                           op;                                                 // In (UVM_TEST_PAGE_MASK_OP)
+    NvU32                           iterations;                                         // In
+    NvU32                           seed;                                               // In
+    NvU64                           generic_ns NV_ALIGN_BYTES(8);                       // Out
+    NvU64                           page_mask_ns NV_ALIGN_BYTES(8);                     // Out
+    NV_STATUS                       rmStatus;                                           // Out
+} UVM_TEST_PAGE_MASK_BENCHMARK_PARAMS;
+
+// munmap() the given HMM range, which has to span more than one VA block, and
+// check that none of the HMM va_blocks overlapping it are left with GPU
+// mappings in the range. va_block_count returns the number of va_blocks which
+// were checked.
+//
+// Returns NV_ERR_INVALID_STATE if HMM isn't enabled or a GPU mapping remains.
+#define UVM_TEST_HMM_MUNMAP_CHECK                        UVM_TEST_IOCTL_BASE(128)
+typedef struct
+{
+    NvU64                           base NV_ALIGN_BYTES(8);                             // In
+    NvU64                           length NV_ALIGN_BYTES(8);                           // In
+    NvU32                           va_block_count;                                     // Out
+    NV_STATUS                       rmStatus;                                           // Out
+} UVM_TEST_HMM_MUNMAP_CHECK_PARAMS;
+
+// Get the state of the cross-VA-block stream prefetcher of the managed VA range
+// containing lookup_address.
+//
+// Error returns:
+// NV_ERR_INVALID_ADDRESS
+//  - lookup_address doesn't match a managed VA range
+#define UVM_TEST_GET_PREFETCH_STREAM_STATE               UVM_TEST_IOCTL_BASE(129)
+typedef struct
+{
+    NvU64                           lookup_address NV_ALIGN_BYTES(8);                   // In
+
+    NvBool                          enabled;                                            // Out
+
+    // Detected stride in VA blocks, 0 if none
+    NvS64                           stride NV_ALIGN_BYTES(8);                           // Out
+    NvU32                           confidence;                                         // Out
+
+    // Blocks ahead of the last faulting block which are already prefetched
+    NvU32                           window;                                             // Out
+
+    NvU64                           prefetched_blocks NV_ALIGN_BYTES(8);                // Out
+    NvU64                           hits NV_ALIGN_BYTES(8);                             // Out
+    NvU64                           misses NV_ALIGN_BYTES(8);                           // Out
+
+    NV_STATUS                       rmStatus;                                           // Out
+} UVM_TEST_GET_PREFETCH_STREAM_STATE_PARAMS;
+
+// Feed synthetic sequences of faulting VA blocks to the stream detector and
+// check the detected strides, the prefetched blocks and the hit/miss
+// accounting.
+#define UVM_TEST_PREFETCH_STREAM_SANITY                  UVM_TEST_IOCTL_BASE(130)
+typedef struct
+{
+    NV_STATUS                       rmStatus;                                           // Out
+} UVM_TEST_PREFETCH_STREAM_SANITY_PARAMS;
+
+// Run the background vidmem reclaimer of the GPU once with the given
+// watermarks, which replace uvm_perf_pmm_reclaim_low_watermark and
+// uvm_perf_pmm_reclaim_high_watermark for the duration of the test. The
+// reclaimer is only woken up if fewer than low_watermark root chunks are free,
+// and it must then stop either at high_watermark free root chunks or when no
+// cold chunks are left to evict. Frequently used chunks must never be evicted
+// by it. The GPU should be otherwise idle during the test.
+//
+// reclaim_enabled is set to false, and nothing else is done, if the reclaimer
+// was disabled when the GPU was registered.
+#define UVM_TEST_PMM_RECLAIM_WATERMARK                   UVM_TEST_IOCTL_BASE(131)
+typedef struct
+{
+    NvProcessorUuid                 gpu_uuid;                                           // In
+    NvU32                           low_watermark;                                      // In
+    NvU32                           high_watermark;                                     // In
+
+    NvBool                          reclaim_enabled;                                    // Out
+    NvBool                          woken_up;                                           // Out
+
+    // Free root chunks in PMA before and after the run
+    NvU64                           num_free_before NV_ALIGN_BYTES(8);                  // Out
+    NvU64                           num_free_after NV_ALIGN_BYTES(8);                   // Out
+
+    // Root chunks evicted by the reclaimer during the test
+    NvU64                           num_reclaimed NV_ALIGN_BYTES(8);                    // Out
+    NV_STATUS                       rmStatus;                                           // Out
+} UVM_TEST_PMM_RECLAIM_WATERMARK_PARAMS;
+
+// Benchmark of the replay policies on a synthetic fault trace, without any
+// GPU. Each batch has batch_size new faults spread over VA blocks of
+// faults_per_block faults. Batches come in runs of run_length batches of each
+// kind, in this order:
+// - faults from a single uTLB
+// - faults from num_utlbs uTLBs
+// - faults from num_utlbs uTLBs with duplicate_percent duplicates
+// - like the previous kind, and the batch has throttled faults
+//
+// Time is simulated. Fetching a fault costs fault_ns, servicing a VA block
+// block_service_ns, flushing the fault buffer flush_ns, and a replay
+// replay_ns for each uTLB with pending faults. Duplicates are fetched again
+// in the next batch unless the buffer was flushed, and flushing after a
+// throttled batch doesn't discard them since the thrashing pages fault again.
+// With ONCE, a replay is issued every uvm_perf_fault_max_batches_per_service
+// batches.
+//
+// The output arrays are indexed by uvm_perf_fault_replay_policy_t, including
+// UVM_PERF_FAULT_REPLAY_POLICY_AUTO (4) which runs the real per-batch policy
+// selection. time_ns is the simulated wall time to service the whole trace and
+// fault_latency_ns the sum, over all num_faults new faults, of the time from
+// their fetch until their replay. auto_num_batches counts the batches for
+// which AUTO selected each policy.
+//
+// Error returns:
+// NV_ERR_INVALID_ARGUMENT
+//  - one of the inputs is out of range
+// NV_ERR_INVALID_STATE
+//  - AUTO didn't select each of BLOCK, BATCH and BATCH_FLUSH at least once,
+//    although the trace has more than one full run of each kind and num_utlbs
+//    is greater than 1
+#define UVM_TEST_FAULT_REPLAY_POLICY_BENCHMARK           UVM_TEST_IOCTL_BASE(132)
+typedef struct
+{
+    NvU32                           num_batches;                                        // In
+    NvU32                           batch_size;                                         // In
+    NvU32                           faults_per_block;                                   // In
+    NvU32                           num_utlbs;                                          // In
+    NvU32                           duplicate_percent;                                  // In
+    NvU32                           run_length;                                         // In
+    NvU32                           fault_ns;                                           // In
+    NvU32                           block_service_ns;                                   // In
+    NvU32                           flush_ns;                                           // In
+    NvU32                           replay_ns;                                          // In
+
+    NvU64                           num_replays[UVM_TEST_FAULT_REPLAY_POLICY_COUNT + 1] NV_ALIGN_BYTES(8);      // Out
+    NvU64                           time_ns[UVM_TEST_FAULT_REPLAY_POLICY_COUNT + 1] NV_ALIGN_BYTES(8);          // Out
+    NvU64                           fault_latency_ns[UVM_TEST_FAULT_REPLAY_POLICY_COUNT + 1] NV_ALIGN_BYTES(8); // Out
+    NvU64                           auto_num_batches[UVM_TEST_FAULT_REPLAY_POLICY_COUNT] NV_ALIGN_BYTES(8);     // Out
+    NvU64                           num_faults NV_ALIGN_BYTES(8);                       // Out
+    NV_STATUS                       rmStatus;                                           // Out
+} UVM_TEST_FAULT_REPLAY_POLICY_BENCHMARK_PARAMS;
+
+// Migrate the VA block containing lookup_address between the CPU and the GPU,
+// iterations times in each direction, first with copy coalescing disabled and
+// then enabled, regardless of the uvm_block_copy_coalesce module parameter.
+// The choice only applies to the migrations done by this test. The arrays are
+// indexed by whether coalescing was enabled and accumulate the time of all the migrations in each direction. Coalescing only
+// applies to blocks which are not backed by a single chunk on both sides, so
+// the caller should make sure that the block is split into multiple CPU or GPU
+// chunks, for example with uvm_cpu_chunk_allocation_sizes.
+//
+// Before each migration to the GPU, every page of the block is filled from the
+// CPU with a pattern derived from its address and the iteration. The pattern
+// is checked once the block is back on the CPU.
+//
+// Error returns:
+// NV_ERR_INVALID_ADDRESS
+//  - lookup_address is not in a managed allocation
+// NV_ERR_INVALID_STATE
+//  - the data read back on the CPU doesn't match the pattern
+#define UVM_TEST_VA_BLOCK_COPY_COALESCE                  UVM_TEST_IOCTL_BASE(133)
+typedef struct
+{
+    NvU64                           lookup_address NV_ALIGN_BYTES(8);                   // In
+    NvProcessorUuid                 gpu_uuid;                                           // In
+    NvU32                           iterations;                                         // In
+
+    NvU32                           num_pages;                                          // Out
+    NvU64                           to_gpu_ns[2] NV_ALIGN_BYTES(8);                     // Out
+    NvU64                           to_cpu_ns[2] NV_ALIGN_BYTES(8);                     // Out
+    NV_STATUS                       rmStatus;                                           // Out
+} UVM_TEST_VA_BLOCK_COPY_COALESCE_PARAMS;
+
+// Check the delivery of tools events to queues with per-CPU rings, see
+// UVM_TOOLS_INIT_EVENT_TRACKER_PER_CPU. Queues backed by kernel memory are
+// subscribed to the VA space of the file, then:
+//  - events recorded on a CPU must only land in that CPU's ring, and be
+//    dropped once the ring is full,
+//  - within a tools event batch, a queue with a shared ring must receive the
+//    events right away, and the per-CPU rings only when the batch fills up or
+//    ends,
+//  - the init ioctl must reject too few rings and counter trackers.
+#define UVM_TEST_TOOLS_PER_CPU_RINGS                     UVM_TEST_IOCTL_BASE(134)
+typedef struct
+{
+    NV_STATUS                       rmStatus;                                           // Out
+} UVM_TEST_TOOLS_PER_CPU_RINGS_PARAMS;
+
+// Exercise UVM_MIGRATE_BATCH on [base, base + length), a managed allocation
+// split into several entries, and gpu_uuid, a GPU with a GPU VA space:
+//  - invalid arguments must be rejected,
+//  - synchronous and asynchronous batches must migrate all the entries,
+//  - if event_fd is not -1, an asynchronous batch must signal it once, after
+//    the migration is complete. It must be a non-blocking eventfd,
+//  - a failing entry must stop the batch, and numMigrated must point at it.
+//
+// If pageable_base is not 0, it must point to a page of pageable memory. When
+// that memory is only accessible through ATS, a batch covering it must be
+// rejected with NV_ERR_NOT_SUPPORTED, and ats_rejected is set.
+//
+// length must be a multiple of 4 pages.
+#define UVM_TEST_MIGRATE_BATCH                           UVM_TEST_IOCTL_BASE(135)
+typedef struct
+{
+    NvU64                           base NV_ALIGN_BYTES(8);                             // In
+    NvU64                           length NV_ALIGN_BYTES(8);                           // In
+    NvU64                           pageable_base NV_ALIGN_BYTES(8);                    // In
+    NvProcessorUuid                 gpu_uuid;                                           // In
+    NvS32                           event_fd;                                           // In
+    NvBool                          ats_rejected;                                       // Out
+    NV_STATUS                       rmStatus;                                           // Out
+} UVM_TEST_MIGRATE_BATCH_PARAMS;
+
+// Enable or disable the batching of HMM va_block invalidations for the calling
+// VA space. Batching is enabled by default, subject to the
+// uvm_hmm_invalidate_batch module parameter. This allows munmap() and
+// mprotect() of the same HMM ranges to be timed with and without batching.
+//
+// Returns NV_ERR_INVALID_STATE if HMM isn't enabled.
+#define UVM_TEST_HMM_SET_INVALIDATE_BATCH                UVM_TEST_IOCTL_BASE(136)
+typedef struct
+{
+    NvBool                          enable;                                             // In
+    NV_STATUS                       rmStatus;                                           // Out
+} UVM_TEST_HMM_SET_INVALIDATE_BATCH_PARAMS;
+
+// Time the munmap of the given range of the calling process. The caller is
+// expected to have populated the range and mapped it on the GPU(s) beforehand.
+// va_block_count returns the number of HMM va_blocks overlapping the range
+// before the munmap and munmap_ns the time spent in vm_munmap().
+//
+// Returns NV_ERR_INVALID_STATE if HMM isn't enabled.
+#define UVM_TEST_HMM_MUNMAP_BENCHMARK                    UVM_TEST_IOCTL_BASE(137)
+typedef struct
+{
+    NvU64                           base NV_ALIGN_BYTES(8);                             // In
+    NvU64                           length NV_ALIGN_BYTES(8);                           // In
+    NvU64                           munmap_ns NV_ALIGN_BYTES(8);                        // Out
+    NvU32                           va_block_count;                                     // Out
+    NV_STATUS                       rmStatus;                                           // Out
+} UVM_TEST_HMM_MUNMAP_BENCHMARK_PARAMS;
+
+// For each UvmCpuNumaPlacement mode, set the mode on [base, base + length) with
+// UVM_SET_CPU_NUMA_PLACEMENT, migrate the VA block containing base to the GPU
+// and make it resident on the CPU again as a CPU fault would. Check that all
+// the CPU pages of the VA block are allocated on the NUMA node selected by the
+// mode, using page_to_nid(). nids is indexed by the mode and returns the node
+// which was selected, or NUMA_NO_NODE if the mode left the choice to the
+// allocator.
+//
+// The range must be a managed allocation without a preferred location, or with
+// the CPU as the preferred location and no preferred CPU NUMA node.
+//
+// Error returns:
+// NV_ERR_INVALID_ADDRESS
+//  - base is not in a managed allocation
+// NV_ERR_INVALID_STATE
+//  - a page was not allocated on the selected node, or the selected node
+//    doesn't match the mode
+#define UVM_TEST_CPU_NUMA_PLACEMENT                      UVM_TEST_IOCTL_BASE(138)
+typedef struct
+{
+    NvU64                           base NV_ALIGN_BYTES(8);                             // In
+    NvU64                           length NV_ALIGN_BYTES(8);                           // In
+    NvProcessorUuid                 gpu_uuid;                                           // In
+    NvS32                           nids[UvmCpuNumaPlacementCount];                     // Out
+    NV_STATUS                       rmStatus;                                           // Out
+} UVM_TEST_CPU_NUMA_PLACEMENT_PARAMS;
+
 #ifdef __cplusplus
 }
 #endif
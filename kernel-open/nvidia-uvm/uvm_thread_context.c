@@ -499,6 +499,7 @@ bool uvm_thread_context_add(uvm_thread_context_t *thread_context)
 
     thread_context->task = current;
     thread_context->ignore_hmm_invalidate_va_block = NULL;
+    thread_context->tools_event_batch = NULL;
     table_entry = thread_context_non_interrupt_table_entry(&array_index);
     return thread_context_non_interrupt_add(thread_context, table_entry, array_index);
 }
@@ -79,6 +79,10 @@ struct uvm_thread_context_struct
     // Used to filter out invalidations we don't care about.
     unsigned long hmm_invalidate_seqnum;
 
+    // Tools events batch the thread is currently recording into, if any. See
+    // uvm_tools_event_batch_begin().
+    uvm_tools_event_batch_t *tools_event_batch;
+
     // Pointer to enclosing node (if any) in red-black tree
     //
     // This field is ignored in interrupt paths
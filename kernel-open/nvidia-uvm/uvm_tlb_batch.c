@@ -91,7 +91,7 @@ static bool tlb_batch_should_invalidate_all(uvm_tlb_batch_t *batch)
     if (!batch->tree->gpu->parent->tlb_batch.va_invalidate_supported)
         return true;
 
-    if (batch->count > UVM_TLB_BATCH_MAX_ENTRIES)
+    if (batch->invalidate_all)
         return true;
 
     if (batch->tree->gpu->parent->tlb_batch.va_range_invalidate_supported)
@@ -113,26 +113,221 @@ void uvm_tlb_batch_end(uvm_tlb_batch_t *batch, uvm_push_t *push, uvm_membar_t tl
         tlb_batch_flush_invalidate_per_va(batch, push);
 }
 
-void uvm_tlb_batch_invalidate(uvm_tlb_batch_t *batch, NvU64 start, NvU64 size, NvU64 page_sizes, uvm_membar_t tlb_membar)
+// Maximum gap between two queued up ranges for them to be merged into a single
+// range once the batch runs out of entries. Invalidating the gap needlessly
+// drops any translations cached for it, which is only cheaper than dropping
+// all of them with an invalidate all as long as the gap is small.
+#define UVM_TLB_BATCH_MAX_MERGE_GAP UVM_PAGE_SIZE_2M
+
+static NvU64 tlb_batch_range_end(const uvm_tlb_batch_range_t *entry)
 {
-    uvm_tlb_batch_range_t *new_entry;
+    return entry->start + entry->size;
+}
 
-    batch->membar = uvm_membar_max(tlb_membar, batch->membar);
+// Number of disjoint ranges the batch tracks before merging them. GPUs which
+// can invalidate a range with a single method pay per range, so there is no
+// point in tracking more ranges than what a per VA invalidate is allowed to
+// issue. GPUs which invalidate each page separately pay per page instead, and
+// merging ranges only adds pages.
+static NvU32 tlb_batch_max_entries(uvm_tlb_batch_t *batch)
+{
+    uvm_parent_gpu_t *parent_gpu = batch->tree->gpu->parent;
 
-    ++batch->count;
+    if (parent_gpu->tlb_batch.va_range_invalidate_supported)
+        return min((NvU32)UVM_TLB_BATCH_MAX_ENTRIES, max(parent_gpu->tlb_batch.max_ranges, 1U));
 
-    if (batch->tree->gpu->parent->tlb_batch.va_range_invalidate_supported)
-        batch->total_ranges++;
-    else
-        batch->total_pages += uvm_div_pow2_64(size, smallest_page_size(page_sizes));
+    return UVM_TLB_BATCH_MAX_ENTRIES;
+}
+
+// Replace the ranges [first, last] with a single range covering all of them.
+static void tlb_batch_merge_ranges(uvm_tlb_batch_t *batch, NvU32 first, NvU32 last)
+{
+    uvm_tlb_batch_range_t *entry = &batch->ranges[first];
+    NvU64 start = entry->start;
+    NvU64 end = tlb_batch_range_end(entry);
+    NvU32 i;
+
+    UVM_ASSERT(first <= last);
+    UVM_ASSERT(last < batch->count);
+
+    if (first == last)
+        return;
+
+    for (i = first + 1; i <= last; ++i) {
+        start = min(start, batch->ranges[i].start);
+        end = max(end, tlb_batch_range_end(&batch->ranges[i]));
+        entry->page_sizes |= batch->ranges[i].page_sizes;
+    }
+
+    entry->start = start;
+    entry->size = end - start;
+
+    memmove(&batch->ranges[first + 1],
+            &batch->ranges[last + 1],
+            (batch->count - last - 1) * sizeof(batch->ranges[0]));
+    batch->count -= last - first;
+}
+
+// Return the smallest gap between two neighbouring queued up ranges, ~0 if
+// there is less than two ranges, and the index of the first of them.
+static NvU64 tlb_batch_smallest_gap(uvm_tlb_batch_t *batch, NvU32 *index)
+{
+    NvU64 smallest_gap = ~0ULL;
+    NvU32 i;
+
+    *index = 0;
+
+    for (i = 0; i + 1 < batch->count; ++i) {
+        NvU64 gap = batch->ranges[i + 1].start - tlb_batch_range_end(&batch->ranges[i]);
+
+        if (gap < smallest_gap) {
+            smallest_gap = gap;
+            *index = i;
+        }
+    }
+
+    return smallest_gap;
+}
+
+// Index of the first range which ends at or after start
+static NvU32 tlb_batch_find_range(uvm_tlb_batch_t *batch, NvU64 start)
+{
+    NvU32 i;
+
+    for (i = 0; i < batch->count; ++i) {
+        if (tlb_batch_range_end(&batch->ranges[i]) >= start)
+            break;
+    }
+
+    return i;
+}
+
+// Make room for a new range disjoint from all the queued up ones by merging the
+// two neighbouring ranges separated by the smallest gap, the new range
+// included. The new range is queued up if it was merged into a neighbour.
+// Returns false if the smallest gap is too big to be worth invalidating.
+static bool tlb_batch_make_room(uvm_tlb_batch_t *batch, NvU64 start, NvU64 size, NvU64 page_sizes, bool *queued)
+{
+    NvU64 end = start + size;
+    NvU32 next = tlb_batch_find_range(batch, start);
+    NvU64 gap_before = next > 0 ? start - tlb_batch_range_end(&batch->ranges[next - 1]) : ~0ULL;
+    NvU64 gap_after = next < batch->count ? batch->ranges[next].start - end : ~0ULL;
+    NvU32 smallest_index;
+    NvU64 smallest_gap = tlb_batch_smallest_gap(batch, &smallest_index);
+
+    *queued = false;
+
+    if (min(gap_before, gap_after) <= smallest_gap) {
+        uvm_tlb_batch_range_t *entry;
+
+        if (min(gap_before, gap_after) > UVM_TLB_BATCH_MAX_MERGE_GAP)
+            return false;
+
+        // Grow the closest neighbour to cover the new range. It stays disjoint
+        // from the other neighbour as the new range was.
+        entry = gap_before <= gap_after ? &batch->ranges[next - 1] : &batch->ranges[next];
+        end = max(end, tlb_batch_range_end(entry));
+        entry->start = min(start, entry->start);
+        entry->size = end - entry->start;
+        entry->page_sizes |= page_sizes;
+        *queued = true;
+
+        return true;
+    }
+
+    if (smallest_gap > UVM_TLB_BATCH_MAX_MERGE_GAP)
+        return false;
+
+    tlb_batch_merge_ranges(batch, smallest_index, smallest_index + 1);
+
+    return true;
+}
+
+// Insert the range keeping the ranges sorted, merging it with any range it
+// overlaps or is adjacent to. Once the batch runs out of entries, ranges get
+// merged as described in tlb_batch_make_room(). Returns false if the range
+// couldn't be queued up.
+static bool tlb_batch_insert_range(uvm_tlb_batch_t *batch, NvU64 start, NvU64 size, NvU64 page_sizes)
+{
+    uvm_tlb_batch_range_t *entry;
+    NvU64 end = start + size;
+    NvU32 first = tlb_batch_find_range(batch, start);
+    NvU32 last;
+
+    UVM_ASSERT(batch->count <= tlb_batch_max_entries(batch));
+
+    if (first == batch->count || batch->ranges[first].start > end) {
+        if (batch->count == tlb_batch_max_entries(batch)) {
+            bool queued;
+
+            if (!tlb_batch_make_room(batch, start, size, page_sizes, &queued))
+                return false;
+
+            if (queued)
+                return true;
+
+            first = tlb_batch_find_range(batch, start);
+        }
+
+        memmove(&batch->ranges[first + 1], &batch->ranges[first], (batch->count - first) * sizeof(batch->ranges[0]));
+        batch->ranges[first].start = start;
+        batch->ranges[first].size = size;
+        batch->ranges[first].page_sizes = page_sizes;
+        batch->count++;
+
+        return true;
+    }
+
+    // Grow the first overlapping or adjacent range to cover the new one and
+    // merge it with all the following ranges it now reaches.
+    entry = &batch->ranges[first];
+    end = max(end, tlb_batch_range_end(entry));
+    entry->start = min(start, entry->start);
+    entry->size = end - entry->start;
+    entry->page_sizes |= page_sizes;
+
+    for (last = first; last + 1 < batch->count; ++last) {
+        if (batch->ranges[last + 1].start > end)
+            break;
+    }
+
+    tlb_batch_merge_ranges(batch, first, last);
+
+    return true;
+}
+
+static void tlb_batch_update_totals(uvm_tlb_batch_t *batch)
+{
+    NvU32 i;
+
+    if (batch->tree->gpu->parent->tlb_batch.va_range_invalidate_supported) {
+        batch->total_ranges = batch->count;
+        return;
+    }
+
+    batch->total_pages = 0;
+    for (i = 0; i < batch->count; ++i) {
+        uvm_tlb_batch_range_t *entry = &batch->ranges[i];
+
+        batch->total_pages += uvm_div_pow2_64(entry->size, smallest_page_size(entry->page_sizes));
+    }
+}
+
+void uvm_tlb_batch_invalidate(uvm_tlb_batch_t *batch, NvU64 start, NvU64 size, NvU64 page_sizes, uvm_membar_t tlb_membar)
+{
+    batch->membar = uvm_membar_max(tlb_membar, batch->membar);
 
     batch->biggest_page_size = max(batch->biggest_page_size, biggest_page_size(page_sizes));
 
-    if (tlb_batch_should_invalidate_all(batch))
+    if (tlb_batch_should_invalidate_all(batch)) {
+        // Just keep count so that uvm_tlb_batch_end() knows the batch isn't
+        // empty.
+        ++batch->count;
         return;
+    }
+
+    if (!tlb_batch_insert_range(batch, start, size, page_sizes))
+        batch->invalidate_all = true;
 
-    new_entry = &batch->ranges[batch->count - 1];
-    new_entry->start = start;
-    new_entry->size = size;
-    new_entry->page_sizes = page_sizes;
+    tlb_batch_update_totals(batch);
 }
@@ -27,9 +27,13 @@
 #include "uvm_forward_decl.h"
 #include "uvm_hal_types.h"
 
-// Max number of separate VA ranges to track before falling back to invalidate all.
-// TLB batches take space on the stack so this number should be big enough to
-// cover our common cases, but not bigger.
+// Max number of separate VA ranges to track. The queued up ranges are kept
+// sorted and adjacent or overlapping ranges are merged, so this bounds the
+// number of disjoint ranges. Once it would be exceeded, the two ranges
+// separated by the smallest gap are merged together, unless the gap is too big
+// in which case the batch falls back to invalidate all. TLB batches take space
+// on the stack so this number should be big enough to cover our common cases,
+// but not bigger.
 //
 // TODO: Bug 1767241: Once we have all the paths using TLB invalidates
 //       implemented, verify whether it makes sense.
@@ -53,15 +57,20 @@ struct uvm_tlb_batch_struct
         // Total number of pages covered by the queued up ranges so far
         NvU32 total_pages;
 
-        // Total number of ranges that have been invalidated so far
+        // Total number of disjoint ranges queued up so far
         // Each range can be invalidated using a single Host method on supported GPUs
         NvU32 total_ranges;
     };
 
-    // Queued up ranges to invalidate
+    // Queued up ranges to invalidate, sorted by start address. The ranges
+    // don't overlap and aren't adjacent.
     uvm_tlb_batch_range_t ranges[UVM_TLB_BATCH_MAX_ENTRIES];
     NvU32 count;
 
+    // Whether the queued up ranges will be invalidated with a single
+    // invalidate all, in which case the ranges are no longer tracked.
+    bool invalidate_all;
+
     // Biggest page size across all queued up invalidates
     NvU64 biggest_page_size;
 
@@ -36,6 +36,7 @@
 #include "uvm_forward_decl.h"
 #include "uvm_range_group.h"
 #include "uvm_mem.h"
+#include "uvm_test.h"
 #include "nv_speculation_barrier.h"
 
 // We limit the number of times a page can be retained by the kernel
@@ -43,6 +44,10 @@
 // over and over again in an attempt to overflow the refcount.
 #define MAX_PAGE_COUNT (1 << 20)
 
+// Number of events staged in a tools event batch before they are written to
+// the per-CPU rings
+#define UVM_TOOLS_EVENT_BATCH_SIZE 64
+
 typedef struct
 {
     NvU32 get_ahead;
@@ -51,8 +56,40 @@ typedef struct
     NvU32 put_behind;
 } uvm_tools_queue_snapshot_t;
 
+// Ring of a queue created with UVM_TOOLS_INIT_EVENT_TRACKER_PER_CPU. A ring is
+// only written by the CPU it belongs to, with preemption disabled, so it
+// doesn't need a lock.
 typedef struct
 {
+    UvmToolsEventControlData *control;
+    void *buffer;
+
+    // Next entry to be written
+    NvU32 put;
+
+    // Value of put last published to user space by ring_commit()
+    NvU32 committed;
+
+    bool is_wakeup_get_valid;
+    NvU32 wakeup_get;
+} ____cacheline_aligned_in_smp uvm_tools_ring_t;
+
+struct uvm_tools_event_batch_struct
+{
+    // VA space whose events are staged in the batch. NULL if the batch is not
+    // in use.
+    uvm_va_space_t *va_space;
+
+    NvU32 num_events;
+
+    // Only queues with per-CPU rings are batched, and they always use
+    // UvmEventEntry_V2 entries
+    UvmEventEntry_V2 events[UVM_TOOLS_EVENT_BATCH_SIZE];
+};
+
+typedef struct
+{
+    // Protects the shared ring. Not taken by producers of per-CPU rings.
     uvm_spinlock_t lock;
     NvU64 subscribed_queues;
     struct list_head queue_nodes[UvmEventNumTypesAll];
@@ -68,6 +105,12 @@ typedef struct
     wait_queue_head_t wait_queue;
     bool is_wakeup_get_valid;
     NvU32 wakeup_get;
+
+    // Per-CPU rings, indexed by CPU id, or NULL if the queue has a single
+    // shared ring. queue_buffer and control then cover all the rings, and
+    // queue_buffer_count is the number of entries of each ring.
+    uvm_tools_ring_t *rings;
+    NvU32 num_rings;
 } uvm_tools_queue_t;
 
 typedef struct
@@ -373,12 +416,24 @@ static void remove_event_tracker(uvm_va_space_t *va_space,
     *subscribed_mask &= ~list_mask;
 }
 
-static bool queue_needs_wakeup(uvm_tools_queue_t *queue, uvm_tools_queue_snapshot_t *sn)
+static bool ring_needs_wakeup(uvm_tools_queue_t *queue, uvm_tools_queue_snapshot_t *sn)
 {
     NvU32 queue_mask = queue->queue_buffer_count - 1;
 
+    return ((queue->queue_buffer_count + sn->put_behind - sn->get_ahead) & queue_mask) >=
+           READ_ONCE(queue->notification_threshold);
+}
+
+static bool queue_needs_wakeup(uvm_tools_queue_t *queue, uvm_tools_queue_snapshot_t *sn)
+{
     uvm_assert_spinlock_locked(&queue->lock);
-    return ((queue->queue_buffer_count + sn->put_behind - sn->get_ahead) & queue_mask) >= queue->notification_threshold;
+
+    return ring_needs_wakeup(queue, sn);
+}
+
+static NvU32 queue_num_rings(uvm_tools_queue_t *queue)
+{
+    return queue->rings ? queue->num_rings : 1;
 }
 
 static void destroy_event_tracker(uvm_tools_event_tracker_t *event_tracker)
@@ -395,7 +450,7 @@ static void destroy_event_tracker(uvm_tools_event_tracker_t *event_tracker)
             uvm_tools_queue_t *queue = &event_tracker->queue;
             NvU64 buffer_size;
 
-            buffer_size = queue->queue_buffer_count * event_tracker->entry_size;
+            buffer_size = (NvU64)queue->queue_buffer_count * event_tracker->entry_size * queue_num_rings(queue);
 
             remove_event_tracker(va_space,
                                  queue->queue_nodes,
@@ -412,8 +467,10 @@ static void destroy_event_tracker(uvm_tools_event_tracker_t *event_tracker)
             if (queue->control != NULL) {
                 unmap_user_pages(queue->control_buffer_pages,
                                  queue->control,
-                                 sizeof(UvmToolsEventControlData));
+                                 sizeof(UvmToolsEventControlData) * queue_num_rings(queue));
             }
+
+            uvm_kvfree(queue->rings);
         }
         else {
             uvm_tools_counter_t *counters = &event_tracker->counter;
@@ -498,14 +555,171 @@ unlock:
     uvm_spin_unlock(&queue->lock);
 }
 
-static void uvm_tools_enqueue_event(struct list_head *head, const void *entry, size_t entry_size, NvU8 eventType)
+// Write an event to the ring of the current CPU without making it visible to
+// user space. Must be called with preemption disabled and after a speculation
+// barrier, see enqueue_event().
+static void ring_enqueue_event(const void *entry, size_t entry_size, NvU8 eventType, uvm_tools_queue_t *queue)
+{
+    uvm_tools_ring_t *ring = &queue->rings[smp_processor_id()];
+    NvU32 queue_size = queue->queue_buffer_count;
+    NvU32 queue_mask = queue_size - 1;
+    NvU32 get_behind;
+
+    // The control data is mapped into user space with read and write
+    // permissions, so its values cannot be trusted. ring->put is only written
+    // by the kernel.
+    get_behind = atomic_read((atomic_t *)&ring->control->get_behind) & queue_mask;
+
+    // one free element means that the ring is full
+    if (((queue_size + get_behind - ring->put) & queue_mask) == 1) {
+        atomic64_inc((atomic64_t *)&ring->control->dropped + eventType);
+        return;
+    }
+
+    memcpy((char *)ring->buffer + ring->put * entry_size, entry, entry_size);
+
+    ring->put = (ring->put + 1) & queue_mask;
+}
+
+// Publish the events written to the ring of the current CPU since the last
+// commit, and wake up the waiters if needed. Must be called with preemption
+// disabled.
+static void ring_commit(uvm_tools_queue_t *queue)
 {
+    uvm_tools_ring_t *ring = &queue->rings[smp_processor_id()];
+    UvmToolsEventControlData *ctrl = ring->control;
+    uvm_tools_queue_snapshot_t sn;
+
+    if (ring->put == ring->committed)
+        return;
+
+    // The entries must be visible before the put pointers that cover them
+    smp_wmb();
+
+    sn.put_behind = ring->put;
+    atomic_set((atomic_t *)&ctrl->put_ahead, sn.put_behind);
+    atomic_set((atomic_t *)&ctrl->put_behind, sn.put_behind);
+    ring->committed = ring->put;
+
+    sn.get_ahead = atomic_read((atomic_t *)&ctrl->get_ahead);
+
+    // Like enqueue_event(), only signal once per value of get_ahead
+    if (ring_needs_wakeup(queue, &sn) && !(ring->is_wakeup_get_valid && ring->wakeup_get == sn.get_ahead)) {
+        ring->is_wakeup_get_valid = true;
+        ring->wakeup_get = sn.get_ahead;
+        wake_up_all(&queue->wait_queue);
+    }
+}
+
+// Write the staged events of the batch to the per-CPU rings of the event
+// queues. All the events are written from the same CPU so that the rings they
+// end up in are only committed once.
+static void tools_event_batch_flush(uvm_tools_event_batch_t *batch)
+{
+    uvm_va_space_t *va_space = batch->va_space;
     uvm_tools_queue_t *queue;
+    NvU64 event_types = 0;
+    NvU32 i;
+
+    uvm_assert_rwsem_locked(&va_space->tools.lock);
+
+    if (batch->num_events == 0)
+        return;
+
+    preempt_disable();
+
+    for (i = 0; i < batch->num_events; i++) {
+        const UvmEventEntry_V2 *entry = &batch->events[i];
+        NvU8 eventType = entry->eventData.eventType;
+
+        list_for_each_entry(queue, va_space->tools.queues_v2 + eventType, queue_nodes[eventType]) {
+            if (!queue->rings)
+                continue;
+
+            // See the comment on speculation in enqueue_event()
+            nv_speculation_barrier();
+
+            ring_enqueue_event(entry, sizeof(*entry), eventType, queue);
+        }
+
+        event_types |= 1ULL << eventType;
+    }
+
+    for (i = 0; i < UvmEventNumTypesAll; i++) {
+        if (!(event_types & (1ULL << i)))
+            continue;
+
+        list_for_each_entry(queue, va_space->tools.queues_v2 + i, queue_nodes[i]) {
+            if (queue->rings)
+                ring_commit(queue);
+        }
+    }
+
+    preempt_enable();
+
+    batch->num_events = 0;
+}
+
+// Stage the event in the batch, flushing it first if it's full
+static void tools_event_batch_stage(uvm_tools_event_batch_t *batch, const UvmEventEntry_V2 *entry)
+{
+    if (batch->num_events == UVM_TOOLS_EVENT_BATCH_SIZE)
+        tools_event_batch_flush(batch);
+
+    batch->events[batch->num_events++] = *entry;
+}
+
+// Write the event to all the queues in the given list that are subscribed to
+// its type. If batch is not NULL, the event is staged in it for the queues with
+// per-CPU rings, which only see it once the batch is flushed. Queues with a
+// single shared ring are always written right away.
+static void uvm_tools_enqueue_event(struct list_head *head,
+                                    const void *entry,
+                                    size_t entry_size,
+                                    NvU8 eventType,
+                                    uvm_tools_event_batch_t *batch)
+{
+    uvm_tools_queue_t *queue;
+    bool staged = false;
 
     UVM_ASSERT(eventType < UvmEventNumTypesAll);
 
-    list_for_each_entry(queue, head + eventType, queue_nodes[eventType])
-        enqueue_event(entry, entry_size, eventType, queue);
+    list_for_each_entry(queue, head + eventType, queue_nodes[eventType]) {
+        if (!queue->rings) {
+            enqueue_event(entry, entry_size, eventType, queue);
+            continue;
+        }
+
+        if (batch) {
+            if (!staged) {
+                UVM_ASSERT(entry_size == sizeof(UvmEventEntry_V2));
+                tools_event_batch_stage(batch, entry);
+                staged = true;
+            }
+
+            continue;
+        }
+
+        // See the comment on speculation in enqueue_event()
+        nv_speculation_barrier();
+
+        preempt_disable();
+        ring_enqueue_event(entry, entry_size, eventType, queue);
+        ring_commit(queue);
+        preempt_enable();
+    }
+}
+
+// Returns the batch in which events of the given VA space recorded by the
+// current thread need to be staged, if any
+static uvm_tools_event_batch_t *tools_event_batch_current(uvm_va_space_t *va_space)
+{
+    uvm_tools_event_batch_t *batch = uvm_thread_context()->tools_event_batch;
+
+    if (batch && batch->va_space == va_space)
+        return batch;
+
+    return NULL;
 }
 
 static void uvm_tools_record_event(uvm_va_space_t *va_space, const UvmEventEntry *entry)
@@ -514,7 +728,9 @@ static void uvm_tools_record_event(uvm_va_space_t *va_space, const UvmEventEntry
 
     uvm_assert_rwsem_locked(&va_space->tools.lock);
 
-    uvm_tools_enqueue_event(va_space->tools.queues, entry, sizeof(*entry), eventType);
+    // Queues of UvmEventEntry never have per-CPU rings, so there's nothing to
+    // batch
+    uvm_tools_enqueue_event(va_space->tools.queues, entry, sizeof(*entry), eventType, NULL);
 }
 
 static void uvm_tools_record_event_v2(uvm_va_space_t *va_space, const UvmEventEntry_V2 *entry)
@@ -523,7 +739,59 @@ static void uvm_tools_record_event_v2(uvm_va_space_t *va_space, const UvmEventEn
 
     uvm_assert_rwsem_locked(&va_space->tools.lock);
 
-    uvm_tools_enqueue_event(va_space->tools.queues_v2, entry, sizeof(*entry), eventType);
+    uvm_tools_enqueue_event(va_space->tools.queues_v2,
+                            entry,
+                            sizeof(*entry),
+                            eventType,
+                            tools_event_batch_current(va_space));
+}
+
+uvm_tools_event_batch_t *uvm_tools_event_batch_alloc(void)
+{
+    return uvm_kvmalloc_zero(sizeof(uvm_tools_event_batch_t));
+}
+
+void uvm_tools_event_batch_free(uvm_tools_event_batch_t *batch)
+{
+    if (!batch)
+        return;
+
+    UVM_ASSERT(!batch->va_space);
+    UVM_ASSERT(batch->num_events == 0);
+
+    uvm_kvfree(batch);
+}
+
+void uvm_tools_event_batch_begin(uvm_tools_event_batch_t *batch, uvm_va_space_t *va_space)
+{
+    uvm_thread_context_t *thread_context = uvm_thread_context();
+
+    UVM_ASSERT(va_space);
+    UVM_ASSERT(!batch->va_space);
+    UVM_ASSERT(batch->num_events == 0);
+    UVM_ASSERT(!thread_context->tools_event_batch);
+
+    batch->va_space = va_space;
+    thread_context->tools_event_batch = batch;
+}
+
+void uvm_tools_event_batch_end(uvm_tools_event_batch_t *batch)
+{
+    uvm_thread_context_t *thread_context = uvm_thread_context();
+    uvm_va_space_t *va_space = batch->va_space;
+
+    UVM_ASSERT(va_space);
+    UVM_ASSERT(thread_context->tools_event_batch == batch);
+
+    thread_context->tools_event_batch = NULL;
+
+    if (batch->num_events != 0) {
+        uvm_down_read(&va_space->tools.lock);
+        tools_event_batch_flush(batch);
+        uvm_up_read(&va_space->tools.lock);
+    }
+
+    batch->va_space = NULL;
 }
 
 static bool counter_matches_processor(UvmCounterName counter, const NvProcessorUuid *processor)
@@ -677,6 +945,7 @@ static long uvm_tools_unlocked_ioctl(struct file *filp, unsigned int cmd, unsign
         UVM_ROUTE_CMD_STACK_NO_INIT_CHECK(UVM_TOOLS_ENABLE_COUNTERS,            uvm_api_tools_enable_counters);
         UVM_ROUTE_CMD_STACK_NO_INIT_CHECK(UVM_TOOLS_DISABLE_COUNTERS,           uvm_api_tools_disable_counters);
         UVM_ROUTE_CMD_STACK_NO_INIT_CHECK(UVM_TOOLS_INIT_EVENT_TRACKER_V2,      uvm_api_tools_init_event_tracker_v2);
+        UVM_ROUTE_CMD_STACK_NO_INIT_CHECK(UVM_TOOLS_INIT_EVENT_TRACKER_PER_CPU, uvm_api_tools_init_event_tracker_per_cpu);
     }
 
     uvm_thread_assert_all_unlocked();
@@ -705,13 +974,32 @@ static unsigned uvm_tools_poll(struct file *filp, poll_table *wait)
 
     uvm_spin_lock(&event_tracker->queue.lock);
 
-    event_tracker->queue.is_wakeup_get_valid = false;
-    ctrl = event_tracker->queue.control;
-    sn.get_ahead = atomic_read((atomic_t *)&ctrl->get_ahead);
-    sn.put_behind = atomic_read((atomic_t *)&ctrl->put_behind);
+    if (event_tracker->queue.rings) {
+        uvm_tools_queue_t *queue = &event_tracker->queue;
+        NvU32 i;
+
+        // The rings are not protected by the queue lock. Clearing
+        // is_wakeup_get_valid concurrently with its producer can at worst
+        // cause a spurious wakeup.
+        for (i = 0; i < queue->num_rings; i++) {
+            WRITE_ONCE(queue->rings[i].is_wakeup_get_valid, false);
+            ctrl = queue->rings[i].control;
+            sn.get_ahead = atomic_read((atomic_t *)&ctrl->get_ahead);
+            sn.put_behind = atomic_read((atomic_t *)&ctrl->put_behind);
+
+            if (ring_needs_wakeup(queue, &sn))
+                flags = POLLIN | POLLRDNORM;
+        }
+    }
+    else {
+        event_tracker->queue.is_wakeup_get_valid = false;
+        ctrl = event_tracker->queue.control;
+        sn.get_ahead = atomic_read((atomic_t *)&ctrl->get_ahead);
+        sn.put_behind = atomic_read((atomic_t *)&ctrl->put_behind);
 
-    if (queue_needs_wakeup(&event_tracker->queue, &sn))
-        flags = POLLIN | POLLRDNORM;
+        if (queue_needs_wakeup(&event_tracker->queue, &sn))
+            flags = POLLIN | POLLRDNORM;
+    }
 
     uvm_spin_unlock(&event_tracker->queue.lock);
 
@@ -1367,6 +1655,75 @@ void uvm_tools_broadcast_access_counter(uvm_gpu_t *gpu, const uvm_access_counter
     uvm_up_read(&g_tools_va_space_list_lock);
 }
 
+static void fill_fault_buffer_entry_info(UvmEventTestFaultBufferEntryInfo *info,
+                                         const uvm_fault_buffer_entry_t *fault_entry)
+{
+    info->eventType           = UvmEventTypeTestFaultBufferEntry;
+    info->faultType           = fault_entry->fault_type;
+    info->accessType          = fault_entry->fault_access_type;
+    info->clientType          = fault_entry->fault_source.client_type;
+    info->mmuEngineType       = fault_entry->fault_source.mmu_engine_type;
+    info->instancePtrAperture = fault_entry->instance_ptr.aperture;
+    info->veId                = fault_entry->fault_source.ve_id;
+    info->gpcId               = fault_entry->fault_source.gpc_id;
+    info->utlbId              = fault_entry->fault_source.utlb_id;
+    info->clientId            = fault_entry->fault_source.client_id;
+    info->mmuEngineId         = fault_entry->fault_source.mmu_engine_id;
+    info->address             = fault_entry->fault_address;
+    info->instancePtr         = fault_entry->instance_ptr.address;
+    info->timeStampGpu        = fault_entry->timestamp;
+}
+
+static void record_fault_buffer_entry(uvm_va_space_t *va_space,
+                                      uvm_parent_gpu_t *parent_gpu,
+                                      const uvm_fault_buffer_entry_t *fault_entry)
+{
+    UvmEventTestFaultBufferEntryInfo *info;
+
+    uvm_down_read(&va_space->tools.lock);
+
+    if (tools_is_event_enabled_v1(va_space, UvmEventTypeTestFaultBufferEntry)) {
+        UvmEventEntry entry;
+
+        memset(&entry, 0, sizeof(entry));
+
+        info = &entry.testEventData.faultBufferEntry;
+        fill_fault_buffer_entry_info(info, fault_entry);
+        info->srcIndex = uvm_parent_id_value(parent_gpu->id);
+
+        uvm_tools_record_event(va_space, &entry);
+    }
+    if (tools_is_event_enabled_v2(va_space, UvmEventTypeTestFaultBufferEntry)) {
+        UvmEventEntry_V2 entry;
+
+        memset(&entry, 0, sizeof(entry));
+
+        info = &entry.testEventData.faultBufferEntry;
+        fill_fault_buffer_entry_info(info, fault_entry);
+        info->srcIndex = uvm_id_value(uvm_gpu_id_from_parent_gpu_id(parent_gpu->id));
+
+        uvm_tools_record_event_v2(va_space, &entry);
+    }
+
+    uvm_up_read(&va_space->tools.lock);
+}
+
+bool uvm_tools_is_fault_buffer_entry_enabled(void)
+{
+    return tools_is_event_enabled_in_any_va_space(UvmEventTypeTestFaultBufferEntry);
+}
+
+void uvm_tools_broadcast_fault_buffer_entry(uvm_parent_gpu_t *parent_gpu, const uvm_fault_buffer_entry_t *fault_entry)
+{
+    uvm_va_space_t *va_space;
+
+    uvm_down_read(&g_tools_va_space_list_lock);
+    list_for_each_entry(va_space, &g_tools_va_space_list, tools.node) {
+        record_fault_buffer_entry(va_space, parent_gpu, fault_entry);
+    }
+    uvm_up_read(&g_tools_va_space_list_lock);
+}
+
 void uvm_tools_test_hmm_split_invalidate(uvm_va_space_t *va_space)
 {
     UvmEventEntry_V2 entry;
@@ -2020,8 +2377,10 @@ done:
     uvm_up_read(&va_space->tools.lock);
 }
 
+// num_rings is 0 for a queue with a single shared ring
 static NV_STATUS create_event_tracker(UVM_TOOLS_INIT_EVENT_TRACKER_V2_PARAMS *params,
                                       size_t entry_size,
+                                      NvU32 num_rings,
                                       struct file *filp)
 {
     NV_STATUS status = NV_OK;
@@ -2077,7 +2436,26 @@ static NV_STATUS create_event_tracker(UVM_TOOLS_INIT_EVENT_TRACKER_V2_PARAMS *pa
             goto fail;
         }
 
-        buffer_size = queue->queue_buffer_count * entry_size;
+        if (num_rings != 0) {
+            NvU32 i;
+
+            // The total size of the rings is bounded like that of a single
+            // shared queue.
+            if ((NvU64)queue->queue_buffer_count * num_rings > UINT_MAX) {
+                status = NV_ERR_INVALID_ARGUMENT;
+                goto fail;
+            }
+
+            queue->rings = uvm_kvmalloc_zero(num_rings * sizeof(*queue->rings));
+            if (!queue->rings) {
+                status = NV_ERR_NO_MEMORY;
+                goto fail;
+            }
+
+            queue->num_rings = num_rings;
+        }
+
+        buffer_size = (NvU64)queue->queue_buffer_count * entry_size * queue_num_rings(queue);
 
         status = map_user_pages(params->queueBuffer,
                                 buffer_size,
@@ -2087,12 +2465,17 @@ static NV_STATUS create_event_tracker(UVM_TOOLS_INIT_EVENT_TRACKER_V2_PARAMS *pa
             goto fail;
 
         status = map_user_pages(params->controlBuffer,
-                                sizeof(UvmToolsEventControlData),
+                                sizeof(UvmToolsEventControlData) * queue_num_rings(queue),
                                 (void **)&queue->control,
                                 &queue->control_buffer_pages);
 
         if (status != NV_OK)
             goto fail;
+
+        for (i = 0; i < num_rings; i++) {
+            queue->rings[i].control = queue->control + i;
+            queue->rings[i].buffer = (char *)queue->queue_buffer + (NvU64)i * queue->queue_buffer_count * entry_size;
+        }
     }
     else {
         uvm_tools_counter_t *counter = &event_tracker->counter;
@@ -2124,12 +2507,34 @@ NV_STATUS uvm_api_tools_init_event_tracker(UVM_TOOLS_INIT_EVENT_TRACKER_PARAMS *
 
     BUILD_BUG_ON(!__same_type(params, params_v2));
 
-    return create_event_tracker(params_v2, sizeof(UvmEventEntry), filp);
+    return create_event_tracker(params_v2, sizeof(UvmEventEntry), 0, filp);
 }
 
 NV_STATUS uvm_api_tools_init_event_tracker_v2(UVM_TOOLS_INIT_EVENT_TRACKER_V2_PARAMS *params, struct file *filp)
 {
-    return create_event_tracker(params, sizeof(UvmEventEntry_V2), filp);
+    return create_event_tracker(params, sizeof(UvmEventEntry_V2), 0, filp);
+}
+
+NV_STATUS uvm_api_tools_init_event_tracker_per_cpu(UVM_TOOLS_INIT_EVENT_TRACKER_PER_CPU_PARAMS *params,
+                                                   struct file *filp)
+{
+    UVM_TOOLS_INIT_EVENT_TRACKER_V2_PARAMS params_v2 = {0};
+    NV_STATUS status;
+
+    // Counters don't have rings
+    if (params->queueBufferSize == 0 || params->numRings < nr_cpu_ids)
+        return NV_ERR_INVALID_ARGUMENT;
+
+    params_v2.queueBuffer = params->queueBuffer;
+    params_v2.queueBufferSize = params->queueBufferSize;
+    params_v2.controlBuffer = params->controlBuffer;
+    params_v2.uvmFd = params->uvmFd;
+
+    status = create_event_tracker(&params_v2, sizeof(UvmEventEntry_V2), nr_cpu_ids, filp);
+    if (status == NV_OK)
+        params->numRings = nr_cpu_ids;
+
+    return status;
 }
 
 NV_STATUS uvm_api_tools_set_notification_threshold(UVM_TOOLS_SET_NOTIFICATION_THRESHOLD_PARAMS *params, struct file *filp)
@@ -2137,20 +2542,29 @@ NV_STATUS uvm_api_tools_set_notification_threshold(UVM_TOOLS_SET_NOTIFICATION_TH
     uvm_tools_queue_snapshot_t sn;
     uvm_tools_event_tracker_t *event_tracker = tools_event_tracker(filp);
     UvmToolsEventControlData *ctrl;
+    NvU32 i;
 
     if (!tracker_is_queue(event_tracker))
         return NV_ERR_INVALID_ARGUMENT;
 
     uvm_spin_lock(&event_tracker->queue.lock);
 
-    event_tracker->queue.notification_threshold = params->notificationThreshold;
+    WRITE_ONCE(event_tracker->queue.notification_threshold, params->notificationThreshold);
 
-    ctrl = event_tracker->queue.control;
-    sn.put_behind = atomic_read((atomic_t *)&ctrl->put_behind);
-    sn.get_ahead = atomic_read((atomic_t *)&ctrl->get_ahead);
+    for (i = 0; i < queue_num_rings(&event_tracker->queue); i++) {
+        if (event_tracker->queue.rings)
+            ctrl = event_tracker->queue.rings[i].control;
+        else
+            ctrl = event_tracker->queue.control;
 
-    if (queue_needs_wakeup(&event_tracker->queue, &sn))
-        wake_up_all(&event_tracker->queue.wait_queue);
+        sn.put_behind = atomic_read((atomic_t *)&ctrl->put_behind);
+        sn.get_ahead = atomic_read((atomic_t *)&ctrl->get_ahead);
+
+        if (queue_needs_wakeup(&event_tracker->queue, &sn)) {
+            wake_up_all(&event_tracker->queue.wait_queue);
+            break;
+        }
+    }
 
     uvm_spin_unlock(&event_tracker->queue.lock);
 
@@ -2645,6 +3059,246 @@ NV_STATUS uvm_test_inject_tools_event_v2(UVM_TEST_INJECT_TOOLS_EVENT_V2_PARAMS *
     return NV_OK;
 }
 
+// Number of entries of each ring of the queues used by
+// uvm_test_tools_per_cpu_rings(). Large enough to hold a full batch.
+#define TEST_TOOLS_RING_SIZE 256
+
+// Set up a queue for uvm_test_tools_per_cpu_rings(). Kernel allocations stand
+// in for the user mappings of a real event tracker. num_rings is 0 for a queue
+// with a single shared ring.
+static NV_STATUS test_tools_queue_init(uvm_tools_queue_t *queue, NvU32 num_rings)
+{
+    NvU32 i;
+
+    uvm_spin_lock_init(&queue->lock, UVM_LOCK_ORDER_LEAF);
+    init_waitqueue_head(&queue->wait_queue);
+    queue->queue_buffer_count = TEST_TOOLS_RING_SIZE;
+    queue->notification_threshold = queue->queue_buffer_count / 2;
+
+    if (num_rings != 0) {
+        queue->rings = uvm_kvmalloc_zero(num_rings * sizeof(*queue->rings));
+        if (!queue->rings)
+            return NV_ERR_NO_MEMORY;
+
+        queue->num_rings = num_rings;
+    }
+
+    queue->queue_buffer = uvm_kvmalloc_zero((size_t)queue_num_rings(queue) *
+                                            queue->queue_buffer_count *
+                                            sizeof(UvmEventEntry_V2));
+    queue->control = uvm_kvmalloc_zero(queue_num_rings(queue) * sizeof(*queue->control));
+    if (!queue->queue_buffer || !queue->control)
+        return NV_ERR_NO_MEMORY;
+
+    for (i = 0; i < num_rings; i++) {
+        queue->rings[i].control = queue->control + i;
+        queue->rings[i].buffer = (UvmEventEntry_V2 *)queue->queue_buffer + (size_t)i * queue->queue_buffer_count;
+    }
+
+    return NV_OK;
+}
+
+static void test_tools_queue_deinit(uvm_tools_queue_t *queue)
+{
+    uvm_kvfree(queue->control);
+    uvm_kvfree(queue->queue_buffer);
+    uvm_kvfree(queue->rings);
+}
+
+// Number of committed entries not consumed yet in the given ring
+static NvU32 test_tools_ring_num_pending(uvm_tools_queue_t *queue, NvU32 ring)
+{
+    UvmToolsEventControlData *ctrl = queue->control + ring;
+
+    return (atomic_read((atomic_t *)&ctrl->put_behind) - atomic_read((atomic_t *)&ctrl->get_behind)) &
+           (queue->queue_buffer_count - 1);
+}
+
+static NvU32 test_tools_queue_num_pending(uvm_tools_queue_t *queue)
+{
+    NvU32 num_pending = 0;
+    NvU32 i;
+
+    for (i = 0; i < queue_num_rings(queue); i++)
+        num_pending += test_tools_ring_num_pending(queue, i);
+
+    return num_pending;
+}
+
+// Consume all the committed entries of the queue, like a tools client would
+static void test_tools_queue_drain(uvm_tools_queue_t *queue)
+{
+    NvU32 i;
+
+    for (i = 0; i < queue_num_rings(queue); i++) {
+        UvmToolsEventControlData *ctrl = queue->control + i;
+        NvU32 put = atomic_read((atomic_t *)&ctrl->put_behind);
+
+        atomic_set((atomic_t *)&ctrl->get_ahead, put);
+        atomic_set((atomic_t *)&ctrl->get_behind, put);
+    }
+}
+
+static void test_tools_record_events(uvm_va_space_t *va_space, UvmEventEntry_V2 *entry, NvU32 first, NvU32 count)
+{
+    NvU32 i;
+
+    for (i = first; i < first + count; i++) {
+        entry->testEventData.accessCounter.tag = i;
+        uvm_tools_record_event_v2(va_space, entry);
+    }
+}
+
+// Events recorded on a CPU must only land in that CPU's ring, and a full ring
+// must drop events like a shared ring does.
+static NV_STATUS test_tools_per_cpu_delivery(uvm_va_space_t *va_space,
+                                             uvm_tools_queue_t *shared_queue,
+                                             uvm_tools_queue_t *per_cpu_queue,
+                                             UvmEventEntry_V2 *entry)
+{
+    const NvU8 event_type = UvmEventTypeTestAccessCounter;
+    const UvmEventEntry_V2 *ring_entries;
+    NvU32 cpu;
+    NvU32 i;
+
+    // The ring can hold one entry less than its size, so the last event is
+    // dropped
+    uvm_down_read(&va_space->tools.lock);
+    cpu = get_cpu();
+    test_tools_record_events(va_space, entry, 0, TEST_TOOLS_RING_SIZE);
+    put_cpu();
+    uvm_up_read(&va_space->tools.lock);
+
+    TEST_CHECK_RET(test_tools_queue_num_pending(shared_queue) == TEST_TOOLS_RING_SIZE - 1);
+    TEST_CHECK_RET(shared_queue->control->dropped[event_type] == 1);
+
+    for (i = 0; i < per_cpu_queue->num_rings; i++) {
+        NvU32 expected = i == cpu ? TEST_TOOLS_RING_SIZE - 1 : 0;
+
+        TEST_CHECK_RET(test_tools_ring_num_pending(per_cpu_queue, i) == expected);
+        TEST_CHECK_RET(per_cpu_queue->control[i].dropped[event_type] == (i == cpu));
+    }
+
+    ring_entries = per_cpu_queue->rings[cpu].buffer;
+    for (i = 0; i < TEST_TOOLS_RING_SIZE - 1; i++) {
+        TEST_CHECK_RET(ring_entries[i].testEventData.eventType == event_type);
+        TEST_CHECK_RET(ring_entries[i].testEventData.accessCounter.tag == i);
+    }
+
+    test_tools_queue_drain(shared_queue);
+    test_tools_queue_drain(per_cpu_queue);
+
+    return NV_OK;
+}
+
+// Within a tools event batch, the shared ring must keep receiving events as
+// they are recorded, while the per-CPU rings only see them when the batch
+// fills up or ends.
+static NV_STATUS test_tools_per_cpu_batch(uvm_va_space_t *va_space,
+                                          uvm_tools_queue_t *shared_queue,
+                                          uvm_tools_queue_t *per_cpu_queue,
+                                          UvmEventEntry_V2 *entry)
+{
+    uvm_tools_event_batch_t *batch;
+    NV_STATUS status = NV_OK;
+
+    batch = uvm_tools_event_batch_alloc();
+    if (!batch)
+        return NV_ERR_NO_MEMORY;
+
+    uvm_tools_event_batch_begin(batch, va_space);
+    uvm_down_read(&va_space->tools.lock);
+
+    test_tools_record_events(va_space, entry, 0, UVM_TOOLS_EVENT_BATCH_SIZE);
+    TEST_CHECK_GOTO(test_tools_queue_num_pending(shared_queue) == UVM_TOOLS_EVENT_BATCH_SIZE, done);
+    TEST_CHECK_GOTO(test_tools_queue_num_pending(per_cpu_queue) == 0, done);
+
+    // The batch is full, so recording one more event flushes it
+    test_tools_record_events(va_space, entry, UVM_TOOLS_EVENT_BATCH_SIZE, 1);
+    TEST_CHECK_GOTO(test_tools_queue_num_pending(shared_queue) == UVM_TOOLS_EVENT_BATCH_SIZE + 1, done);
+    TEST_CHECK_GOTO(test_tools_queue_num_pending(per_cpu_queue) == UVM_TOOLS_EVENT_BATCH_SIZE, done);
+
+done:
+    uvm_up_read(&va_space->tools.lock);
+    uvm_tools_event_batch_end(batch);
+    uvm_tools_event_batch_free(batch);
+
+    if (status != NV_OK)
+        return status;
+
+    TEST_CHECK_RET(test_tools_queue_num_pending(shared_queue) == UVM_TOOLS_EVENT_BATCH_SIZE + 1);
+    TEST_CHECK_RET(test_tools_queue_num_pending(per_cpu_queue) == UVM_TOOLS_EVENT_BATCH_SIZE + 1);
+
+    test_tools_queue_drain(shared_queue);
+    test_tools_queue_drain(per_cpu_queue);
+
+    return NV_OK;
+}
+
+NV_STATUS uvm_test_tools_per_cpu_rings(UVM_TEST_TOOLS_PER_CPU_RINGS_PARAMS *params, struct file *filp)
+{
+    uvm_va_space_t *va_space = uvm_va_space_get(filp);
+    UVM_TOOLS_INIT_EVENT_TRACKER_PER_CPU_PARAMS init_params = {0};
+    const NvU8 event_type = UvmEventTypeTestAccessCounter;
+    uvm_tools_queue_t *shared_queue;
+    uvm_tools_queue_t *per_cpu_queue;
+    UvmEventEntry_V2 entry = {0};
+    NV_STATUS status;
+
+    // A per-CPU queue needs a ring for every possible CPU id, and cannot be
+    // used for counters. The arguments are checked before uvmFd, which is
+    // invalid.
+    init_params.queueBufferSize = TEST_TOOLS_RING_SIZE;
+    init_params.numRings = nr_cpu_ids - 1;
+    init_params.uvmFd = ~0U;
+    TEST_CHECK_RET(uvm_api_tools_init_event_tracker_per_cpu(&init_params, filp) == NV_ERR_INVALID_ARGUMENT);
+
+    init_params.queueBufferSize = 0;
+    init_params.numRings = nr_cpu_ids;
+    TEST_CHECK_RET(uvm_api_tools_init_event_tracker_per_cpu(&init_params, filp) == NV_ERR_INVALID_ARGUMENT);
+
+    shared_queue = uvm_kvmalloc_zero(sizeof(*shared_queue));
+    per_cpu_queue = uvm_kvmalloc_zero(sizeof(*per_cpu_queue));
+    if (!shared_queue || !per_cpu_queue) {
+        status = NV_ERR_NO_MEMORY;
+        goto free_queues;
+    }
+
+    status = test_tools_queue_init(shared_queue, 0);
+    if (status != NV_OK)
+        goto deinit_queues;
+
+    status = test_tools_queue_init(per_cpu_queue, nr_cpu_ids);
+    if (status != NV_OK)
+        goto deinit_queues;
+
+    uvm_down_write(&va_space->tools.lock);
+    list_add(&shared_queue->queue_nodes[event_type], va_space->tools.queues_v2 + event_type);
+    list_add(&per_cpu_queue->queue_nodes[event_type], va_space->tools.queues_v2 + event_type);
+    uvm_up_write(&va_space->tools.lock);
+
+    entry.testEventData.accessCounter.eventType = event_type;
+
+    status = test_tools_per_cpu_delivery(va_space, shared_queue, per_cpu_queue, &entry);
+    if (status == NV_OK)
+        status = test_tools_per_cpu_batch(va_space, shared_queue, per_cpu_queue, &entry);
+
+    uvm_down_write(&va_space->tools.lock);
+    list_del(&shared_queue->queue_nodes[event_type]);
+    list_del(&per_cpu_queue->queue_nodes[event_type]);
+    uvm_up_write(&va_space->tools.lock);
+
+deinit_queues:
+    test_tools_queue_deinit(shared_queue);
+    test_tools_queue_deinit(per_cpu_queue);
+
+free_queues:
+    uvm_kvfree(shared_queue);
+    uvm_kvfree(per_cpu_queue);
+
+    return status;
+}
+
 NV_STATUS uvm_test_increment_tools_counter(UVM_TEST_INCREMENT_TOOLS_COUNTER_PARAMS *params, struct file *filp)
 {
     NvU32 i;
@@ -34,6 +34,7 @@
 
 NV_STATUS uvm_test_inject_tools_event(UVM_TEST_INJECT_TOOLS_EVENT_PARAMS *params, struct file *filp);
 NV_STATUS uvm_test_inject_tools_event_v2(UVM_TEST_INJECT_TOOLS_EVENT_V2_PARAMS *params, struct file *filp);
+NV_STATUS uvm_test_tools_per_cpu_rings(UVM_TEST_TOOLS_PER_CPU_RINGS_PARAMS *params, struct file *filp);
 NV_STATUS uvm_test_increment_tools_counter(UVM_TEST_INCREMENT_TOOLS_COUNTER_PARAMS *params, struct file *filp);
 NV_STATUS uvm_test_tools_flush_replay_events(UVM_TEST_TOOLS_FLUSH_REPLAY_EVENTS_PARAMS *params, struct file *filp);
 
@@ -125,6 +126,29 @@ void uvm_tools_record_access_counter(uvm_va_space_t *va_space,
                                      uvm_gpu_id_t gpu_id,
                                      const uvm_access_counter_buffer_entry_t *buffer_entry);
 
+// Batching of tools events
+//
+// Between uvm_tools_event_batch_begin() and uvm_tools_event_batch_end(), the
+// events recorded by the calling thread for the given VA space are staged in
+// the batch for the queues with per-CPU rings, and they are only written to
+// those rings when the batch is full or ended, so each ring is made visible to
+// user space once per batch. Queues with a single shared ring are not batched
+// and keep receiving the events as they are recorded.
+//
+// The VA space must remain valid until the batch is ended, and batches cannot
+// be nested.
+uvm_tools_event_batch_t *uvm_tools_event_batch_alloc(void);
+void uvm_tools_event_batch_free(uvm_tools_event_batch_t *batch);
+void uvm_tools_event_batch_begin(uvm_tools_event_batch_t *batch, uvm_va_space_t *va_space);
+void uvm_tools_event_batch_end(uvm_tools_event_batch_t *batch);
+
+// Returns true if recording of raw fault buffer entries is enabled in any VA
+// space. Used to check once per fault batch whether
+// uvm_tools_broadcast_fault_buffer_entry needs to be called.
+bool uvm_tools_is_fault_buffer_entry_enabled(void);
+
+void uvm_tools_broadcast_fault_buffer_entry(uvm_parent_gpu_t *parent_gpu, const uvm_fault_buffer_entry_t *fault_entry);
+
 void uvm_tools_test_hmm_split_invalidate(uvm_va_space_t *va_space);
 
 // schedules completed events and then waits from the to be dispatched
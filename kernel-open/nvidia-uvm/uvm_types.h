@@ -74,6 +74,28 @@ typedef unsigned long long UvmStream;
 //-----------------------------------------------------------------------------
 #define UVM_DISCARD_FLAGS_UNMAP ((NvU64)1)
 
+//-----------------------------------------------------------------------------
+// UVM CPU NUMA placement policies
+//
+// These policies select the NUMA node on which CPU pages are allocated when
+// managed memory becomes resident on the CPU because of a fault or an access
+// counter notification, and the VA range has no preferred CPU NUMA node:
+// UvmCpuNumaPlacementLocal: The node closest to the thread servicing the
+//      fault. This is the default.
+// UvmCpuNumaPlacementGpu: The node closest to the GPU that faulted, or to the
+//      GPU the pages are migrated from.
+// UvmCpuNumaPlacementInterleave: Each VA block is allocated on one of the
+//      nodes with memory, selected round-robin by block address.
+//-----------------------------------------------------------------------------
+typedef enum
+{
+    UvmCpuNumaPlacementLocal      = 0,
+    UvmCpuNumaPlacementGpu        = 1,
+    UvmCpuNumaPlacementInterleave = 2,
+    // ---- Add new values above this line
+    UvmCpuNumaPlacementCount
+} UvmCpuNumaPlacement;
+
 typedef struct
 {
     // UUID of the physical GPU if the GPU is not SMC capable or SMC enabled,
@@ -297,8 +319,9 @@ typedef enum
 
     UvmEventTypeTestHmmSplitInvalidate     = UvmEventTestTypesFirst,
     UvmEventTypeTestAccessCounter          = UvmEventTestTypesFirst + 1,
+    UvmEventTypeTestFaultBufferEntry       = UvmEventTestTypesFirst + 2,
 
-    UvmEventTestTypesLast                  = UvmEventTypeTestAccessCounter,
+    UvmEventTestTypesLast                  = UvmEventTypeTestFaultBufferEntry,
 
     UvmEventNumTypesAll
 } UvmEventType;
@@ -323,6 +346,7 @@ typedef enum
 #define UVM_EVENT_ENABLE_EVICTION                     ((NvU64)1 << UvmEventTypeEviction)
 #define UVM_EVENT_ENABLE_TEST_ACCESS_COUNTER          ((NvU64)1 << UvmEventTypeTestAccessCounter)
 #define UVM_EVENT_ENABLE_TEST_HMM_SPLIT_INVALIDATE    ((NvU64)1 << UvmEventTypeTestHmmSplitInvalidate)
+#define UVM_EVENT_ENABLE_TEST_FAULT_BUFFER_ENTRY      ((NvU64)1 << UvmEventTypeTestFaultBufferEntry)
 
 //------------------------------------------------------------------------------
 // Information associated with a memory violation event
@@ -1286,6 +1310,37 @@ typedef struct
     NvU8 eventType;
 } UvmEventTestSplitInvalidateInfo;
 
+//------------------------------------------------------------------------------
+// This info is provided for every replayable fault buffer entry fetched by the
+// driver, before any coalescing, so that fault streams can be recorded and
+// replayed offline. Fields hold the raw driver values. See
+// uvm_fault_buffer_entry_t for details.
+//------------------------------------------------------------------------------
+typedef struct
+{
+    //
+    // eventType has to be the 1st argument of this structure.
+    // Setting eventType = UvmEventTypeTestFaultBufferEntry helps to identify
+    // event data in a queue.
+    //
+    NvU8 eventType;
+    NvU8 faultType;             // uvm_fault_type_t
+    NvU8 accessType;            // uvm_fault_access_type_t
+    NvU8 clientType;            // uvm_fault_client_type_t
+    NvU8 mmuEngineType;         // uvm_mmu_engine_type_t
+    NvU8 instancePtrAperture;   // uvm_aperture_t
+    NvU8 veId;
+    NvU8 gpcId;
+    NvU16 srcIndex;             // index of the gpu that reported the fault
+    NvU16 utlbId;
+    NvU16 clientId;
+    NvU16 mmuEngineId;
+    NvU64 address;              // faulting address, as reported by the GPU
+    NvU64 instancePtr;
+    NvU64 timeStampGpu;         // gpu time stamp when the fault entry was
+                                // written in the fault buffer
+} UvmEventTestFaultBufferEntryInfo;
+
 //------------------------------------------------------------------------------
 // Entry added in the event queue buffer when an enabled event occurs. For
 // compatibility with all tools ensure that this structure is 64 bit aligned.
@@ -1320,6 +1375,7 @@ typedef struct
 
             UvmEventTestAccessCounterInfo accessCounter;
             UvmEventTestSplitInvalidateInfo splitInvalidate;
+            UvmEventTestFaultBufferEntryInfo faultBufferEntry;
         } testEventData;
     };
 } UvmEventEntry;
@@ -1354,6 +1410,7 @@ typedef struct
 
             UvmEventTestAccessCounterInfo_V2 accessCounter;
             UvmEventTestSplitInvalidateInfo splitInvalidate;
+            UvmEventTestFaultBufferEntryInfo faultBufferEntry;
         } testEventData;
     };
 } UvmEventEntry_V2;
@@ -40,6 +40,7 @@
 #include "uvm_mem.h"
 #include "uvm_gpu_access_counters.h"
 #include "uvm_va_space_mm.h"
+#include "uvm_test.h"
 #include "uvm_test_ioctl.h"
 #include "uvm_va_policy.h"
 #include "uvm_conf_computing.h"
@@ -60,6 +61,26 @@ static struct kmem_cache *g_uvm_page_mask_cache __read_mostly;
 static struct kmem_cache *g_uvm_va_block_context_cache __read_mostly;
 static struct kmem_cache *g_uvm_va_block_cpu_node_state_cache __read_mostly;
 
+// Number of freed uvm_va_block_context_t kept per CPU for reuse. Contexts are
+// mostly allocated and freed around a single operation, so a handful per CPU
+// covers the common case.
+#define UVM_VA_BLOCK_CONTEXT_MAGAZINE_SIZE 4
+
+// Per-CPU magazine of fully constructed uvm_va_block_context_t, including their
+// per-node page tracking masks. Only accessed with preemption disabled.
+typedef struct
+{
+    uvm_va_block_context_t *contexts[UVM_VA_BLOCK_CONTEXT_MAGAZINE_SIZE];
+    unsigned count;
+} uvm_va_block_context_magazine_t;
+
+static DEFINE_PER_CPU(uvm_va_block_context_magazine_t, g_uvm_va_block_context_magazine);
+
+static int uvm_va_block_context_magazine __read_mostly = 1;
+module_param(uvm_va_block_context_magazine, int, S_IRUGO|S_IWUSR);
+MODULE_PARM_DESC(uvm_va_block_context_magazine,
+                 "Cache freed VA block contexts per CPU for reuse by the next allocation. Default: 1.");
+
 static int uvm_fault_force_sysmem __read_mostly = 0;
 module_param(uvm_fault_force_sysmem, int, S_IRUGO|S_IWUSR);
 MODULE_PARM_DESC(uvm_fault_force_sysmem, "Force (1) using sysmem storage for pages that faulted. Default: 0.");
@@ -71,6 +92,11 @@ static int uvm_block_cpu_to_cpu_copy_with_ce __read_mostly = 0;
 module_param(uvm_block_cpu_to_cpu_copy_with_ce, int, S_IRUGO | S_IWUSR);
 MODULE_PARM_DESC(uvm_block_cpu_to_cpu_copy_with_ce, "Use GPU CEs for CPU-to-CPU migrations.");
 
+static int uvm_block_copy_coalesce __read_mostly = 1;
+module_param(uvm_block_copy_coalesce, int, S_IRUGO | S_IWUSR);
+MODULE_PARM_DESC(uvm_block_copy_coalesce, "Merge copies of physically-contiguous pages into a single CE transfer when "
+                                          "the block storage is not physically-contiguous as a whole. Default: 1.");
+
 // Caching is always disabled for mappings to remote memory. The following two
 // module parameters can be used to force caching for GPU peer/sysmem mappings.
 //
@@ -184,6 +210,7 @@ void uvm_va_block_retry_init(uvm_va_block_retry_t *retry)
     uvm_tracker_init(&retry->tracker);
     INIT_LIST_HEAD(&retry->used_chunks);
     INIT_LIST_HEAD(&retry->free_chunks);
+    retry->no_eviction = false;
 }
 
 static uvm_va_block_cpu_node_state_t *block_node_state_get(uvm_va_block_t *block, int nid)
@@ -924,8 +951,24 @@ NV_STATUS uvm_va_block_init(void)
     return NV_OK;
 }
 
+static void block_context_destroy(uvm_va_block_context_t *va_block_context);
+
+static void block_context_magazines_drain(void)
+{
+    int cpu;
+
+    for_each_possible_cpu(cpu) {
+        uvm_va_block_context_magazine_t *magazine = per_cpu_ptr(&g_uvm_va_block_context_magazine, cpu);
+
+        while (magazine->count > 0)
+            block_context_destroy(magazine->contexts[--magazine->count]);
+    }
+}
+
 void uvm_va_block_exit(void)
 {
+    block_context_magazines_drain();
+
     kmem_cache_destroy_safe(&g_uvm_va_block_cpu_node_state_cache);
     kmem_cache_destroy_safe(&g_uvm_va_block_context_cache);
     kmem_cache_destroy_safe(&g_uvm_page_mask_cache);
@@ -966,7 +1009,7 @@ error:
     return NV_ERR_NO_MEMORY;
 }
 
-uvm_va_block_context_t *uvm_va_block_context_alloc(struct mm_struct *mm)
+static uvm_va_block_context_t *block_context_create(void)
 {
     uvm_va_block_context_t *block_context = kmem_cache_alloc(g_uvm_va_block_context_cache, NV_UVM_GFP_FLAGS);
     NV_STATUS status;
@@ -980,6 +1023,68 @@ uvm_va_block_context_t *uvm_va_block_context_alloc(struct mm_struct *mm)
         return NULL;
     }
 
+    uvm_kvmalloc_object_created(UVM_KVMALLOC_OBJECT_VA_BLOCK_CONTEXT);
+
+    return block_context;
+}
+
+static void block_context_destroy(uvm_va_block_context_t *va_block_context)
+{
+    block_context_free_tracking(&va_block_context->make_resident.cpu_pages_used);
+    kmem_cache_free(g_uvm_va_block_context_cache, va_block_context);
+
+    uvm_kvmalloc_object_destroyed(UVM_KVMALLOC_OBJECT_VA_BLOCK_CONTEXT);
+}
+
+static uvm_va_block_context_t *block_context_magazine_pop(void)
+{
+    uvm_va_block_context_magazine_t *magazine;
+    uvm_va_block_context_t *block_context = NULL;
+
+    if (!uvm_va_block_context_magazine)
+        return NULL;
+
+    magazine = get_cpu_ptr(&g_uvm_va_block_context_magazine);
+    if (magazine->count > 0)
+        block_context = magazine->contexts[--magazine->count];
+    put_cpu_ptr(&g_uvm_va_block_context_magazine);
+
+    return block_context;
+}
+
+static bool block_context_magazine_push(uvm_va_block_context_t *block_context)
+{
+    uvm_va_block_context_magazine_t *magazine;
+    bool pushed = false;
+
+    if (!uvm_va_block_context_magazine)
+        return false;
+
+    magazine = get_cpu_ptr(&g_uvm_va_block_context_magazine);
+    if (magazine->count < ARRAY_SIZE(magazine->contexts)) {
+        magazine->contexts[magazine->count++] = block_context;
+        pushed = true;
+    }
+    put_cpu_ptr(&g_uvm_va_block_context_magazine);
+
+    return pushed;
+}
+
+uvm_va_block_context_t *uvm_va_block_context_alloc(struct mm_struct *mm)
+{
+    uvm_va_block_context_t *block_context = block_context_magazine_pop();
+    bool from_cache = block_context != NULL;
+
+    if (!block_context) {
+        block_context = block_context_create();
+        if (!block_context)
+            return NULL;
+    }
+
+    uvm_kvmalloc_object_allocated(UVM_KVMALLOC_OBJECT_VA_BLOCK_CONTEXT, from_cache);
+
+    // Callers don't expect the context to be cleared, so a cached context only
+    // needs the same initialization as a new one.
     uvm_va_block_context_init(block_context, mm);
     return block_context;
 }
@@ -1004,15 +1109,20 @@ void uvm_va_block_context_init(uvm_va_block_context_t *va_block_context, struct
 
     va_block_context->mm = mm;
     va_block_context->make_resident.dest_nid = NUMA_NO_NODE;
+    va_block_context->make_resident.copy_coalesce = -1;
     nodes_clear(va_block_context->make_resident.cpu_pages_used.nodes);
 }
 
 void uvm_va_block_context_free(uvm_va_block_context_t *va_block_context)
 {
-    if (va_block_context) {
-        block_context_free_tracking(&va_block_context->make_resident.cpu_pages_used);
-        kmem_cache_free(g_uvm_va_block_context_cache, va_block_context);
-    }
+    if (!va_block_context)
+        return;
+
+    // Don't leave a stale mm pointer in cached contexts
+    va_block_context->mm = NULL;
+
+    if (!block_context_magazine_push(va_block_context))
+        block_context_destroy(va_block_context);
 }
 
 // Convert from page_index to chunk_index. The goal is for each system page in
@@ -1998,6 +2108,9 @@ static NV_STATUS block_alloc_gpu_chunk(uvm_va_block_t *block,
             status = uvm_pmm_gpu_alloc_user(&gpu->pmm, 1, size, UVM_PMM_ALLOC_FLAGS_NONE, &gpu_chunk, &retry->tracker);
         }
 
+        if (status == NV_ERR_NO_MEMORY && retry->no_eviction)
+            return status;
+
         if (status == NV_ERR_NO_MEMORY) {
             // If that fails with no memory, try allocating with eviction and
             // return back to the caller immediately so that the operation can
@@ -3316,6 +3429,25 @@ typedef struct
     // True if at least one CE transfer (such as a memcopy) has already been
     // pushed to the GPU during the VA block copy thus far.
     bool copy_pushed;
+
+    // Whether physically-contiguous pages may be coalesced into a single CE
+    // transfer. See block_copy_should_coalesce.
+    bool coalesce;
+
+    // Run of pages whose source and destination are both physically
+    // contiguous, pending to be copied with a single CE transfer. Only used
+    // when the storage of the block is not physically-contiguous as a whole in
+    // the source or the destination, in which case pages are copied one at a
+    // time. See block_copy_push_coalesced.
+    struct
+    {
+        uvm_va_block_region_t region;
+
+        // Addresses of the first page of the run, from the view of the copying
+        // GPU.
+        uvm_gpu_address_t src_address;
+        uvm_gpu_address_t dst_address;
+    } run;
 } block_copy_state_t;
 
 // Begin a push appropriate for copying data from src_id processor to dst_id
@@ -3505,6 +3637,25 @@ static void block_mark_memory_used(uvm_va_block_t *block, uvm_processor_id_t id)
     }
 }
 
+// Report a use of the block's memory on the GPU, after servicing a GPU fault or
+// access counter notification on it, to the PMM eviction policy.
+static void block_mark_memory_referenced(uvm_va_block_t *block, uvm_processor_id_t id)
+{
+    uvm_gpu_t *gpu;
+
+    if (UVM_ID_IS_CPU(id) || !uvm_processor_mask_test(&block->resident, id))
+        return;
+
+    gpu = uvm_gpu_get(id);
+
+    // Same restrictions as block_mark_memory_used()
+    if (!uvm_va_block_is_hmm(block) &&
+        uvm_va_block_size(block) == UVM_CHUNK_SIZE_MAX &&
+        uvm_parent_gpu_supports_eviction(gpu->parent)) {
+        uvm_pmm_gpu_mark_root_chunk_referenced(&gpu->pmm, uvm_va_block_gpu_state_get(block, gpu->id)->chunks[0]);
+    }
+}
+
 static void block_set_resident_processor(uvm_va_block_t *block, uvm_processor_id_t id)
 {
     UVM_ASSERT(!uvm_page_mask_empty(uvm_va_block_resident_mask_get(block, id, NUMA_NO_NODE)));
@@ -3839,6 +3990,68 @@ static void block_copy_push(uvm_va_block_t *block,
     copy_state->copy_pushed = true;
 }
 
+// Push the CE transfer for the pending run of contiguous pages, if any
+static void block_copy_flush_run(block_copy_state_t *copy_state, uvm_push_t *push)
+{
+    uvm_gpu_t *gpu = uvm_push_get_gpu(push);
+    NvU64 size = uvm_va_block_region_size(copy_state->run.region);
+
+    if (size == 0)
+        return;
+
+    // See block_copy_push
+    if (copy_state->copy_pushed)
+        uvm_push_set_flag(push, UVM_PUSH_FLAG_CE_NEXT_PIPELINED);
+    else
+        UVM_ASSERT(!uvm_push_test_flag(push, UVM_PUSH_FLAG_CE_NEXT_PIPELINED));
+
+    uvm_push_set_flag(push, UVM_PUSH_FLAG_NEXT_MEMBAR_NONE);
+
+    gpu->parent->ce_hal->memcopy(push, copy_state->run.dst_address, copy_state->run.src_address, size);
+
+    copy_state->copy_pushed = true;
+    copy_state->run.region = uvm_va_block_region(0, 0);
+}
+
+static bool block_copy_address_extends_run(uvm_gpu_address_t run_address, NvU64 run_size, uvm_gpu_address_t address)
+{
+    run_address.address += run_size;
+
+    return uvm_gpu_addr_cmp(run_address, address) == 0;
+}
+
+// Copy a single page, merging it with the pending run when both its source and
+// destination immediately follow those of the run. The CE transfer for the run
+// is pushed once a page breaks the physical contiguity, or when the push ends.
+//
+// This turns copies from/to blocks backed by multiple chunks (for example, CPU
+// chunks smaller than the block, or GPU chunks allocated separately) into one
+// transfer per physically-contiguous run instead of one transfer per page.
+static void block_copy_push_coalesced(uvm_va_block_t *block,
+                                      block_copy_state_t *copy_state,
+                                      uvm_page_index_t page_index,
+                                      uvm_push_t *push)
+{
+    uvm_gpu_t *gpu = uvm_push_get_gpu(push);
+    uvm_gpu_address_t src_address = block_copy_get_address(block, &copy_state->src, page_index, gpu);
+    uvm_gpu_address_t dst_address = block_copy_get_address(block, &copy_state->dst, page_index, gpu);
+    NvU64 run_size = uvm_va_block_region_size(copy_state->run.region);
+
+    if (run_size > 0 &&
+        page_index == copy_state->run.region.outer &&
+        block_copy_address_extends_run(copy_state->run.src_address, run_size, src_address) &&
+        block_copy_address_extends_run(copy_state->run.dst_address, run_size, dst_address)) {
+        copy_state->run.region.outer++;
+        return;
+    }
+
+    block_copy_flush_run(copy_state, push);
+
+    copy_state->run.region = uvm_va_block_region_for_page(page_index);
+    copy_state->run.src_address = src_address;
+    copy_state->run.dst_address = dst_address;
+}
+
 static NV_STATUS block_copy_end_push(uvm_va_block_t *block,
                                      block_copy_state_t *copy_state,
                                      uvm_tracker_t *copy_tracker,
@@ -3847,6 +4060,8 @@ static NV_STATUS block_copy_end_push(uvm_va_block_t *block,
 {
     NV_STATUS tracker_status;
 
+    block_copy_flush_run(copy_state, push);
+
     // TODO: Bug 1766424: If the destination is a GPU and the copy was done
     //       by that GPU, use a GPU-local membar if no peer can currently
     //       map this page. When peer access gets enabled, do a MEMBAR_SYS
@@ -3889,6 +4104,21 @@ static bool block_copy_should_use_push(uvm_va_block_t *block, block_copy_state_t
         !(UVM_ID_IS_CPU(copy_state->src.id) && uvm_id_equal(copy_state->src.id, copy_state->dst.id));
 }
 
+// Page copies are coalesced into physically-contiguous runs only if the block
+// storage is not contiguous as a whole on both sides, since otherwise the
+// caller already copies whole contiguous regions at once. Copies that need to
+// be encrypted are done one page at a time.
+static bool block_copy_should_coalesce(block_copy_state_t *copy_state)
+{
+    if (!copy_state->coalesce)
+        return false;
+
+    if (copy_state->src.is_block_contig && copy_state->dst.is_block_contig)
+        return false;
+
+    return !is_cc_sysmem_copy(copy_state);
+}
+
 static NV_STATUS block_copy_pages(uvm_va_block_t *va_block,
                                   block_copy_state_t *copy_state,
                                   uvm_va_block_region_t region,
@@ -3929,6 +4159,10 @@ static NV_STATUS block_copy_pages(uvm_va_block_t *va_block,
                 block_mark_cpu_page_dirty(va_block, page_index, copy_state->dst.nid);
         }
     }
+    else if (block_copy_should_coalesce(copy_state)) {
+        UVM_ASSERT(uvm_va_block_region_num_pages(region) == 1);
+        block_copy_push_coalesced(va_block, copy_state, region.first, push);
+    }
     else {
         block_copy_push(va_block, copy_state, region, push);
     }
@@ -4069,6 +4303,11 @@ static NV_STATUS block_copy_resident_pages_between(uvm_va_block_t *block,
     copy_state.src.is_block_contig = is_block_phys_contig(block, src_id, copy_state.src.nid);
     copy_state.dst.is_block_contig = is_block_phys_contig(block, dst_id, copy_state.dst.nid);
 
+    if (block_context->make_resident.copy_coalesce >= 0)
+        copy_state.coalesce = block_context->make_resident.copy_coalesce;
+    else
+        copy_state.coalesce = !!uvm_block_copy_coalesce;
+
     // Zero destination pages if copying over nvlink that can hit STO
     status = zero_destination_mem_if_needed(block, region, copy_mask, src_id, dst_id);
     if (status != NV_OK)
@@ -9548,6 +9787,7 @@ static NV_STATUS block_evict_pages_from_gpu(uvm_va_block_t *va_block, uvm_gpu_t
                                                  subregion,
                                                  UVM_ID_CPU,
                                                  UVM_MIGRATE_MODE_MAKE_RESIDENT_AND_MAP,
+                                                 UVM_MAKE_RESIDENT_CAUSE_API_MIGRATE,
                                                  NULL);
         }
 
@@ -10966,6 +11206,12 @@ NV_STATUS uvm_va_block_split_locked(uvm_va_block_t *existing_va_block,
                               uvm_va_block_num_cpu_pages(existing_va_block),
                               &new_block->maybe_mapped_pages,
                               uvm_va_block_num_cpu_pages(new_block));
+
+        new_block->prefetch_info.last_migration_proc_id = existing_va_block->prefetch_info.last_migration_proc_id;
+        block_split_page_mask(&existing_va_block->prefetch_info.prefetched_pages,
+                              uvm_va_block_num_cpu_pages(existing_va_block),
+                              &new_block->prefetch_info.prefetched_pages,
+                              uvm_va_block_num_cpu_pages(new_block));
     }
 
     block_set_processor_masks(existing_va_block);
@@ -11729,8 +11975,65 @@ static uvm_processor_id_t block_select_processor_residency(uvm_va_block_t *va_bl
     return processor_id;
 }
 
+// Select the NUMA node for a page that is becoming resident on the CPU
+// according to the CPU NUMA placement policy of its VA range. current_nid is
+// used when the policy cannot be honored.
+static int block_select_placement_node(uvm_va_block_t *va_block,
+                                       uvm_page_index_t page_index,
+                                       uvm_processor_id_t processor_id,
+                                       const uvm_va_policy_t *policy,
+                                       int current_nid)
+{
+    uvm_processor_id_t gpu_id = UVM_ID_INVALID;
+    uvm_gpu_id_t id;
+    int nid;
+
+    switch (policy->cpu_numa_placement) {
+        case UvmCpuNumaPlacementGpu:
+            // Use the GPU that triggered the migration, or the GPU the page is
+            // migrated from if the CPU did, so that the copy and later DMAs
+            // from that GPU don't cross sockets.
+            if (UVM_ID_IS_GPU(processor_id)) {
+                gpu_id = processor_id;
+            }
+            else {
+                for_each_gpu_id_in_mask(id, &va_block->resident) {
+                    if (uvm_page_mask_test(uvm_va_block_resident_mask_get(va_block, id, NUMA_NO_NODE), page_index)) {
+                        gpu_id = id;
+                        break;
+                    }
+                }
+
+                if (UVM_ID_IS_INVALID(gpu_id) && UVM_ID_IS_GPU(policy->preferred_location))
+                    gpu_id = policy->preferred_location;
+            }
+
+            if (UVM_ID_IS_INVALID(gpu_id))
+                return current_nid;
+
+            nid = uvm_gpu_get(gpu_id)->parent->closest_cpu_numa_node;
+            break;
+
+        case UvmCpuNumaPlacementInterleave:
+            // Interleave at VA block granularity so that CPU chunks can still
+            // be allocated with the largest size.
+            nid = uvm_cpu_chunk_interleave_node(va_block->start / UVM_VA_BLOCK_SIZE);
+            break;
+
+        default:
+            UVM_ASSERT(policy->cpu_numa_placement == UvmCpuNumaPlacementLocal);
+            return current_nid;
+    }
+
+    if (nid == NUMA_NO_NODE || !node_state(nid, N_MEMORY))
+        return current_nid;
+
+    return nid;
+}
+
 static int block_select_node_residency(uvm_va_block_t *va_block,
                                        uvm_page_index_t page_index,
+                                       uvm_processor_id_t processor_id,
                                        uvm_processor_id_t new_residency,
                                        const uvm_va_policy_t *policy,
                                        const uvm_perf_thrashing_hint_t *thrashing_hint)
@@ -11760,9 +12063,15 @@ static int block_select_node_residency(uvm_va_block_t *va_block,
         return policy->preferred_nid;
 
     // If the preferred location is the CPU, the new resident nid is the
-    // preferred nid.
-    if (UVM_ID_IS_CPU(policy->preferred_location))
-        return policy->preferred_nid;
+    // preferred nid. Without a preferred nid, pages which are not resident on
+    // the CPU yet are placed according to the CPU NUMA placement policy.
+    if (UVM_ID_IS_CPU(policy->preferred_location)) {
+        if (policy->preferred_nid != NUMA_NO_NODE ||
+            uvm_va_block_cpu_is_page_resident_on(va_block, NUMA_NO_NODE, page_index))
+            return policy->preferred_nid;
+
+        return block_select_placement_node(va_block, page_index, processor_id, policy, NUMA_NO_NODE);
+    }
 
     // If read duplication is enabled and the page is also resident on the CPU,
     // keep its current NUMA node residency.
@@ -11774,7 +12083,7 @@ static int block_select_node_residency(uvm_va_block_t *va_block,
     if (uvm_va_block_cpu_is_page_resident_on(va_block, NUMA_NO_NODE, page_index))
         return NUMA_NO_NODE;
 
-    return current_nid;
+    return block_select_placement_node(va_block, page_index, processor_id, policy, current_nid);
 }
 
 uvm_processor_id_t uvm_va_block_select_residency(uvm_va_block_t *va_block,
@@ -11815,7 +12124,7 @@ uvm_processor_id_t uvm_va_block_select_residency(uvm_va_block_t *va_block,
 
     // Now, that we know the new residency processor, select the NUMA node ID
     // based on the new processor.
-    nid = block_select_node_residency(va_block, page_index, id, policy, thrashing_hint);
+    nid = block_select_node_residency(va_block, page_index, processor_id, id, policy, thrashing_hint);
 
     va_block_context->make_resident.dest_nid = nid;
 
@@ -12441,6 +12750,9 @@ NV_STATUS uvm_va_block_service_locked(uvm_processor_id_t processor_id,
         status = uvm_va_block_service_finish(processor_id, va_block, service_context);
         if (status != NV_OK)
             break;
+
+        if (UVM_ID_IS_GPU(processor_id))
+            block_mark_memory_referenced(va_block, new_residency);
     }
 
     return status;
@@ -13415,6 +13727,8 @@ NV_STATUS uvm_va_block_evict_chunks(uvm_va_block_t *va_block,
     if (status != NV_OK)
         goto out;
 
+    uvm_perf_prefetch_notify_eviction(va_block, gpu->id, pages_to_evict);
+
     // VA space lock may not be held and hence we cannot reestablish any
     // mappings here and need to defer it to a work queue.
     //
@@ -13803,6 +14117,396 @@ out:
     return status;
 }
 
+static NV_STATUS test_block_copy_migrate(uvm_va_block_t *va_block,
+                                        uvm_service_block_context_t *service_context,
+                                        uvm_processor_id_t dest_id,
+                                        NvU64 *time_ns)
+{
+    uvm_va_block_retry_t va_block_retry;
+    uvm_tracker_t tracker = UVM_TRACKER_INIT();
+    NvU64 start = NV_GETTIME();
+    NV_STATUS status;
+
+    status = UVM_VA_BLOCK_LOCK_RETRY(va_block,
+                                     &va_block_retry,
+                                     uvm_va_block_migrate_locked(va_block,
+                                                                 &va_block_retry,
+                                                                 service_context,
+                                                                 uvm_va_block_region_from_block(va_block),
+                                                                 dest_id,
+                                                                 UVM_MIGRATE_MODE_MAKE_RESIDENT_AND_MAP,
+                                                                 UVM_MAKE_RESIDENT_CAUSE_API_MIGRATE,
+                                                                 &tracker));
+    if (status == NV_OK)
+        status = uvm_tracker_wait_deinit(&tracker);
+    else
+        uvm_tracker_deinit(&tracker);
+
+    *time_ns += NV_GETTIME() - start;
+
+    return status;
+}
+
+// Fill all the pages of the block, which must be resident on the CPU, with a
+// pattern derived from seed, or check that they hold it.
+static NV_STATUS test_block_copy_pattern(uvm_va_block_t *va_block, NvU64 seed, bool check)
+{
+    uvm_page_mask_t *resident_mask;
+    uvm_page_index_t page_index;
+    NV_STATUS status;
+
+    uvm_mutex_lock(&va_block->lock);
+
+    status = uvm_tracker_wait(&va_block->tracker);
+    if (status != NV_OK)
+        goto out;
+
+    resident_mask = uvm_va_block_resident_mask_get(va_block, UVM_ID_CPU, NUMA_NO_NODE);
+
+    for_each_va_block_page(page_index, va_block) {
+        NvU64 address = uvm_va_block_cpu_page_address(va_block, page_index);
+        struct page *page;
+        NvU64 *data;
+        size_t i;
+
+        if (!uvm_page_mask_test(resident_mask, page_index)) {
+            status = NV_ERR_INVALID_STATE;
+            break;
+        }
+
+        page = uvm_va_block_get_cpu_page(va_block, page_index);
+        data = kmap(page);
+
+        for (i = 0; i < PAGE_SIZE / sizeof(*data); i++) {
+            NvU64 expected = (address + i * sizeof(*data)) ^ seed;
+
+            if (!check) {
+                data[i] = expected;
+            }
+            else if (data[i] != expected) {
+                UVM_TEST_PRINT("Page %u of block [0x%llx, 0x%llx]: 0x%llx instead of 0x%llx at offset %zu\n",
+                               page_index,
+                               va_block->start,
+                               va_block->end,
+                               data[i],
+                               expected,
+                               i * sizeof(*data));
+                status = NV_ERR_INVALID_STATE;
+                break;
+            }
+        }
+
+        kunmap(page);
+
+        if (status != NV_OK)
+            break;
+    }
+
+out:
+    uvm_mutex_unlock(&va_block->lock);
+
+    return status;
+}
+
+NV_STATUS uvm_test_va_block_copy_coalesce(UVM_TEST_VA_BLOCK_COPY_COALESCE_PARAMS *params, struct file *filp)
+{
+    uvm_va_space_t *va_space = uvm_va_space_get(filp);
+    uvm_service_block_context_t *service_context = NULL;
+    uvm_va_range_managed_t *managed_range;
+    uvm_va_block_t *va_block;
+    uvm_gpu_t *gpu;
+    struct mm_struct *mm;
+    NV_STATUS status = NV_OK;
+    int coalesce;
+    NvU32 i;
+
+    memset(params->to_gpu_ns, 0, sizeof(params->to_gpu_ns));
+    memset(params->to_cpu_ns, 0, sizeof(params->to_cpu_ns));
+
+    mm = uvm_va_space_mm_or_current_retain_lock(va_space);
+    uvm_va_space_down_read(va_space);
+
+    gpu = uvm_va_space_get_gpu_by_uuid(va_space, &params->gpu_uuid);
+    if (!gpu || !uvm_gpu_can_address(gpu, params->lookup_address, 1)) {
+        status = NV_ERR_INVALID_DEVICE;
+        goto out;
+    }
+
+    managed_range = uvm_va_range_managed_find(va_space, params->lookup_address);
+    if (!managed_range) {
+        status = NV_ERR_INVALID_ADDRESS;
+        goto out;
+    }
+
+    status = uvm_va_range_block_create(managed_range,
+                                       uvm_va_range_block_index(managed_range, params->lookup_address),
+                                       &va_block);
+    if (status != NV_OK)
+        goto out;
+
+    if (!uvm_range_group_all_migratable(va_space, va_block->start, va_block->end)) {
+        status = NV_ERR_INVALID_ADDRESS;
+        goto out;
+    }
+
+    service_context = uvm_service_block_context_alloc(mm);
+    if (!service_context) {
+        status = NV_ERR_NO_MEMORY;
+        goto out;
+    }
+
+    service_context->prefetch_hint.residency = UVM_ID_INVALID;
+    service_context->block_context->make_resident.dest_nid = NUMA_NO_NODE;
+
+    params->num_pages = uvm_va_block_num_cpu_pages(va_block);
+
+    for (coalesce = 0; coalesce < 2; coalesce++) {
+        service_context->block_context->make_resident.copy_coalesce = coalesce;
+
+        for (i = 0; i < params->iterations; i++) {
+            NvU64 seed = ((NvU64)i << 1) | coalesce;
+            NvU64 cpu_ns = 0;
+
+            // Populate the block on the CPU and write the pattern. This is not
+            // accounted since it only matters for the first iteration.
+            TEST_NV_CHECK_GOTO(test_block_copy_migrate(va_block, service_context, UVM_ID_CPU, &cpu_ns), out);
+            TEST_NV_CHECK_GOTO(test_block_copy_pattern(va_block, seed, false), out);
+
+            TEST_NV_CHECK_GOTO(test_block_copy_migrate(va_block,
+                                                       service_context,
+                                                       gpu->id,
+                                                       &params->to_gpu_ns[coalesce]),
+                               out);
+            TEST_NV_CHECK_GOTO(test_block_copy_migrate(va_block,
+                                                       service_context,
+                                                       UVM_ID_CPU,
+                                                       &params->to_cpu_ns[coalesce]),
+                               out);
+
+            TEST_NV_CHECK_GOTO(test_block_copy_pattern(va_block, seed, true), out);
+
+            if (fatal_signal_pending(current)) {
+                status = NV_ERR_SIGNAL_PENDING;
+                goto out;
+            }
+        }
+    }
+
+out:
+    uvm_service_block_context_free(service_context);
+    uvm_va_space_up_read(va_space);
+    uvm_va_space_mm_or_current_release_unlock(va_space, mm);
+
+    return status;
+}
+
+// Make the whole block resident on the CPU selecting the destination NUMA node
+// the same way a CPU fault on its first page would. The selected node is
+// returned in nid.
+static NV_STATUS test_cpu_numa_placement_make_resident(uvm_va_block_t *va_block,
+                                                       uvm_va_block_retry_t *va_block_retry,
+                                                       uvm_va_block_context_t *block_context,
+                                                       int *nid)
+{
+    const uvm_va_policy_t *policy = uvm_va_policy_get(va_block, va_block->start);
+    uvm_perf_thrashing_hint_t thrashing_hint = { .type = UVM_PERF_THRASHING_HINT_TYPE_NONE };
+    uvm_processor_id_t new_residency;
+    bool read_duplicate;
+
+    new_residency = uvm_va_block_select_residency(va_block,
+                                                  block_context,
+                                                  0,
+                                                  UVM_ID_CPU,
+                                                  uvm_fault_access_type_mask_bit(UVM_FAULT_ACCESS_TYPE_WRITE),
+                                                  policy,
+                                                  &thrashing_hint,
+                                                  UVM_SERVICE_OPERATION_REPLAYABLE_FAULTS,
+                                                  true,
+                                                  &read_duplicate);
+    if (!UVM_ID_IS_CPU(new_residency))
+        return NV_ERR_INVALID_STATE;
+
+    *nid = block_context->make_resident.dest_nid;
+
+    return uvm_va_block_make_resident(va_block,
+                                      va_block_retry,
+                                      block_context,
+                                      UVM_ID_CPU,
+                                      uvm_va_block_region_from_block(va_block),
+                                      NULL,
+                                      NULL,
+                                      UVM_MAKE_RESIDENT_CAUSE_REPLAYABLE_FAULT);
+}
+
+// Return the node the placement mode should have selected for the block, or
+// selected_nid if the mode can't be honored or depends on the servicing thread.
+static int test_cpu_numa_placement_expected_nid(uvm_va_block_t *va_block,
+                                                uvm_gpu_t *gpu,
+                                                UvmCpuNumaPlacement placement,
+                                                int selected_nid)
+{
+    int nid;
+
+    switch (placement) {
+        case UvmCpuNumaPlacementGpu:
+            nid = gpu->parent->closest_cpu_numa_node;
+            break;
+        case UvmCpuNumaPlacementInterleave:
+            nid = uvm_cpu_chunk_interleave_node(va_block->start / UVM_VA_BLOCK_SIZE);
+            break;
+        default:
+            return selected_nid;
+    }
+
+    if (nid == NUMA_NO_NODE || !node_state(nid, N_MEMORY))
+        return selected_nid;
+
+    return nid;
+}
+
+static NV_STATUS test_cpu_numa_placement_check(uvm_va_block_t *va_block,
+                                               uvm_gpu_t *gpu,
+                                               UvmCpuNumaPlacement placement,
+                                               int nid)
+{
+    int expected_nid = test_cpu_numa_placement_expected_nid(va_block, gpu, placement, nid);
+    uvm_page_index_t page_index;
+    NV_STATUS status = NV_OK;
+
+    if (nid != expected_nid) {
+        UVM_TEST_PRINT("Placement %u selected node %d instead of %d\n", placement, nid, expected_nid);
+        return NV_ERR_INVALID_STATE;
+    }
+
+    uvm_mutex_lock(&va_block->lock);
+
+    status = uvm_tracker_wait(&va_block->tracker);
+    if (status != NV_OK)
+        goto out;
+
+    for_each_va_block_page(page_index, va_block) {
+        struct page *page;
+
+        if (!uvm_va_block_cpu_is_page_resident_on(va_block, NUMA_NO_NODE, page_index)) {
+            status = NV_ERR_INVALID_STATE;
+            break;
+        }
+
+        // The allocator picks the node when none was selected
+        if (nid == NUMA_NO_NODE)
+            continue;
+
+        page = uvm_va_block_get_cpu_page(va_block, page_index);
+        if (page_to_nid(page) != nid) {
+            UVM_TEST_PRINT("Placement %u page %u on node %d instead of %d\n",
+                           placement,
+                           page_index,
+                           page_to_nid(page),
+                           nid);
+            status = NV_ERR_INVALID_STATE;
+            break;
+        }
+    }
+
+out:
+    uvm_mutex_unlock(&va_block->lock);
+
+    return status;
+}
+
+static NV_STATUS test_cpu_numa_placement_mode(UVM_TEST_CPU_NUMA_PLACEMENT_PARAMS *params,
+                                              struct file *filp,
+                                              UvmCpuNumaPlacement placement)
+{
+    uvm_va_space_t *va_space = uvm_va_space_get(filp);
+    UVM_SET_CPU_NUMA_PLACEMENT_PARAMS placement_params = { 0 };
+    uvm_service_block_context_t *service_context = NULL;
+    uvm_va_range_managed_t *managed_range;
+    uvm_va_block_retry_t va_block_retry;
+    uvm_va_block_t *va_block;
+    uvm_gpu_t *gpu;
+    struct mm_struct *mm;
+    NvU64 migrate_ns = 0;
+    int nid = NUMA_NO_NODE;
+    NV_STATUS status;
+
+    placement_params.requestedBase = params->base;
+    placement_params.length = params->length;
+    placement_params.placement = placement;
+    status = uvm_api_set_cpu_numa_placement(&placement_params, filp);
+    if (status != NV_OK)
+        return status;
+
+    mm = uvm_va_space_mm_or_current_retain_lock(va_space);
+    uvm_va_space_down_read(va_space);
+
+    gpu = uvm_va_space_get_gpu_by_uuid(va_space, &params->gpu_uuid);
+    if (!gpu || !uvm_gpu_can_address(gpu, params->base, 1)) {
+        status = NV_ERR_INVALID_DEVICE;
+        goto out;
+    }
+
+    managed_range = uvm_va_range_managed_find(va_space, params->base);
+    if (!managed_range) {
+        status = NV_ERR_INVALID_ADDRESS;
+        goto out;
+    }
+
+    status = uvm_va_range_block_create(managed_range,
+                                       uvm_va_range_block_index(managed_range, params->base),
+                                       &va_block);
+    if (status != NV_OK)
+        goto out;
+
+    service_context = uvm_service_block_context_alloc(mm);
+    if (!service_context) {
+        status = NV_ERR_NO_MEMORY;
+        goto out;
+    }
+
+    service_context->prefetch_hint.residency = UVM_ID_INVALID;
+    service_context->block_context->make_resident.dest_nid = NUMA_NO_NODE;
+
+    // Start from the GPU so that the GPU mode has a source GPU, and so that the
+    // CPU pages are allocated again.
+    TEST_NV_CHECK_GOTO(test_block_copy_migrate(va_block, service_context, gpu->id, &migrate_ns), out);
+
+    status = UVM_VA_BLOCK_LOCK_RETRY(va_block,
+                                     &va_block_retry,
+                                     test_cpu_numa_placement_make_resident(va_block,
+                                                                           &va_block_retry,
+                                                                           service_context->block_context,
+                                                                           &nid));
+    params->nids[placement] = nid;
+    if (status != NV_OK)
+        goto out;
+
+    status = test_cpu_numa_placement_check(va_block, gpu, placement, nid);
+
+out:
+    uvm_service_block_context_free(service_context);
+    uvm_va_space_up_read(va_space);
+    uvm_va_space_mm_or_current_release_unlock(va_space, mm);
+
+    return status;
+}
+
+NV_STATUS uvm_test_cpu_numa_placement(UVM_TEST_CPU_NUMA_PLACEMENT_PARAMS *params, struct file *filp)
+{
+    UvmCpuNumaPlacement placement;
+
+    for (placement = 0; placement < UvmCpuNumaPlacementCount; placement++)
+        params->nids[placement] = NUMA_NO_NODE;
+
+    for (placement = 0; placement < UvmCpuNumaPlacementCount; placement++) {
+        NV_STATUS status = test_cpu_numa_placement_mode(params, filp, placement);
+        if (status != NV_OK)
+            return status;
+    }
+
+    return NV_OK;
+}
+
 NV_STATUS uvm_test_va_residency_info(UVM_TEST_VA_RESIDENCY_INFO_PARAMS *params, struct file *filp)
 {
     NV_STATUS status = NV_OK;
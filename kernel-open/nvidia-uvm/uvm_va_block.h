@@ -496,6 +496,12 @@ struct uvm_va_block_struct
         uvm_processor_id_t last_migration_proc_id;
 
         NvU16 fault_migrations_to_last_proc;
+
+        // Pages prefetched to last_migration_proc_id that have not been
+        // accounted as used or evicted untouched yet. This is the feedback
+        // for the adaptive prefetch threshold of the VA range. Only used for
+        // managed blocks.
+        uvm_page_mask_t prefetched_pages;
     } prefetch_info;
 
     struct
@@ -516,6 +522,13 @@ struct uvm_va_block_struct
         // while not holding the block lock and calling hmm_range_fault().
         unsigned long changed;
 
+        // The mmu_notifier invalidation, identified by its range and sequence
+        // number, which already handled this va_block on behalf of a
+        // neighbouring va_block's notifier callback. Protected by the va_block
+        // lock. See hmm_invalidate_batch().
+        const struct mmu_notifier_range *invalidate_batch_range;
+        unsigned long invalidate_batch_seq;
+
         // Parent VA space pointer. It is NULL for managed blocks or if
         // the HMM block is dead. This field can be read while holding the
         // block lock and is only modified while holding the va_space write
@@ -607,6 +620,11 @@ struct uvm_va_block_retry_struct
     // can contain chunks from multiple GPUs. All the used chunks are unpinned
     // when the operation is finished with uvm_va_block_retry_deinit().
     struct list_head used_chunks;
+
+    // Fail GPU chunk allocations with NV_ERR_NO_MEMORY instead of evicting
+    // other blocks. Used by speculative migrations, which aren't worth an
+    // eviction. Cleared by uvm_va_block_retry_init().
+    bool no_eviction;
 };
 
 // Module load/exit
@@ -1515,6 +1533,10 @@ uvm_gpu_chunk_t *uvm_va_block_lookup_gpu_chunk(uvm_va_block_t *va_block, uvm_gpu
 //
 // The out_tracker can be NULL.
 //
+// cause is reported in the migration events. It is
+// UVM_MAKE_RESIDENT_CAUSE_API_MIGRATE for UvmMigrate() and
+// UVM_MAKE_RESIDENT_CAUSE_PREFETCH for speculative migrations.
+//
 // If do_mappings is false, mappings are not added after pages have been
 // migrated.
 //
@@ -1537,6 +1559,7 @@ NV_STATUS uvm_va_block_migrate_locked(uvm_va_block_t *va_block,
                                       uvm_va_block_region_t region,
                                       uvm_processor_id_t dest_id,
                                       uvm_migrate_mode_t mode,
+                                      uvm_make_resident_cause_t cause,
                                       uvm_tracker_t *out_tracker);
 
 // Write block's data from a CPU buffer
@@ -1593,6 +1616,8 @@ NV_STATUS uvm_test_change_pte_mapping(UVM_TEST_CHANGE_PTE_MAPPING_PARAMS *params
 NV_STATUS uvm_test_va_block_info(UVM_TEST_VA_BLOCK_INFO_PARAMS *params, struct file *filp);
 NV_STATUS uvm_test_va_residency_info(UVM_TEST_VA_RESIDENCY_INFO_PARAMS *params, struct file *filp);
 NV_STATUS uvm_test_va_block_discard_status(UVM_TEST_VA_BLOCK_DISCARD_STATUS_PARAMS *params, struct file *filp);
+NV_STATUS uvm_test_va_block_copy_coalesce(UVM_TEST_VA_BLOCK_COPY_COALESCE_PARAMS *params, struct file *filp);
+NV_STATUS uvm_test_cpu_numa_placement(UVM_TEST_CPU_NUMA_PLACEMENT_PARAMS *params, struct file *filp);
 
 // Compute the offset in system pages of addr from the start of va_block.
 static uvm_page_index_t uvm_va_block_cpu_page_index(uvm_va_block_t *va_block, NvU64 addr)
@@ -1776,12 +1801,29 @@ static bool uvm_page_mask_region_test(const uvm_page_mask_t *mask,
 
 static NvU32 uvm_page_mask_region_weight(const uvm_page_mask_t *mask, uvm_va_block_region_t region)
 {
-    NvU32 weight_before = 0;
+    size_t first_word = BIT_WORD(region.first);
+    size_t last_word;
+    NvU32 weight = 0;
+    size_t i;
 
-    if (region.first > 0)
-        weight_before = bitmap_weight(mask->bitmap, region.first);
+    if (region.first == region.outer)
+        return 0;
+
+    // Only walk the words covered by the region, masking the partial words at
+    // both ends.
+    last_word = BIT_WORD(region.outer - 1);
+    for (i = first_word; i <= last_word; i++) {
+        unsigned long word = mask->bitmap[i];
+
+        if (i == first_word)
+            word &= BITMAP_FIRST_WORD_MASK(region.first);
+        if (i == last_word)
+            word &= BITMAP_LAST_WORD_MASK(region.outer);
 
-    return bitmap_weight(mask->bitmap, region.outer) - weight_before;
+        weight += hweight_long(word);
+    }
+
+    return weight;
 }
 
 static bool uvm_page_mask_region_empty(const uvm_page_mask_t *mask, uvm_va_block_region_t region)
@@ -1817,14 +1859,43 @@ static void uvm_page_mask_zero(uvm_page_mask_t *mask)
     bitmap_zero(mask->bitmap, PAGES_PER_UVM_VA_BLOCK);
 }
 
+// The whole-mask operations below loop over the words of the mask with a
+// compile-time trip count, which the compiler fully unrolls, instead of calling
+// the out-of-line bitmap_*() helpers with a runtime length. Like those helpers,
+// the operations returning a result ignore the bits past
+// PAGES_PER_UVM_VA_BLOCK in the last word. Vector instructions aren't used since
+// they would require saving the FPU state in the kernel.
+#define UVM_PAGE_MASK_WORDS BITS_TO_LONGS(PAGES_PER_UVM_VA_BLOCK)
+
+// Mask of the valid bits of the given word of a page mask
+static unsigned long uvm_page_mask_word_valid_bits(size_t word)
+{
+    if (word == UVM_PAGE_MASK_WORDS - 1)
+        return BITMAP_LAST_WORD_MASK(PAGES_PER_UVM_VA_BLOCK);
+
+    return ~0UL;
+}
+
 static bool uvm_page_mask_empty(const uvm_page_mask_t *mask)
 {
-    return bitmap_empty(mask->bitmap, PAGES_PER_UVM_VA_BLOCK);
+    unsigned long result = 0;
+    size_t i;
+
+    for (i = 0; i < UVM_PAGE_MASK_WORDS; i++)
+        result |= mask->bitmap[i] & uvm_page_mask_word_valid_bits(i);
+
+    return result == 0;
 }
 
 static bool uvm_page_mask_full(const uvm_page_mask_t *mask)
 {
-    return bitmap_full(mask->bitmap, PAGES_PER_UVM_VA_BLOCK);
+    unsigned long result = 0;
+    size_t i;
+
+    for (i = 0; i < UVM_PAGE_MASK_WORDS; i++)
+        result |= ~mask->bitmap[i] & uvm_page_mask_word_valid_bits(i);
+
+    return result == 0;
 }
 
 static void uvm_page_mask_fill(uvm_page_mask_t *mask)
@@ -1836,26 +1907,48 @@ static bool uvm_page_mask_and(uvm_page_mask_t *mask_out,
                               const uvm_page_mask_t *mask_in1,
                               const uvm_page_mask_t *mask_in2)
 {
-    return bitmap_and(mask_out->bitmap, mask_in1->bitmap, mask_in2->bitmap, PAGES_PER_UVM_VA_BLOCK);
+    unsigned long result = 0;
+    size_t i;
+
+    for (i = 0; i < UVM_PAGE_MASK_WORDS; i++) {
+        mask_out->bitmap[i] = mask_in1->bitmap[i] & mask_in2->bitmap[i];
+        result |= mask_out->bitmap[i] & uvm_page_mask_word_valid_bits(i);
+    }
+
+    return result != 0;
 }
 
 static bool uvm_page_mask_andnot(uvm_page_mask_t *mask_out,
                                  const uvm_page_mask_t *mask_in1,
                                  const uvm_page_mask_t *mask_in2)
 {
-    return bitmap_andnot(mask_out->bitmap, mask_in1->bitmap, mask_in2->bitmap, PAGES_PER_UVM_VA_BLOCK);
+    unsigned long result = 0;
+    size_t i;
+
+    for (i = 0; i < UVM_PAGE_MASK_WORDS; i++) {
+        mask_out->bitmap[i] = mask_in1->bitmap[i] & ~mask_in2->bitmap[i];
+        result |= mask_out->bitmap[i] & uvm_page_mask_word_valid_bits(i);
+    }
+
+    return result != 0;
 }
 
 static void uvm_page_mask_or(uvm_page_mask_t *mask_out,
                              const uvm_page_mask_t *mask_in1,
                              const uvm_page_mask_t *mask_in2)
 {
-    bitmap_or(mask_out->bitmap, mask_in1->bitmap, mask_in2->bitmap, PAGES_PER_UVM_VA_BLOCK);
+    size_t i;
+
+    for (i = 0; i < UVM_PAGE_MASK_WORDS; i++)
+        mask_out->bitmap[i] = mask_in1->bitmap[i] | mask_in2->bitmap[i];
 }
 
 static void uvm_page_mask_complement(uvm_page_mask_t *mask_out, const uvm_page_mask_t *mask_in)
 {
-    bitmap_complement(mask_out->bitmap, mask_in->bitmap, PAGES_PER_UVM_VA_BLOCK);
+    size_t i;
+
+    for (i = 0; i < UVM_PAGE_MASK_WORDS; i++)
+        mask_out->bitmap[i] = ~mask_in->bitmap[i];
 }
 
 static void uvm_page_mask_copy(uvm_page_mask_t *mask_out, const uvm_page_mask_t *mask_in)
@@ -1865,17 +1958,85 @@ static void uvm_page_mask_copy(uvm_page_mask_t *mask_out, const uvm_page_mask_t
 
 static NvU32 uvm_page_mask_weight(const uvm_page_mask_t *mask)
 {
-    return bitmap_weight(mask->bitmap, PAGES_PER_UVM_VA_BLOCK);
+    NvU32 weight = 0;
+    size_t i;
+
+    for (i = 0; i < UVM_PAGE_MASK_WORDS; i++)
+        weight += hweight_long(mask->bitmap[i] & uvm_page_mask_word_valid_bits(i));
+
+    return weight;
 }
 
 static bool uvm_page_mask_subset(const uvm_page_mask_t *subset, const uvm_page_mask_t *mask)
 {
-    return bitmap_subset(subset->bitmap, mask->bitmap, PAGES_PER_UVM_VA_BLOCK);
+    unsigned long result = 0;
+    size_t i;
+
+    for (i = 0; i < UVM_PAGE_MASK_WORDS; i++)
+        result |= subset->bitmap[i] & ~mask->bitmap[i] & uvm_page_mask_word_valid_bits(i);
+
+    return result == 0;
 }
 
 static bool uvm_page_mask_equal(const uvm_page_mask_t *mask_in1, const uvm_page_mask_t *mask_in2)
 {
-    return bitmap_equal(mask_in1->bitmap, mask_in2->bitmap, PAGES_PER_UVM_VA_BLOCK);
+    unsigned long result = 0;
+    size_t i;
+
+    for (i = 0; i < UVM_PAGE_MASK_WORDS; i++)
+        result |= (mask_in1->bitmap[i] ^ mask_in2->bitmap[i]) & uvm_page_mask_word_valid_bits(i);
+
+    return result == 0;
+}
+
+// Fused uvm_page_mask_andnot() and uvm_page_mask_weight() of the result, in a
+// single pass over the masks.
+static NvU32 uvm_page_mask_andnot_weight(uvm_page_mask_t *mask_out,
+                                         const uvm_page_mask_t *mask_in1,
+                                         const uvm_page_mask_t *mask_in2)
+{
+    NvU32 weight = 0;
+    size_t i;
+
+    for (i = 0; i < UVM_PAGE_MASK_WORDS; i++) {
+        mask_out->bitmap[i] = mask_in1->bitmap[i] & ~mask_in2->bitmap[i];
+        weight += hweight_long(mask_out->bitmap[i] & uvm_page_mask_word_valid_bits(i));
+    }
+
+    return weight;
+}
+
+// Fused uvm_page_mask_and() and uvm_page_mask_weight() of the result, in a
+// single pass over the masks.
+static NvU32 uvm_page_mask_and_weight(uvm_page_mask_t *mask_out,
+                                      const uvm_page_mask_t *mask_in1,
+                                      const uvm_page_mask_t *mask_in2)
+{
+    NvU32 weight = 0;
+    size_t i;
+
+    for (i = 0; i < UVM_PAGE_MASK_WORDS; i++) {
+        mask_out->bitmap[i] = mask_in1->bitmap[i] & mask_in2->bitmap[i];
+        weight += hweight_long(mask_out->bitmap[i] & uvm_page_mask_word_valid_bits(i));
+    }
+
+    return weight;
+}
+
+// Returns the first page set in both masks, or PAGES_PER_UVM_VA_BLOCK if there
+// is none, without computing the whole intersection.
+static uvm_page_index_t uvm_page_mask_and_find_first(const uvm_page_mask_t *mask_in1, const uvm_page_mask_t *mask_in2)
+{
+    size_t i;
+
+    for (i = 0; i < UVM_PAGE_MASK_WORDS; i++) {
+        unsigned long word = mask_in1->bitmap[i] & mask_in2->bitmap[i] & uvm_page_mask_word_valid_bits(i);
+
+        if (word)
+            return i * BITS_PER_LONG + __ffs(word);
+    }
+
+    return PAGES_PER_UVM_VA_BLOCK;
 }
 
 static bool uvm_page_mask_init_from_region(uvm_page_mask_t *mask_out,
@@ -1903,7 +2064,7 @@ static void uvm_page_mask_shift_left(uvm_page_mask_t *mask_out, const uvm_page_m
 
 static bool uvm_page_mask_intersects(const uvm_page_mask_t *mask1, const uvm_page_mask_t *mask2)
 {
-    return bitmap_intersects(mask1->bitmap, mask2->bitmap, PAGES_PER_UVM_VA_BLOCK);
+    return uvm_page_mask_and_find_first(mask1, mask2) != PAGES_PER_UVM_VA_BLOCK;
 }
 
 // Print the given page mask on the given buffer using hex symbols. The
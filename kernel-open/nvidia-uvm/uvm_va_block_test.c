@@ -28,6 +28,7 @@
 #include "uvm_va_block.h"
 #include "uvm_va_space.h"
 #include "uvm_mmu.h"
+#include "uvm_test_rng.h"
 
 static NV_STATUS test_chunk_index_range(NvU64 start, NvU64 size, uvm_gpu_t *gpu)
 {
@@ -110,3 +111,144 @@ out:
     uvm_va_space_up_read(va_space);
     return status;
 }
+
+typedef struct
+{
+    uvm_page_mask_t in1;
+    uvm_page_mask_t in2;
+    uvm_page_mask_t out;
+} page_mask_benchmark_masks_t;
+
+// Returns a value summarizing the result of the operation: whether the output
+// is non-empty for and/andnot, the weight or the first page found.
+static NvU64 page_mask_benchmark_op(UVM_TEST_PAGE_MASK_OP op, bool generic, page_mask_benchmark_masks_t *masks)
+{
+    unsigned long *out = masks->out.bitmap;
+    const unsigned long *in1 = masks->in1.bitmap;
+    const unsigned long *in2 = masks->in2.bitmap;
+
+    switch (op) {
+        case UVM_TEST_PAGE_MASK_OP_AND:
+            if (generic)
+                return bitmap_and(out, in1, in2, PAGES_PER_UVM_VA_BLOCK) != 0;
+            return uvm_page_mask_and(&masks->out, &masks->in1, &masks->in2);
+        case UVM_TEST_PAGE_MASK_OP_ANDNOT:
+            if (generic)
+                return bitmap_andnot(out, in1, in2, PAGES_PER_UVM_VA_BLOCK) != 0;
+            return uvm_page_mask_andnot(&masks->out, &masks->in1, &masks->in2);
+        case UVM_TEST_PAGE_MASK_OP_OR:
+            if (generic)
+                bitmap_or(out, in1, in2, PAGES_PER_UVM_VA_BLOCK);
+            else
+                uvm_page_mask_or(&masks->out, &masks->in1, &masks->in2);
+            return 0;
+        case UVM_TEST_PAGE_MASK_OP_WEIGHT:
+            if (generic)
+                return bitmap_weight(in1, PAGES_PER_UVM_VA_BLOCK);
+            return uvm_page_mask_weight(&masks->in1);
+        case UVM_TEST_PAGE_MASK_OP_ANDNOT_WEIGHT:
+            if (generic) {
+                bitmap_andnot(out, in1, in2, PAGES_PER_UVM_VA_BLOCK);
+                return bitmap_weight(out, PAGES_PER_UVM_VA_BLOCK);
+            }
+            return uvm_page_mask_andnot_weight(&masks->out, &masks->in1, &masks->in2);
+        case UVM_TEST_PAGE_MASK_OP_AND_FIND_FIRST:
+            if (generic) {
+                bitmap_and(out, in1, in2, PAGES_PER_UVM_VA_BLOCK);
+                return find_first_bit(out, PAGES_PER_UVM_VA_BLOCK);
+            }
+            return uvm_page_mask_and_find_first(&masks->in1, &masks->in2);
+        default:
+            UVM_ASSERT_MSG(0, "Unexpected op %u\n", op);
+            return 0;
+    }
+}
+
+static bool page_mask_benchmark_op_writes_out(UVM_TEST_PAGE_MASK_OP op)
+{
+    return op != UVM_TEST_PAGE_MASK_OP_WEIGHT && op != UVM_TEST_PAGE_MASK_OP_AND_FIND_FIRST;
+}
+
+static NV_STATUS test_page_mask_op_matches(UVM_TEST_PAGE_MASK_OP op,
+                                           page_mask_benchmark_masks_t *masks,
+                                           uvm_page_mask_t *generic_out)
+{
+    NvU64 generic_result, page_mask_result;
+
+    generic_result = page_mask_benchmark_op(op, true, masks);
+    uvm_page_mask_copy(generic_out, &masks->out);
+
+    page_mask_result = page_mask_benchmark_op(op, false, masks);
+
+    TEST_CHECK_RET(generic_result == page_mask_result);
+    if (page_mask_benchmark_op_writes_out(op))
+        TEST_CHECK_RET(bitmap_equal(generic_out->bitmap, masks->out.bitmap, PAGES_PER_UVM_VA_BLOCK));
+
+    return NV_OK;
+}
+
+static NvU64 page_mask_benchmark_time(UVM_TEST_PAGE_MASK_OP op,
+                                      bool generic,
+                                      page_mask_benchmark_masks_t *masks,
+                                      NvU32 iterations)
+{
+    NvU64 start_time = NV_GETTIME();
+    NvU32 i;
+
+    for (i = 0; i < iterations; i++) {
+        // Feed the result back into the input so that the compiler can't hoist
+        // the operation out of the loop.
+        masks->in1.bitmap[0] ^= page_mask_benchmark_op(op, generic, masks) & 1;
+    }
+
+    return NV_GETTIME() - start_time;
+}
+
+NV_STATUS uvm_test_page_mask_benchmark(UVM_TEST_PAGE_MASK_BENCHMARK_PARAMS *params, struct file *filp)
+{
+    page_mask_benchmark_masks_t *masks;
+    uvm_page_mask_t *generic_out;
+    uvm_test_rng_t rng;
+    NV_STATUS status = NV_OK;
+    NvU32 i;
+
+    if (params->op >= UVM_TEST_PAGE_MASK_OP_COUNT || params->iterations == 0)
+        return NV_ERR_INVALID_ARGUMENT;
+
+    masks = uvm_kvmalloc_zero(sizeof(*masks));
+    generic_out = uvm_kvmalloc_zero(sizeof(*generic_out));
+    if (!masks || !generic_out) {
+        status = NV_ERR_NO_MEMORY;
+        goto out;
+    }
+
+    uvm_test_rng_init(&rng, params->seed);
+
+    // Check the corner cases first, including bits set past the end of the
+    // last word which must be ignored by both implementations.
+    TEST_NV_CHECK_GOTO(test_page_mask_op_matches(params->op, masks, generic_out), out);
+
+    memset(masks->in1.bitmap, 0xff, sizeof(masks->in1.bitmap));
+    TEST_NV_CHECK_GOTO(test_page_mask_op_matches(params->op, masks, generic_out), out);
+
+    memset(masks->in2.bitmap, 0xff, sizeof(masks->in2.bitmap));
+    TEST_NV_CHECK_GOTO(test_page_mask_op_matches(params->op, masks, generic_out), out);
+
+    for (i = 0; i < 64; i++) {
+        uvm_test_rng_memset(&rng, masks, sizeof(*masks));
+
+        // Sparse masks exercise the early exits of the searches
+        if (i & 1)
+            uvm_page_mask_and(&masks->in1, &masks->in1, &masks->out);
+
+        TEST_NV_CHECK_GOTO(test_page_mask_op_matches(params->op, masks, generic_out), out);
+    }
+
+    params->generic_ns = page_mask_benchmark_time(params->op, true, masks, params->iterations);
+    params->page_mask_ns = page_mask_benchmark_time(params->op, false, masks, params->iterations);
+
+out:
+    uvm_kvfree(generic_out);
+    uvm_kvfree(masks);
+    return status;
+}
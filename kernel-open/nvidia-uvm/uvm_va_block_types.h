@@ -239,6 +239,11 @@ typedef struct
         // Access counters notification buffer index. Only valid when cause is
         // UVM_MAKE_RESIDENT_CAUSE_ACCESS_COUNTER.
         NvU32 access_counters_buffer_index;
+
+        // If 0 or 1, overrides the uvm_block_copy_coalesce module parameter
+        // for the copies done with this context. Only set by tests, -1
+        // otherwise.
+        int copy_coalesce;
     } make_resident;
 
     // State used by the mapping APIs (unmap, map, revoke). This could be used
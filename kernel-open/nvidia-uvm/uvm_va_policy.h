@@ -79,6 +79,11 @@ struct uvm_va_policy_struct
     // their page tables updated to access the (possibly remote) pages.
     uvm_processor_mask_t accessed_by;
 
+    // NUMA node selection for CPU pages when preferred_nid is NUMA_NO_NODE.
+    // Only managed VA ranges can set a policy other than
+    // UvmCpuNumaPlacementLocal.
+    UvmCpuNumaPlacement cpu_numa_placement;
+
 };
 
 // Policy nodes are used for storing policies in HMM va_blocks.
@@ -44,6 +44,12 @@ static struct kmem_cache *g_uvm_va_range_sked_reflected_cache __read_mostly;
 static struct kmem_cache *g_uvm_va_range_semaphore_pool_cache __read_mostly;
 static struct kmem_cache *g_uvm_vma_wrapper_cache __read_mostly;
 
+static int uvm_free_range_locked __read_mostly = 1;
+module_param(uvm_free_range_locked, int, S_IRUGO|S_IWUSR);
+MODULE_PARM_DESC(uvm_free_range_locked,
+                 "Unmap external ranges freed by UvmFree with only the span of the range locked "
+                 "instead of holding the VA space lock for write. Default: 1.");
+
 NV_STATUS uvm_va_range_init(void)
 {
     NV_STATUS status;
@@ -195,6 +201,9 @@ static uvm_va_range_managed_t *uvm_va_range_alloc_managed(uvm_va_space_t *va_spa
 
     managed_range->policy = uvm_va_policy_default;
 
+    uvm_perf_prefetch_stream_init(&managed_range->prefetch_stream);
+    uvm_perf_prefetch_adaptive_init(&managed_range->prefetch_adaptive);
+
     managed_range->blocks = uvm_kvmalloc_zero(uvm_va_range_num_blocks(managed_range) *
                                               sizeof(managed_range->blocks[0]));
     if (!managed_range->blocks) {
@@ -499,30 +508,44 @@ static void uvm_va_range_destroy_managed(uvm_va_range_managed_t *managed_range)
     kmem_cache_free(g_uvm_va_range_managed_cache, managed_range);
 }
 
-static void uvm_va_range_destroy_external(uvm_va_range_external_t *external_range, struct list_head *deferred_free_list)
+// Destroy all the external mappings of the range. The VA space lock must be
+// held for write, or for read if the range is dying.
+static void va_range_external_unmap_all(uvm_va_range_external_t *external_range,
+                                        struct list_head *deferred_free_list)
 {
+    uvm_va_space_t *va_space = external_range->va_range.va_space;
     uvm_gpu_t *gpu;
 
-    uvm_processor_mask_cache_free(external_range->retained_mask);
+    uvm_assert_rwsem_locked(&va_space->lock);
 
     if (uvm_processor_mask_empty(&external_range->mapped_gpus))
-        goto out;
+        return;
 
     UVM_ASSERT(deferred_free_list);
 
-    for_each_va_space_gpu_in_mask(gpu, external_range->va_range.va_space, &external_range->mapped_gpus) {
+    for_each_va_space_gpu_in_mask(gpu, va_space, &external_range->mapped_gpus) {
         uvm_ext_gpu_range_tree_t *range_tree = uvm_ext_gpu_range_tree(external_range, gpu);
         uvm_ext_gpu_map_t *ext_map, *ext_map_next;
 
         uvm_mutex_lock(&range_tree->lock);
         uvm_ext_gpu_map_for_each_safe(ext_map, ext_map_next, external_range, gpu)
             uvm_ext_gpu_map_destroy(external_range, ext_map, deferred_free_list);
+
+        // Other threads may test bits of the mask with just the VA space lock
+        // held for read and their range tree lock.
+        uvm_processor_mask_clear_atomic(&external_range->mapped_gpus, gpu->id);
         uvm_mutex_unlock(&range_tree->lock);
     }
 
     UVM_ASSERT(uvm_processor_mask_empty(&external_range->mapped_gpus));
+}
+
+static void uvm_va_range_destroy_external(uvm_va_range_external_t *external_range, struct list_head *deferred_free_list)
+{
+    uvm_processor_mask_cache_free(external_range->retained_mask);
+
+    va_range_external_unmap_all(external_range, deferred_free_list);
 
-out:
     kmem_cache_free(g_uvm_va_range_external_cache, external_range);
 }
 
@@ -658,6 +681,55 @@ static uvm_processor_mask_t *uvm_free_external(uvm_va_range_external_t *external
     return retained_mask;
 }
 
+// Unmap an external range being freed with the VA space lock only held for
+// read. Unmapping a large external range can take a long time, during which
+// holding the VA space lock for write would stall fault servicing and all the
+// other ioctls of the VA space, even though they can't touch the range.
+//
+// Instead, the range is marked dying and left in the VA range tree, which
+// keeps its span locked: lookups for new external mappings skip it and new
+// ranges can't be created over it. The lock is then downgraded to read for the
+// unmap, and taken again for write to remove the range from the tree. The GPUs
+// mapping the range are retained before the lock is dropped if there is
+// deferred work.
+//
+// Must be called with the VA space lock held for write, which is held again
+// for write on return. *write_ns is the time it was held for write before the
+// downgrade.
+static void uvm_free_external_range_locked(uvm_va_range_external_t *external_range,
+                                           uvm_processor_mask_t *retained_mask,
+                                           NvU64 lock_start,
+                                           NvU64 *write_ns,
+                                           struct list_head *deferred_free_list)
+{
+    uvm_va_space_t *va_space = external_range->va_range.va_space;
+    NvU64 read_start;
+
+    uvm_assert_rwsem_locked_write(&va_space->lock);
+
+    external_range->va_range.dying = true;
+
+    uvm_va_space_downgrade_write(va_space);
+    read_start = NV_GETTIME();
+    *write_ns = read_start - lock_start;
+
+    va_range_external_unmap_all(external_range, deferred_free_list);
+
+    // Retain the GPUs before dropping the lock, so they can't be unregistered
+    // before the deferred work is done.
+    if (!list_empty(deferred_free_list))
+        uvm_global_gpu_retain(retained_mask);
+
+    uvm_va_space_up_read(va_space);
+
+    uvm_va_space_lock_stat_add(&va_space->lock_stats.free_range_locked, NV_GETTIME() - read_start);
+
+    uvm_va_space_down_write(va_space);
+
+    UVM_ASSERT(external_range->va_range.dying);
+    UVM_ASSERT(uvm_processor_mask_empty(&external_range->mapped_gpus));
+}
+
 // This destroys VA ranges created by ioctl. VA ranges created by mmap, such as
 // through UvmMemMap, go through munmap.
 static NV_STATUS uvm_free(uvm_va_space_t *va_space, NvU64 base)
@@ -666,12 +738,15 @@ static NV_STATUS uvm_free(uvm_va_space_t *va_space, NvU64 base)
     NV_STATUS status = NV_OK;
     uvm_processor_mask_t *retained_mask = NULL;
     uvm_gpu_t *retained_gpu = NULL;
+    NvU64 lock_start;
+    NvU64 write_ns = 0;
     LIST_HEAD(deferred_free_list);
 
     uvm_va_space_down_write(va_space);
+    lock_start = NV_GETTIME();
 
     va_range = uvm_va_range_find(va_space, base);
-    if (!va_range || va_range->node.start != base) {
+    if (!va_range || va_range->node.start != base || va_range->dying) {
         status = NV_ERR_INVALID_ADDRESS;
         goto out;
     }
@@ -700,6 +775,19 @@ static NV_STATUS uvm_free(uvm_va_space_t *va_space, NvU64 base)
     if (status != NV_OK)
         goto out;
 
+    if (va_range->type == UVM_VA_RANGE_TYPE_EXTERNAL && uvm_free_range_locked) {
+        uvm_free_external_range_locked(uvm_va_range_to_external(va_range),
+                                       retained_mask,
+                                       lock_start,
+                                       &write_ns,
+                                       &deferred_free_list);
+        lock_start = NV_GETTIME();
+
+        // All the mappings are gone, so there is no deferred work left
+        uvm_va_range_destroy(va_range, NULL);
+        goto out;
+    }
+
     uvm_va_range_destroy(va_range, &deferred_free_list);
 
     // If there is deferred work, retain the required GPUs.
@@ -711,8 +799,14 @@ static NV_STATUS uvm_free(uvm_va_space_t *va_space, NvU64 base)
     }
 
 out:
+    write_ns += NV_GETTIME() - lock_start;
     uvm_va_space_up_write(va_space);
 
+    // Failed lookups hold the lock very briefly and would skew the latencies
+    // of actual frees.
+    if (status == NV_OK)
+        uvm_va_space_lock_stat_add(&va_space->lock_stats.free_write, write_ns);
+
     if (!list_empty(&deferred_free_list)) {
         UVM_ASSERT(status == NV_OK);
         uvm_deferred_free_object_list(&deferred_free_list);
@@ -1363,10 +1457,14 @@ NV_STATUS uvm_va_range_split(uvm_va_range_managed_t *existing_managed_range,
     new_policy->read_duplication = existing_policy->read_duplication;
     new_policy->preferred_location = existing_policy->preferred_location;
     new_policy->preferred_nid = existing_policy->preferred_nid;
+    new_policy->cpu_numa_placement = existing_policy->cpu_numa_placement;
     uvm_processor_mask_copy(&new_policy->accessed_by,
                             &existing_policy->accessed_by);
     uvm_processor_mask_copy(&new->uvm_lite_gpus, &existing_managed_range->uvm_lite_gpus);
 
+    // Both halves keep the prefetch threshold learnt so far
+    new->prefetch_adaptive.threshold = READ_ONCE(existing_managed_range->prefetch_adaptive.threshold);
+
     status = uvm_va_range_split_blocks(existing_managed_range, new);
     if (status != NV_OK) {
         uvm_va_range_destroy(&new->va_range, NULL);
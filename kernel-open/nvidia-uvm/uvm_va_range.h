@@ -28,6 +28,7 @@
 #include "nv-kref.h"
 #include "uvm_common.h"
 #include "uvm_perf_module.h"
+#include "uvm_perf_prefetch.h"
 #include "uvm_processors.h"
 #include "uvm_gpu.h"
 #include "uvm_lock.h"
@@ -231,6 +232,13 @@ struct uvm_va_range_struct
     // Set by error injection ioctl (testing purposes only).
     bool inject_add_gpu_va_space_error;
 
+    // Set while the va_range is torn down by uvm_free() with the VA space lock
+    // only held for read. The va_range stays in the VA range tree until then,
+    // which keeps its span locked against the creation of new ranges, but it
+    // must not be looked up to start new work. Only written with the VA space
+    // lock held for write.
+    bool dying;
+
     uvm_va_range_type_t type;
 };
 
@@ -287,6 +295,14 @@ struct uvm_va_range_managed_struct
     bool inject_split_error;
 
     uvm_perf_module_data_desc_t perf_modules_data[UVM_PERF_MODULE_TYPE_COUNT];
+
+    // Detector of GPU fault streams that span multiple VA blocks of the range.
+    // See uvm_perf_prefetch_stream_notify().
+    uvm_perf_prefetch_stream_t prefetch_stream;
+
+    // Prefetch threshold learnt from the use of the prefetched pages of the
+    // range. See uvm_perf_prefetch_adaptive_t.
+    uvm_perf_prefetch_adaptive_t prefetch_adaptive;
 };
 
 // Subclass of va_range state for va_range.type == UVM_VA_RANGE_TYPE_EXTERNAL
@@ -684,7 +700,7 @@ static uvm_va_range_external_t *uvm_va_range_external_find(uvm_va_space_t *va_sp
     va_range = uvm_va_range_find(va_space, addr);
     if (!va_range)
         return NULL;
-    if (va_range->type != UVM_VA_RANGE_TYPE_EXTERNAL)
+    if (va_range->type != UVM_VA_RANGE_TYPE_EXTERNAL || va_range->dying)
         return NULL;
     return uvm_va_range_to_external(va_range);
 }
@@ -2414,6 +2414,63 @@ NV_STATUS uvm_test_va_space_allow_movable_allocations(UVM_TEST_VA_SPACE_ALLOW_MO
     return NV_OK;
 }
 
+void uvm_va_space_lock_stat_add(uvm_va_space_lock_stat_t *stat, NvU64 ns)
+{
+    NvU64 max_ns = atomic64_read(&stat->max_ns);
+
+    atomic64_inc(&stat->count);
+    atomic64_add(ns, &stat->total_ns);
+
+    while (ns > max_ns) {
+        NvU64 old_max_ns = atomic64_cmpxchg(&stat->max_ns, max_ns, ns);
+        if (old_max_ns == max_ns)
+            break;
+
+        max_ns = old_max_ns;
+    }
+}
+
+static void va_space_lock_stat_get(uvm_va_space_lock_stat_t *stat,
+                                   NvU64 *count,
+                                   NvU64 *total_ns,
+                                   NvU64 *max_ns,
+                                   bool reset)
+{
+    if (reset) {
+        *count = atomic64_xchg(&stat->count, 0);
+        *total_ns = atomic64_xchg(&stat->total_ns, 0);
+        *max_ns = atomic64_xchg(&stat->max_ns, 0);
+    }
+    else {
+        *count = atomic64_read(&stat->count);
+        *total_ns = atomic64_read(&stat->total_ns);
+        *max_ns = atomic64_read(&stat->max_ns);
+    }
+}
+
+NV_STATUS uvm_test_va_space_lock_stats(UVM_TEST_VA_SPACE_LOCK_STATS_PARAMS *params, struct file *filp)
+{
+    uvm_va_space_t *va_space = uvm_va_space_get(filp);
+
+    va_space_lock_stat_get(&va_space->lock_stats.free_write,
+                           &params->free_write_count,
+                           &params->free_write_total_ns,
+                           &params->free_write_max_ns,
+                           params->reset);
+    va_space_lock_stat_get(&va_space->lock_stats.free_range_locked,
+                           &params->free_range_locked_count,
+                           &params->free_range_locked_total_ns,
+                           &params->free_range_locked_max_ns,
+                           params->reset);
+    va_space_lock_stat_get(&va_space->lock_stats.fault_read_wait,
+                           &params->fault_read_wait_count,
+                           &params->fault_read_wait_total_ns,
+                           &params->fault_read_wait_max_ns,
+                           params->reset);
+
+    return NV_OK;
+}
+
 // List of fault service contexts for CPU faults
 static LIST_HEAD(g_cpu_service_block_context_list);
 
@@ -183,6 +183,15 @@ typedef struct
     uvm_parent_gpu_t *routing_table[UVM_PARENT_ID_MAX_GPUS];
 } uvm_egm_numa_node_info_t;
 
+// Latency of one kind of VA space lock acquisition or critical section.
+// Reported by UVM_TEST_VA_SPACE_LOCK_STATS.
+typedef struct
+{
+    atomic64_t count;
+    atomic64_t total_ns;
+    atomic64_t max_ns;
+} uvm_va_space_lock_stat_t;
+
 struct uvm_va_space_struct
 {
     // Mask of gpus registered with the va space
@@ -409,6 +418,20 @@ struct uvm_va_space_struct
         uvm_mutex_t mask_mutex;
     } closest_processors;
 
+    struct
+    {
+        // Time spent by uvm_free() holding the VA space lock for write
+        uvm_va_space_lock_stat_t free_write;
+
+        // Time spent by uvm_free() tearing down a range which is kept locked
+        // while the VA space lock is only held for read
+        uvm_va_space_lock_stat_t free_range_locked;
+
+        // Time spent by the replayable fault servicing path waiting to
+        // acquire the VA space lock for read
+        uvm_va_space_lock_stat_t fault_read_wait;
+    } lock_stats;
+
     struct
     {
         bool  page_prefetch_enabled;
@@ -425,6 +448,10 @@ struct uvm_va_space_struct
 
         atomic64_t split_invalidate_delay_us;
 
+        // Disables the batching of HMM va_block invalidations. Read from the
+        // mmu_notifier callbacks without any lock held.
+        bool hmm_invalidate_batch_disabled;
+
         bool force_cpu_to_cpu_copy_with_ce;
 
         bool allow_allocation_from_movable;
@@ -885,6 +912,10 @@ NV_STATUS uvm_test_force_cpu_to_cpu_copy_with_ce(UVM_TEST_FORCE_CPU_TO_CPU_COPY_
                                                  struct file *filp);
 NV_STATUS uvm_test_va_space_allow_movable_allocations(UVM_TEST_VA_SPACE_ALLOW_MOVABLE_ALLOCATIONS_PARAMS *params,
                                                       struct file *filp);
+NV_STATUS uvm_test_va_space_lock_stats(UVM_TEST_VA_SPACE_LOCK_STATS_PARAMS *params, struct file *filp);
+
+// Account ns to the given lock latency statistic
+void uvm_va_space_lock_stat_add(uvm_va_space_lock_stat_t *stat, NvU64 ns);
 
 // Handle a CPU fault in the given VA space for a managed allocation,
 // performing any operations necessary to establish a coherent CPU mapping